@@ -6,7 +6,8 @@
  *
  *  Description: Internal header file for A12 BBIS driver
  *
- *     Switches: ---
+ *     Switches: A12_NO_TRACE - compile out the event trace
+ *               A12_NO_REC   - compile out the register access recording
  *
  *
  *---------------------------------------------------------------------------
@@ -48,6 +49,9 @@
 #define A12_MMOD_BRIDGE_VEN_ID	0x1172 /* Altera */
 #define A12_MMOD_BRIDGE_DEV_ID	0x410c /* A12 */
 
+#define A12_PCI_MAX_BUS			255	 /* bridge scan (BRIDGE_INSTANCE) */
+#define A12_PCI_MAX_DEV			32
+
 
 #define A12_MMOD_SLOT_OFFSET	0x02000000 /* addr off between M-mod slots */
 
@@ -59,7 +63,200 @@
 #define A12_MMOD_IACK_BASE		0x01ffff00
 #define A12_MMOD_CTRL_BASE		0x01ffff04
 
+/* QSPI window in BAR0 (QSPI_WIN_xxx), IRQ status register (QSPI_IRQ_xxx) */
+#define A12_QSPI_WIN_OFFSET		(3 * A12_MMOD_SLOT_OFFSET)
+#define A12_QSPI_WIN_SIZE		0x800
+#define A12_QSPI_IRQ_OFFSET		0x1f /* status register SPSR */
+#define A12_QSPI_IRQ_MASK		0xe0 /* SPIF | MODF | HALTA */
+#define A12_BAR0_SIZE			(4 * A12_MMOD_SLOT_OFFSET)
+
+/* sizes of the address spaces */
+#define A12_MMOD_A24_D32_SIZE	0x01000000
+#define A12_MMOD_A24_D16_SIZE	(0x01000000 - 0x300)
+#define A12_MMOD_A08_SIZE		0x100
+
+/* windows of block transfers, index into MMOD.vWin[] */
+#define A12_WIN_D32				0	 /* + A12_WIN_A08 for A08 */
+#define A12_WIN_D16				1
+#define A12_WIN_A08				2
+#define A12_NBR_OF_WINS			4
+
 #define A12_CTRL_SIZE			0x2
+
+/* BAR0 config register attribute bits */
+#define A12_PCI_BAR_TYPE		0x06 /* memory BAR type */
+#define A12_PCI_BAR_TYPE_64		0x04 /* 64-bit BAR */
+#define A12_PCI_BAR_PREFETCH	0x08 /* prefetchable */
+#define A12_PCI_BAR_ADDR		0xfffffff0 /* address bits */
+
+/* control register bits */
+#define A12_CTRL_IRQ			0x01 /* IRQ pending (read only) */
+#define A12_CTRL_IEN			0x02 /* IRQ enable */
+#define A12_CTRL_FAST			0x0c /* fast bits, reset value */
+#define A12_CTRL_TIMING(t)		((t) << 2) /* A12_TIMING_xxx to fast bits */
+
+#define A12_CACHE_LINE			64	 /* separates hot per-slot data */
+
+/* reasons for the BBIS to hold IEN cleared while the driver enabled it */
+#define A12_MASK_MODERATE		0x01 /* IRQ moderation holdoff */
+#define A12_MASK_DEFER			0x02 /* queued for deferred servicing */
+#define A12_MASK_POLL			0x04 /* slot in polling mode */
+#define A12_MASK_SUSPEND		0x08 /* bridge suspended */
+#define A12_MASK_RESET			0x10 /* slot quiesced for reset */
+#define A12_MASK_STORM			0x20 /* IRQ storm quarantine */
+
+#define A12_STORM_MAX_SHIFT		6	 /* quarantine doubled at most 6 times */
+
+#define A12_SCAN_HIT			16	 /* scanScore added per claim */
+#define A12_SCAN_SCORE_MAX		0xffffff /* scanScore used for the order */
+
+/*
+ * Build switch A12_OS_WORKERS: the OS layer calls A12_DeferClaim for the
+ * deferred slot work and A12_Poll for polled slots. The stock MDIS kernel
+ * calls neither, so without it this code is not built at all and
+ * deferred servicing and polling are refused, a slot would stay masked.
+ */
+#ifdef A12_OS_WORKERS
+# define A12_DEFER_QUEUES		8	 /* per-CPU deferred work queues */
+# define A12_SRV_DEFERRED		2	 /* SrvClaim: slot queued, no ISR */
+# define A12_POLLED(h,bit)		((h)->irq.pollMask & (bit))
+#else
+# define A12_POLLED(h,bit)		0
+#endif
+
+
+/*
+ * Lock-free helpers, return the previous value. Without compiler atomics
+ * (or with build switch A12_OSS_ATOMIC), they are done under a driver
+ * wide OSS spin lock instead, see AtomicOp.
+ */
+#if defined(A12_OSS_ATOMIC) || (!defined(__GNUC__) && !defined(_MSC_VER))
+# ifndef A12_OSS_ATOMIC
+#  define A12_OSS_ATOMIC
+# endif
+# define A12_AOP_OR					0
+# define A12_AOP_AND				1
+# define A12_AOP_ADD				2
+# define A12_AOP_CAS				3	 /* v: new value, o: expected */
+# define A12_AOP_BAR				4	 /* lock/unlock only */
+# define A12_ATOMIC_FETCH_OR(p,v)	\
+	AtomicOp((volatile u_int32*)(p),(v),0,A12_AOP_OR)
+# define A12_ATOMIC_FETCH_AND(p,v)	\
+	AtomicOp((volatile u_int32*)(p),(v),0,A12_AOP_AND)
+# define A12_ATOMIC_FETCH_ADD(p,v)	\
+	AtomicOp((volatile u_int32*)(p),(v),0,A12_AOP_ADD)
+# define A12_ATOMIC_CAS(p,o,n)		\
+	(AtomicOp((volatile u_int32*)(p),(n),(o),A12_AOP_CAS) == (u_int32)(o))
+# define A12_ATOMIC_CASPTR(p,o,n)	\
+	AtomicCasPtr((void * volatile *)(p),(void*)(o),(void*)(n))
+# define A12_MEMBAR()				AtomicOp(NULL,0,0,A12_AOP_BAR)
+# define A12_CACHE_ALIGNED
+#elif defined(__GNUC__)
+# define A12_ATOMIC_FETCH_OR(p,v)	__sync_fetch_and_or((p),(v))
+# define A12_ATOMIC_FETCH_AND(p,v)	__sync_fetch_and_and((p),(v))
+# define A12_ATOMIC_FETCH_ADD(p,v)	__sync_fetch_and_add((p),(v))
+# define A12_ATOMIC_CAS(p,o,n)		__sync_bool_compare_and_swap((p),(o),(n))
+# define A12_ATOMIC_CASPTR(p,o,n)	__sync_bool_compare_and_swap((p),(o),(n))
+# define A12_MEMBAR()				__sync_synchronize()
+# define A12_CACHE_ALIGNED			__attribute__((aligned(A12_CACHE_LINE)))
+#elif defined(_MSC_VER)
+# define A12_ATOMIC_FETCH_OR(p,v)	((u_int32)_InterlockedOr((long*)(p),(v)))
+# define A12_ATOMIC_FETCH_AND(p,v)	((u_int32)_InterlockedAnd((long*)(p),(v)))
+# define A12_ATOMIC_FETCH_ADD(p,v)	\
+	((u_int32)_InterlockedExchangeAdd((long*)(p),(v)))
+# define A12_ATOMIC_CAS(p,o,n)		\
+	(_InterlockedCompareExchange((long*)(p),(n),(o)) == (long)(o))
+# define A12_ATOMIC_CASPTR(p,o,n)	\
+	(_InterlockedCompareExchangePointer((void**)(p),(n),(o)) == (void*)(o))
+# define A12_MEMBAR()				MemoryBarrier()
+# define A12_CACHE_ALIGNED			__declspec(align(A12_CACHE_LINE))
+#endif
+
+/* cycle counter for the IRQ statistics */
+#if defined(A12_SIM)
+# define A12_CYCLES(h)		A12SIM_Clock()
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+# define A12_CYCLES(h)		A12_Rdtsc()
+static __inline__ u_int64 A12_Rdtsc( void )
+{
+	u_int32 lo, hi;
+	__asm__ __volatile__( "rdtsc" : "=a"(lo), "=d"(hi) );
+	return ((u_int64)hi << 32) | lo;
+}
+#else
+# define A12_CYCLES(h)		((u_int64)OSS_TickGet( (h)->osHdl ))
+#endif
+
+/*
+ * 16 byte SIMD accesses for block transfers (one PCI burst of 4 DWORDs).
+ * Not in kernel builds, which must not touch the FPU/SIMD registers.
+ */
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(__KERNEL__)
+# define A12_BLK_SIMD
+# include <emmintrin.h>
+# if defined(A12_SIM)
+#  define A12_RD128(ma,offs)		A12SIM_Read128((void*)(ma),(offs))
+#  define A12_WR128(ma,offs,v)		A12SIM_Write128((void*)(ma),(offs),(v))
+# else
+#  define A12_RD128(ma,offs)		\
+	_mm_load_si128( (__m128i*)((u_int8*)(ma)+(offs)) )
+#  define A12_WR128(ma,offs,v)		\
+	_mm_store_si128( (__m128i*)((u_int8*)(ma)+(offs)), (v) )
+# endif
+#endif
+
+/*
+ * Write-combined mappings. OSS_MapPhysToVirtAddr has no cache attribute,
+ * so only the simulator and the userspace backend (resource<n>_wc of the
+ * BAR in sysfs) provide them, elsewhere views are uncached.
+ */
+#if defined(A12_SIM)
+# define A12_MAP_WC(h,phys,size,virtP)	A12SIM_MapWc((phys),(size),(virtP))
+# define A12_UNMAP_WC(h,virt,size)		A12SIM_UnMapWc((virt),(size))
+#elif defined(A12_UIO)
+# define A12_MAP_WC(h,phys,size,virtP)	A12UIO_MapWc((phys),(size),(virtP))
+# define A12_UNMAP_WC(h,virt,size)		A12UIO_UnMapWc((virt),(size))
+#endif
+
+/*
+ * Event trace of the interrupt path, see TraceRec. When the trace is off
+ * an event costs the test of irq.trace, which is on the cache line the
+ * interrupt path reads anyway.
+ */
+#ifdef A12_NO_TRACE
+# define A12_TRACE_ON(h)	0
+#else
+# define A12_TRACE_ON(h)	((h)->irq.trace)
+#endif
+#define A12_TRACE(h,mSlot,ev,ctrl,ret) \
+	do { if( A12_TRACE_ON(h) ) TraceRec( (h),(mSlot),(ev),(ctrl),(ret) ); \
+	} while(0)
+
+/*
+ * Register access recording, see RecAdd. Accesses and the entry points
+ * they belong to are recorded; while recording is off, this costs the
+ * test of irq.rec next to irq.trace.
+ */
+#ifdef A12_NO_REC
+# define A12_REC_ON(h)		0
+#else
+# define A12_REC_ON(h)		((h)->irq.rec)
+#endif
+#define A12_RECORD(h,mSlot,op,arg,val) \
+	do { if( A12_REC_ON(h) ) RecAdd( (h),(mSlot),(op),(arg),(val) ); \
+	} while(0)
+
+/* CPU the caller runs on, selects the deferred work queue */
+#if defined(A12_SIM)
+# define A12_CPU_ID()		A12SIM_CpuId()
+#elif defined(A12_UIO)
+# define A12_CPU_ID()		A12UIO_CpuId()
+#elif defined(LINUX) && defined(__KERNEL__)
+# define A12_CPU_ID()		((u_int32)raw_smp_processor_id())
+#else
+# define A12_CPU_ID()		0
+#endif
+
 /*---------------------------------------------------------------------------+
 |    TYPEDEFS                                                                |
 +---------------------------------------------------------------------------*/
@@ -67,24 +264,203 @@
 |  TYPEDEFS                                |
 +-----------------------------------------*/
 
-/* struct for each M-module slot */
+/* configuration of each device (M-module slots 0..2, QSPI) */
 typedef struct {
+	u_int32 devBusType;
+	u_int32 interrupts;
+	u_int32 addrSpace;
+	int32 	pciBusNbr;
+	int32 	pciDevNbr;
+	int32   irqLevel;
+	int32   irqMode;
+	u_int32	enable;				/* device usable */
+	u_int32	policy;				/* A12_POLICY_xxx (M-modules) */
+	u_int32	timing;				/* A12_TIMING_xxx (M-modules) */
+	u_int32	scanPrio;			/* SLOT_n_SCAN_PRIO (M-modules) */
+} A12_SLOT_CFG;
+
+/* struct for each M-module slot, on its own cache line(s) */
+typedef struct A12_CACHE_ALIGNED {
 	MACCESS		vCtrlBase;		/* control registers virtual base */
+	MACCESS		vWin[A12_NBR_OF_WINS]; /* block windows, mapped on use */
+	volatile u_int32 ctrl;		/* control register shadow (w/o IRQ bit) */
+	volatile u_int32 ctrlUsers;	/* vCtrlBase accesses in progress */
+	volatile u_int32 unmapped;	/* vCtrlBase unmapped by A12_RESET_REMAP */
+	volatile u_int32 maskReasons; /* A12_MASK_xxx */
+	/* IRQ moderation */
+	u_int32		modBudget;		/* IRQs before holdoff, 0=off */
+	u_int32		modTime;		/* holdoff time [ms] */
+	volatile u_int32 modEvents;	/* IRQs since last holdoff */
+	OSS_ALARM_HANDLE *modAlarm;	/* holdoff alarm */
+#ifdef A12_OS_WORKERS
+	/* hybrid IRQ/poll mode */
+	u_int32		poll;			/* hybrid mode enabled */
+	u_int32		pollOn;			/* IRQs/window to start polling */
+	u_int32		pollOff;		/* IRQs/window to return to IRQs */
+	u_int32		pollWinMs;		/* rate window [ms] */
+	u_int32		pollWin;		/* rate window [ticks] */
+	u_int32		pollPeriod;		/* poll period for the poller [us] */
+	volatile u_int32 pollEvents; /* IRQs in current window */
+	volatile u_int32 pollWinStart; /* tick of window start */
+#endif
+	/* IRQ storm quarantine */
+	u_int32		stormIrqs;		/* IRQs/window = storm, 0=off */
+	u_int32		stormWinMs;		/* storm window [ms] */
+	u_int32		stormWin;		/* storm window [ticks] */
+	u_int32		stormTime;		/* first quarantine [ms] */
+	volatile u_int32 stormShift; /* quarantine = stormTime << stormShift */
+	volatile u_int32 stormHoldoff; /* current quarantine [ms], 0=none */
+	volatile u_int32 stormEvents; /* IRQs in current window */
+	volatile u_int32 stormWinStart; /* tick of window start */
+	OSS_ALARM_HANDLE *stormAlarm; /* quarantine end alarm */
+	/* adaptive scan order */
+	volatile u_int32 scanScore;	/* claims, halved each tick */
+	volatile u_int32 scanTick;	/* tick of last claim */
+	void		*brdHdl;		/* back pointer for alarm callbacks */
+	u_int32		slot;			/* own slot number */
+	u_int32		cpus;			/* CPU hint of deferred work, 0=none */
 } MMOD;
 
+/* board wide interrupt state, written from every CPU taking the IRQ */
+typedef struct A12_CACHE_ALIGNED {
+	volatile u_int32 enMask;		/* enabled devices, bit CFIDX */
+	volatile u_int32 ienMask;		/* slots with IEN set */
+#ifdef A12_OS_WORKERS
+	volatile u_int32 irqPend;		/* pending slots of A12_Poll */
+	volatile u_int32 irqPendValid;	/* unconsumed A12_Poll answers */
+	volatile u_int32 pollMask;		/* slots in polling mode */
+	volatile u_int32 pollFix;		/* slots always polled */
+#endif
+	volatile u_int32 trace;			/* event trace on */
+	volatile u_int32 rec;			/* access recording on */
+	volatile u_int32 qspiMask;		/* QSPI status bits claiming IRQ9 */
+	volatile u_int32 scan;			/* A12_SCAN_xxx */
+	volatile u_int32 scanOrder;		/* order by SLOT_n_SCAN_PRIO */
+} A12_IRQ_STATE;
+
+/* QSPI interrupt check and events, written from the IRQ9 path */
+typedef struct A12_CACHE_ALIGNED {
+	MACCESS		vStat;				/* IRQ status register */
+	volatile u_int32 last;			/* status of last claimed IRQ */
+	volatile u_int32 ev[8];			/* claimed IRQs per status bit */
+} A12_QSPI;
+
+/* per device statistics, recorded lock-free from the IRQ path */
+typedef struct A12_CACHE_ALIGNED {
+	A12_IRQ_STAT	s;				/* counters, see bb_a12_ext.h */
+	u_int64			t0;				/* cycles at irqSrvInit */
+	u_int32			inSrv;			/* between irqSrvInit and Exit */
+} A12_DEV_STAT;
+
+#ifdef A12_OS_WORKERS
+/* deferred work queue of one CPU: slots waiting for a worker */
+typedef struct A12_CACHE_ALIGNED {
+	volatile u_int32 mask;			/* queued M-module slots */
+} A12_DEFER_QUEUE;
+#endif
+
+#ifdef A12_OS_WORKERS
+/* scatter-gather queue of one M-module slot */
+typedef struct A12_CACHE_ALIGNED {
+	A12_SG_REQ * volatile submit;	/* submitted requests, newest first */
+	volatile u_int32 busy;			/* queue executed by an SG worker */
+	/* busy owner only */
+	A12_SG_REQ	*ovfl;				/* completed, ring was full */
+	A12_SG_REQ	*ovflTail;
+	A12_SG_STAT	stat;				/* statistics */
+	/* completion ring, written by busy owner (head), consumer (tail) */
+	A12_SG_REQ	*ring[A12_SG_RING];
+	volatile u_int32 head;
+	volatile u_int32 tail;
+} A12_SG_QUEUE;
+#endif
+
+/* event trace ring of one CPU, written from that CPU only */
+typedef struct A12_CACHE_ALIGNED {
+	volatile u_int32 head;			/* events recorded */
+	u_int32		tail;				/* events drained */
+	u_int32		lost;				/* overwritten before drained */
+	A12_TRACE_EV ev[A12_TRACE_ENTRIES];
+} A12_TRACE_RING;
+
+/* recorded access with absolute time */
+typedef struct {
+	u_int64		time;				/* CPU cycles */
+	A12_REC		r;					/* r.dt unused */
+} A12_REC_ENT;
+
+/* access recording ring, written from all CPUs */
+typedef struct A12_CACHE_ALIGNED {
+	volatile u_int32 head;			/* records recorded */
+	u_int32		tail;				/* records drained */
+	u_int32		lost;				/* overwritten before drained */
+	u_int32		lostRep;			/* lost reported in a chunk */
+	u_int64		cycOn;				/* CPU cycles at recording on */
+	u_int32		tickOn;				/* OSS ticks at recording on */
+	A12_REC_ENT	ent[A12_REC_ENTRIES];
+} A12_REC_RING;
+
+/*
+ * Cold fields first, hot interrupt path data on separate cache lines.
+ * The handle itself is allocated cache line aligned (see A12_Init).
+ */
 typedef struct {
 	MDIS_IDENT_FUNCT_TBL idFuncTbl;				/* id function table		*/
+	void		*ownMem;						/* allocated memory			*/
     u_int32     ownMemSize;						/* own memory size			*/
     OSS_HANDLE* osHdl;							/* os specific handle		*/
+#ifdef A12_OSS_ATOMIC
+	u_int32		atomRef;						/* AtomicInit done */
+#endif
     DESC_HANDLE *descHdl;						/* descriptor handle pointer*/
     u_int32     debugLevel;						/* debug level for BBIS     */
 	DBG_HANDLE  *debugHdl;						/* debug handle				*/
+	int32		pciBusNbr;						/* bridge PCI bus */
+	int32		pciDevNbr;						/* bridge PCI device */
 	void		*physBase;						/* phys base of regs (BAR0) */
-	MMOD		mmod[A12_NBR_OF_MMODS];			/* m-module control */
+	u_int32		barPrefetch;					/* BAR0 prefetchable */
+	u_int32		a24Attr[A12_NBR_OF_MMODS];		/* allowed A12_MATTR_xxx */
     OSS_RESOURCES res[A12_NBR_OF_MMODS]; 		/* resources */
-	int32		resourcesAssigned; 				/* flag resources assigned */
+	u_int32		lazyInit;						/* slots set up on first use */
+	u_int32		resAssigned;					/* slots with resources */
+	u_int32		attached;						/* slots set up (SlotAttach) */
+	u_int32		brdUp;							/* between BrdInit/BrdExit */
+	u_int32		irqValid;						/* irqLevel/Vector valid */
 	int32		irqLevel;						/* bridge IRQ level */
 	int32		irqVector;						/* bridge IRQ vector */
+#ifdef A12_OS_WORKERS
+	u_int32		irqDefer;						/* deferred servicing on */
+#endif
+	u_int32		irqCpus;						/* CPU hint of bridge IRQ */
+	u_int32		suspended;						/* M_BB_A12_SUSPEND */
+	u_int32		enSave;							/* enMask while suspended */
+	u_int32		warm;							/* A12_WarmInit until BrdInit */
+	u_int32		ienSave;						/* ienMask for warm BrdInit */
+	u_int32		quiesced;						/* slots held for reset */
+	A12_SLOT_CFG slotCfg[BRD_NBR_OF_BRDDEV];	/* device configuration */
+	A12_SLOT_RES slotRes[BRD_NBR_OF_BRDDEV];	/* device resources */
+	u_int32		resValid;						/* slotRes valid, bit CFIDX */
+	u_int32		qspiOffs;						/* QSPI window in BAR0 */
+	u_int32		qspiSize;
+	u_int32		qspiIrqOffs;					/* QSPI IRQ status register */
+	u_int32		qspiIrqMask;					/* its IRQ bits, 0=no check */
+	A12_TRACE_RING *trRing;						/* trace rings, on demand */
+	void		*trMem;							/* allocated trace memory */
+	u_int32		trMemSize;
+	A12_REC_RING *recRing;						/* recording, on demand */
+	void		*recMem;						/* allocated recording mem */
+	u_int32		recMemSize;
+	/* hot */
+	A12_IRQ_STATE irq;							/* interrupt state */
+	MMOD		mmod[A12_NBR_OF_MMODS];			/* m-module control */
+	A12_QSPI	qspi;							/* QSPI interrupt */
+	A12_DEV_STAT stat[BRD_NBR_OF_BRDDEV];		/* IRQ statistics */
+#ifdef A12_OS_WORKERS
+	A12_DEFER_QUEUE dq[A12_DEFER_QUEUES];		/* deferred work queues */
+#endif
+#ifdef A12_OS_WORKERS
+	A12_SG_QUEUE sg[A12_NBR_OF_MMODS];			/* scatter-gather queues */
+#endif
 } BBIS_HANDLE;
 
 
@@ -93,6 +469,8 @@ typedef struct {
 +---------------------------------------------------------------------------*/
 /* init/exit */
 static int32 A12_Init(OSS_HANDLE*, DESC_SPEC*, BBIS_HANDLE**);
+static int32 A12_WarmInit(OSS_HANDLE*, DESC_SPEC*, const A12_WARM*,
+						  BBIS_HANDLE**);
 static int32 A12_BrdInit(BBIS_HANDLE*);
 static int32 A12_BrdExit(BBIS_HANDLE*);
 static int32 A12_Exit(BBIS_HANDLE**);
@@ -103,6 +481,33 @@ static int32 A12_CfgInfo(BBIS_HANDLE*, u_int32, ...);
 static int32 A12_IrqEnable(BBIS_HANDLE*, u_int32, u_int32);
 static int32 A12_IrqSrvInit(BBIS_HANDLE*, u_int32);
 static void  A12_IrqSrvExit(BBIS_HANDLE*, u_int32);
+static int32 A12_IrqPendMask(BBIS_HANDLE*, u_int32*);
+#ifdef A12_OS_WORKERS
+static int32 A12_DeferClaim(BBIS_HANDLE*, u_int32, u_int32*);
+static int32 A12_Poll(BBIS_HANDLE*, u_int32*);
+#endif
+static int32 A12_IrqOrder(BBIS_HANDLE*, u_int32*);
+/* address views */
+static int32 A12_GetMAddrEx(BBIS_HANDLE*, u_int32, u_int32, u_int32,
+							A12_MADDR*);
+static int32 A12_MapView(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+						 A12_VIEW*);
+static int32 A12_UnMapView(BBIS_HANDLE*, A12_VIEW*);
+/* block transfers */
+static int32 A12_BlkRead(BBIS_HANDLE*, u_int32, u_int32, u_int32, void*,
+						 u_int32);
+static int32 A12_BlkWrite(BBIS_HANDLE*, u_int32, u_int32, u_int32,
+						  const void*, u_int32);
+static int32 A12_BlkFill(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+						 u_int32);
+/* scatter-gather queue */
+#ifdef A12_OS_WORKERS
+static int32 A12_SgSubmit(BBIS_HANDLE*, u_int32, A12_SG_REQ*);
+static int32 A12_SgComplete(BBIS_HANDLE*, u_int32, A12_SG_REQ**);
+static int32 A12_SgRun(BBIS_HANDLE*, u_int32, const A12_SG_BACKEND*);
+#endif
+/* resources */
+static int32 A12_ResQuery(BBIS_HANDLE*, u_int32, A12_SLOT_RES*, u_int32*);
 /* exception handling */
 static int32 A12_ExpEnable(BBIS_HANDLE*,u_int32, u_int32);
 static int32 A12_ExpSrv(BBIS_HANDLE*,u_int32);
@@ -114,9 +519,74 @@ static int32 A12_GetMAddr(BBIS_HANDLE*, u_int32, u_int32, u_int32, void**, u_int
 static int32 A12_SetStat(BBIS_HANDLE*, u_int32, int32, INT32_OR_64);
 static int32 A12_GetStat(BBIS_HANDLE*, u_int32, int32, INT32_OR_64*);
 /* unused */
+#ifndef A12_OS_WORKERS
 static int32 A12_Unused(void);
+#endif
 /* miscellaneous */
 static char* Ident( void );
+static int32 SrvClaim(BBIS_HANDLE*, u_int32, u_int32, int32);
+static void CtrlUpdate(BBIS_HANDLE*, u_int32, u_int32, u_int32);
+static int32 CtrlGet(BBIS_HANDLE*, u_int32);
+static void CtrlPut(BBIS_HANDLE*, u_int32);
+static void StatHist(A12_DEV_STAT*, u_int64);
+#ifdef A12_OSS_ATOMIC
+static int32 AtomicInit(OSS_HANDLE*);
+static void AtomicExit(void);
+static u_int32 AtomicOp(volatile u_int32*, u_int32, u_int32, u_int32);
+static int32 AtomicCasPtr(void * volatile *, void*, void*);
+#endif
+static void IenApply(BBIS_HANDLE*, u_int32);
+static int32 ModSet(BBIS_HANDLE*, u_int32, u_int32, u_int32);
+static void ModAlarm(void*);
+#ifdef A12_OS_WORKERS
+static u_int32 DeferTake(A12_DEFER_QUEUE*, u_int32);
+#endif
+static int32 HandleAlloc(OSS_HANDLE*, DESC_SPEC*, BBIS_HANDLE**);
+static int32 BridgeFind(BBIS_HANDLE*, u_int32);
+static int32 BridgeCheck(BBIS_HANDLE*);
+static int32 IrqAttach(BBIS_HANDLE*);
+static int32 SlotAttach(BBIS_HANDLE*, u_int32);
+static int32 SlotMap(BBIS_HANDLE*, u_int32);
+static void WarmSave(BBIS_HANDLE*, A12_WARM*);
+static int32 Suspend(BBIS_HANDLE*, u_int32);
+static int32 SlotReset(BBIS_HANDLE*, u_int32, u_int32);
+#ifdef A12_OS_WORKERS
+static int32 PollSet(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+					 u_int32, u_int32);
+static void PollCheck(BBIS_HANDLE*, u_int32);
+static void PollSwitch(BBIS_HANDLE*, u_int32, u_int32);
+#endif
+static int32 StormSet(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32);
+static void StormCheck(BBIS_HANDLE*, u_int32);
+static void StormAlarm(void*);
+static u_int32 ScanOrder(BBIS_HANDLE*, u_int32);
+static void ScanHit(BBIS_HANDLE*, u_int32);
+static int32 PolicySet(BBIS_HANDLE*, u_int32, u_int32);
+static int32 SlotEnable(BBIS_HANDLE*, u_int32, u_int32);
+static void TraceRec(BBIS_HANDLE*, u_int32, u_int32, u_int32, int32);
+static int32 TraceOn(BBIS_HANDLE*, u_int32);
+static u_int32 TraceDrain(BBIS_HANDLE*, A12_TRACE_EV*, u_int32);
+static void RecAdd(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32);
+static int32 RecOn(BBIS_HANDLE*, u_int32);
+static u_int32 RecDrain(BBIS_HANDLE*, void*, u_int32);
+static int32 QspiAttach(BBIS_HANDLE*);
+static int32 SlotRes(BBIS_HANDLE*, u_int32, A12_SLOT_RES**);
+static int32 MAddr(BBIS_HANDLE*, u_int32, u_int32, u_int32, U_INT32_OR_64*,
+				   u_int32*);
+static u_int32 MAttr(BBIS_HANDLE*, u_int32, u_int32);
+static int32 BlkWin(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+					u_int32, const void*, MACCESS*);
+static int32 BlkRead(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32, void*,
+					 u_int32);
+static int32 BlkWrite(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+					  const void*, u_int32);
+#ifdef A12_OS_WORKERS
+static void SgFlush(A12_SG_QUEUE*);
+static void SgQueue(BBIS_HANDLE*, u_int32, const A12_SG_BACKEND*);
+static void SgDone(A12_SG_QUEUE*, A12_SG_REQ*);
+static int32 SgCopy(void*, u_int32, u_int32, u_int32, u_int32, u_int32, void*,
+					u_int32);
+#endif
 static int32 Cleanup(BBIS_HANDLE *brdHdl, int32 retCode);
 
 #ifdef __cplusplus
@@ -0,0 +1,1111 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: a12_sim.c
+ *      Project: A12 board handler
+ *
+ *       Author: kp
+ *
+ *  Description: Host-side simulator for the A12 PCI->M-module bridge
+ *
+ *               Emulates the Altera 0x1172/0x410c bridge at PCI device
+ *               0x18, its BAR0 with the 32 MB M-module slot windows and
+ *               the per-slot control registers, and provides stand-ins
+ *               for the OSS and DESC functions the A12 BBIS calls.
+ *
+ *               Every bus access is charged to a configurable latency
+ *               model so the PCI cost of the handler can be estimated
+ *               without an A12 carrier.
+ *
+ *     Required: ---
+ *     Switches: A12_SIM
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ******************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/mdis_err.h>
+#include <MEN/a12_sim.h>
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+/* bridge layout, must match a12_int.h */
+#define SIM_BRIDGE_BUS		0			/* location of bridge 0 */
+#define SIM_BRIDGE_DEV		0x18
+#define SIM_VEN_ID			0x1172
+#define SIM_DEV_ID			0x410c
+#define SIM_SLOT_OFFSET		0x02000000
+#define SIM_IACK_BASE		0x01ffff00
+#define SIM_CTRL_BASE		0x01ffff04
+
+#define SIM_BAR0_SIZE		(SIM_SLOT_OFFSET * A12SIM_NBR_OF_SLOTS)
+#define SIM_MAX_ALARMS		16
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+typedef struct {
+	u_int8		*mem;		/* backing store of the 32 MB slot space */
+	u_int8		ctrl;		/* control register (without IRQ bit) */
+	u_int8		irqLine;	/* M-module IRQ line level */
+	u_int8		minWait;	/* timing steps below fast the module needs */
+} SIM_SLOT;
+
+typedef struct {
+	u_int32			present;					/* bridge exists */
+	int32			bus;						/* PCI bus number */
+	int32			dev;						/* PCI device number */
+	u_int64			bar0;						/* BAR0 phys address */
+	u_int32			barAttr;					/* A12SIM_BAR_xxx */
+	int32			irqLine;					/* PCI interrupt line */
+	SIM_SLOT		slot[A12SIM_NBR_OF_SLOTS];	/* slot spaces */
+} SIM_BRIDGE;
+
+typedef struct {
+	const A12SIM_DESC	*desc;		/* descriptor table */
+} SIM_DESC_HDL;
+
+/* OSS alarm, runs in simulated time (A12SIM_Advance) */
+typedef struct {
+	void		(*funct)(void *arg);	/* callback, NULL: unused */
+	void		*arg;					/* callback argument */
+	u_int64		expire;					/* expiry time [ns] */
+	u_int64		period;					/* period [ns] if cyclic */
+	u_int32		active;					/* alarm armed */
+} SIM_ALARM;
+
+/*-----------------------------------------+
+|  GLOBALS                                 |
++-----------------------------------------*/
+static SIM_BRIDGE		G_bridge[A12SIM_MAX_BRIDGES] = {
+	{ TRUE, SIM_BRIDGE_BUS, SIM_BRIDGE_DEV, A12SIM_BAR0_DEFAULT, 0,
+	  A12SIM_IRQ_LINE_DEFAULT } };
+static SIM_BRIDGE		*G_cur = &G_bridge[0];	/* A12SIM_SelBridge */
+static A12SIM_LATENCY	G_lat = { 200, 1000, 100, 30, 0, FALSE };
+static A12SIM_STATS		G_stats;
+static SIM_ALARM		G_alarm[SIM_MAX_ALARMS];
+static u_int64			G_clock;		/* simulated time [ns] */
+static u_int32			G_cpu;			/* CPU the caller runs on */
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static void Charge( u_int32 ns );
+static u_int8 *SlotSpace( SIM_BRIDGE *br, u_int32 slot );
+static SIM_SLOT *CtrlSlot( void *addr );
+static u_int32 SlotWait( void *addr, u_int32 *okP );
+static SIM_BRIDGE *PciBridge( int32 bus, int32 dev, int32 func );
+
+/****************************** A12SIM_Reset *********************************
+ *
+ *  Description:  Reset bridge model, latency model and statistics
+ *
+ *                Only bridge 0 remains, selected by A12SIM_SelBridge.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  -
+ *  Output.....:  -
+ *  Globals....:  G_bridge, G_cur, G_lat, G_stats
+ ****************************************************************************/
+void A12SIM_Reset( void )
+{
+	u_int32 i, b;
+
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ ){
+		for( i=0; i<A12SIM_NBR_OF_SLOTS; i++ ){
+			if( G_bridge[b].slot[i].mem )
+				free( G_bridge[b].slot[i].mem );
+		}
+	}
+	memset( G_bridge, 0, sizeof(G_bridge) );
+	memset( G_alarm, 0, sizeof(G_alarm) );
+	G_bridge[0].present = TRUE;
+	G_bridge[0].bus		= SIM_BRIDGE_BUS;
+	G_bridge[0].dev		= SIM_BRIDGE_DEV;
+	G_bridge[0].bar0	= A12SIM_BAR0_DEFAULT;
+	G_bridge[0].irqLine = A12SIM_IRQ_LINE_DEFAULT;
+	G_cur = &G_bridge[0];
+
+	G_lat.cfgNs	  = 200;
+	G_lat.readNs  = 1000;
+	G_lat.writeNs = 100;
+	G_lat.beatNs  = 30;
+	G_lat.waitNs  = 0;
+	G_lat.spin	  = FALSE;
+
+	G_clock = 0;
+	G_cpu	= 0;
+	A12SIM_ClrStats();
+}
+
+/*************************** A12SIM_SetLatency *******************************
+ *
+ *  Description:  Set per-access latency model
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  lat		new latency model
+ *  Output.....:  -
+ *  Globals....:  G_lat
+ ****************************************************************************/
+void A12SIM_SetLatency( const A12SIM_LATENCY *lat )
+{
+	G_lat = *lat;
+}
+
+/**************************** A12SIM_GetStats ********************************
+ *
+ *  Description:  Get access statistics
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  stats		statistics buffer
+ *  Output.....:  *stats	statistics since last A12SIM_ClrStats
+ *  Globals....:  G_stats
+ ****************************************************************************/
+void A12SIM_GetStats( A12SIM_STATS *stats )
+{
+	*stats = G_stats;
+}
+
+/**************************** A12SIM_ClrStats ********************************
+ *
+ *  Description:  Clear access statistics
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  -
+ *  Output.....:  -
+ *  Globals....:  G_stats
+ ****************************************************************************/
+void A12SIM_ClrStats( void )
+{
+	memset( &G_stats, 0, sizeof(G_stats) );
+}
+
+/***************************** A12SIM_Clock **********************************
+ *
+ *  Description:  Get simulated time
+ *
+ *                Runs with bus accesses and A12SIM_Advance, not cleared
+ *                by A12SIM_ClrStats.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  -
+ *  Output.....:  return	simulated time in ns
+ *  Globals....:  G_clock
+ ****************************************************************************/
+u_int64 A12SIM_Clock( void )
+{
+	return G_clock;
+}
+
+/**************************** A12SIM_Advance *********************************
+ *
+ *  Description:  Advance simulated time (e.g. for CPU work of a scenario)
+ *
+ *                OSS alarms expiring in this time are called in order.
+ *                Bus accesses advance the time too, but never fire alarms.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  ns		time to add
+ *  Output.....:  -
+ *  Globals....:  G_clock, G_alarm
+ ****************************************************************************/
+void A12SIM_Advance( u_int32 ns )
+{
+	u_int64 end = G_clock + ns;
+	SIM_ALARM *al, *next;
+	u_int32 i;
+
+	for(;;){
+		/* earliest alarm up to end */
+		for( next=NULL, i=0; i<SIM_MAX_ALARMS; i++ ){
+			al = &G_alarm[i];
+			if( al->active && al->expire <= end &&
+				(next == NULL || al->expire < next->expire) )
+				next = al;
+		}
+		if( next == NULL )
+			break;
+
+		if( next->expire > G_clock )
+			G_clock = next->expire;
+
+		if( next->period )
+			next->expire += next->period;
+		else
+			next->active = FALSE;
+
+		next->funct( next->arg );
+	}
+
+	if( end > G_clock )
+		G_clock = end;
+}
+
+/***************************** A12SIM_SetCpu *********************************
+ *
+ *  Description:  Set CPU the following handler calls run on
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  cpu		CPU number
+ *  Output.....:  -
+ *  Globals....:  G_cpu
+ ****************************************************************************/
+void A12SIM_SetCpu( u_int32 cpu )
+{
+	G_cpu = cpu;
+}
+
+/***************************** A12SIM_CpuId **********************************
+ *
+ *  Description:  Get CPU set by A12SIM_SetCpu (A12_CPU_ID of the handler)
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  -
+ *  Output.....:  return	CPU number
+ *  Globals....:  G_cpu
+ ****************************************************************************/
+u_int32 A12SIM_CpuId( void )
+{
+	return G_cpu;
+}
+
+/**************************** A12SIM_AddBridge *******************************
+ *
+ *  Description:  Add a bridge at a PCI location
+ *
+ *                BAR0 is placed behind the one of the previous bridge,
+ *                the interrupt line is A12SIM_IRQ_LINE_DEFAULT + index.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  bus		PCI bus number
+ *                dev		PCI device number
+ *  Output.....:  return	bridge index for A12SIM_SelBridge, -1 if the
+ *                          location is taken or no bridge left
+ *  Globals....:  G_bridge
+ ****************************************************************************/
+int32 A12SIM_AddBridge( u_int32 bus, u_int32 dev )
+{
+	int32 b;
+
+	if( PciBridge( (int32)bus, (int32)dev, 0 ) )
+		return -1;
+
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ ){
+		if( !G_bridge[b].present ){
+			G_bridge[b].present = TRUE;
+			G_bridge[b].bus		= (int32)bus;
+			G_bridge[b].dev		= (int32)dev;
+			G_bridge[b].bar0	= A12SIM_BAR0_DEFAULT +
+								  (u_int64)b * SIM_BAR0_SIZE;
+			G_bridge[b].irqLine = A12SIM_IRQ_LINE_DEFAULT + b;
+			return b;
+		}
+	}
+	return -1;
+}
+
+/**************************** A12SIM_SelBridge *******************************
+ *
+ *  Description:  Select the bridge of the following bridge model calls
+ *
+ *                A12SIM_SetBar0, A12SIM_SetIrq, A12SIM_IrqAsserted and
+ *                A12SIM_CtrlPeek work on the selected bridge.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  idx		bridge index (0 or from A12SIM_AddBridge)
+ *  Output.....:  -
+ *  Globals....:  G_cur
+ ****************************************************************************/
+void A12SIM_SelBridge( u_int32 idx )
+{
+	if( idx < A12SIM_MAX_BRIDGES && G_bridge[idx].present )
+		G_cur = &G_bridge[idx];
+}
+
+/***************************** A12SIM_SetBar0 ********************************
+ *
+ *  Description:  Place BAR0 of the selected bridge
+ *
+ *                A12SIM_BAR_64 allows addresses above 4GB. With
+ *                A12SIM_BAR_OSS32, OSS_BusToPhysAddr drops the high dword
+ *                like an OSS without 64-bit BAR support.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  addr		BAR0 phys address (32 MB aligned)
+ *                attr		A12SIM_BAR_xxx
+ *  Output.....:  -
+ *  Globals....:  G_cur
+ ****************************************************************************/
+void A12SIM_SetBar0( u_int64 addr, u_int32 attr )
+{
+	G_cur->bar0	   = addr;
+	G_cur->barAttr = attr;
+}
+
+/***************************** A12SIM_SetIrq *********************************
+ *
+ *  Description:  Drive the IRQ line of an M-module of the selected bridge
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  slot		slot number 0..2
+ *                level		0=inactive 1=active
+ *  Output.....:  -
+ *  Globals....:  G_cur
+ ****************************************************************************/
+void A12SIM_SetIrq( u_int32 slot, u_int32 level )
+{
+	if( slot < A12SIM_NBR_OF_SLOTS )
+		G_cur->slot[slot].irqLine = level ? 1 : 0;
+}
+
+/*************************** A12SIM_IrqAsserted ******************************
+ *
+ *  Description:  Check if the selected bridge drives its PCI interrupt
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  -
+ *  Output.....:  return	bitmask of slots with active and enabled IRQ
+ *  Globals....:  G_cur
+ ****************************************************************************/
+u_int32 A12SIM_IrqAsserted( void )
+{
+	u_int32 i, mask = 0;
+
+	for( i=0; i<A12SIM_NBR_OF_SLOTS-1; i++ ){
+		if( G_cur->slot[i].irqLine &&
+			(G_cur->slot[i].ctrl & A12SIM_CTRL_IEN) )
+			mask |= 1 << i;
+	}
+	return mask;
+}
+
+/**************************** A12SIM_CtrlPeek ********************************
+ *
+ *  Description:  Get control register contents without bus cost
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  slot		slot number 0..2
+ *  Output.....:  return	register value as the handler would read it
+ *  Globals....:  G_cur
+ ****************************************************************************/
+u_int8 A12SIM_CtrlPeek( u_int32 slot )
+{
+	if( slot >= A12SIM_NBR_OF_SLOTS )
+		return 0xff;
+
+	return G_cur->slot[slot].ctrl | G_cur->slot[slot].irqLine;
+}
+
+/**************************** A12SIM_PowerLoss *******************************
+ *
+ *  Description:  Lose the register contents of the selected bridge, as a
+ *                power down (suspend) does
+ *
+ *                Control registers are cleared, module memory is kept.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  -
+ *  Output.....:  -
+ *  Globals....:  G_cur
+ ****************************************************************************/
+void A12SIM_PowerLoss( void )
+{
+	u_int32 i;
+
+	for( i=0; i<A12SIM_NBR_OF_SLOTS; i++ )
+		G_cur->slot[i].ctrl = 0;
+}
+
+/****************************** A12SIM_Poke8 *********************************
+ *
+ *  Description:  Set a byte of a slot space without bus cost, e.g. a
+ *                device register like the QSPI status
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  slot		slot index 0..A12SIM_NBR_OF_SLOTS-1 (3=QSPI)
+ *                offs		offset in the slot space
+ *                val		value
+ *  Output.....:  -
+ *  Globals....:  G_cur
+ ****************************************************************************/
+void A12SIM_Poke8( u_int32 slot, u_int32 offs, u_int8 val )
+{
+	u_int8 *mem;
+
+	if( slot < A12SIM_NBR_OF_SLOTS && offs < SIM_SLOT_OFFSET &&
+		(mem = SlotSpace( G_cur, slot )) != NULL )
+		mem[offs] = val;
+}
+
+/*************************** A12SIM_SetModTiming *****************************
+ *
+ *  Description:  Set the fastest bus timing the M-module in a slot works
+ *                with
+ *
+ *                Faster accesses read all ones and lose writes, they are
+ *                counted in A12SIM_STATS.timingErrs.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  slot		slot number 0..2
+ *                timing	fast bits value 0..3 (3=fast, any timing)
+ *  Output.....:  -
+ *  Globals....:  G_cur
+ ****************************************************************************/
+void A12SIM_SetModTiming( u_int32 slot, u_int32 timing )
+{
+	if( slot < A12SIM_NBR_OF_SLOTS-1 && timing <= 3 )
+		G_cur->slot[slot].minWait = (u_int8)(3 - timing);
+}
+
+/****************************** A12SIM_ReadX *********************************
+ *
+ *  Description:  Register/memory read accessors
+ *
+ *                Control registers are decoded, everything else reads the
+ *                backing store of the slot space. M-module accesses take
+ *                longer with slower timing, see SlotWait.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  ma		virtual base address
+ *                offs		offset to base
+ *  Output.....:  return	read value
+ *  Globals....:  G_stats
+ ****************************************************************************/
+u_int8 A12SIM_Read8( void *ma, u_int32 offs )
+{
+	u_int8 *addr = (u_int8*)ma + offs;
+	SIM_SLOT *slt;
+	u_int32 ok;
+
+	G_stats.reads++;
+
+	if( (slt = CtrlSlot( addr )) != NULL ){
+		Charge( G_lat.readNs );
+		return slt->ctrl | slt->irqLine;
+	}
+
+	Charge( G_lat.readNs + SlotWait( addr, &ok ) );
+	return ok ? *addr : 0xff;
+}
+
+u_int16 A12SIM_Read16( void *ma, u_int32 offs )
+{
+	u_int16 val;
+	u_int32 ok;
+
+	G_stats.reads++;
+	Charge( G_lat.readNs + SlotWait( (u_int8*)ma + offs, &ok ) );
+
+	memcpy( &val, (u_int8*)ma + offs, sizeof(val) );
+	return ok ? val : 0xffff;
+}
+
+u_int32 A12SIM_Read32( void *ma, u_int32 offs )
+{
+	u_int32 val;
+	u_int32 ok;
+
+	G_stats.reads++;
+	Charge( G_lat.readNs + SlotWait( (u_int8*)ma + offs, &ok ) );
+
+	memcpy( &val, (u_int8*)ma + offs, sizeof(val) );
+	return ok ? val : 0xffffffff;
+}
+
+#if defined(__SSE2__)
+/***************************** A12SIM_Read128 ********************************
+ *
+ *  Description:  16 byte read, one PCI burst of 4 DWORDs
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  ma		virtual base address
+ *                offs		offset to base (16 byte aligned)
+ *  Output.....:  return	read value
+ *  Globals....:  G_stats
+ ****************************************************************************/
+__m128i A12SIM_Read128( void *ma, u_int32 offs )
+{
+	u_int32 ok;
+
+	G_stats.reads++;
+	Charge( G_lat.readNs + 3 * G_lat.beatNs +
+			4 * SlotWait( (u_int8*)ma + offs, &ok ) );
+
+	if( !ok )
+		return _mm_set1_epi32( -1 );
+	return _mm_load_si128( (__m128i*)((u_int8*)ma + offs) );
+}
+
+/**************************** A12SIM_Write128 ********************************
+ *
+ *  Description:  16 byte write, one PCI burst of 4 DWORDs
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  ma		virtual base address
+ *                offs		offset to base (16 byte aligned)
+ *                val		value to write
+ *  Output.....:  -
+ *  Globals....:  G_stats
+ ****************************************************************************/
+void A12SIM_Write128( void *ma, u_int32 offs, __m128i val )
+{
+	u_int32 ok;
+
+	G_stats.writes++;
+	Charge( G_lat.writeNs + 3 * G_lat.beatNs +
+			4 * SlotWait( (u_int8*)ma + offs, &ok ) );
+
+	if( ok )
+		_mm_store_si128( (__m128i*)((u_int8*)ma + offs), val );
+}
+#endif /* __SSE2__ */
+
+/***************************** A12SIM_WriteX *********************************
+ *
+ *  Description:  Register/memory write accessors
+ *
+ *                The IRQ pending bit of the control register is read only.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  ma		virtual base address
+ *                offs		offset to base
+ *                val		value to write
+ *  Output.....:  -
+ *  Globals....:  G_stats
+ ****************************************************************************/
+void A12SIM_Write8( void *ma, u_int32 offs, u_int8 val )
+{
+	u_int8 *addr = (u_int8*)ma + offs;
+	SIM_SLOT *slt;
+	u_int32 ok;
+
+	G_stats.writes++;
+
+	if( (slt = CtrlSlot( addr )) != NULL ){
+		Charge( G_lat.writeNs );
+		slt->ctrl = val & ~A12SIM_CTRL_IRQ;
+		return;
+	}
+
+	Charge( G_lat.writeNs + SlotWait( addr, &ok ) );
+	if( ok )
+		*addr = val;
+}
+
+void A12SIM_Write16( void *ma, u_int32 offs, u_int16 val )
+{
+	u_int32 ok;
+
+	G_stats.writes++;
+	Charge( G_lat.writeNs + SlotWait( (u_int8*)ma + offs, &ok ) );
+
+	if( ok )
+		memcpy( (u_int8*)ma + offs, &val, sizeof(val) );
+}
+
+void A12SIM_Write32( void *ma, u_int32 offs, u_int32 val )
+{
+	u_int32 ok;
+
+	G_stats.writes++;
+	Charge( G_lat.writeNs + SlotWait( (u_int8*)ma + offs, &ok ) );
+
+	if( ok )
+		memcpy( (u_int8*)ma + offs, &val, sizeof(val) );
+}
+
+/***************************** A12SIM_MapWc **********************************
+ *
+ *  Description:  Write-combined mapping (A12_MAP_WC of the handler)
+ *
+ *                Same backing store as OSS_MapPhysToVirtAddr, counted
+ *                separately.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  phys		physical address
+ *                size		size [bytes]
+ *  Output.....:  *virtP	virtual address
+ *                return	0 | error code
+ *  Globals....:  G_stats
+ ****************************************************************************/
+int32 A12SIM_MapWc( u_int64 phys, u_int32 size, void **virtP )
+{
+	int32 error;
+
+	error = OSS_MapPhysToVirtAddr( NULL, (void*)(U_INT32_OR_64)phys, size,
+								   OSS_ADDRSPACE_MEM, OSS_BUSTYPE_PCI, 0,
+								   virtP );
+	if( !error ){
+		G_stats.maps--;
+		G_stats.wcMaps++;
+	}
+	return error;
+}
+
+/**************************** A12SIM_UnMapWc *********************************
+ *
+ *  Description:  Unmap write-combined mapping
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  virt		virtual address
+ *                size		size [bytes]
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+void A12SIM_UnMapWc( void *virt, u_int32 size )
+{
+}
+
+/********************************* Charge ************************************
+ *
+ *  Description:  Account bus latency, optionally burn it on the CPU
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  ns		latency of the access
+ *  Output.....:  -
+ *  Globals....:  G_stats, G_clock, G_lat
+ ****************************************************************************/
+static void Charge( u_int32 ns )
+{
+	struct timespec t0, t;
+
+	G_stats.simNs += ns;
+	G_clock += ns;
+
+	if( !G_lat.spin || !ns )
+		return;
+
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+	do {
+		clock_gettime( CLOCK_MONOTONIC, &t );
+	} while( (u_int64)(t.tv_sec - t0.tv_sec) * 1000000000 +
+			 t.tv_nsec - t0.tv_nsec < ns );
+}
+
+/******************************* SlotSpace ***********************************
+ *
+ *  Description:  Get backing store of a slot space, allocate on first use
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  br		bridge
+ *                slot		slot index 0..A12SIM_NBR_OF_SLOTS-1
+ *  Output.....:  return	backing store or NULL
+ *  Globals....:  -
+ ****************************************************************************/
+static u_int8 *SlotSpace( SIM_BRIDGE *br, u_int32 slot )
+{
+	SIM_SLOT *slt = &br->slot[slot];
+
+	if( slt->mem == NULL )
+		slt->mem = (u_int8*)calloc( 1, SIM_SLOT_OFFSET );
+
+	return slt->mem;
+}
+
+/******************************* CtrlSlot ************************************
+ *
+ *  Description:  Decode control register address
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  addr		virtual address of the access
+ *  Output.....:  return	slot owning the control register or NULL
+ *  Globals....:  G_bridge
+ ****************************************************************************/
+static SIM_SLOT *CtrlSlot( void *addr )
+{
+	u_int32 i, b;
+	u_int8 *mem;
+
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ ){
+		for( i=0; i<A12SIM_NBR_OF_SLOTS-1; i++ ){
+			mem = G_bridge[b].slot[i].mem;
+			if( mem && (u_int8*)addr == mem + SIM_CTRL_BASE )
+				return &G_bridge[b].slot[i];
+		}
+	}
+	return NULL;
+}
+
+/******************************* SlotWait ************************************
+ *
+ *  Description:  Bus timing of an M-module access
+ *
+ *                Each timing step below fast (fast bits of the slot's
+ *                control register) adds G_lat.waitNs. If the timing is too
+ *                fast for the module (A12SIM_SetModTiming), the access
+ *                fails. Other accesses take no extra time.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  addr		virtual address of the access
+ *  Output.....:  okP		access succeeds
+ *                return	extra latency [ns]
+ *  Globals....:  G_bridge, G_lat, G_stats
+ ****************************************************************************/
+static u_int32 SlotWait( void *addr, u_int32 *okP )
+{
+	SIM_SLOT *slt;
+	u_int32 i, b, wait;
+
+	*okP = TRUE;
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ ){
+		for( i=0; i<A12SIM_NBR_OF_SLOTS-1; i++ ){
+			slt = &G_bridge[b].slot[i];
+			if( slt->mem && (u_int8*)addr >= slt->mem &&
+				(u_int8*)addr < slt->mem + SIM_IACK_BASE ){
+				wait = 3 - ((slt->ctrl & A12SIM_CTRL_FAST) >> 2);
+				if( wait < slt->minWait ){
+					G_stats.timingErrs++;
+					*okP = FALSE;
+				}
+				return wait * G_lat.waitNs;
+			}
+		}
+	}
+	return 0;
+}
+
+/******************************* PciBridge ***********************************
+ *
+ *  Description:  Find the bridge at a PCI location
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  bus		PCI bus number
+ *                dev		PCI device number
+ *                func		PCI function number
+ *  Output.....:  return	bridge or NULL
+ *  Globals....:  G_bridge
+ ****************************************************************************/
+static SIM_BRIDGE *PciBridge( int32 bus, int32 dev, int32 func )
+{
+	u_int32 b;
+
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ ){
+		if( G_bridge[b].present && G_bridge[b].bus == bus &&
+			G_bridge[b].dev == dev && func == 0 )
+			return &G_bridge[b];
+	}
+	return NULL;
+}
+
+/*--------------------------------------------------------------------------+
+|    OSS STAND-INS                                                          |
++--------------------------------------------------------------------------*/
+void* OSS_MemGet( OSS_HANDLE *osHdl, u_int32 size, u_int32 *gotsizeP )
+{
+	*gotsizeP = size;
+	return calloc( 1, size );
+}
+
+int32 OSS_MemFree( OSS_HANDLE *osHdl, void *addr, u_int32 size )
+{
+	free( addr );
+	return 0;
+}
+
+void OSS_MemFill( OSS_HANDLE *osHdl, u_int32 size, char *adr, int8 value )
+{
+	memset( adr, value, size );
+}
+
+void OSS_MemCopy( OSS_HANDLE *osHdl, u_int32 size, char *src, char *dest )
+{
+	memmove( dest, src, size );
+}
+
+char* OSS_Ident( void )
+{
+	return "OSS - A12 simulator";
+}
+
+int32 OSS_PciGetConfig(
+	OSS_HANDLE *osHdl,
+	int32 busNbr,
+	int32 pciDevNbr,
+	int32 pciFunction,
+	int32 which,
+	int32 *valueP )
+{
+	SIM_BRIDGE *br;
+
+	G_stats.cfgReads++;
+	Charge( G_lat.cfgNs );
+
+	/* nobody home */
+	if( (br = PciBridge( busNbr, pciDevNbr, pciFunction )) == NULL ){
+		*valueP = (which == OSS_PCI_INTERRUPT_LINE) ? 0xff : 0xffff;
+		return 0;
+	}
+
+	switch( which ){
+	case OSS_PCI_VENDOR_ID:		 *valueP = SIM_VEN_ID;			break;
+	case OSS_PCI_DEVICE_ID:		 *valueP = SIM_DEV_ID;			break;
+	case OSS_PCI_INTERRUPT_LINE: *valueP = br->irqLine;			break;
+	case OSS_PCI_ADDR_0:
+		*valueP = (int32)((u_int32)br->bar0 |
+						  (br->barAttr & (A12SIM_BAR_64 | A12SIM_BAR_PREFETCH)));
+		break;
+	case OSS_PCI_ADDR_1:
+		*valueP = (br->barAttr & A12SIM_BAR_64) ?
+			(int32)(br->bar0 >> 32) : 0;
+		break;
+	default:					 *valueP = 0;					break;
+	}
+	return 0;
+}
+
+int32 OSS_BusToPhysAddr( OSS_HANDLE *osHdl, int32 busType, void **physAddrP,
+						 ... )
+{
+	va_list argptr;
+	int32 busNbr, pciDevNbr, pciFunction, barNbr;
+	SIM_BRIDGE *br;
+
+	va_start( argptr, physAddrP );
+	busNbr		= va_arg( argptr, int32 );
+	pciDevNbr	= va_arg( argptr, int32 );
+	pciFunction	= va_arg( argptr, int32 );
+	barNbr		= va_arg( argptr, int32 );
+	va_end( argptr );
+
+	G_stats.cfgReads++;
+	Charge( G_lat.cfgNs );
+
+	if( busType != OSS_BUSTYPE_PCI || barNbr != 0 ||
+		(br = PciBridge( busNbr, pciDevNbr, pciFunction )) == NULL )
+		return ERR_OSS_PCI_NO_DEVINSLOT;
+
+	*physAddrP = (void*)(U_INT32_OR_64)((br->barAttr & A12SIM_BAR_OSS32) ?
+										(u_int32)br->bar0 : br->bar0);
+	return 0;
+}
+
+int32 OSS_MapPhysToVirtAddr(
+	OSS_HANDLE *osHdl,
+	void *physAddr,
+	u_int32 size,
+	int32 addrSpace,
+	int32 busType,
+	int32 busNbr,
+	void **virtAddrP )
+{
+	U_INT32_OR_64 offs = 0;
+	SIM_BRIDGE *br = NULL;
+	u_int32 slot, b;
+	u_int8 *mem;
+
+	G_stats.maps++;
+
+	/* bridge decoding the address */
+	for( b=0; b<A12SIM_MAX_BRIDGES && br == NULL; b++ ){
+		offs = (U_INT32_OR_64)physAddr - G_bridge[b].bar0;
+		if( G_bridge[b].present &&
+			(U_INT32_OR_64)physAddr >= G_bridge[b].bar0 &&
+			offs + size <= SIM_BAR0_SIZE )
+			br = &G_bridge[b];
+	}
+	if( br == NULL )
+		return ERR_OSS_ILL_PARAM;
+
+	slot = (u_int32)(offs / SIM_SLOT_OFFSET);
+	if( (mem = SlotSpace( br, slot )) == NULL )
+		return ERR_OSS_MEM_ALLOC;
+
+	*virtAddrP = mem + (offs % SIM_SLOT_OFFSET);
+	return 0;
+}
+
+int32 OSS_UnMapVirtAddr( OSS_HANDLE *osHdl, void **virtAddrP, u_int32 size,
+						 int32 addrSpace )
+{
+	G_stats.unmaps++;
+	*virtAddrP = NULL;
+	return 0;
+}
+
+int32 OSS_AssignResources( OSS_HANDLE *osHdl, int32 busType, int32 busNbr,
+						   int32 resNbr, OSS_RESOURCES res[] )
+{
+	return 0;
+}
+
+int32 OSS_UnAssignResources( OSS_HANDLE *osHdl, int32 busType, int32 busNbr,
+							 int32 resNbr, OSS_RESOURCES res[] )
+{
+	return 0;
+}
+
+int32 OSS_IrqLevelToVector( OSS_HANDLE *osHdl, int32 busType, int32 level,
+							int32 *vectorP )
+{
+	G_stats.irqVecs++;
+	*vectorP = level;
+	return 0;
+}
+
+int32 OSS_AlarmCreate( OSS_HANDLE *osHdl, void (*funct)(void *arg),
+					   void *arg, OSS_ALARM_HANDLE **alarmP )
+{
+	u_int32 i;
+
+	for( i=0; i<SIM_MAX_ALARMS; i++ ){
+		if( G_alarm[i].funct == NULL ){
+			G_alarm[i].funct  = funct;
+			G_alarm[i].arg	  = arg;
+			G_alarm[i].active = FALSE;
+			*alarmP = (OSS_ALARM_HANDLE*)&G_alarm[i];
+			return 0;
+		}
+	}
+	return ERR_OSS_MEM_ALLOC;
+}
+
+int32 OSS_AlarmRemove( OSS_HANDLE *osHdl, OSS_ALARM_HANDLE **alarmP )
+{
+	memset( *alarmP, 0, sizeof(SIM_ALARM) );
+	*alarmP = NULL;
+	return 0;
+}
+
+int32 OSS_AlarmSet( OSS_HANDLE *osHdl, OSS_ALARM_HANDLE *alarm,
+					u_int32 msec, u_int32 cyclic, u_int32 *realMsecP )
+{
+	SIM_ALARM *al = (SIM_ALARM*)alarm;
+
+	al->expire = G_clock + (u_int64)msec * 1000000;
+	al->period = cyclic ? (u_int64)msec * 1000000 : 0;
+	al->active = TRUE;
+	*realMsecP = msec;
+	return 0;
+}
+
+int32 OSS_AlarmClear( OSS_HANDLE *osHdl, OSS_ALARM_HANDLE *alarm )
+{
+	((SIM_ALARM*)alarm)->active = FALSE;
+	return 0;
+}
+
+/* single threaded: the lock only catches a missing release */
+int32 OSS_SpinLockCreate( OSS_HANDLE *osHdl, OSS_SPINL_HANDLE **spinlP )
+{
+	if( (*spinlP = calloc( 1, sizeof(u_int32) )) == NULL )
+		return ERR_OSS_MEM_ALLOC;
+	return 0;
+}
+
+int32 OSS_SpinLockRemove( OSS_HANDLE *osHdl, OSS_SPINL_HANDLE **spinlP )
+{
+	free( *spinlP );
+	*spinlP = NULL;
+	return 0;
+}
+
+int32 OSS_SpinLockAcquire( OSS_HANDLE *osHdl, OSS_SPINL_HANDLE *spinl )
+{
+	if( (*(u_int32*)spinl)++ ){
+		fprintf( stderr, "*** a12_sim: spin lock already held\n" );
+		abort();
+	}
+	return 0;
+}
+
+int32 OSS_SpinLockRelease( OSS_HANDLE *osHdl, OSS_SPINL_HANDLE *spinl )
+{
+	(*(u_int32*)spinl)--;
+	return 0;
+}
+
+int32 OSS_MikroDelay( OSS_HANDLE *osHdl, u_int32 mikroSec )
+{
+	G_clock += (u_int64)mikroSec * 1000;
+	return 0;
+}
+
+int32 OSS_TickGet( OSS_HANDLE *osHdl )
+{
+	return (int32)(G_clock / 1000000);
+}
+
+int32 OSS_TickRateGet( OSS_HANDLE *osHdl )
+{
+	return 1000;
+}
+
+/*--------------------------------------------------------------------------+
+|    DESC STAND-INS                                                         |
++--------------------------------------------------------------------------*/
+int32 DESC_Init( DESC_SPEC *descSpec, OSS_HANDLE *osHdl,
+				 DESC_HANDLE **descHandleP )
+{
+	SIM_DESC_HDL *dh;
+
+	if( (dh = (SIM_DESC_HDL*)calloc( 1, sizeof(*dh) )) == NULL )
+		return ERR_OSS_MEM_ALLOC;
+
+	dh->desc = (const A12SIM_DESC*)descSpec;
+	*descHandleP = (DESC_HANDLE*)dh;
+	return 0;
+}
+
+int32 DESC_GetUInt32( DESC_HANDLE *descHandle, u_int32 defVal,
+					  u_int32 *valueP, char *keyFmt, ... )
+{
+	SIM_DESC_HDL *dh = (SIM_DESC_HDL*)descHandle;
+	const A12SIM_DESC *d;
+	char key[64];
+	va_list argptr;
+
+	G_stats.descKeys++;
+
+	va_start( argptr, keyFmt );
+	vsnprintf( key, sizeof(key), keyFmt, argptr );
+	va_end( argptr );
+
+	for( d=dh->desc; d && d->key; d++ ){
+		if( strcmp( d->key, key ) == 0 ){
+			*valueP = d->value;
+			return 0;
+		}
+	}
+
+	*valueP = defVal;
+	return ERR_DESC_KEY_NOTFOUND;
+}
+
+int32 DESC_DbgLevelSet( DESC_HANDLE *descHandle, u_int32 dbgLevel )
+{
+	return 0;
+}
+
+int32 DESC_Exit( DESC_HANDLE **descHandleP )
+{
+	free( *descHandleP );
+	*descHandleP = NULL;
+	return 0;
+}
+
+char* DESC_Ident( void )
+{
+	return "DESC - A12 simulator";
+}
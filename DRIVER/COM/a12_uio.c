@@ -0,0 +1,807 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: a12_uio.c
+ *      Project: A12 board handler
+ *
+ *       Author: kp
+ *
+ *  Description: Userspace backend for the A12 PCI->M-module bridge
+ *
+ *               Provides the OSS and DESC functions the A12 BBIS calls
+ *               for running it in a Linux process (kernel bypass):
+ *
+ *               - PCI config space is read from the config file of the
+ *                 device in sysfs (<root>/bus/pci/devices/<dom:bus:dev.fn>)
+ *               - BAR addresses are taken from its resource file
+ *               - BAR windows are mmap()ed through its resource<n> file,
+ *                 so the register accessors of the handler (MAC_MEM_MAPPED)
+ *                 work on BAR0 directly without system calls
+ *               - write-combined views (A12_MAP_WC of the handler) are
+ *                 mmap()ed through resource<n>_wc, which only exists for
+ *                 prefetchable BARs
+ *               - alarms run in a thread each
+ *
+ *               There is no interrupt delivery. The slots are polled with
+ *               A12_Poll (A12UIO_IrqWait).
+ *
+ *               <root> is /sys unless changed by A12UIO_SetRoot, which
+ *               allows testing against a fake device tree whose resource0
+ *               is a plain file.
+ *
+ *     Required: pthread
+ *     Switches: A12_UIO
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ******************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE			/* sched_getcpu */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/mdis_err.h>
+#include <MEN/mdis_api.h>
+#include <MEN/bb_defs.h>
+#include <MEN/bb_entry.h>
+#include <MEN/bb_a12_ext.h>
+#include <MEN/a12_uio.h>
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define UIO_MAX_BARS		8			/* BARs known to OSS_BusToPhysAddr */
+#define UIO_PATH_LEN		256
+
+/* PCI config space offsets */
+#define UIO_CFG_VENDOR		0x00
+#define UIO_CFG_DEVICE		0x02
+#define UIO_CFG_BAR0		0x10
+#define UIO_CFG_IRQ_LINE	0x3c
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/* BAR reported by OSS_BusToPhysAddr, mappable through resource<bar> */
+typedef struct {
+	u_int32		used;		/* entry valid */
+	int32		bus;		/* PCI bus number */
+	int32		dev;		/* PCI device number */
+	int32		func;		/* PCI function */
+	int32		bar;		/* BAR number */
+	u_int64		start;		/* first phys address */
+	u_int64		end;		/* last phys address */
+} UIO_BAR;
+
+typedef struct {
+	const A12UIO_DESC	*desc;		/* descriptor table */
+} UIO_DESC_HDL;
+
+/* OSS alarm, served by its own thread */
+typedef struct {
+	void			(*funct)(void *arg);	/* callback */
+	void			*arg;					/* callback argument */
+	pthread_t		thread;					/* alarm thread */
+	pthread_mutex_t	lock;					/* protects the fields below */
+	pthread_cond_t	cond;					/* set, clear, remove */
+	struct timespec	expire;					/* expiry (CLOCK_MONOTONIC) */
+	u_int32			periodMs;				/* period [ms] if cyclic */
+	u_int32			active;					/* alarm armed */
+	u_int32			quit;					/* thread to terminate */
+} UIO_ALARM;
+
+/*-----------------------------------------+
+|  GLOBALS                                 |
++-----------------------------------------*/
+static char			G_root[UIO_PATH_LEN] = A12UIO_ROOT_DEFAULT;
+static UIO_BAR		G_bar[UIO_MAX_BARS];
+static pthread_mutex_t G_barLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static int32 DevPath( char *path, int32 bus, int32 dev, int32 func,
+					  const char *file );
+static int32 CfgRead( int32 bus, int32 dev, int32 func, u_int32 offs,
+					  u_int32 size, u_int32 *valueP );
+static int32 BarMap( u_int64 phys, u_int32 size, const char *suffix,
+					 void **virtAddrP );
+static void TsAddMs( struct timespec *ts, u_int32 ms );
+static void *AlarmThread( void *arg );
+
+/***************************** A12UIO_SetRoot ********************************
+ *
+ *  Description:  Set the sysfs root the PCI devices are looked up in
+ *
+ *                Must be called before the BBIS is initialized.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  root		sysfs mount point, NULL: A12UIO_ROOT_DEFAULT
+ *  Output.....:  -
+ *  Globals....:  G_root, G_bar
+ ****************************************************************************/
+void A12UIO_SetRoot( const char *root )
+{
+	snprintf( G_root, sizeof(G_root), "%s",
+			  root ? root : A12UIO_ROOT_DEFAULT );
+
+	pthread_mutex_lock( &G_barLock );
+	memset( G_bar, 0, sizeof(G_bar) );
+	pthread_mutex_unlock( &G_barLock );
+}
+
+/***************************** A12UIO_CpuId **********************************
+ *
+ *  Description:  Get the CPU the caller runs on (A12_CPU_ID)
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  -
+ *  Output.....:  return	CPU number
+ *  Globals....:  -
+ ****************************************************************************/
+u_int32 A12UIO_CpuId( void )
+{
+	int cpu = sched_getcpu();
+
+	return cpu < 0 ? 0 : (u_int32)cpu;
+}
+
+/**************************** A12UIO_IrqWait *********************************
+ *
+ *  Description:  Wait for a pending slot by polling the control registers
+ *
+ *                Calls A12_Poll until it reports a pending slot or the
+ *                timeout expires. Only slots in polling mode are seen,
+ *                i.e. with SLOT_n_IRQ_POLICY A12_POLICY_POLL and enabled
+ *                by irqEnable.
+ *
+ *                The caller then services the slots in *maskP like an
+ *                interrupt (irqSrvInit, driver ISR, irqSrvExit).
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  bb			BBIS jump table (A12_GetEntry)
+ *                h				BBIS handle
+ *                timeoutUs		max. wait time [us]
+ *  Output.....:  *maskP		bit n set for each pending slot n
+ *                return		0 | ERR_OSS_TIMEOUT | error code
+ *  Globals....:  -
+ ****************************************************************************/
+int32 A12UIO_IrqWait(
+	BBIS_ENTRY *bb,
+	BBIS_HANDLE *h,
+	u_int32 timeoutUs,
+	u_int32 *maskP )
+{
+	struct timespec t0, t1;
+	int32 error;
+
+	clock_gettime( CLOCK_MONOTONIC, &t0 );
+
+	for(;;){
+		if( (error = A12_ENTRY_POLL( bb )( h, maskP )) )
+			return error;
+		if( *maskP )
+			return 0;
+
+		clock_gettime( CLOCK_MONOTONIC, &t1 );
+		if( (u_int64)(t1.tv_sec - t0.tv_sec) * 1000000 +
+			(t1.tv_nsec - t0.tv_nsec) / 1000 >= timeoutUs )
+			return ERR_OSS_TIMEOUT;
+	}
+}
+
+/****************************** A12UIO_MapWc *********************************
+ *
+ *  Description:  Write-combined mapping (A12_MAP_WC of the handler)
+ *
+ *                Maps the BAR through its resource<n>_wc file. Linux only
+ *                creates it for prefetchable BARs, the handler maps the
+ *                view uncached if this fails.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  phys		physical address
+ *                size		size [bytes]
+ *  Output.....:  *virtP	virtual address
+ *                return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+int32 A12UIO_MapWc( u_int64 phys, u_int32 size, void **virtP )
+{
+	return BarMap( phys, size, "_wc", virtP );
+}
+
+/***************************** A12UIO_UnMapWc ********************************
+ *
+ *  Description:  Unmap write-combined mapping
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  virt		virtual address
+ *                size		size [bytes]
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+void A12UIO_UnMapWc( void *virt, u_int32 size )
+{
+	OSS_UnMapVirtAddr( NULL, &virt, size, OSS_ADDRSPACE_MEM );
+}
+
+/********************************* DevPath ***********************************
+ *
+ *  Description:  Build the sysfs path of a file of a PCI device
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  path		buffer (UIO_PATH_LEN)
+ *                bus		PCI bus number
+ *                dev		PCI device number
+ *                func		PCI function
+ *                file		file name in the device directory
+ *  Output.....:  return	0 | ERR_OSS_ILL_PARAM (path too long)
+ *  Globals....:  G_root
+ ****************************************************************************/
+static int32 DevPath( char *path, int32 bus, int32 dev, int32 func,
+					  const char *file )
+{
+	int n = snprintf( path, UIO_PATH_LEN,
+					  "%s/bus/pci/devices/%04x:%02x:%02x.%x/%s",
+					  G_root, A12UIO_PCI_DOMAIN, (unsigned)bus & 0xff,
+					  (unsigned)dev & 0x1f, (unsigned)func & 0x7, file );
+
+	return (n < 0 || n >= UIO_PATH_LEN) ? ERR_OSS_ILL_PARAM : 0;
+}
+
+/********************************* CfgRead ***********************************
+ *
+ *  Description:  Read a little endian value from PCI config space
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  bus		PCI bus number
+ *                dev		PCI device number
+ *                func		PCI function
+ *                offs		config space offset
+ *                size		1, 2 or 4 bytes
+ *  Output.....:  *valueP	value
+ *                return	0 | ERR_OSS_PCI_NO_DEVINSLOT
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 CfgRead( int32 bus, int32 dev, int32 func, u_int32 offs,
+					  u_int32 size, u_int32 *valueP )
+{
+	char path[UIO_PATH_LEN];
+	u_int8 buf[4];
+	u_int32 i;
+	int fd;
+
+	if( DevPath( path, bus, dev, func, "config" ) ||
+		(fd = open( path, O_RDONLY )) < 0 )
+		return ERR_OSS_PCI_NO_DEVINSLOT;
+
+	if( pread( fd, buf, size, offs ) != (ssize_t)size ){
+		close( fd );
+		return ERR_OSS_PCI_NO_DEVINSLOT;
+	}
+	close( fd );
+
+	for( *valueP=0, i=0; i<size; i++ )
+		*valueP |= (u_int32)buf[i] << (8 * i);
+	return 0;
+}
+
+/********************************** BarMap ***********************************
+ *
+ *  Description:  mmap() a range of a BAR seen by OSS_BusToPhysAddr
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  phys		physical address
+ *                size		size [bytes]
+ *                suffix	appended to resource<n>, e.g. "_wc"
+ *  Output.....:  *virtAddrP	virtual address
+ *                return	0 | error code
+ *  Globals....:  G_bar
+ ****************************************************************************/
+static int32 BarMap( u_int64 phys, u_int32 size, const char *suffix,
+					 void **virtAddrP )
+{
+	u_int64 offs = 0, page, delta;
+	char path[UIO_PATH_LEN], file[16];
+	UIO_BAR *bar = NULL;
+	void *virt;
+	u_int32 n;
+	int fd;
+
+	/* BAR decoding the address */
+	pthread_mutex_lock( &G_barLock );
+	for( n=0; n<UIO_MAX_BARS && bar == NULL; n++ ){
+		if( G_bar[n].used && phys >= G_bar[n].start &&
+			phys + size - 1 <= G_bar[n].end )
+			bar = &G_bar[n];
+	}
+	if( bar ){
+		offs = phys - bar->start;
+		snprintf( file, sizeof(file), "resource%d%s", (int)bar->bar,
+				  suffix );
+		if( DevPath( path, bar->bus, bar->dev, bar->func, file ) )
+			bar = NULL;
+	}
+	pthread_mutex_unlock( &G_barLock );
+
+	if( bar == NULL || size == 0 )
+		return ERR_OSS_ILL_PARAM;
+
+	/* mmap offset must be page aligned */
+	page  = (u_int64)sysconf( _SC_PAGESIZE );
+	delta = offs & (page - 1);
+
+	if( (fd = open( path, O_RDWR | O_SYNC )) < 0 )
+		return ERR_OSS_MAP_FAILED;
+
+	virt = mmap( NULL, delta + size, PROT_READ | PROT_WRITE, MAP_SHARED,
+				 fd, (off_t)(offs - delta) );
+	close( fd );
+
+	if( virt == MAP_FAILED )
+		return ERR_OSS_MAP_FAILED;
+
+	*virtAddrP = (u_int8*)virt + delta;
+	return 0;
+}
+
+/********************************* TsAddMs ***********************************
+ *
+ *  Description:  Advance a timespec by milliseconds
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  ts		time
+ *                ms		milliseconds to add
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void TsAddMs( struct timespec *ts, u_int32 ms )
+{
+	ts->tv_sec	+= ms / 1000;
+	ts->tv_nsec += (long)(ms % 1000) * 1000000;
+	if( ts->tv_nsec >= 1000000000 ){
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000;
+	}
+}
+
+/******************************** AlarmThread ********************************
+ *
+ *  Description:  Serve one OSS alarm
+ *
+ *                The callback is called without the alarm lock held, so
+ *                it may set or clear its own alarm.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  arg		alarm (UIO_ALARM)
+ *  Output.....:  return	NULL
+ *  Globals....:  -
+ ****************************************************************************/
+static void *AlarmThread( void *arg )
+{
+	UIO_ALARM *al = (UIO_ALARM*)arg;
+	struct timespec now;
+
+	pthread_mutex_lock( &al->lock );
+	while( !al->quit ){
+		if( !al->active ){
+			pthread_cond_wait( &al->cond, &al->lock );
+			continue;
+		}
+
+		if( pthread_cond_timedwait( &al->cond, &al->lock, &al->expire )
+			!= ETIMEDOUT )
+			continue;		/* set, cleared or removed meanwhile */
+
+		clock_gettime( CLOCK_MONOTONIC, &now );
+		if( !al->active || al->quit ||
+			now.tv_sec < al->expire.tv_sec ||
+			(now.tv_sec == al->expire.tv_sec &&
+			 now.tv_nsec < al->expire.tv_nsec) )
+			continue;
+
+		if( al->periodMs )
+			TsAddMs( &al->expire, al->periodMs );
+		else
+			al->active = FALSE;
+
+		pthread_mutex_unlock( &al->lock );
+		al->funct( al->arg );
+		pthread_mutex_lock( &al->lock );
+	}
+	pthread_mutex_unlock( &al->lock );
+	return NULL;
+}
+
+/*--------------------------------------------------------------------------+
+|    OSS STAND-INS                                                          |
++--------------------------------------------------------------------------*/
+void* OSS_MemGet( OSS_HANDLE *osHdl, u_int32 size, u_int32 *gotsizeP )
+{
+	*gotsizeP = size;
+	return calloc( 1, size );
+}
+
+int32 OSS_MemFree( OSS_HANDLE *osHdl, void *addr, u_int32 size )
+{
+	free( addr );
+	return 0;
+}
+
+void OSS_MemFill( OSS_HANDLE *osHdl, u_int32 size, char *adr, int8 value )
+{
+	memset( adr, value, size );
+}
+
+void OSS_MemCopy( OSS_HANDLE *osHdl, u_int32 size, char *src, char *dest )
+{
+	memmove( dest, src, size );
+}
+
+char* OSS_Ident( void )
+{
+	return "OSS - A12 userspace";
+}
+
+int32 OSS_PciGetConfig(
+	OSS_HANDLE *osHdl,
+	int32 busNbr,
+	int32 pciDevNbr,
+	int32 pciFunction,
+	int32 which,
+	int32 *valueP )
+{
+	u_int32 val;
+	int32 error;
+
+	switch( which ){
+	case OSS_PCI_VENDOR_ID:
+		error = CfgRead( busNbr, pciDevNbr, pciFunction, UIO_CFG_VENDOR,
+						 2, &val );
+		break;
+	case OSS_PCI_DEVICE_ID:
+		error = CfgRead( busNbr, pciDevNbr, pciFunction, UIO_CFG_DEVICE,
+						 2, &val );
+		break;
+	case OSS_PCI_ADDR_0:
+	case OSS_PCI_ADDR_1:
+		error = CfgRead( busNbr, pciDevNbr, pciFunction,
+						 UIO_CFG_BAR0 + 4 * (which - OSS_PCI_ADDR_0),
+						 4, &val );
+		break;
+	case OSS_PCI_INTERRUPT_LINE:
+		error = CfgRead( busNbr, pciDevNbr, pciFunction, UIO_CFG_IRQ_LINE,
+						 1, &val );
+		break;
+	default:
+		*valueP = 0;
+		return 0;
+	}
+
+	/* nobody home */
+	if( error )
+		val = (which == OSS_PCI_INTERRUPT_LINE) ? 0xff : 0xffff;
+
+	*valueP = (int32)val;
+	return 0;
+}
+
+int32 OSS_BusToPhysAddr( OSS_HANDLE *osHdl, int32 busType, void **physAddrP,
+						 ... )
+{
+	va_list argptr;
+	int32 busNbr, pciDevNbr, pciFunction, barNbr, n;
+	unsigned long long start = 0, end = 0, flags;
+	char path[UIO_PATH_LEN], line[128];
+	UIO_BAR *bar = NULL;
+	FILE *fp;
+
+	va_start( argptr, physAddrP );
+	busNbr		= va_arg( argptr, int32 );
+	pciDevNbr	= va_arg( argptr, int32 );
+	pciFunction	= va_arg( argptr, int32 );
+	barNbr		= va_arg( argptr, int32 );
+	va_end( argptr );
+
+	if( busType != OSS_BUSTYPE_PCI || barNbr < 0 || barNbr > 5 )
+		return ERR_OSS_ILL_PARAM;
+
+	/* line <barNbr> of resource: start end flags */
+	if( DevPath( path, busNbr, pciDevNbr, pciFunction, "resource" ) ||
+		(fp = fopen( path, "r" )) == NULL )
+		return ERR_OSS_PCI_NO_DEVINSLOT;
+
+	for( n=0; n<=barNbr; n++ ){
+		if( fgets( line, sizeof(line), fp ) == NULL ||
+			sscanf( line, "%llx %llx %llx", &start, &end, &flags ) != 3 ){
+			start = 0;
+			break;
+		}
+	}
+	fclose( fp );
+
+	if( start == 0 || end <= start )
+		return ERR_OSS_PCI_NO_DEVINSLOT;
+
+	/* remember it for OSS_MapPhysToVirtAddr */
+	pthread_mutex_lock( &G_barLock );
+	for( n=0; n<UIO_MAX_BARS; n++ ){
+		if( G_bar[n].used && G_bar[n].bus == busNbr &&
+			G_bar[n].dev == pciDevNbr && G_bar[n].func == pciFunction &&
+			G_bar[n].bar == barNbr ){
+			bar = &G_bar[n];
+			break;
+		}
+		if( !G_bar[n].used && bar == NULL )
+			bar = &G_bar[n];
+	}
+	if( bar ){
+		bar->used	= TRUE;
+		bar->bus	= busNbr;
+		bar->dev	= pciDevNbr;
+		bar->func	= pciFunction;
+		bar->bar	= barNbr;
+		bar->start	= start;
+		bar->end	= end;
+	}
+	pthread_mutex_unlock( &G_barLock );
+
+	if( bar == NULL )
+		return ERR_OSS_MEM_ALLOC;
+
+	*physAddrP = (void*)(U_INT32_OR_64)start;
+	return 0;
+}
+
+int32 OSS_MapPhysToVirtAddr(
+	OSS_HANDLE *osHdl,
+	void *physAddr,
+	u_int32 size,
+	int32 addrSpace,
+	int32 busType,
+	int32 busNbr,
+	void **virtAddrP )
+{
+	return BarMap( (U_INT32_OR_64)physAddr, size, "", virtAddrP );
+}
+
+int32 OSS_UnMapVirtAddr( OSS_HANDLE *osHdl, void **virtAddrP, u_int32 size,
+						 int32 addrSpace )
+{
+	U_INT32_OR_64 virt = (U_INT32_OR_64)*virtAddrP;
+	U_INT32_OR_64 page = (U_INT32_OR_64)sysconf( _SC_PAGESIZE );
+	U_INT32_OR_64 base = virt & ~(page - 1);
+
+	if( *virtAddrP == NULL )
+		return 0;
+
+	munmap( (void*)base, virt - base + size );
+	*virtAddrP = NULL;
+	return 0;
+}
+
+int32 OSS_AssignResources( OSS_HANDLE *osHdl, int32 busType, int32 busNbr,
+						   int32 resNbr, OSS_RESOURCES res[] )
+{
+	return 0;
+}
+
+int32 OSS_UnAssignResources( OSS_HANDLE *osHdl, int32 busType, int32 busNbr,
+							 int32 resNbr, OSS_RESOURCES res[] )
+{
+	return 0;
+}
+
+int32 OSS_IrqLevelToVector( OSS_HANDLE *osHdl, int32 busType, int32 level,
+							int32 *vectorP )
+{
+	*vectorP = level;
+	return 0;
+}
+
+int32 OSS_AlarmCreate( OSS_HANDLE *osHdl, void (*funct)(void *arg),
+					   void *arg, OSS_ALARM_HANDLE **alarmP )
+{
+	pthread_condattr_t attr;
+	UIO_ALARM *al;
+
+	if( (al = (UIO_ALARM*)calloc( 1, sizeof(*al) )) == NULL )
+		return ERR_OSS_MEM_ALLOC;
+
+	al->funct = funct;
+	al->arg	  = arg;
+	pthread_mutex_init( &al->lock, NULL );
+	pthread_condattr_init( &attr );
+	pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+	pthread_cond_init( &al->cond, &attr );
+	pthread_condattr_destroy( &attr );
+
+	if( pthread_create( &al->thread, NULL, AlarmThread, al ) ){
+		pthread_cond_destroy( &al->cond );
+		pthread_mutex_destroy( &al->lock );
+		free( al );
+		return ERR_OSS_MEM_ALLOC;
+	}
+
+	*alarmP = (OSS_ALARM_HANDLE*)al;
+	return 0;
+}
+
+int32 OSS_AlarmRemove( OSS_HANDLE *osHdl, OSS_ALARM_HANDLE **alarmP )
+{
+	UIO_ALARM *al = (UIO_ALARM*)*alarmP;
+
+	pthread_mutex_lock( &al->lock );
+	al->quit = TRUE;
+	pthread_cond_signal( &al->cond );
+	pthread_mutex_unlock( &al->lock );
+	pthread_join( al->thread, NULL );
+
+	pthread_cond_destroy( &al->cond );
+	pthread_mutex_destroy( &al->lock );
+	free( al );
+	*alarmP = NULL;
+	return 0;
+}
+
+int32 OSS_AlarmSet( OSS_HANDLE *osHdl, OSS_ALARM_HANDLE *alarm,
+					u_int32 msec, u_int32 cyclic, u_int32 *realMsecP )
+{
+	UIO_ALARM *al = (UIO_ALARM*)alarm;
+
+	pthread_mutex_lock( &al->lock );
+	clock_gettime( CLOCK_MONOTONIC, &al->expire );
+	TsAddMs( &al->expire, msec );
+	al->periodMs = cyclic ? msec : 0;
+	al->active	 = TRUE;
+	pthread_cond_signal( &al->cond );
+	pthread_mutex_unlock( &al->lock );
+
+	*realMsecP = msec;
+	return 0;
+}
+
+int32 OSS_AlarmClear( OSS_HANDLE *osHdl, OSS_ALARM_HANDLE *alarm )
+{
+	UIO_ALARM *al = (UIO_ALARM*)alarm;
+
+	pthread_mutex_lock( &al->lock );
+	al->active = FALSE;
+	pthread_cond_signal( &al->cond );
+	pthread_mutex_unlock( &al->lock );
+	return 0;
+}
+
+int32 OSS_SpinLockCreate( OSS_HANDLE *osHdl, OSS_SPINL_HANDLE **spinlP )
+{
+	pthread_mutex_t *m;
+
+	if( (m = malloc( sizeof(*m) )) == NULL )
+		return ERR_OSS_MEM_ALLOC;
+	pthread_mutex_init( m, NULL );
+	*spinlP = (OSS_SPINL_HANDLE*)m;
+	return 0;
+}
+
+int32 OSS_SpinLockRemove( OSS_HANDLE *osHdl, OSS_SPINL_HANDLE **spinlP )
+{
+	pthread_mutex_destroy( (pthread_mutex_t*)*spinlP );
+	free( *spinlP );
+	*spinlP = NULL;
+	return 0;
+}
+
+int32 OSS_SpinLockAcquire( OSS_HANDLE *osHdl, OSS_SPINL_HANDLE *spinl )
+{
+	pthread_mutex_lock( (pthread_mutex_t*)spinl );
+	return 0;
+}
+
+int32 OSS_SpinLockRelease( OSS_HANDLE *osHdl, OSS_SPINL_HANDLE *spinl )
+{
+	pthread_mutex_unlock( (pthread_mutex_t*)spinl );
+	return 0;
+}
+
+int32 OSS_MikroDelay( OSS_HANDLE *osHdl, u_int32 mikroSec )
+{
+	struct timespec ts;
+
+	ts.tv_sec  = mikroSec / 1000000;
+	ts.tv_nsec = (long)(mikroSec % 1000000) * 1000;
+	nanosleep( &ts, NULL );
+	return 0;
+}
+
+int32 OSS_TickGet( OSS_HANDLE *osHdl )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (int32)((u_int64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+int32 OSS_TickRateGet( OSS_HANDLE *osHdl )
+{
+	return 1000;
+}
+
+/*--------------------------------------------------------------------------+
+|    DESC STAND-INS                                                         |
++--------------------------------------------------------------------------*/
+int32 DESC_Init( DESC_SPEC *descSpec, OSS_HANDLE *osHdl,
+				 DESC_HANDLE **descHandleP )
+{
+	UIO_DESC_HDL *dh;
+
+	if( (dh = (UIO_DESC_HDL*)calloc( 1, sizeof(*dh) )) == NULL )
+		return ERR_OSS_MEM_ALLOC;
+
+	dh->desc = (const A12UIO_DESC*)descSpec;
+	*descHandleP = (DESC_HANDLE*)dh;
+	return 0;
+}
+
+int32 DESC_GetUInt32( DESC_HANDLE *descHandle, u_int32 defVal,
+					  u_int32 *valueP, char *keyFmt, ... )
+{
+	UIO_DESC_HDL *dh = (UIO_DESC_HDL*)descHandle;
+	const A12UIO_DESC *d;
+	char key[64];
+	va_list argptr;
+
+	va_start( argptr, keyFmt );
+	vsnprintf( key, sizeof(key), keyFmt, argptr );
+	va_end( argptr );
+
+	for( d=dh->desc; d && d->key; d++ ){
+		if( strcmp( d->key, key ) == 0 ){
+			*valueP = d->value;
+			return 0;
+		}
+	}
+
+	*valueP = defVal;
+	return ERR_DESC_KEY_NOTFOUND;
+}
+
+int32 DESC_DbgLevelSet( DESC_HANDLE *descHandle, u_int32 dbgLevel )
+{
+	return 0;
+}
+
+int32 DESC_Exit( DESC_HANDLE **descHandleP )
+{
+	free( *descHandleP );
+	*descHandleP = NULL;
+	return 0;
+}
+
+char* DESC_Ident( void )
+{
+	return "DESC - A12 userspace";
+}
@@ -23,6 +23,14 @@
  *
  *     Required: ---
  *     Switches: _ONE_NAMESPACE_PER_DRIVER_
+ *               A12_SIM	build against the host-side simulator (a12_sim.c)
+ *               A12_UIO	build for a Linux process, BAR0 mapped through
+ *                       	sysfs (a12_uio.c)
+ *               A12_OS_WORKERS	the OS layer calls A12_DeferClaim,
+ *                       	A12_Poll (IRQ_DEFER, SLOT_n_POLL) and
+ *                       	A12_SgRun (SG queue)
+ *               A12_OSS_ATOMIC	atomic operations under an OSS spin
+ *                       	lock instead of compiler atomics
  *
  *---------------------------------------------------------------------------
  * Copyright 2001-2019, MEN Mikro Elektronik GmbH
@@ -54,6 +62,13 @@
 #include <MEN/mdis_err.h>   /* MDIS error codes               */
 #include <MEN/mdis_api.h>   /* MDIS global defs               */
 #include <MEN/maccess.h>
+#ifdef A12_SIM
+# include <MEN/a12_sim.h>	/* host-side bridge simulator       */
+#endif
+#ifdef A12_UIO
+# include <MEN/a12_uio.h>	/* userspace backend                */
+#endif
+#include <MEN/bb_a12_ext.h>	/* A12 bbis extended interface	  */
 
 #include "a12_int.h"		/* A12 specific defines */
 
@@ -73,38 +88,38 @@
 
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
-typedef struct {
-	u_int32 devBusType;
-	u_int32 interrupts;
-	u_int32 addrSpace;
-	int32 	pciBusNbr;
-	int32 	pciDevNbr;
-	int32   irqLevel;
-	int32   irqMode;
-} A12_SLOT_CFG;
-
 /*-----------------------------------------+
 |  GLOBALS                                 |
 +-----------------------------------------*/
+/* defaults, copied to h->slotCfg[] by A12_Init */
 const A12_SLOT_CFG G_slotCfg[BRD_NBR_OF_BRDDEV] = {
 	/* M-mods */
 	{ OSS_BUSTYPE_MMODULE, BBIS_IRQ_DEVIRQ, OSS_ADDRSPACE_MEM, -1, -1, -1,
-	  BBIS_IRQ_SHARED },
+	  BBIS_IRQ_SHARED, TRUE, A12_POLICY_IRQ, A12_TIMING_FAST, 0 },
 	{ OSS_BUSTYPE_MMODULE, BBIS_IRQ_DEVIRQ, OSS_ADDRSPACE_MEM, -1, -1, -1,
-	  BBIS_IRQ_SHARED },
+	  BBIS_IRQ_SHARED, TRUE, A12_POLICY_IRQ, A12_TIMING_FAST, 0 },
 	{ OSS_BUSTYPE_MMODULE, BBIS_IRQ_DEVIRQ, OSS_ADDRSPACE_MEM, -1, -1, -1,
-	  BBIS_IRQ_SHARED },
+	  BBIS_IRQ_SHARED, TRUE, A12_POLICY_IRQ, A12_TIMING_FAST, 0 },
 	/* QSPI */
 	{ OSS_BUSTYPE_NONE, BBIS_IRQ_DEVIRQ, OSS_ADDRSPACE_MEM, -1, -1, 9,
-	  BBIS_IRQ_EXCLUSIVE }
+	  BBIS_IRQ_EXCLUSIVE, TRUE, A12_POLICY_IRQ, A12_TIMING_FAST, 0 }
 };
 
+#ifdef A12_OSS_ATOMIC
+/* spin lock of the atomic operations, shared by all boards (AtomicInit) */
+static OSS_HANDLE		*G_atomOsHdl;
+static OSS_SPINL_HANDLE	*G_atomLock;
+static u_int32			G_atomUsers;
+#endif
+
 
 /*-----------------------------------------+
 |  PROTOTYPES                              |
 +-----------------------------------------*/
 /* init/exit */
 static int32 A12_Init(OSS_HANDLE*, DESC_SPEC*, BBIS_HANDLE**);
+static int32 A12_WarmInit(OSS_HANDLE*, DESC_SPEC*, const A12_WARM*,
+						  BBIS_HANDLE**);
 static int32 A12_BrdInit(BBIS_HANDLE*);
 static int32 A12_BrdExit(BBIS_HANDLE*);
 static int32 A12_Exit(BBIS_HANDLE**);
@@ -115,6 +130,33 @@ static int32 A12_CfgInfo(BBIS_HANDLE*, u_int32, ...);
 static int32 A12_IrqEnable(BBIS_HANDLE*, u_int32, u_int32);
 static int32 A12_IrqSrvInit(BBIS_HANDLE*, u_int32);
 static void  A12_IrqSrvExit(BBIS_HANDLE*, u_int32);
+static int32 A12_IrqPendMask(BBIS_HANDLE*, u_int32*);
+#ifdef A12_OS_WORKERS
+static int32 A12_DeferClaim(BBIS_HANDLE*, u_int32, u_int32*);
+static int32 A12_Poll(BBIS_HANDLE*, u_int32*);
+#endif
+static int32 A12_IrqOrder(BBIS_HANDLE*, u_int32*);
+/* address views */
+static int32 A12_GetMAddrEx(BBIS_HANDLE*, u_int32, u_int32, u_int32,
+							A12_MADDR*);
+static int32 A12_MapView(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+						 A12_VIEW*);
+static int32 A12_UnMapView(BBIS_HANDLE*, A12_VIEW*);
+/* block transfers */
+static int32 A12_BlkRead(BBIS_HANDLE*, u_int32, u_int32, u_int32, void*,
+						 u_int32);
+static int32 A12_BlkWrite(BBIS_HANDLE*, u_int32, u_int32, u_int32,
+						  const void*, u_int32);
+static int32 A12_BlkFill(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+						 u_int32);
+#ifdef A12_OS_WORKERS
+/* scatter-gather queue */
+static int32 A12_SgSubmit(BBIS_HANDLE*, u_int32, A12_SG_REQ*);
+static int32 A12_SgComplete(BBIS_HANDLE*, u_int32, A12_SG_REQ**);
+static int32 A12_SgRun(BBIS_HANDLE*, u_int32, const A12_SG_BACKEND*);
+#endif
+/* resources */
+static int32 A12_ResQuery(BBIS_HANDLE*, u_int32, A12_SLOT_RES*, u_int32*);
 /* exception handling */
 static int32 A12_ExpEnable(BBIS_HANDLE*,u_int32, u_int32);
 static int32 A12_ExpSrv(BBIS_HANDLE*,u_int32);
@@ -125,11 +167,76 @@ static int32 A12_GetMAddr(BBIS_HANDLE*, u_int32, u_int32, u_int32, void**, u_int
 /* getstat/setstat */
 static int32 A12_SetStat(BBIS_HANDLE*, u_int32, int32, INT32_OR_64);
 static int32 A12_GetStat(BBIS_HANDLE*, u_int32, int32, INT32_OR_64*);
+#ifndef A12_OS_WORKERS
 /* unused */
 static int32 A12_Unused(void);
+#endif
 /* miscellaneous */
 static char* Ident( void );
 static int32 Cleanup(BBIS_HANDLE *h, int32 retCode);
+static int32 SrvClaim(BBIS_HANDLE*, u_int32, u_int32, int32);
+static void CtrlUpdate(BBIS_HANDLE*, u_int32, u_int32, u_int32);
+static int32 CtrlGet(BBIS_HANDLE*, u_int32);
+static void CtrlPut(BBIS_HANDLE*, u_int32);
+static void StatHist(A12_DEV_STAT*, u_int64);
+#ifdef A12_OSS_ATOMIC
+static int32 AtomicInit(OSS_HANDLE*);
+static void AtomicExit(void);
+static u_int32 AtomicOp(volatile u_int32*, u_int32, u_int32, u_int32);
+static int32 AtomicCasPtr(void * volatile *, void*, void*);
+#endif
+static void IenApply(BBIS_HANDLE*, u_int32);
+static int32 ModSet(BBIS_HANDLE*, u_int32, u_int32, u_int32);
+static void ModAlarm(void*);
+#ifdef A12_OS_WORKERS
+static u_int32 DeferTake(A12_DEFER_QUEUE*, u_int32);
+#endif
+static int32 HandleAlloc(OSS_HANDLE*, DESC_SPEC*, BBIS_HANDLE**);
+static int32 BridgeFind(BBIS_HANDLE*, u_int32);
+static int32 BridgeCheck(BBIS_HANDLE*);
+static int32 IrqAttach(BBIS_HANDLE*);
+static int32 SlotAttach(BBIS_HANDLE*, u_int32);
+static int32 SlotMap(BBIS_HANDLE*, u_int32);
+static void WarmSave(BBIS_HANDLE*, A12_WARM*);
+static int32 Suspend(BBIS_HANDLE*, u_int32);
+static int32 SlotReset(BBIS_HANDLE*, u_int32, u_int32);
+#ifdef A12_OS_WORKERS
+static int32 PollSet(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+					 u_int32, u_int32);
+static void PollCheck(BBIS_HANDLE*, u_int32);
+static void PollSwitch(BBIS_HANDLE*, u_int32, u_int32);
+#endif
+static int32 StormSet(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32);
+static void StormCheck(BBIS_HANDLE*, u_int32);
+static void StormAlarm(void*);
+static u_int32 ScanOrder(BBIS_HANDLE*, u_int32);
+static void ScanHit(BBIS_HANDLE*, u_int32);
+static int32 PolicySet(BBIS_HANDLE*, u_int32, u_int32);
+static int32 SlotEnable(BBIS_HANDLE*, u_int32, u_int32);
+static void TraceRec(BBIS_HANDLE*, u_int32, u_int32, u_int32, int32);
+static int32 TraceOn(BBIS_HANDLE*, u_int32);
+static u_int32 TraceDrain(BBIS_HANDLE*, A12_TRACE_EV*, u_int32);
+static void RecAdd(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32);
+static int32 RecOn(BBIS_HANDLE*, u_int32);
+static u_int32 RecDrain(BBIS_HANDLE*, void*, u_int32);
+static int32 QspiAttach(BBIS_HANDLE*);
+static int32 SlotRes(BBIS_HANDLE*, u_int32, A12_SLOT_RES**);
+static int32 MAddr(BBIS_HANDLE*, u_int32, u_int32, u_int32, U_INT32_OR_64*,
+				   u_int32*);
+static u_int32 MAttr(BBIS_HANDLE*, u_int32, u_int32);
+static int32 BlkWin(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+					u_int32, const void*, MACCESS*);
+static int32 BlkRead(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32, void*,
+					 u_int32);
+static int32 BlkWrite(BBIS_HANDLE*, u_int32, u_int32, u_int32, u_int32,
+					  const void*, u_int32);
+#ifdef A12_OS_WORKERS
+static void SgFlush(A12_SG_QUEUE*);
+static void SgQueue(BBIS_HANDLE*, u_int32, const A12_SG_BACKEND*);
+static void SgDone(A12_SG_QUEUE*, A12_SG_REQ*);
+static int32 SgCopy(void*, u_int32, u_int32, u_int32, u_int32, u_int32, void*,
+					u_int32);
+#endif
 
 
 /**************************** A12_GetEntry ***********************************
@@ -152,39 +259,53 @@ static int32 Cleanup(BBIS_HANDLE *h, int32 retCode);
     bbisP->brdInit      =   A12_BrdInit;
     bbisP->brdExit      =   A12_BrdExit;
     bbisP->exit         =   A12_Exit;
-    bbisP->fkt04        =   A12_Unused;
+    bbisP->fkt04        =   A12_ENTRY_SET(A12_WarmInit);
     /* info */
     bbisP->brdInfo      =   A12_BrdInfo;
     bbisP->cfgInfo      =   A12_CfgInfo;
-    bbisP->fkt07        =   A12_Unused;
-    bbisP->fkt08        =   A12_Unused;
-    bbisP->fkt09        =   A12_Unused;
+    bbisP->fkt07        =   A12_ENTRY_SET(A12_GetMAddrEx);
+    bbisP->fkt08        =   A12_ENTRY_SET(A12_MapView);
+    bbisP->fkt09        =   A12_ENTRY_SET(A12_UnMapView);
     /* interrupt handling */
     bbisP->irqEnable    =   A12_IrqEnable;
     bbisP->irqSrvInit   =   A12_IrqSrvInit;
     bbisP->irqSrvExit   =   A12_IrqSrvExit;
     bbisP->setIrqHandle =   NULL;
-    bbisP->fkt14        =   A12_Unused;
+    bbisP->fkt14        =   A12_ENTRY_SET(A12_IrqPendMask);
     /* exception handling */
     bbisP->expEnable    =   A12_ExpEnable;
     bbisP->expSrv       =   A12_ExpSrv;
+#ifdef A12_OS_WORKERS
+    bbisP->fkt17        =   A12_ENTRY_SET(A12_DeferClaim);
+    bbisP->fkt18        =   A12_ENTRY_SET(A12_Poll);
+#else
     bbisP->fkt17        =   A12_Unused;
     bbisP->fkt18        =   A12_Unused;
-    bbisP->fkt19        =   A12_Unused;
+#endif
+    bbisP->fkt19        =   A12_ENTRY_SET(A12_BlkRead);
     /* */
-    bbisP->fkt20        =   A12_Unused;
-    bbisP->fkt21        =   A12_Unused;
+    bbisP->fkt20        =   A12_ENTRY_SET(A12_BlkWrite);
+    bbisP->fkt21        =   A12_ENTRY_SET(A12_BlkFill);
+#ifdef A12_OS_WORKERS
+    bbisP->fkt22        =   A12_ENTRY_SET(A12_SgSubmit);
+    bbisP->fkt23        =   A12_ENTRY_SET(A12_SgComplete);
+#else
     bbisP->fkt22        =   A12_Unused;
     bbisP->fkt23        =   A12_Unused;
-    bbisP->fkt24        =   A12_Unused;
+#endif
+    bbisP->fkt24        =   A12_ENTRY_SET(A12_ResQuery);
     /*  getstat / setstat / address setting */
     bbisP->setStat      =   A12_SetStat;
     bbisP->getStat      =   A12_GetStat;
     bbisP->setMIface    =   A12_SetMIface;
     bbisP->clrMIface    =   A12_ClrMIface;
     bbisP->getMAddr     =   A12_GetMAddr;
-    bbisP->fkt30        =   A12_Unused;
+    bbisP->fkt30        =   A12_ENTRY_SET(A12_IrqOrder);
+#ifdef A12_OS_WORKERS
+    bbisP->fkt31        =   A12_ENTRY_SET(A12_SgRun);
+#else
     bbisP->fkt31        =   A12_Unused;
+#endif
 }
 
 /****************************** A12_Init *************************************
@@ -204,6 +325,130 @@ static int32 Cleanup(BBIS_HANDLE *h, int32 retCode);
  *                -----------------------  ---------------  -------------
  *                DEBUG_LEVEL_DESC         OSS_DBG_DEFAULT  see dbg.h
  *                DEBUG_LEVEL              OSS_DBG_DEFAULT  see dbg.h
+ *                PCI_BUS_NUMBER           0                0..255
+ *                PCI_DEVICE_NUMBER        0x18             0..31
+ *                BRIDGE_INSTANCE          -                0..max
+ *                SLOT_n_IRQ_MOD_EVENTS    0 (off)          0..0xffffffff
+ *                SLOT_n_IRQ_MOD_TIME      1                1..0xffffffff
+ *                IRQ_DEFER                0 (off)          0, 1
+ *                IRQ_CPU_MASK             0 (none)         0..0xffffffff
+ *                IRQ_SCAN                 0 (static)       A12_SCAN_xxx
+ *                SLOT_n_SCAN_PRIO         0                0..0xff
+ *                SLOT_n_CPU_MASK          0 (none)         0..0xffffffff
+ *                LAZY_INIT                0 (off)          0, 1
+ *                SLOT_n_POLL              0 (off)          0, 1
+ *                SLOT_n_POLL_ON           50               1..0xffffffff
+ *                SLOT_n_POLL_OFF          5                0..POLL_ON-1
+ *                SLOT_n_POLL_WINDOW       1                1..0xffffffff
+ *                SLOT_n_POLL_PERIOD       10               0..0xffffffff
+ *                SLOT_n_STORM_IRQS        0 (off)          0..0xffffffff
+ *                SLOT_n_STORM_WINDOW      10               1..0xffffffff
+ *                SLOT_n_STORM_TIME        10               1..0x10000
+ *                SLOT_n_A24_ATTR          0 (uncached)     A12_MATTR_xxx
+ *                SLOT_n_ENABLE            1 (on)           0, 1
+ *                SLOT_n_IRQ_MODE          see below        BBIS_IRQ_SHARED,
+ *                                                          BBIS_IRQ_EXCLUSIVE
+ *                SLOT_n_IRQ_POLICY        0 (interrupts)   A12_POLICY_xxx
+ *                SLOT_n_TIMING            3 (fast)         A12_TIMING_xxx
+ *                QSPI_WIN_OFFSET          0x06000000       see below
+ *                QSPI_WIN_SIZE            0x800            see below
+ *                QSPI_IRQ_OFFSET          0x1f             0..QSPI_WIN_SIZE-1
+ *                QSPI_IRQ_MASK            0xe0             0..0xff
+ *                REC_ENABLE               0 (off)          0, 1
+ *
+ *                PCI_BUS_NUMBER/PCI_DEVICE_NUMBER locate the M-module
+ *                bridge. Without PCI_DEVICE_NUMBER, BRIDGE_INSTANCE n
+ *                selects the n-th A12 bridge (0 = first) found by a scan
+ *                from PCI_BUS_NUMBER upwards. Each bridge is a separate
+ *                board instance with its own descriptor, IRQ and
+ *                statistics.
+ *
+ *                LAZY_INIT skips all per-slot work at init: resources,
+ *                control register mapping and the SLOT_n_xxx keys of a
+ *                slot are handled on its first use (A12_GetMAddr,
+ *                A12_IrqEnable or a setstat/getstat of the slot), the PCI
+ *                interrupt line on the first BBIS_CFGINFO_IRQ query.
+ *
+ *                SLOT_n_IRQ_MOD_xxx enable IRQ moderation for M-module
+ *                slot n: after SLOT_n_IRQ_MOD_EVENTS serviced interrupts,
+ *                IEN is held cleared for SLOT_n_IRQ_MOD_TIME milliseconds.
+ *
+ *                IRQ_DEFER enables deferred servicing of the M-module
+ *                slots, see A12_IrqSrvInit and A12_DeferClaim. It is
+ *                refused unless the BBIS is built with A12_OS_WORKERS,
+ *                i.e. for an OS layer which calls A12_DeferClaim. The
+ *                same holds for SLOT_n_POLL and A12_POLICY_POLL, which
+ *                need an OS layer calling A12_Poll. Without the switch,
+ *                the other SLOT_n_POLL_xxx keys are not read.
+ *
+ *                IRQ_CPU_MASK and SLOT_n_CPU_MASK are CPU hints (bit n =
+ *                CPU n): the preferred CPUs of the bridge interrupt and of
+ *                the deferred work of M-module slot n. The BBIS reports
+ *                them (A12_CFGINFO_CPUMASK) for the OS layer to apply, and
+ *                hands deferred work of slot n only to workers on its CPUs
+ *                (A12_DeferClaim).
+ *
+ *                IRQ_SCAN sets the order in which the OS layer should check
+ *                the M-module slots on an interrupt, see A12_IrqOrder.
+ *                A12_SCAN_STATIC checks higher SLOT_n_SCAN_PRIO first (the
+ *                lower slot on a tie, i.e. 0, 1, 2 by default), so a
+ *                critical module is found first. A12_SCAN_ADAPTIVE checks
+ *                the slots first which claimed the interrupt most often
+ *                and most recently, SLOT_n_SCAN_PRIO only breaks ties.
+ *
+ *                SLOT_n_POLL enables the hybrid IRQ/poll mode of M-module
+ *                slot n. When a SLOT_n_POLL_WINDOW milliseconds window
+ *                sees SLOT_n_POLL_ON or more interrupts, IEN is cleared
+ *                and the slot is polled (A12_Poll) every
+ *                SLOT_n_POLL_PERIOD microseconds. It returns to interrupts
+ *                when a window sees SLOT_n_POLL_OFF or fewer events.
+ *
+ *                SLOT_n_STORM_xxx protect the other slots from M-module
+ *                slot n asserting its interrupt without end (e.g. a
+ *                pending bit stuck at 1): when a SLOT_n_STORM_WINDOW
+ *                milliseconds window sees SLOT_n_STORM_IRQS interrupts,
+ *                IEN is cleared for SLOT_n_STORM_TIME milliseconds. Each
+ *                further storm doubles the quarantine (up to 64 times),
+ *                a quiet window after the quarantine starts again with
+ *                SLOT_n_STORM_TIME. Polled slots need no quarantine, the
+ *                poll period limits their load.
+ *
+ *                SLOT_n_A24_ATTR allows write-combined (A12_MATTR_WC) or
+ *                prefetchable (A12_MATTR_PREFETCH) views of the A24
+ *                windows of M-module slot n, see A12_MapView. Only set
+ *                these for modules without side effects on reordered
+ *                or merged accesses. OSS can not map write-combined,
+ *                such views are only granted by the simulator and the
+ *                userspace build (sysfs resource0_wc, which Linux only
+ *                provides for a prefetchable BAR0), elsewhere they are
+ *                mapped uncached.
+ *
+ *                SLOT_n_ENABLE, SLOT_n_IRQ_MODE and SLOT_n_IRQ_POLICY form
+ *                the device configuration table (n=3 is the QSPI). A
+ *                disabled device can not be opened and is skipped by the
+ *                interrupt and board init/exit paths. SLOT_n_IRQ_MODE
+ *                defaults to BBIS_IRQ_SHARED for the M-module slots and
+ *                BBIS_IRQ_EXCLUSIVE for the QSPI. With SLOT_n_IRQ_POLICY
+ *                A12_POLICY_POLL, M-module slot n is always polled
+ *                (A12_Poll), its IEN is never set.
+ *
+ *                SLOT_n_TIMING sets the bus timing of M-module slot n (fast
+ *                bits of its control register), A12_TIMING_FAST unless
+ *                the module needs slower cycles.
+ *
+ *                QSPI_WIN_OFFSET/SIZE place the QSPI window in BAR0, the
+ *                window must end within the 128 MB of BAR0. The QSPI claims
+ *                its interrupt (IRQ9) only when the byte register at
+ *                QSPI_IRQ_OFFSET of the window has a bit of QSPI_IRQ_MASK
+ *                set. The defaults are the SPIF, MODF and HALTA flags of
+ *                the QSPI status register SPSR. QSPI_IRQ_MASK=0 claims
+ *                every IRQ9 without reading the QSPI.
+ *
+ *                REC_ENABLE starts the register access recording at init,
+ *                so BrdInit is recorded too, see M_BB_A12_REC.
+ *
+ *                A12_WarmInit restarts the BBIS from a saved board state
+ *                instead, without bridge search and descriptor.
  *---------------------------------------------------------------------------
  *  Input......:  osHdl     pointer to os specific structure
  *                descSpec  pointer to os specific descriptor specifier
@@ -218,156 +463,394 @@ static int32 A12_Init(
     BBIS_HANDLE     **hP )
 {
     BBIS_HANDLE	*h = NULL;
-	u_int32     gotsize;
     u_int32		value;
-	int32 venId, devId, error, i;
-
-    /*-------------------------------+
-    | initialize the board structure |
-    +-------------------------------*/
-    /* get memory for the board structure */
-    *hP = h = (BBIS_HANDLE*) (OSS_MemGet(
-        osHdl, sizeof(BBIS_HANDLE), &gotsize ));
-    if ( h == NULL )
-        return ERR_OSS_MEM_ALLOC;
-
-    /* store data into the board structure */
-    h->ownMemSize = gotsize;
-    h->osHdl = osHdl;
-
-    /*------------------------------+
-    |  init id function table       |
-    +------------------------------*/
-	/* drivers ident function */
-	h->idFuncTbl.idCall[0].identCall = Ident;
-	/* libraries ident functions */
-	h->idFuncTbl.idCall[1].identCall = DESC_Ident;
-	h->idFuncTbl.idCall[2].identCall = OSS_Ident;
-	/* terminator */
-	h->idFuncTbl.idCall[3].identCall = NULL;
+	int32 error, i;
 
-    /*------------------------------+
-    |  prepare debugging            |
-    +------------------------------*/
-	DBG_MYLEVEL = OSS_DBG_DEFAULT;	/* set OS specific debug level */
-	DBGINIT((NULL,&DBH));
+	*hP = NULL;
+	if( (error = HandleAlloc( osHdl, descSpec, &h )) )
+		return error;
+	*hP = h;
 
     DBGWRT_1((DBH,"BB - %s_Init\n",BBNAME));
 
-    /*------------------------------+
-    |  scan descriptor              |
-    +------------------------------*/
-    /* init descHdl */
-    error = DESC_Init( descSpec, osHdl, &h->descHdl );
-	if (error)
-		return( Cleanup(h,error) );
-
-    /* get DEBUG_LEVEL_DESC */
-    error = DESC_GetUInt32(h->descHdl, OSS_DBG_DEFAULT, &value,
-				"DEBUG_LEVEL_DESC");
-	if ( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+	/*-----------------------------------+
+	|  Locate M-module bridge            |
+	+-----------------------------------*/
+	error = DESC_GetUInt32( h->descHdl, 0, &value, "PCI_BUS_NUMBER" );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
 		return( Cleanup(h,error) );
+	h->pciBusNbr = (int32)value;
 
-	/* set debug level for DESC module */
-	DESC_DbgLevelSet(h->descHdl, value);
-
-    /* get DEBUG_LEVEL */
-    error = DESC_GetUInt32( h->descHdl, OSS_DBG_DEFAULT,
-							 &(h->debugLevel),
-                "DEBUG_LEVEL");
-	if ( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+	error = DESC_GetUInt32( h->descHdl, A12_MMOD_BRIDGE_DEV_NO, &value,
+							"PCI_DEVICE_NUMBER" );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
 		return( Cleanup(h,error) );
-
+	h->pciDevNbr = (int32)value;
+
+	if( error == ERR_DESC_KEY_NOTFOUND ){
+		error = DESC_GetUInt32( h->descHdl, 0, &value, "BRIDGE_INSTANCE" );
+		if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+			return( Cleanup(h,error) );
+		if( !error && (error = BridgeFind( h, value )) )
+			return( Cleanup(h,error) );
+	}
+	DBGWRT_2((DBH," bridge at bus %d device 0x%x\n", h->pciBusNbr,
+			  h->pciDevNbr));
 
 	/*-----------------------------------+
 	|  Check if M-module bridge present  |
 	+-----------------------------------*/
-	error = OSS_PciGetConfig( h->osHdl, 0, A12_MMOD_BRIDGE_DEV_NO, 0,
-							  OSS_PCI_VENDOR_ID, &venId );
-	error = OSS_PciGetConfig( h->osHdl, 0, A12_MMOD_BRIDGE_DEV_NO, 0,
-							  OSS_PCI_DEVICE_ID, &devId );
+	if( (error = BridgeCheck( h )) )
+		return( Cleanup(h,error) );
+
+	/*------------------------------------------+
+	|  Determine base address of M-module regs  |
+	+------------------------------------------*/
+	error = OSS_BusToPhysAddr( h->osHdl, OSS_BUSTYPE_PCI, &h->physBase,
+							   h->pciBusNbr, h->pciDevNbr, 0, 0 ); /* BAR0 */
 	if( error ){
-		DBGWRT_ERR((DBH, "*** %s_BrdInit: Can't read PCI ven/dev Id\n",
+		DBGWRT_ERR((DBH, "*** %s_BrdInit: Can't read BAR0 Id\n",
 					BBNAME ));
 		return( Cleanup(h,error) );
 	}
 
-	if( venId == 0xffff && devId == 0xffff ){
-		DBGWRT_ERR((DBH, "*** %s_BrdInit: PCI->M-mod bridge not present!\n",
+	/*
+	 * BAR0 attributes, 64-bit BAR must be reachable. The high dword is
+	 * in BAR1; an OSS that only knows 32-bit BARs drops it, then the
+	 * address is composed from both dwords.
+	 */
+	error = OSS_PciGetConfig( h->osHdl, h->pciBusNbr, h->pciDevNbr, 0,
+							  OSS_PCI_ADDR_0, (int32*)&value );
+	if( !error && (value & A12_PCI_BAR_TYPE) == A12_PCI_BAR_TYPE_64 ){
+		u_int32 high;
+
+		error = OSS_PciGetConfig( h->osHdl, h->pciBusNbr, h->pciDevNbr, 0,
+								  OSS_PCI_ADDR_1, (int32*)&high );
+		if( !error && high && sizeof(void*) < sizeof(u_int64) ){
+			DBGWRT_ERR((DBH, "*** %s_BrdInit: BAR0 above 4GB not "
+						"addressable\n", BBNAME ));
+			return( Cleanup(h,ERR_BBIS_ILL_ADDRMODE) );
+		}
+		if( !error && high &&
+			!((u_int64)(U_INT32_OR_64)h->physBase >> 32) )
+			h->physBase = (void*)(U_INT32_OR_64)
+				(((u_int64)high << 32) | (value & A12_PCI_BAR_ADDR));
+	}
+	if( error )
+		return( Cleanup(h,error) );
+
+	h->barPrefetch = (value & A12_PCI_BAR_PREFETCH) ? TRUE : FALSE;
+	DBGWRT_2((DBH," physBase 0x%08lx prefetchable=%d\n", h->physBase,
+			  h->barPrefetch ));
+
+	/* deferred servicing */
+	error = DESC_GetUInt32( h->descHdl, 0, &value, "IRQ_DEFER" );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return( Cleanup(h,error) );
+#ifdef A12_OS_WORKERS
+	h->irqDefer = value ? TRUE : FALSE;
+#else
+	if( value ){
+		DBGWRT_ERR((DBH, "*** %s_Init: IRQ_DEFER needs A12_OS_WORKERS\n",
 					BBNAME));
-		return( Cleanup(h,ERR_BBIS_ILL_ID));
+		return( Cleanup(h,ERR_BBIS_DESC_PARAM) );
 	}
+#endif
 
-	if( (venId != A12_MMOD_BRIDGE_VEN_ID) ||
-		(devId != A12_MMOD_BRIDGE_DEV_ID )){
-		DBGWRT_ERR((DBH, "*** %s_BrdInit: bad vendor/device ID of "
-					"PCI->M-mod bridge %04lx %04lx\n", BBNAME, venId, devId));
-		return( Cleanup(h,ERR_BBIS_ILL_ID));
+	/* CPU hint of the bridge interrupt */
+	error = DESC_GetUInt32( h->descHdl, 0, &h->irqCpus, "IRQ_CPU_MASK" );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return( Cleanup(h,error) );
+
+	/* order of the slot checks */
+	error = DESC_GetUInt32( h->descHdl, A12_SCAN_STATIC, &value, "IRQ_SCAN" );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return( Cleanup(h,error) );
+	if( value > A12_SCAN_ADAPTIVE ){
+		DBGWRT_ERR((DBH, "*** %s_Init: IRQ_SCAN %d invalid\n", BBNAME, value));
+		return( Cleanup(h,ERR_BBIS_DESC_PARAM) );
 	}
+	h->irq.scan = value;
 
-	/*------------------------------------------+
-	|  Determine base address of M-module regs  |
-	+------------------------------------------*/
-	error = OSS_BusToPhysAddr( h->osHdl, OSS_BUSTYPE_PCI, &h->physBase,
-							   0, A12_MMOD_BRIDGE_DEV_NO, 0, 0 ); /* BAR0 */
-	if( error ){
-		DBGWRT_ERR((DBH, "*** %s_BrdInit: Can't read BAR0 Id\n",
-					BBNAME ));
+	/* lazy slot resources */
+	error = DESC_GetUInt32( h->descHdl, 0, &h->lazyInit, "LAZY_INIT" );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
 		return( Cleanup(h,error) );
+
+	/* register access recording */
+	error = DESC_GetUInt32( h->descHdl, 0, &value, "REC_ENABLE" );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return( Cleanup(h,error) );
+	if( value && (error = RecOn( h, TRUE )) )
+		return( Cleanup(h,error) );
+
+	/* QSPI window and interrupt status register */
+	{
+		static const char *key[] = { "QSPI_WIN_OFFSET", "QSPI_WIN_SIZE",
+									 "QSPI_IRQ_OFFSET", "QSPI_IRQ_MASK" };
+		static const u_int32 def[] = { A12_QSPI_WIN_OFFSET, A12_QSPI_WIN_SIZE,
+									   A12_QSPI_IRQ_OFFSET, A12_QSPI_IRQ_MASK };
+		u_int32 val[4];
+
+		for( i=0; i<4; i++ ){
+			error = DESC_GetUInt32( h->descHdl, def[i], &val[i],
+									(char*)key[i] );
+			if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+				return( Cleanup(h,error) );
+		}
+
+		if( val[0] >= A12_BAR0_SIZE || val[1] == 0 ||
+			val[1] > A12_BAR0_SIZE - val[0] ||
+			(val[3] && (val[2] >= val[1] || val[3] > 0xff)) ){
+			DBGWRT_ERR((DBH, "*** %s_Init: bad QSPI_xxx keys\n", BBNAME));
+			return( Cleanup(h,ERR_BBIS_DESC_PARAM) );
+		}
+		h->qspiOffs	   = val[0];
+		h->qspiSize	   = val[1];
+		h->qspiIrqOffs = val[2];
+		h->qspiIrqMask = val[3];
 	}
-	DBGWRT_2((DBH," physBase 0x%08lx\n", h->physBase ));
 
-	/*------------------------------------+
-	|  Assign resources for control regs  |
-	+------------------------------------*/
-	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
-		h->res[i].type = OSS_RES_MEM;
-		h->res[i].u.mem.physAddr = (void *)((INT32_OR_64)h->physBase +
-			(A12_MMOD_SLOT_OFFSET*i) + A12_MMOD_CTRL_BASE);
-		h->res[i].u.mem.size = A12_CTRL_SIZE;
+	/*--------------------------------------+
+	|  Device configuration table           |
+	+--------------------------------------*/
+	for( i=0; i<BRD_NBR_OF_BRDDEV; i++ ){
+		A12_SLOT_CFG *cfg = &h->slotCfg[i];
+
+		*cfg = G_slotCfg[i];
+
+		error = DESC_GetUInt32( h->descHdl, cfg->enable, &cfg->enable,
+								"SLOT_%d_ENABLE", i );
+		if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+			return( Cleanup(h,error) );
+
+		error = DESC_GetUInt32( h->descHdl, cfg->irqMode, &value,
+								"SLOT_%d_IRQ_MODE", i );
+		if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+			return( Cleanup(h,error) );
+		if( value != BBIS_IRQ_SHARED && value != BBIS_IRQ_EXCLUSIVE ){
+			DBGWRT_ERR((DBH, "*** %s_Init: SLOT_%d_IRQ_MODE %d invalid\n",
+						BBNAME, i, value));
+			return( Cleanup(h,ERR_BBIS_DESC_PARAM) );
+		}
+		cfg->irqMode = (int32)value;
+
+		if( i < A12_NBR_OF_MMODS ){
+			error = DESC_GetUInt32( h->descHdl, 0, &cfg->scanPrio,
+									"SLOT_%d_SCAN_PRIO", i );
+			if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+				return( Cleanup(h,error) );
+			if( cfg->scanPrio > A12_SCAN_PRIO_MAX ){
+				DBGWRT_ERR((DBH, "*** %s_Init: SLOT_%d_SCAN_PRIO %d "
+							"invalid\n", BBNAME, i, cfg->scanPrio));
+				return( Cleanup(h,ERR_BBIS_DESC_PARAM) );
+			}
+		}
+
+		if( cfg->enable )
+			h->irq.enMask |= 1 << i;
+		else {
+			DBGWRT_2((DBH," device %d disabled\n", i));
+		}
 	}
+	h->irq.scanOrder = ScanOrder( h, FALSE );
+
+	/*--------------------------------------+
+	|  Interrupt and M-module slots         |
+	+--------------------------------------*/
+	if( !h->lazyInit ){
+		if( (error = IrqAttach( h )) )
+			return( Cleanup(h,error) );
+
+		for( i=0; i<A12_NBR_OF_MMODS; i++ ){
+			if( !h->slotCfg[i].enable )
+				continue;
+			if( (error = SlotAttach( h, i )) )
+				return( Cleanup(h,error) );
+		}
 
-    /* assign the resources */
-    if( (error = OSS_AssignResources( h->osHdl, OSS_BUSTYPE_PCI, 0,
-                                      A12_NBR_OF_MMODS, h->res )) )
-		return Cleanup(h, error);
+		if( h->slotCfg[A12_NBR_OF_MMODS].enable &&
+			(error = QspiAttach( h )) )
+			return( Cleanup(h,error) );
 
-	h->resourcesAssigned = TRUE;
-	/*---------------------+
-	|  Map used resources  |
-	+---------------------*/
-	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
-		error = OSS_MapPhysToVirtAddr(
-				h->osHdl,
-				(void*)( (INT32_OR_64)h->physBase +
-						 (A12_MMOD_SLOT_OFFSET*i) + A12_MMOD_CTRL_BASE),
-				A12_CTRL_SIZE,
-				OSS_ADDRSPACE_MEM,
-				OSS_BUSTYPE_PCI,
-				0,
-				(void *)&h->mmod[i].vCtrlBase );
-		if( error ) return Cleanup( h, error );
-		DBGWRT_2((DBH," vCtrlBase for M-mod %d: 0x%08lx\n", i,
-				  h->mmod[i].vCtrlBase));
+		/* resources of the devices */
+		for( i=0; i<BRD_NBR_OF_BRDDEV; i++ ){
+			A12_SLOT_RES *res;
+
+			if( h->slotCfg[i].enable &&
+				(error = SlotRes( h, i < A12_NBR_OF_MMODS ? i :
+								  BBIS_SLOTS_ONBOARDDEVICE_START, &res )) )
+				return( Cleanup(h,error) );
+		}
 	}
 
-    /* get interrupt line */
-	error = OSS_PciGetConfig( h->osHdl, 0, A12_MMOD_BRIDGE_DEV_NO, 0,
-							   OSS_PCI_INTERRUPT_LINE, &h->irqLevel );
+    return 0;
+}
 
-	/* no interrupt connected */
-	if( error || (h->irqLevel == 0xff) )
-		return Cleanup(h,ERR_BBIS_NO_IRQ);
+/**************************** A12_WarmInit ***********************************
+ *
+ *  Description:  Allocate and return board handle from a saved board state
+ *
+ *                Warm restart of the BBIS: instead of the search of the
+ *                bridge, the BAR0 reads and the descriptor, the bridge
+ *                location, interrupt and settings come from a state saved
+ *                with M_BB_A12_BLK_WARM by the previous instance.
+ *
+ *                - checks the IDs of the bridge at the saved location
+ *                - assigns and maps the control registers of the slots
+ *                  that were set up, with their saved settings
+ *                - A12_BrdInit restores their control registers and the
+ *                  interrupt enables in one pass
+ *
+ *                Only the DEBUG_LEVEL_xxx keys are read from descSpec.
+ *                Slots not set up at the save read their SLOT_n_xxx keys
+ *                on first use, as with LAZY_INIT. Recording (REC_ENABLE)
+ *                is not restarted.
+ *
+ *                Jump table entry fkt04, see bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  osHdl     pointer to os specific structure
+ *                descSpec  pointer to os specific descriptor specifier
+ *                warm      saved board state
+ *                hP   pointer to not initialized board handle structure
+ *  Output.....:  *hP  initialized board handle structure
+ *				  return    0 | error code
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_WarmInit(
+    OSS_HANDLE      *osHdl,
+    DESC_SPEC       *descSpec,
+    const A12_WARM  *warm,
+    BBIS_HANDLE     **hP )
+{
+    BBIS_HANDLE	*h = NULL;
+	u_int32 bit;
+	int32 error, i;
 
-	/* convert level to vector */
-	if( (error = OSS_IrqLevelToVector( h->osHdl, OSS_BUSTYPE_PCI,
-										h->irqLevel, &h->irqVector )) )
-		return Cleanup(h,error);
+	*hP = NULL;
+	if( warm == NULL || warm->magic != A12_WARM_MAGIC ||
+		warm->version != A12_WARM_VERSION || warm->size != sizeof(A12_WARM) )
+		return ERR_BBIS_ILL_PARAM;
 
-	DBGWRT_2((DBH," IRQ level=0x%x, vector=0x%x\n",
-			  h->irqLevel, h->irqVector));
+	/* BAR0 must be reachable */
+	if( sizeof(void*) < sizeof(u_int64) && (warm->physBase >> 32) )
+		return ERR_BBIS_ILL_ADDRMODE;
+
+	if( (error = HandleAlloc( osHdl, descSpec, &h )) )
+		return error;
+	*hP = h;
+
+    DBGWRT_1((DBH,"BB - %s_WarmInit\n",BBNAME));
+
+	/*-----------------------------------+
+	|  M-module bridge at saved place    |
+	+-----------------------------------*/
+	h->pciBusNbr = warm->pciBusNbr;
+	h->pciDevNbr = warm->pciDevNbr;
+	if( (error = BridgeCheck( h )) )
+		return( Cleanup(h,error) );
+
+	h->physBase	   = (void*)(U_INT32_OR_64)warm->physBase;
+	h->barPrefetch = warm->barPrefetch ? TRUE : FALSE;
+	h->irqValid	   = warm->irqValid ? TRUE : FALSE;
+	h->irqLevel	   = warm->irqLevel;
+	h->irqVector   = warm->irqVector;
+#ifdef A12_OS_WORKERS
+	h->irqDefer	   = warm->irqDefer ? TRUE : FALSE;
+#else
+	if( warm->irqDefer )
+		return( Cleanup(h,ERR_BBIS_ILL_PARAM) );
+#endif
+	h->irqCpus	   = warm->irqCpus;
+	h->lazyInit	   = warm->lazyInit;
+	h->irq.scan	   = warm->scan;
+	h->qspiOffs	   = warm->qspiOffs;
+	h->qspiSize	   = warm->qspiSize;
+	h->qspiIrqOffs = warm->qspiIrqOffs;
+	h->qspiIrqMask = warm->qspiIrqMask;
+	DBGWRT_2((DBH," bridge at bus %d device 0x%x physBase 0x%08lx\n",
+			  h->pciBusNbr, h->pciDevNbr, h->physBase));
+
+	/*--------------------------------------+
+	|  Device configuration table           |
+	+--------------------------------------*/
+	for( i=0; i<BRD_NBR_OF_BRDDEV; i++ ){
+		A12_SLOT_CFG *cfg = &h->slotCfg[i];
+
+		*cfg = G_slotCfg[i];
+		cfg->enable	 = (warm->enable >> i) & 1;
+		cfg->irqMode = (int32)warm->irqMode[i];
+		if( cfg->irqMode != BBIS_IRQ_SHARED &&
+			cfg->irqMode != BBIS_IRQ_EXCLUSIVE )
+			return( Cleanup(h,ERR_BBIS_ILL_PARAM) );
+		if( i < A12_NBR_OF_MMODS )
+			cfg->scanPrio = warm->scanPrio[i];
+
+		if( cfg->enable )
+			h->irq.enMask |= 1 << i;
+	}
+	if( warm->scan > A12_SCAN_ADAPTIVE )
+		return( Cleanup(h,ERR_BBIS_ILL_PARAM) );
+	for( i=0; i<A12_NBR_OF_MMODS; i++ )
+		if( h->slotCfg[i].scanPrio > A12_SCAN_PRIO_MAX )
+			return( Cleanup(h,ERR_BBIS_ILL_PARAM) );
+	h->irq.scanOrder = ScanOrder( h, FALSE );
+
+	/*--------------------------------------+
+	|  Slots set up at the save             |
+	+--------------------------------------*/
+	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
+		const A12_WARM_SLOT *ws = &warm->slot[i];
+		MMOD *mm = &h->mmod[i];
+
+		bit = 1 << i;
+		if( !(warm->attached & h->irq.enMask & bit) )
+			continue;
+		if( warm->timing[i] > A12_TIMING_FAST ||
+			warm->policy[i] > A12_POLICY_POLL )
+			return( Cleanup(h,ERR_BBIS_ILL_PARAM) );
+#ifndef A12_OS_WORKERS
+		if( warm->policy[i] == A12_POLICY_POLL )
+			return( Cleanup(h,ERR_BBIS_ILL_PARAM) );
+#endif
+
+		if( (error = SlotMap( h, i )) )
+			return( Cleanup(h,error) );
 
+		/* the saved register, IEN is set by A12_BrdInit */
+		mm->ctrl = ws->ctrl & ~(A12_CTRL_IEN | A12_CTRL_IRQ);
+		h->slotCfg[i].timing = warm->timing[i];
+		h->a24Attr[i] = ws->a24Attr & (A12_MATTR_WC | A12_MATTR_PREFETCH);
+		mm->cpus = ws->cpus;
 
+		if( (error = ModSet( h, i, ws->modBudget, ws->modTime )) ||
+#ifdef A12_OS_WORKERS
+			(error = PollSet( h, i, ws->poll, ws->pollOn, ws->pollOff,
+							  ws->pollWinMs, ws->pollPeriod )) ||
+#else
+			(error = ws->poll ? ERR_BBIS_ILL_PARAM : 0) ||
+#endif
+			(error = StormSet( h, i, ws->stormIrqs, ws->stormWinMs,
+							   ws->stormTime )) )
+			return( Cleanup(h,error) );
+
+		/* polling mode is entered by A12_BrdInit, no register write */
+		h->slotCfg[i].policy = warm->policy[i];
+#ifdef A12_OS_WORKERS
+		if( warm->policy[i] == A12_POLICY_POLL )
+			h->irq.pollFix |= bit;
+#endif
+
+		h->attached |= bit;
+	}
+
+	bit = 1 << A12_NBR_OF_MMODS;
+	if( (warm->attached & h->irq.enMask & bit) && (error = QspiAttach( h )) )
+		return( Cleanup(h,error) );
+
+	h->ienSave = warm->ienMask & h->attached;
+	h->warm	   = TRUE;
     return 0;
 }
 
@@ -375,6 +858,9 @@ static int32 A12_Init(
  *
  *  Description:  Board initialization.
  *				  - init all control regs to a safe state
+ *                  (disabled slots are not touched)
+ *                - after A12_WarmInit: restore the saved control regs,
+ *                  IEN included, one write per slot
  *---------------------------------------------------------------------------
  *  Input......:  h    		pointer to board handle structure
  *  Output.....:  return    0 | error code
@@ -385,11 +871,33 @@ static int32 A12_BrdInit(
 {
 	int32 mSlot;
 
-	DBGWRT_1((DBH, "BB - %s_BrdInit\n",BBNAME));
+	DBGWRT_1((DBH, "BB - %s_BrdInit: warm=%d\n",BBNAME,h->warm));
+
+	h->irq.ienMask = h->warm ? h->ienSave : 0;
+#ifdef A12_OS_WORKERS
+	h->irq.pollMask = h->irq.pollFix;
+#endif
 
 	for( mSlot=0; mSlot<A12_NBR_OF_MMODS; mSlot++ ){
-		MWRITE_D8( h->mmod[mSlot].vCtrlBase, 0, 0xc );	/* fast bit set */
+		/* always polled slots start in polling mode */
+		h->mmod[mSlot].maskReasons =
+			A12_POLLED( h, 1 << mSlot ) ? A12_MASK_POLL : 0;
+		h->mmod[mSlot].modEvents = 0;
+		if( !(h->attached & h->irq.enMask & (1 << mSlot)) )
+			continue;
+		if( h->warm )
+			IenApply( h, mSlot );
+		else
+			CtrlUpdate( h, mSlot,
+						A12_CTRL_TIMING(h->slotCfg[mSlot].timing), 0xff );
 	}
+	h->brdUp = TRUE;
+	h->warm = FALSE;
+
+#ifdef A12_OS_WORKERS
+	for( mSlot=0; mSlot<A12_DEFER_QUEUES; mSlot++ )
+		h->dq[mSlot].mask = 0;
+#endif
 
 	return 0;
 }
@@ -399,6 +907,7 @@ static int32 A12_BrdInit(
  *  Description:  Board deinitialization.
  *
  *                - init all control regs to a safe state
+ *                  (disabled slots are not touched)
  *
  *---------------------------------------------------------------------------
  *  Input......:  h    pointer to board handle structure
@@ -413,8 +922,15 @@ static int32 A12_BrdExit(
 	DBGWRT_1((DBH, "BB - %s_BrdExit\n",BBNAME));
 
 	for( mSlot=0; mSlot<A12_NBR_OF_MMODS; mSlot++ ){
-		MWRITE_D8( h->mmod[mSlot].vCtrlBase, 0, 0xc );	/* fast bit set */
+		if( h->attached & h->irq.enMask & (1 << mSlot) )
+			CtrlUpdate( h, mSlot,
+						A12_CTRL_TIMING(h->slotCfg[mSlot].timing), 0xff );
 	}
+	h->brdUp = FALSE;
+	h->irq.ienMask = 0;
+#ifdef A12_OS_WORKERS
+	h->irq.pollMask = 0;
+#endif
 
     return 0;
 }
@@ -588,6 +1104,7 @@ static int32 A12_BrdInfo(
  *				  BBIS_CFGINFO_PCI_DEVNBR	PCI device number
  *                BBIS_CFGINFO_IRQ          interrupt parameters
  *                BBIS_CFGINFO_EXP          exception interrupt parameters
+ *                A12_CFGINFO_CPUMASK       CPU hints
  *
  *                The BBIS_CFGINFO_BUSNBR code returns the number of the
  *                bus on which the specified device resides
@@ -601,6 +1118,11 @@ static int32 A12_BrdInfo(
  *                The BBIS_CFGINFO_EXP code returns the exception interrupt
  *                vector, level and mode of the specified device.
  *
+ *                The A12_CFGINFO_CPUMASK code returns the CPU hints of the
+ *                interrupt and the deferred work of the specified device
+ *                (IRQ_CPU_MASK, SLOT_n_CPU_MASK), 0 = no preference. The
+ *                QSPI has no hints.
+ *
  *---------------------------------------------------------------------------
  *  Input......:  h    pointer to board handle structure
  *                code      reference to the information we need
@@ -630,10 +1152,10 @@ static int32 A12_CfgInfo(
 		u_int32 *busNbr = va_arg( argptr, u_int32* );
 		u_int32 mSlot   = va_arg( argptr, u_int32 );
 
-		if ( G_slotCfg[CFIDX(mSlot)].pciBusNbr >= 0 )
-			*busNbr = G_slotCfg[CFIDX(mSlot)].pciBusNbr;
+		if ( h->slotCfg[CFIDX(mSlot)].pciBusNbr >= 0 )
+			*busNbr = h->slotCfg[CFIDX(mSlot)].pciBusNbr;
 		else
-			*busNbr = 0;		/* M-module bridge on bus 0 */
+			*busNbr = h->pciBusNbr;		/* bus of M-module bridge */
 
 		break;
 	}
@@ -644,10 +1166,10 @@ static int32 A12_CfgInfo(
 		u_int32 mSlot      = va_arg( argptr, u_int32 );
 		u_int32 *pciDevNbr = va_arg( argptr, u_int32* );
 
-		if ( G_slotCfg[CFIDX(mSlot)].pciDevNbr >= 0 )
-			*pciDevNbr = G_slotCfg[CFIDX(mSlot)].pciDevNbr;
+		if ( h->slotCfg[CFIDX(mSlot)].pciDevNbr >= 0 )
+			*pciDevNbr = h->slotCfg[CFIDX(mSlot)].pciDevNbr;
 		else
-			*pciDevNbr = A12_MMOD_BRIDGE_DEV_NO;
+			*pciDevNbr = h->pciDevNbr;
 		break;
 	}
 
@@ -658,38 +1180,20 @@ static int32 A12_CfgInfo(
 		u_int32 *vector = va_arg( argptr, u_int32* );
 		u_int32 *level  = va_arg( argptr, u_int32* );
 		u_int32 *mode   = va_arg( argptr, u_int32* );
+		A12_SLOT_RES *res;
 
-		/* check device number */
-		if( (CFIDX(mSlot) < 0) || (CFIDX(mSlot) >= BRD_NBR_OF_BRDDEV )){
-			DBGWRT_ERR((DBH,"*** %s_CfgInfo: mSlot=0x%x not supported\n",
+		if( (status = SlotRes( h, (u_int32)mSlot, &res )) ){
+			DBGWRT_ERR((DBH,"*** %s_CfgInfo: mSlot=0x%x not available\n",
 						BBNAME,mSlot));
 			va_end( argptr );
-			return ERR_BBIS_ILL_SLOT;
+			return status;
 		}
 
-		*mode  = G_slotCfg[CFIDX(mSlot)].irqMode;
-
-		if( G_slotCfg[CFIDX(mSlot)].irqLevel == -1 ){
-			*level = h->irqLevel;
-			*vector = h->irqVector;
-		}
-		else {
-			*level = G_slotCfg[CFIDX(mSlot)].irqLevel;
-
-			/* convert level to vector */
-			status = OSS_IrqLevelToVector(
-						h->osHdl,
-						G_slotCfg[CFIDX(mSlot)].devBusType,
-						(int32)*level,
-						(int32*)vector );
-		}
+		*mode	= res->irqMode;
+		*level	= res->irqLevel;
+		*vector	= res->irqVector;
 		DBGWRT_2((DBH, " dev:%d : IRQ mode=0x%x, level=0x%x, vector=0x%x\n",
 				mSlot, *mode, *level, *vector));
-
-		if (status) {
-			va_end( argptr );
-			return status;
-		}
 		break;
 	}
 
@@ -711,6 +1215,25 @@ static int32 A12_CfgInfo(
 		break;
 	}
 
+	/* CPU hints */
+	case A12_CFGINFO_CPUMASK:
+	{
+		u_int32 mSlot     = va_arg( argptr, u_int32 );
+		u_int32 *irqCpus  = va_arg( argptr, u_int32* );
+		u_int32 *workCpus = va_arg( argptr, u_int32* );
+
+		*irqCpus = *workCpus = 0;
+		if( mSlot < A12_NBR_OF_MMODS ){
+			if( (status = SlotAttach( h, mSlot )) )
+				break;
+			*irqCpus  = h->irqCpus;
+			*workCpus = h->mmod[mSlot].cpus;
+		}
+		else if( mSlot != BBIS_SLOTS_ONBOARDDEVICE_START )
+			status = ERR_BBIS_ILL_SLOT;
+		break;
+	}
+
 
 	/* error */
 	default:
@@ -730,6 +1253,11 @@ static int32 A12_CfgInfo(
  *
  *                For QSPI, nothing is done. QSPI has seperate IRQ9
  *
+ *                IEN is changed in the control register shadow, so this
+ *                is a single posted write without PCI read. While the BBIS
+ *                holds the slot masked (e.g. IRQ moderation), IEN is only
+ *                set when the mask is released.
+ *
  *---------------------------------------------------------------------------
  *  Input......:  h    pointer to board handle structure
  *                mSlot     module slot number
@@ -746,10 +1274,21 @@ static int32 A12_IrqEnable(
 			  BBNAME,mSlot,enable));
 
 	if( mSlot < A12_NBR_OF_MMODS ){
+		int32 error;
+
+		A12_RECORD( h, mSlot, A12_ROP_ENTRY, A12_REP_IRQENABLE, enable );
+		if( (error = SlotAttach( h, mSlot )) ){
+			A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_IRQENABLE, error );
+			return error;
+		}
+
 		if( enable )
-			MSETMASK_D8( h->mmod[mSlot].vCtrlBase, 0, 0x2 ); /* set IEN */
+			A12_ATOMIC_FETCH_OR( &h->irq.ienMask, 1 << mSlot );
 		else
-			MCLRMASK_D8( h->mmod[mSlot].vCtrlBase, 0, 0x2 ); /* clear IEN */
+			A12_ATOMIC_FETCH_AND( &h->irq.ienMask, ~(1 << mSlot) );
+
+		IenApply( h, mSlot );
+		A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_IRQENABLE, 0 );
 	}
 
 	return 0;
@@ -761,30 +1300,129 @@ static int32 A12_IrqEnable(
  *
  *                checks if the slot caused the interrupt
  *
+ *                A pending slot reported by A12_Poll is answered from
+ *                the poll instead of reading the control register again.
+ *
+ *                With deferred servicing (IRQ_DEFER), an asserting
+ *                M-module slot is masked and queued on the work queue of
+ *                the current CPU (or the first CPU of SLOT_n_CPU_MASK if
+ *                the current one is not in it) instead, and BBIS_IRQ_NO
+ *                is returned so
+ *                its driver ISR is not called in interrupt context. The
+ *                slot is then serviced by a worker, see A12_DeferClaim.
+ *
+ *                A disabled device (SLOT_n_ENABLE) and a slot in IRQ storm
+ *                quarantine (SLOT_n_STORM_xxx) never claim the
+ *                interrupt. The QSPI claims IRQ9 by its status register,
+ *                see QSPI_IRQ_MASK in A12_Init.
+ *
+ *                With IRQ_SCAN A12_SCAN_ADAPTIVE, each claim moves the
+ *                slot up in the scan order, see A12_IrqOrder.
+ *
+ *                The interrupt path records its events in the event trace
+ *                (M_BB_A12_TRACE) instead of debug output.
+ *
  *---------------------------------------------------------------------------
  *  Input......:  h    pointer to board handle structure
  *                mSlot     module slot number
- *  Output.....:  return    BBIS_IRQ_NO
+ *  Output.....:  return    BBIS_IRQ_NO | BBIS_IRQ_YES
  *  Globals....:  ---
  ****************************************************************************/
 static int32 A12_IrqSrvInit(
     BBIS_HANDLE     *h,
     u_int32         mSlot)
 {
-	IDBGWRT_1((DBH, "BB - %s_IrqSrvInit: mSlot=%d\n",BBNAME,mSlot));
+	A12_DEV_STAT *st = &h->stat[CFIDX(mSlot)];
+	u_int32 bit = (mSlot < A12_NBR_OF_MMODS) ? 1 << mSlot : 0;
+	u_int32 ctrl = 0;
+	int32 ret;
 
-	if( (mSlot==0x1000) ||
-		(MREAD_D8( h->mmod[CFIDX(mSlot)].vCtrlBase, 0 ) & 0x1 ))
-		return BBIS_IRQ_YES;
-	else
+	A12_RECORD( h, mSlot, A12_ROP_ENTRY, A12_REP_SRVINIT, 0 );
+
+	/* disabled device, enMask shares the cache line with the snapshot */
+	if( !(h->irq.enMask & (1 << CFIDX(mSlot))) ){
+		A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_SRVINIT, BBIS_IRQ_NO );
+		return BBIS_IRQ_NO;
+	}
+
+	/* IRQ storm quarantine: no ISR call from shared interrupts either */
+	if( bit && (h->mmod[mSlot].maskReasons & A12_MASK_STORM) ){
+#ifdef A12_OS_WORKERS
+		A12_ATOMIC_FETCH_AND( &h->irq.irqPendValid, ~bit );
+#endif
+		A12_ATOMIC_FETCH_ADD( &st->s.irqNo, 1 );
+		A12_TRACE( h, mSlot, A12_TEV_SRVINIT, 0, BBIS_IRQ_NO );
+		A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_SRVINIT, BBIS_IRQ_NO );
 		return BBIS_IRQ_NO;
+	}
+
+	/* QSPI on IRQ9: claimed if it flags an event */
+	if( !bit ){
+		u_int32 qm = h->irq.qspiMask, ev, n;
+
+		ret = BBIS_IRQ_YES;
+		if( qm ){
+			ctrl = MREAD_D8( h->qspi.vStat, 0 );
+			A12_RECORD( h, mSlot, A12_ROP_RD8, 0, ctrl );
+			if( (ev = ctrl & qm) ){
+				h->qspi.last = ctrl;
+				for( n=0; ev; n++, ev >>= 1 ){
+					if( ev & 1 )
+						A12_ATOMIC_FETCH_ADD( &h->qspi.ev[n], 1 );
+				}
+			}
+			else
+				ret = BBIS_IRQ_NO;
+		}
+	}
+#ifdef A12_OS_WORKERS
+	/* answer from A12_Poll */
+	else if( (h->irq.irqPendValid & bit) &&
+			 (A12_ATOMIC_FETCH_AND( &h->irq.irqPendValid, ~bit ) & bit) ){
+		ctrl = h->mmod[mSlot].ctrl | ((h->irq.irqPend & bit) ?
+									  A12_CTRL_IRQ : 0);
+		ret = (ctrl & A12_CTRL_IRQ) ? BBIS_IRQ_YES : BBIS_IRQ_NO;
+	}
+#endif
+	else if( CtrlGet( h, mSlot ) ){
+		ctrl = MREAD_D8( h->mmod[mSlot].vCtrlBase, 0 );
+		CtrlPut( h, mSlot );
+		A12_RECORD( h, mSlot, A12_ROP_RD8, 0, ctrl );
+		ret = (ctrl & A12_CTRL_IRQ) ? BBIS_IRQ_YES : BBIS_IRQ_NO;
+	}
+	/* being set up again (A12_RESET_REMAP) */
+	else {
+		ctrl = h->mmod[mSlot].ctrl;
+		ret = BBIS_IRQ_NO;
+	}
+
+	ret = SrvClaim( h, mSlot, ctrl, ret );
+#ifdef A12_OS_WORKERS
+	if( ret == A12_SRV_DEFERRED )
+		ret = BBIS_IRQ_NO;
+#endif
+
+	A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_SRVINIT, ret );
+	return ret;
 }
 
 /****************************** A12_IrqSrvExit *******************************
  *
  *  Description:  Called at the end of an interrupt.
  *
- *                Do nothing
+ *                Records the service time in the IRQ statistics.
+ *                With IRQ moderation, IEN is cleared after the configured
+ *                number of serviced interrupts and restored by the holdoff
+ *                alarm, so a burst is handled in one pass.
+ *
+ *                For a slot serviced by a deferred worker, the worker
+ *                calls this after the driver ISR, which unmasks the slot.
+ *
+ *                In hybrid IRQ/poll mode, the interrupt rate is checked
+ *                here for the switch to polling.
+ *
+ *                With IRQ storm detection, a slot exceeding its interrupt
+ *                rate is quarantined here (IEN cleared, see StormCheck).
  *
  *---------------------------------------------------------------------------
  *  Input......:  h    pointer to board handle structure
@@ -796,14 +1434,259 @@ static void A12_IrqSrvExit(
     BBIS_HANDLE     *h,
     u_int32         mSlot )
 {
-	IDBGWRT_1((DBH, "BB - %s_IrqSrvExit: mSlot=%d\n",BBNAME,mSlot));
+	A12_DEV_STAT *st = &h->stat[CFIDX(mSlot)];
+
+	A12_RECORD( h, mSlot, A12_ROP_ENTRY, A12_REP_SRVEXIT, 0 );
+	A12_TRACE( h, mSlot, A12_TEV_SRVEXIT,
+			   mSlot < A12_NBR_OF_MMODS ? h->mmod[mSlot].ctrl : 0, 0 );
+
+	if( st->inSrv ){
+		StatHist( st, A12_CYCLES(h) - st->t0 );
+		st->inSrv = FALSE;
+	}
+
+#ifdef A12_OS_WORKERS
+	/* end of deferred servicing */
+	if( mSlot < A12_NBR_OF_MMODS &&
+		(A12_ATOMIC_FETCH_AND( &h->mmod[mSlot].maskReasons, ~A12_MASK_DEFER )
+		 & A12_MASK_DEFER) )
+		IenApply( h, mSlot );
+#endif
+
+	/* IRQ storm detection, the poll period limits polled slots */
+	if( mSlot < A12_NBR_OF_MMODS && h->mmod[mSlot].stormIrqs &&
+		!A12_POLLED( h, 1 << mSlot ) )
+		StormCheck( h, mSlot );
+
+#ifdef A12_OS_WORKERS
+	/* hybrid IRQ/poll mode */
+	if( mSlot < A12_NBR_OF_MMODS && h->mmod[mSlot].poll )
+		PollCheck( h, mSlot );
+#endif
+
+	/* IRQ moderation */
+	if( mSlot < A12_NBR_OF_MMODS && h->mmod[mSlot].modBudget ){
+		MMOD *mm = &h->mmod[mSlot];
+		u_int32 realMsec;
+
+		if( A12_ATOMIC_FETCH_ADD( &mm->modEvents, 1 ) + 1 >= mm->modBudget ){
+			mm->modEvents = 0;
+			A12_ATOMIC_FETCH_OR( &mm->maskReasons, A12_MASK_MODERATE );
+			A12_TRACE( h, mSlot, A12_TEV_HOLDOFF, mm->ctrl, mm->modTime );
+			IenApply( h, mSlot );
+			OSS_AlarmSet( h->osHdl, mm->modAlarm, mm->modTime, FALSE,
+						  &realMsec );
+			A12_ATOMIC_FETCH_ADD( &st->s.modHoldoffs, 1 );
+		}
+	}
+
+	A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_SRVEXIT, 0 );
 }
 
-/****************************** A12_ExpEnable ********************************
+/***************************** A12_IrqPendMask *******************************
  *
- *  Description:  Exception interrupt enable / disable.
+ *  Description:  Claim the interrupt for all asserting M-module slots
  *
- *                Do nothing
+ *                Reads the control register of every slot with enabled
+ *                interrupt once and does the irqSrvInit work for each of
+ *                them. The dispatcher then calls the driver ISR and
+ *                irqSrvExit for each slot in *maskP, without irqSrvInit.
+ *                Nothing is kept in the handle, each call reads the
+ *                registers again.
+ *
+ *                Slots queued for deferred servicing (IRQ_DEFER) are not
+ *                in *maskP, A12_PEND_DEFERRED is set instead: the
+ *                interrupt was handled.
+ *
+ *                Jump table entry fkt14, see bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                maskP     pointer to variable where mask is stored
+ *  Output.....:  *maskP    bit n set: slot n claimed | A12_PEND_DEFERRED
+ *                return    0
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_IrqPendMask(
+    BBIS_HANDLE     *h,
+    u_int32         *maskP )
+{
+	u_int32 mSlot, ien = h->irq.ienMask & h->irq.enMask, mask = 0, ctrl;
+	int32 ret;
+
+	A12_RECORD( h, A12_REC_BRD, A12_ROP_ENTRY, A12_REP_PENDMASK, 0 );
+
+	for( mSlot=0; mSlot<A12_NBR_OF_MMODS; mSlot++ ){
+		if( !(ien & (1 << mSlot)) )
+			continue;
+		/* IRQ storm quarantine, not claimed anyway */
+		if( (h->mmod[mSlot].maskReasons & A12_MASK_STORM) ||
+			!CtrlGet( h, mSlot ) )
+			continue;
+
+		ctrl = MREAD_D8( h->mmod[mSlot].vCtrlBase, 0 );
+		CtrlPut( h, mSlot );
+		A12_RECORD( h, mSlot, A12_ROP_RD8, 0, ctrl );
+		ret = SrvClaim( h, mSlot, ctrl,
+						(ctrl & A12_CTRL_IRQ) ? BBIS_IRQ_YES : BBIS_IRQ_NO );
+		if( ret == BBIS_IRQ_YES )
+			mask |= 1 << mSlot;
+#ifdef A12_OS_WORKERS
+		else if( ret == A12_SRV_DEFERRED )
+			mask |= A12_PEND_DEFERRED;
+#endif
+	}
+
+	A12_TRACE( h, 0, A12_TEV_PENDMASK, 0, mask );
+	A12_RECORD( h, A12_REC_BRD, A12_ROP_EXIT, A12_REP_PENDMASK, mask );
+
+	*maskP = mask;
+	return 0;
+}
+
+#ifdef A12_OS_WORKERS
+/****************************** A12_DeferClaim *******************************
+ *
+ *  Description:  Claim a slot queued for deferred servicing
+ *
+ *                Called by the deferred worker of a CPU. Takes one slot
+ *                from the work queue of that CPU, or, if it is empty,
+ *                steals one from the queue of another CPU, so idle CPUs
+ *                share the work of busy slots. Slots with a CPU hint
+ *                (SLOT_n_CPU_MASK) are only claimed by workers on CPUs of
+ *                the hint, so the OS layer must run workers there.
+ *
+ *                The worker calls the driver ISR of the claimed slot and
+ *                then irqSrvExit, which unmasks the slot. It calls
+ *                A12_DeferClaim again until *maskP is 0.
+ *
+ *                Jump table entry fkt17 (A12_OS_WORKERS builds only), see
+ *                bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                cpu       CPU of the calling worker
+ *  Output.....:  maskP     bit n set for claimed slot n, 0 if no work
+ *                return    0
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_DeferClaim(
+    BBIS_HANDLE     *h,
+    u_int32         cpu,
+    u_int32         *maskP )
+{
+	u_int32 n, bit = 0, allow = 0;
+
+	A12_RECORD( h, A12_REC_BRD, A12_ROP_ENTRY, A12_REP_DEFERCLAIM, cpu );
+
+	/* slots this CPU may service */
+	for( n=0; n<A12_NBR_OF_MMODS; n++ ){
+		if( !h->mmod[n].cpus ||
+			(cpu < 32 && (h->mmod[n].cpus & ((u_int32)1 << cpu))) )
+			allow |= 1 << n;
+	}
+
+	for( n=0; n<A12_DEFER_QUEUES && !bit; n++ )
+		bit = DeferTake( &h->dq[(cpu + n) % A12_DEFER_QUEUES], allow );
+
+	A12_TRACE( h, 0, A12_TEV_CLAIM, 0, bit );
+	A12_RECORD( h, A12_REC_BRD, A12_ROP_EXIT, A12_REP_DEFERCLAIM, bit );
+
+	*maskP = bit;
+	return 0;
+}
+
+/********************************* A12_Poll **********************************
+ *
+ *  Description:  Poll the slots in polling mode of the hybrid IRQ/poll mode
+ *
+ *                Called by the poller of the OS layer every poll period
+ *                (M_BB_A12_POLL_PERIOD) while M_BB_A12_POLL_ACTIVE of any
+ *                slot is set. For each slot in *maskP, it calls
+ *                irqSrvInit, the driver ISR and irqSrvExit as for an
+ *                interrupt; irqSrvInit is answered from this poll.
+ *
+ *                Slots which went idle are switched back to interrupts
+ *                here.
+ *
+ *                Jump table entry fkt18 (A12_OS_WORKERS builds only), see
+ *                bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *  Output.....:  maskP     bit n set for each pending polled slot n
+ *                return    0
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_Poll(
+    BBIS_HANDLE     *h,
+    u_int32         *maskP )
+{
+	u_int32 mSlot, bit, mask = 0, ctrl;
+	u_int32 poll = h->irq.pollMask & h->irq.ienMask & h->irq.enMask;
+
+	A12_RECORD( h, A12_REC_BRD, A12_ROP_ENTRY, A12_REP_POLL, 0 );
+
+	for( mSlot=0; mSlot<A12_NBR_OF_MMODS; mSlot++ ){
+		bit = 1 << mSlot;
+		if( !(poll & bit) || !CtrlGet( h, mSlot ) )
+			continue;
+
+		ctrl = MREAD_D8( h->mmod[mSlot].vCtrlBase, 0 );
+		CtrlPut( h, mSlot );
+		A12_RECORD( h, mSlot, A12_ROP_RD8, 0, ctrl );
+		if( ctrl & A12_CTRL_IRQ ){
+			mask |= bit;
+			A12_ATOMIC_FETCH_OR( &h->irq.irqPend, bit );
+		}
+		else
+			A12_ATOMIC_FETCH_AND( &h->irq.irqPend, ~bit );
+
+		PollCheck( h, mSlot );
+	}
+	/* answers for irqSrvInit, only of this poll */
+	A12_ATOMIC_FETCH_AND( &h->irq.irqPendValid, ~poll );
+	A12_ATOMIC_FETCH_OR( &h->irq.irqPendValid, mask );
+
+	A12_TRACE( h, 0, A12_TEV_POLL, 0, mask );
+	A12_RECORD( h, A12_REC_BRD, A12_ROP_EXIT, A12_REP_POLL, mask );
+
+	*maskP = mask;
+	return 0;
+}
+#endif /* A12_OS_WORKERS */
+
+/******************************* A12_IrqOrder ********************************
+ *
+ *  Description:  Get the order in which to check the M-module slots
+ *
+ *                The OS layer calls irqSrvInit for the slots in this
+ *                order, see IRQ_SCAN in A12_Init. No register access.
+ *
+ *                Jump table entry fkt30, see bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *  Output.....:  orderP    slots, A12_SCAN_SLOT(*orderP,n) is checked n-th
+ *                return    0
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_IrqOrder(
+    BBIS_HANDLE     *h,
+    u_int32         *orderP )
+{
+	if( h->irq.scan == A12_SCAN_ADAPTIVE )
+		*orderP = ScanOrder( h, TRUE );
+	else
+		*orderP = h->irq.scanOrder;
+	return 0;
+}
+
+/****************************** A12_ExpEnable ********************************
+ *
+ *  Description:  Exception interrupt enable / disable.
+ *
+ *                Do nothing
  *
  *---------------------------------------------------------------------------
  *  Input......:  h    pointer to board handle structure
@@ -838,7 +1721,7 @@ static int32 A12_ExpSrv(
     BBIS_HANDLE     *h,
     u_int32         mSlot )
 {
-	IDBGWRT_1((DBH, "BB - %s_ExpSrv: mSlot=%d\n",BBNAME,mSlot));
+	A12_TRACE( h, mSlot, A12_TEV_EXPSRV, 0, BBIS_IRQ_NO );
 
 	return BBIS_IRQ_NO;
 }
@@ -914,249 +1797,3849 @@ static int32 A12_GetMAddr(
     void            **mAddr,
     u_int32         *mSize )
 {
-	int32 cfgIdx;
-	u_int32 size=0;
-	INT32_OR_64 base;
+	U_INT32_OR_64 base;
+	int32 error;
 
 	DBGWRT_1((DBH, "BB - %s_GetMAddr: mSlot=%d\n",BBNAME,mSlot));
 
-	cfgIdx = CFIDX(mSlot);
-	/* check device number */
-	if( (cfgIdx<0) || (cfgIdx >= BRD_NBR_OF_BRDDEV )){
-		DBGWRT_ERR((DBH,"*** %s_GetMaddr: mSlot=0x%x not supported\n",
-					BBNAME,mSlot));
-		return ERR_BBIS_ILL_SLOT;
-	}
-
-	base = (INT32_OR_64)h->physBase + (cfgIdx * A12_MMOD_SLOT_OFFSET);
-
-	if( cfgIdx < A12_NBR_OF_MMODS ){
-		/* M-module slots */
-
-	    switch (addrMode){
-		case MDIS_MA08:
-			switch(dataMode){
-			case MDIS_MD16:
-			case MDIS_MD08:
-				base += A12_MMOD_A08_D16_BASE;
-				size = 0x100;
-				break;
-			case MDIS_MD32:
-				base += A12_MMOD_A08_D32_BASE;
-				size = 0x100;
-				break;
-			default:
-				base = 0xffffffff;
-				break;
-			}
-			break;
-
-		case MDIS_MA24:
-			switch(dataMode){
-			case MDIS_MD16:
-			case MDIS_MD08:
-				base += A12_MMOD_A24_D16_BASE;
-				size = 0x1000000 - 0x300;
-				break;
-			case MDIS_MD32:
-				base += A12_MMOD_A24_D32_BASE;
-				size = 0x1000000;
-				break;
-			default:
-				base = 0xffffffff;
-				break;
-			}
-			break;
-		}
-	}
-	else {
-		/* QSPI */
-		size = 0x800;
-	}
-
-	if( base == 0xffffffff ){
-		DBGWRT_ERR((DBH,"*** %s_GetMAddr: addrMode=0x%x/dataMode=0x%x "
-					"not supported\n",
-					BBNAME,addrMode, dataMode));
-        return ERR_BBIS_ILL_ADDRMODE;
-	}
+	if( (error = MAddr( h, mSlot, addrMode, dataMode, &base, mSize )) )
+		return error;
 
 	/* assign address spaces */
 	*mAddr = (void *)base;
-    *mSize = size;
 
-	DBGWRT_2((DBH, " mSlot:0x%x : phys address=0x%x, length=0x%x\n",
+	DBGWRT_2((DBH, " mSlot:0x%x : phys address=0x%08lx, length=0x%x\n",
 		mSlot, *mAddr, *mSize));
 
     return 0;
 }
 
-/****************************** A12_SetStat **********************************
+/***************************** A12_GetMAddrEx ********************************
  *
- *  Description:  Set driver status
+ *  Description:  Get physical address description with attributes
  *
- *                Following status codes are supported:
+ *                Like A12_GetMAddr, but the address is returned as 64-bit
+ *                value, together with the view attributes A12_MapView
+ *                would grant for the window (A12_MATTR_xxx).
  *
- *                Code                 Description                Values
- *                -------------------  -------------------------  ----------
- *                M_BB_DEBUG_LEVEL     board debug level          see dbg.h
+ *                Jump table entry fkt07, see bb_a12_ext.h.
  *
  *---------------------------------------------------------------------------
  *  Input......:  h    pointer to board handle structure
  *                mSlot     module slot number
- *                code      setstat code
- *                value     setstat value or ptr to blocksetstat data
- *  Output.....:  return    0 | error code
+ *                addrMode  MDIS_MA08 | MDIS_MA24
+ *                dataMode  MDIS_MD16 | MDIS_MD32
+ *  Output.....:  ma        address description
+ *                return    0 | error code
  *  Globals....:  ---
  ****************************************************************************/
-static int32 A12_SetStat(
+static int32 A12_GetMAddrEx(
     BBIS_HANDLE     *h,
     u_int32         mSlot,
-    int32           code,
-	INT32_OR_64     value )
+    u_int32         addrMode,
+    u_int32         dataMode,
+    A12_MADDR       *ma )
 {
-    DBGWRT_1((DBH, "BB - %s_SetStat: mSlot=%d code=0x%04x value=0x%x\n",
-			  BBNAME, mSlot, code, value));
+	U_INT32_OR_64 base;
+	int32 error;
 
-    switch (code) {
-        /* set debug level */
-        case M_BB_DEBUG_LEVEL:
-            h->debugLevel = value;
-            break;
+	DBGWRT_1((DBH, "BB - %s_GetMAddrEx: mSlot=%d\n",BBNAME,mSlot));
 
-        /* unknown */
-        default:
-            return ERR_BBIS_UNK_CODE;
-    }
+	if( (error = MAddr( h, mSlot, addrMode, dataMode, &base, &ma->size )) )
+		return error;
 
-    return 0;
+	ma->phys = (u_int64)base;
+	ma->attr = MAttr( h, mSlot, addrMode );
+	return 0;
 }
 
-/****************************** A12_GetStat **********************************
+/****************************** A12_MapView **********************************
  *
- *  Description:  Get driver status
+ *  Description:  Map an address space with the requested attributes
  *
- *                Following status codes are supported:
+ *                Attributes not allowed for the window (see
+ *                A12_GetMAddrEx) or not supported by the OS are dropped,
+ *                the view is then mapped uncached. view->attr tells what
+ *                was granted. The view must be unmapped with
+ *                A12_UnMapView before the board handle is closed.
  *
- *                Code                 Description                Values
- *                -------------------  -------------------------  ----------
- *                M_BB_DEBUG_LEVEL     driver debug level         see dbg.h
- *                M_BB_IRQ_VECT        interrupt vector           0..max
- *                M_BB_IRQ_LEVEL       interrupt level            0..max
- *                M_BB_IRQ_PRIORITY    interrupt priority         0
- *                M_MK_BLK_REV_ID      ident function table ptr   -
+ *                Jump table entry fkt08, see bb_a12_ext.h.
  *
  *---------------------------------------------------------------------------
  *  Input......:  h    pointer to board handle structure
  *                mSlot     module slot number
- *                code      getstat code
- *  Output.....:  valueP    getstat value or ptr to blockgetstat data
+ *                addrMode  MDIS_MA08 | MDIS_MA24
+ *                dataMode  MDIS_MD16 | MDIS_MD32
+ *                attr      requested A12_MATTR_xxx
+ *  Output.....:  view      mapped view
  *                return    0 | error code
  *  Globals....:  ---
  ****************************************************************************/
-static int32 A12_GetStat(
+static int32 A12_MapView(
     BBIS_HANDLE     *h,
     u_int32         mSlot,
-    int32           code,
-	INT32_OR_64     *valueP )
+    u_int32         addrMode,
+    u_int32         dataMode,
+    u_int32         attr,
+    A12_VIEW        *view )
 {
-    int32       status=0;
-
-    DBGWRT_1((DBH, "BB - %s_GetStat: mSlot=%d code=0x%04x\n",BBNAME,mSlot,code));
-
-    switch (code) {
-        /* get debug level */
-        case M_BB_DEBUG_LEVEL:
-            *valueP = h->debugLevel;
-            break;
-
-        /* get IRQ vector */
-        case M_BB_IRQ_VECT:
-		{
-			u_int32 vector, level, mode;
+	U_INT32_OR_64 base;
+	int32 error;
 
-			status = A12_CfgInfo( h, BBIS_CFGINFO_IRQ, mSlot,
-								  &vector, &level, &mode );
+	DBGWRT_1((DBH, "BB - %s_MapView: mSlot=%d attr=0x%x\n",BBNAME,mSlot,
+			  attr));
 
-			*valueP = (int32)vector;
-			break;
-		}
-        /* get IRQ level */
-        case M_BB_IRQ_LEVEL:
-		{
-			u_int32 vector, level, mode;
-
-			status = A12_CfgInfo( h, BBIS_CFGINFO_IRQ, mSlot,
-								  &vector, &level, &mode );
-
-			*valueP = (int32)level;
-			break;
-		}
-
-        /* get IRQ priority */
-        case M_BB_IRQ_PRIORITY:
-            *valueP = 0;
-            break;
-
-        /* ident table */
-        case M_MK_BLK_REV_ID:
-           *valueP = (INT32_OR_64)&h->idFuncTbl;
-           break;
+	view->virt = NULL;
+	if( (error = MAddr( h, mSlot, addrMode, dataMode, &base, &view->size )) )
+		return error;
 
-        /* unknown */
-        default:
-            status = ERR_BBIS_UNK_CODE;
-    }
+	attr &= MAttr( h, mSlot, addrMode );
+#ifdef A12_MAP_WC
+	/* no write-combined mapping of this BAR: map it uncached */
+	if( attr && A12_MAP_WC( h, base, view->size, &view->virt ) )
+		attr = 0;
+#else
+	attr = 0;
+#endif
+	if( !attr )
+		error = OSS_MapPhysToVirtAddr( h->osHdl, (void*)base, view->size,
+									   OSS_ADDRSPACE_MEM, OSS_BUSTYPE_PCI,
+									   h->pciBusNbr,
+									   &view->virt );
+	if( error ){
+		view->virt = NULL;
+		return error;
+	}
 
-    return status;
+	view->attr = attr;
+	DBGWRT_2((DBH, " mSlot:0x%x : view=0x%08lx, length=0x%x attr=0x%x\n",
+			  mSlot, view->virt, view->size, view->attr));
+	return 0;
 }
 
-/****************************** A12_Unused ***********************************
+/***************************** A12_UnMapView *********************************
  *
- *  Description:  Dummy function for unused jump table entries.
+ *  Description:  Unmap a view mapped by A12_MapView
+ *
+ *                Jump table entry fkt09, see bb_a12_ext.h.
  *
  *---------------------------------------------------------------------------
- *  Input......:  ---
- *  Output.....:  return  ERR_BBIS_ILL_FUNC
+ *  Input......:  h    pointer to board handle structure
+ *                view      mapped view
+ *  Output.....:  return    0 | error code
  *  Globals....:  ---
  ****************************************************************************/
-static int32 A12_Unused( void )		/* nodoc */
+static int32 A12_UnMapView(
+    BBIS_HANDLE     *h,
+    A12_VIEW        *view )
 {
-    return ERR_BBIS_ILL_FUNC;
+	DBGWRT_1((DBH, "BB - %s_UnMapView: view=0x%08lx\n",BBNAME,view->virt));
+
+	if( view->virt == NULL )
+		return 0;
+
+#ifdef A12_UNMAP_WC
+	if( view->attr ){
+		A12_UNMAP_WC( h, view->virt, view->size );
+		view->virt = NULL;
+		return 0;
+	}
+#endif
+	return OSS_UnMapVirtAddr( h->osHdl, &view->virt, view->size,
+							  OSS_ADDRSPACE_MEM );
 }
 
-/*********************************** Ident **********************************
+/****************************** A12_BlkRead **********************************
  *
- *  Description:  Return ident string
+ *  Description:  Read a block from the A24 window of an M-module
+ *
+ *                A24 D32: 32-bit accesses. With A12_BLK_SIMD, the
+ *                16 byte aligned part is read with 16 byte loads (one
+ *                PCI burst each), staged four at a time in SIMD registers.
+ *                A24 D16: 16-bit accesses, each one D16 M-module cycle.
+ *
+ *                Offset, size and buffer must be aligned to the data
+ *                width. The window is mapped on first use.
+ *
+ *                Jump table entry fkt19, see bb_a12_ext.h.
  *
  *---------------------------------------------------------------------------
- *  Input......:  -
- *  Output.....:  return  pointer to ident string
- *  Globals....:  -
+ *  Input......:  h    pointer to board handle structure
+ *                mSlot     module slot number
+ *                dataMode  MDIS_MD16 | MDIS_MD32
+ *                offs      offset in A24 window
+ *                size      size [bytes]
+ *  Output.....:  buf       data read
+ *                return    0 | error code
+ *  Globals....:  ---
  ****************************************************************************/
-static char* Ident( void )		/* nodoc */
+static int32 A12_BlkRead(
+    BBIS_HANDLE     *h,
+    u_int32         mSlot,
+    u_int32         dataMode,
+    u_int32         offs,
+    void            *buf,
+    u_int32         size )
 {
-	return( (char*) IdentString );
+	int32 error;
+
+	IDBGWRT_2((DBH, "BB - %s_BlkRead: mSlot=%d offs=0x%x size=0x%x\n",
+			   BBNAME,mSlot,offs,size));
+
+	A12_RECORD( h, mSlot, A12_ROP_ENTRY, A12_REP_BLKREAD, offs );
+	A12_RECORD( h, mSlot, A12_ROP_ARG, dataMode, size );
+	error = BlkRead( h, mSlot, MDIS_MA24, dataMode, offs, buf, size );
+	A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_BLKREAD, error );
+	return error;
 }
 
-/********************************* Cleanup **********************************
+/****************************** A12_BlkWrite *********************************
  *
- *  Description:  Close all handles, free memory and return error code
+ *  Description:  Write a block to the A24 window of an M-module
  *
- *		          NOTE: The h handle is invalid after calling this
- *                      function.
+ *                Accesses as A12_BlkRead.
+ *
+ *                Jump table entry fkt20, see bb_a12_ext.h.
  *
  *---------------------------------------------------------------------------
  *  Input......:  h    pointer to board handle structure
- *                retCode	return value
- *  Output.....:  return	retCode
- *  Globals....:  -
+ *                mSlot     module slot number
+ *                dataMode  MDIS_MD16 | MDIS_MD32
+ *                offs      offset in A24 window
+ *                buf       data to write
+ *                size      size [bytes]
+ *  Output.....:  return    0 | error code
+ *  Globals....:  ---
  ****************************************************************************/
-static int32 Cleanup(
-   BBIS_HANDLE  *h,
-   int32        retCode		/* nodoc */
-)
-{
+static int32 A12_BlkWrite(
+    BBIS_HANDLE     *h,
+    u_int32         mSlot,
+    u_int32         dataMode,
+    u_int32         offs,
+    const void      *buf,
+    u_int32         size )
+{
+	int32 error;
+
+	IDBGWRT_2((DBH, "BB - %s_BlkWrite: mSlot=%d offs=0x%x size=0x%x\n",
+			   BBNAME,mSlot,offs,size));
+
+	A12_RECORD( h, mSlot, A12_ROP_ENTRY, A12_REP_BLKWRITE, offs );
+	A12_RECORD( h, mSlot, A12_ROP_ARG, dataMode, size );
+	error = BlkWrite( h, mSlot, MDIS_MA24, dataMode, offs, buf, size );
+	A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_BLKWRITE, error );
+	return error;
+}
+
+/****************************** A12_BlkFill **********************************
+ *
+ *  Description:  Fill a block in the A24 window of an M-module
+ *
+ *                Accesses as A12_BlkRead. With MDIS_MD16, the lower 16
+ *                bits of val are used.
+ *
+ *                Jump table entry fkt21, see bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                mSlot     module slot number
+ *                dataMode  MDIS_MD16 | MDIS_MD32
+ *                offs      offset in A24 window
+ *                val       fill pattern
+ *                size      size [bytes]
+ *  Output.....:  return    0 | error code
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_BlkFill(
+    BBIS_HANDLE     *h,
+    u_int32         mSlot,
+    u_int32         dataMode,
+    u_int32         offs,
+    u_int32         val,
+    u_int32         size )
+{
+	u_int32 end = offs + size;
+	MACCESS ma;
+	int32 error;
+
+	IDBGWRT_2((DBH, "BB - %s_BlkFill: mSlot=%d offs=0x%x size=0x%x\n",
+			   BBNAME,mSlot,offs,size));
+
+	A12_RECORD( h, mSlot, A12_ROP_ENTRY, A12_REP_BLKFILL, offs );
+	A12_RECORD( h, mSlot, A12_ROP_ARG, dataMode, size );
+	A12_RECORD( h, mSlot, A12_ROP_ARG, 0, val );
+
+	if( (error = BlkWin( h, mSlot, MDIS_MA24, dataMode, offs, size, NULL,
+						 &ma )) ){
+		A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_BLKFILL, error );
+		return error;
+	}
+	A12_RECORD( h, mSlot, A12_ROP_WRBLK, dataMode, size );
+
+	if( dataMode == MDIS_MD16 ){
+		for( ; offs < end; offs += 2 )
+			MWRITE_D16( ma, offs, (u_int16)val );
+	}
+	else {
+#ifdef A12_BLK_SIMD
+		__m128i v = _mm_set1_epi32( (int)val );
+
+		for( ; (offs & 0xf) && offs < end; offs += 4 )
+			MWRITE_D32( ma, offs, val );
+
+		for( ; end - offs >= 16; offs += 16 )
+			A12_WR128( ma, offs, v );
+#endif
+		for( ; offs < end; offs += 4 )
+			MWRITE_D32( ma, offs, val );
+	}
+
+	A12_RECORD( h, mSlot, A12_ROP_EXIT, A12_REP_BLKFILL, 0 );
+	return 0;
+}
+
+#ifdef A12_OS_WORKERS
+/****************************** A12_SgSubmit *********************************
+ *
+ *  Description:  Queue an asynchronous scatter-gather request
+ *
+ *                The windows of the request are mapped here, the slot
+ *                must be enabled. The request is only queued, no module
+ *                access: the SG worker of the OS layer executes the queue
+ *                of the slot with A12_SgRun. The OS layer wakes it after
+ *                a submit without A12_SG_MORE, so requests submitted
+ *                with A12_SG_MORE are batched with the following one.
+ *
+ *                req->status gets the first error of the backend, the
+ *                request is then passed to req->callback (called in the
+ *                context of the SG worker) or put into the completion
+ *                ring of the slot (see A12_SgComplete).
+ *
+ *                The request and its elements must stay valid until
+ *                completed. Requests still queued on A12_Exit are not
+ *                completed.
+ *
+ *                Jump table entry fkt22, see bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                mSlot     module slot number
+ *                req       request
+ *  Output.....:  return    0 | error code
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_SgSubmit(
+    BBIS_HANDLE     *h,
+    u_int32         mSlot,
+    A12_SG_REQ      *req )
+{
+	A12_SG_QUEUE *q;
+	A12_SG_REQ *old;
+	MACCESS ma;
+	int32 error;
+
+	IDBGWRT_2((DBH, "BB - %s_SgSubmit: mSlot=%d dir=%d nElem=%d\n",
+			   BBNAME,mSlot,req->dir,req->nElem));
+
+	if( mSlot >= A12_NBR_OF_MMODS )
+		return ERR_BBIS_ILL_SLOT;
+
+	if( req->dir > A12_SG_WRITE || (req->nElem && req->elem == NULL) ||
+		(req->addrMode != MDIS_MA08 && req->addrMode != MDIS_MA24) )
+		return ERR_BBIS_ILL_PARAM;
+
+	/* slot enabled, window mapped before the request is queued */
+	if( (error = BlkWin( h, mSlot, req->addrMode, req->dataMode, 0, 0,
+						 NULL, &ma )) )
+		return error;
+
+	q = &h->sg[mSlot];
+	req->status = 0;
+	A12_ATOMIC_FETCH_ADD( &q->stat.reqs, 1 );
+	A12_ATOMIC_FETCH_ADD( &q->stat.elems, req->nElem );
+
+	do {
+		old = q->submit;
+		req->next = old;
+	} while( !A12_ATOMIC_CASPTR( &q->submit, old, req ) );
+
+	return 0;
+}
+
+/***************************** A12_SgComplete ********************************
+ *
+ *  Description:  Remove the oldest request from the completion ring
+ *
+ *                Only one caller per slot at a time. Completions which
+ *                did not fit into the ring are moved into it here unless
+ *                the SG worker is executing the queue.
+ *
+ *                Jump table entry fkt23, see bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                mSlot     module slot number
+ *  Output.....:  reqP      completed request, NULL if none
+ *                return    0 | error code
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_SgComplete(
+    BBIS_HANDLE     *h,
+    u_int32         mSlot,
+    A12_SG_REQ      **reqP )
+{
+	A12_SG_QUEUE *q;
+
+	if( mSlot >= A12_NBR_OF_MMODS )
+		return ERR_BBIS_ILL_SLOT;
+
+	q = &h->sg[mSlot];
+	*reqP = NULL;
+
+	/* move completions waiting for room into the ring */
+	if( q->tail == q->head && q->ovfl &&
+		A12_ATOMIC_CAS( &q->busy, FALSE, TRUE ) ){
+		SgFlush( q );
+		A12_MEMBAR();
+		q->busy = FALSE;
+	}
+
+	if( q->tail == q->head )
+		return 0;
+
+	A12_MEMBAR();
+	*reqP = q->ring[q->tail % A12_SG_RING];
+	A12_MEMBAR();
+	q->tail++;
+
+	return 0;
+}
+
+/******************************** A12_SgRun **********************************
+ *
+ *  Description:  Execute the scatter-gather queue of a slot
+ *
+ *                Called by the SG worker of the OS layer after it was
+ *                woken for a submit, see A12_SgSubmit. The requests
+ *                queued until then are executed in order, see SgQueue,
+ *                and completed. If another worker already executes the
+ *                queue of the slot, that one also takes the new requests.
+ *
+ *                The backend moves the data, e.g. through a DMA engine of
+ *                the OS layer; NULL or be->xfer NULL selects CPU copies
+ *                like A12_BlkRead/A12_BlkWrite. It must stay valid until
+ *                A12_SgRun returns.
+ *
+ *                Jump table entry fkt31, see bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                mSlot     module slot number
+ *                be        copy backend | NULL
+ *  Output.....:  return    0 | error code
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_SgRun(
+    BBIS_HANDLE         *h,
+    u_int32             mSlot,
+    const A12_SG_BACKEND *be )
+{
+	A12_SG_BACKEND cpu;
+	A12_SG_QUEUE *q;
+
+	if( mSlot >= A12_NBR_OF_MMODS )
+		return ERR_BBIS_ILL_SLOT;
+
+	q = &h->sg[mSlot];
+	if( be == NULL || be->xfer == NULL ){
+		cpu.xfer = SgCopy;
+		cpu.arg	 = (void*)h;
+		be = &cpu;
+	}
+
+	/* execute until no request is left behind by a concurrent submit */
+	while( q->submit && A12_ATOMIC_CAS( &q->busy, FALSE, TRUE ) ){
+		SgQueue( h, mSlot, be );
+		A12_MEMBAR();
+		q->busy = FALSE;
+		A12_MEMBAR();
+	}
+	return 0;
+}
+#endif /* A12_OS_WORKERS */
+
+/****************************** A12_ResQuery *********************************
+ *
+ *  Description:  Resources of one or all devices
+ *
+ *                With mSlot A12_RES_ALL, all BRD_NBR_OF_BRDDEV devices are
+ *                returned in device order (M-module slots 0..2, QSPI),
+ *                disabled devices with enable=0 and no IRQ or windows.
+ *                The resources are taken from the handle, they are only
+ *                computed on the first query after a configuration change.
+ *
+ *                Jump table entry fkt24, see bb_a12_ext.h.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                mSlot     module slot number | A12_RES_ALL
+ *                nP        number of entries in res
+ *  Output.....:  res       device resources
+ *                nP        number of filled entries
+ *                return    0 | error code
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_ResQuery(
+    BBIS_HANDLE     *h,
+    u_int32         mSlot,
+    A12_SLOT_RES    *res,
+    u_int32         *nP )
+{
+	A12_SLOT_RES *r;
+	u_int32 i, n = 0;
+	int32 error;
+
+	DBGWRT_1((DBH, "BB - %s_ResQuery: mSlot=0x%x\n",BBNAME,mSlot));
+
+	if( mSlot != A12_RES_ALL ){
+		if( *nP < 1 )
+			return ERR_BBIS_ILL_PARAM;
+		if( (error = SlotRes( h, mSlot, &r )) )
+			return error;
+		res[0] = *r;
+		*nP = 1;
+		return 0;
+	}
+
+	if( *nP < BRD_NBR_OF_BRDDEV )
+		return ERR_BBIS_ILL_PARAM;
+
+	for( i=0; i<BRD_NBR_OF_BRDDEV; i++ ){
+		mSlot = i < A12_NBR_OF_MMODS ? i : BBIS_SLOTS_ONBOARDDEVICE_START;
+
+		if( h->slotCfg[i].enable ){
+			if( (error = SlotRes( h, mSlot, &r )) )
+				return error;
+			res[n++] = *r;
+		}
+		else {
+			/* disabled: identity only */
+			OSS_MemFill( h->osHdl, sizeof(A12_SLOT_RES), (char*)&res[n], 0 );
+			res[n].mSlot	  = mSlot;
+			res[n].devBusType = h->slotCfg[i].devBusType;
+			res[n].interrupts = h->slotCfg[i].interrupts;
+			res[n].addrSpace  = h->slotCfg[i].addrSpace;
+			n++;
+		}
+	}
+
+	*nP = n;
+	return 0;
+}
+
+/****************************** A12_SetStat **********************************
+ *
+ *  Description:  Set driver status
+ *
+ *                Following status codes are supported:
+ *
+ *                Code                 Description                Values
+ *                -------------------  -------------------------  ----------
+ *                M_BB_DEBUG_LEVEL     board debug level          see dbg.h
+ *                M_BB_A12_IRQSTAT_CLR clear IRQ statistics       0=mSlot
+ *                                                                1=all
+ *                M_BB_A12_IRQMOD_EVENTS IRQs before holdoff      0=off
+ *                M_BB_A12_IRQMOD_TIME holdoff time [ms]          1..max
+ *                M_BB_A12_IRQ_DEFER   deferred servicing         0=off
+ *                                                                1=on
+ *                M_BB_A12_POLL        hybrid IRQ/poll mode       0=off
+ *                                                                1=on
+ *                M_BB_A12_POLL_ON     IRQs/window to poll        1..max
+ *                M_BB_A12_POLL_OFF    events/window to IRQ       0..POLL_ON-1
+ *                M_BB_A12_POLL_WINDOW rate window [ms]           1..max
+ *                M_BB_A12_POLL_PERIOD poll period [us]           0..max
+ *                M_BB_A12_STORM_IRQS  IRQs/window = storm        0=off
+ *                M_BB_A12_STORM_WINDOW storm window [ms]         1..max
+ *                M_BB_A12_STORM_TIME  first quarantine [ms]      1..0x10000
+ *                M_BB_A12_SLOT_ENABLE device enabled             0=off
+ *                                                                1=on
+ *                M_BB_A12_SLOT_IRQ_MODE IRQ mode for next open   BBIS_IRQ_xxx
+ *                M_BB_A12_SLOT_POLICY interrupt policy           A12_POLICY_xxx
+ *                M_BB_A12_TRACE       event trace                0=off
+ *                                                                1=on
+ *                M_BB_A12_SLOT_TIMING bus timing                 A12_TIMING_xxx
+ *                M_BB_A12_IRQ_CPUMASK CPU hint of bridge IRQ     0=none
+ *                M_BB_A12_SLOT_CPUMASK CPU hint of deferred work 0=none
+ *                M_BB_A12_REC         register access recording  0=off
+ *                                                                1=on
+ *                M_BB_A12_SUSPEND     suspend bridge             0=resume
+ *                                                                1=suspend
+ *                M_BB_A12_SLOT_RESET  reset steps of mSlot       A12_RESET_xxx
+ *                M_BB_A12_SCAN        order of the slot checks   A12_SCAN_xxx
+ *                M_BB_A12_SCAN_PRIO   scan priority of mSlot     0..0xff
+ *
+ *                The CPU hints are bit masks (bit n = CPU n), see
+ *                IRQ_CPU_MASK in A12_Init. The OS layer picks them up with
+ *                A12_CFGINFO_CPUMASK, e.g. on the next open.
+ *
+ *                M_BB_A12_SLOT_TIMING takes effect at once, IEN is kept.
+ *                Only change it while the driver of the slot does not
+ *                access the module.
+ *
+ *                M_BB_A12_IRQ_DEFER=1 and M_BB_A12_SLOT_POLICY=
+ *                A12_POLICY_POLL fail unless the BBIS is built with
+ *                A12_OS_WORKERS, see A12_Init. The M_BB_A12_POLL_xxx codes
+ *                of the hybrid IRQ/poll mode exist only in such builds.
+ *
+ *                M_BB_A12_SLOT_ENABLE=0 fails while the driver of the slot
+ *                has its interrupt enabled. M_BB_A12_SLOT_xxx also work
+ *                for the QSPI (mSlot 0x1000), except M_BB_A12_SLOT_POLICY.
+ *
+ *                M_BB_A12_SUSPEND=1 before the bridge is powered down
+ *                masks all slots and keeps the BBIS off the bridge, the
+ *                control register state is kept in the handle.
+ *                M_BB_A12_SUSPEND=0 restores it, IEN included, and fails
+ *                with ERR_BBIS_ILL_ID (still suspended) if the bridge is
+ *                not back. Drivers must not access their modules while
+ *                suspended, devices can not be enabled or disabled.
+ *
+ *                M_BB_A12_SLOT_RESET recovers a misbehaving M-module slot
+ *                without A12_Exit: A12_RESET_QUIESCE masks the slot, the
+ *                driver may then reset its module, A12_RESET_CTRL,
+ *                A12_RESET_REMAP and A12_RESET_ENABLE reset the control
+ *                register, set the slot up again and put it back in
+ *                service (A12_RESET_ALL: all steps at once). The other
+ *                slots keep servicing interrupts, see SlotReset.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                mSlot     module slot number
+ *                code      setstat code
+ *                value     setstat value or ptr to blocksetstat data
+ *  Output.....:  return    0 | error code
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_SetStat(
+    BBIS_HANDLE     *h,
+    u_int32         mSlot,
+    int32           code,
+	INT32_OR_64     value )
+{
+    DBGWRT_1((DBH, "BB - %s_SetStat: mSlot=%d code=0x%04x value=0x%x\n",
+			  BBNAME, mSlot, code, value));
+
+    switch (code) {
+        /* set debug level */
+        case M_BB_DEBUG_LEVEL:
+            h->debugLevel = value;
+            break;
+
+        /* clear IRQ statistics */
+        case M_BB_A12_IRQSTAT_CLR:
+		{
+			u_int32 i, n, *cnt;
+
+			/* counters are updated lock-free, zero each one atomically */
+			for( i=0; i<BRD_NBR_OF_BRDDEV; i++ ){
+				if( !value && i != CFIDX(mSlot) )
+					continue;
+				cnt = (u_int32*)&h->stat[i].s;
+				for( n=0; n<sizeof(A12_IRQ_STAT)/sizeof(u_int32); n++ )
+					A12_ATOMIC_FETCH_AND( &cnt[n], 0 );
+			}
+			if( value || mSlot >= A12_NBR_OF_MMODS ){
+				for( i=0; i<8; i++ )
+					A12_ATOMIC_FETCH_AND( &h->qspi.ev[i], 0 );
+				h->qspi.last = 0;
+			}
+			break;
+		}
+
+        /* IRQ moderation */
+        case M_BB_A12_IRQMOD_EVENTS:
+        case M_BB_A12_IRQMOD_TIME:
+		{
+			int32 error;
+
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (error = SlotAttach( h, mSlot )) )
+				return error;
+
+			if( code == M_BB_A12_IRQMOD_EVENTS )
+				return ModSet( h, mSlot, (u_int32)value,
+							   h->mmod[mSlot].modTime );
+			else
+				return ModSet( h, mSlot, h->mmod[mSlot].modBudget,
+							   (u_int32)value );
+		}
+
+        /* deferred servicing, queued slots are still serviced */
+        case M_BB_A12_IRQ_DEFER:
+#ifdef A12_OS_WORKERS
+			h->irqDefer = value ? TRUE : FALSE;
+#else
+			if( value )
+				return ERR_BBIS_ILL_PARAM;
+#endif
+			break;
+
+#ifdef A12_OS_WORKERS
+        /* hybrid IRQ/poll mode */
+        case M_BB_A12_POLL:
+        case M_BB_A12_POLL_ON:
+        case M_BB_A12_POLL_OFF:
+        case M_BB_A12_POLL_WINDOW:
+        case M_BB_A12_POLL_PERIOD:
+		{
+			MMOD *mm;
+			int32 error;
+
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (error = SlotAttach( h, mSlot )) )
+				return error;
+
+			mm = &h->mmod[mSlot];
+			return PollSet( h, mSlot,
+				code == M_BB_A12_POLL        ? (u_int32)value : mm->poll,
+				code == M_BB_A12_POLL_ON     ? (u_int32)value : mm->pollOn,
+				code == M_BB_A12_POLL_OFF    ? (u_int32)value : mm->pollOff,
+				code == M_BB_A12_POLL_WINDOW ? (u_int32)value : mm->pollWinMs,
+				code == M_BB_A12_POLL_PERIOD ? (u_int32)value :
+											   mm->pollPeriod );
+		}
+#endif
+
+        /* IRQ storm detection */
+        case M_BB_A12_STORM_IRQS:
+        case M_BB_A12_STORM_WINDOW:
+        case M_BB_A12_STORM_TIME:
+		{
+			MMOD *mm;
+			int32 error;
+
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (error = SlotAttach( h, mSlot )) )
+				return error;
+
+			mm = &h->mmod[mSlot];
+			return StormSet( h, mSlot,
+				code == M_BB_A12_STORM_IRQS   ? (u_int32)value : mm->stormIrqs,
+				code == M_BB_A12_STORM_WINDOW ? (u_int32)value : mm->stormWinMs,
+				code == M_BB_A12_STORM_TIME   ? (u_int32)value : mm->stormTime );
+		}
+
+        /* device configuration */
+        case M_BB_A12_SLOT_ENABLE:
+			return SlotEnable( h, mSlot, (u_int32)value );
+
+        case M_BB_A12_SLOT_IRQ_MODE:
+		{
+			int32 idx = CFIDX(mSlot);
+
+			if( idx < 0 || idx >= BRD_NBR_OF_BRDDEV )
+				return ERR_BBIS_ILL_SLOT;
+			if( value != BBIS_IRQ_SHARED && value != BBIS_IRQ_EXCLUSIVE )
+				return ERR_BBIS_ILL_PARAM;
+
+			h->slotCfg[idx].irqMode = (int32)value;
+			h->resValid &= ~(1 << idx);
+			break;
+		}
+
+        case M_BB_A12_SLOT_POLICY:
+		{
+			int32 error;
+
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (error = SlotAttach( h, mSlot )) )
+				return error;
+
+			return PolicySet( h, mSlot, (u_int32)value );
+		}
+
+        case M_BB_A12_SLOT_TIMING:
+		{
+			int32 error;
+
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( value < A12_TIMING_SLOW || value > A12_TIMING_FAST )
+				return ERR_BBIS_ILL_PARAM;
+			if( (error = SlotAttach( h, mSlot )) )
+				return error;
+
+			h->slotCfg[mSlot].timing = (u_int32)value;
+			if( h->brdUp )
+				CtrlUpdate( h, mSlot, A12_CTRL_TIMING((u_int32)value),
+							A12_CTRL_FAST );
+			break;
+		}
+
+        /* CPU hints */
+        case M_BB_A12_IRQ_CPUMASK:
+			h->irqCpus = (u_int32)value;
+			break;
+
+        case M_BB_A12_SLOT_CPUMASK:
+		{
+			int32 error;
+
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (error = SlotAttach( h, mSlot )) )
+				return error;
+
+			h->mmod[mSlot].cpus = (u_int32)value;
+			break;
+		}
+
+        /* event trace */
+        case M_BB_A12_TRACE:
+			return TraceOn( h, value ? TRUE : FALSE );
+
+        /* register access recording */
+        case M_BB_A12_REC:
+			return RecOn( h, value ? TRUE : FALSE );
+
+        /* suspend/resume */
+        case M_BB_A12_SUSPEND:
+			return Suspend( h, value ? TRUE : FALSE );
+
+        /* slot reset */
+        case M_BB_A12_SLOT_RESET:
+			return SlotReset( h, mSlot, (u_int32)value );
+
+        /* order of the slot checks */
+        case M_BB_A12_SCAN:
+			if( (u_int32)value > A12_SCAN_ADAPTIVE )
+				return ERR_BBIS_ILL_PARAM;
+			h->irq.scan = (u_int32)value;
+			break;
+
+        case M_BB_A12_SCAN_PRIO:
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (u_int32)value > A12_SCAN_PRIO_MAX )
+				return ERR_BBIS_ILL_PARAM;
+
+			h->slotCfg[mSlot].scanPrio = (u_int32)value;
+			h->irq.scanOrder = ScanOrder( h, FALSE );
+			break;
+
+        /* unknown */
+        default:
+            return ERR_BBIS_UNK_CODE;
+    }
+
+    return 0;
+}
+
+/****************************** A12_GetStat **********************************
+ *
+ *  Description:  Get driver status
+ *
+ *                Following status codes are supported:
+ *
+ *                Code                 Description                Values
+ *                -------------------  -------------------------  ----------
+ *                M_BB_DEBUG_LEVEL     driver debug level         see dbg.h
+ *                M_BB_IRQ_VECT        interrupt vector           0..max
+ *                M_BB_IRQ_LEVEL       interrupt level            0..max
+ *                M_BB_IRQ_PRIORITY    interrupt priority         0
+ *                M_MK_BLK_REV_ID      ident function table ptr   -
+ *                M_BB_A12_IRQMOD_EVENTS IRQs before holdoff      0=off
+ *                M_BB_A12_IRQMOD_TIME holdoff time [ms]          1..max
+ *                M_BB_A12_IRQ_DEFER   deferred servicing         0..1
+ *                M_BB_A12_POLL        hybrid IRQ/poll mode       0..1
+ *                M_BB_A12_POLL_ON     IRQs/window to poll        1..max
+ *                M_BB_A12_POLL_OFF    events/window to IRQ       0..max
+ *                M_BB_A12_POLL_WINDOW rate window [ms]           1..max
+ *                M_BB_A12_POLL_PERIOD poll period [us]           0..max
+ *                M_BB_A12_POLL_ACTIVE slot currently polled      0..1
+ *                M_BB_A12_STORM_IRQS  IRQs/window = storm        0=off
+ *                M_BB_A12_STORM_WINDOW storm window [ms]         1..max
+ *                M_BB_A12_STORM_TIME  first quarantine [ms]      1..0x10000
+ *                M_BB_A12_STORM_HOLDOFF current quarantine [ms]  0=none
+ *                M_BB_A12_BLK_IRQSTAT IRQ statistics             A12_IRQ_STAT
+ *                M_BB_A12_BLK_SGSTAT  SG queue statistics        A12_SG_STAT
+ *                M_BB_A12_SLOT_ENABLE device enabled             0..1
+ *                M_BB_A12_SLOT_IRQ_MODE IRQ mode                 BBIS_IRQ_xxx
+ *                M_BB_A12_SLOT_POLICY interrupt policy           A12_POLICY_xxx
+ *                M_BB_A12_SLOT_TIMING bus timing                 A12_TIMING_xxx
+ *                M_BB_A12_IRQ_CPUMASK CPU hint of bridge IRQ     0=none
+ *                M_BB_A12_SLOT_CPUMASK CPU hint of deferred work 0=none
+ *                M_BB_A12_TRACE       event trace                0..1
+ *                M_BB_A12_TRACE_LOST  events overwritten         0..max
+ *                M_BB_A12_BLK_TRACE   drain event trace          A12_TRACE_EV[]
+ *                M_BB_A12_BLK_QSPISTAT QSPI interrupt events     A12_QSPI_STAT
+ *                M_BB_A12_BLK_SLOTRES device resources           A12_SLOT_RES
+ *                M_BB_A12_REC         register access recording  0..1
+ *                M_BB_A12_REC_LOST    records overwritten        0..max
+ *                M_BB_A12_BLK_REC     drain access recording     A12_REC_HDR,
+ *                                                                A12_REC[]
+ *                M_BB_A12_SUSPEND     bridge suspended           0..1
+ *                M_BB_A12_SLOT_RESET  slot quiesced              0..1
+ *                M_BB_A12_SCAN        order of the slot checks   A12_SCAN_xxx
+ *                M_BB_A12_SCAN_PRIO   scan priority of mSlot     0..0xff
+ *                M_BB_A12_SCAN_ORDER  current scan order         see
+ *                                                                A12_IrqOrder
+ *                M_BB_A12_BLK_WARM    board state                A12_WARM
+ *
+ *                M_BB_A12_POLL..M_BB_A12_POLL_PERIOD exist only if the
+ *                BBIS is built with A12_OS_WORKERS.
+ *
+ *                M_BB_A12_BLK_SLOTRES returns the resources of mSlot, or
+ *                of all devices if the buffer is large enough, as
+ *                A12_ResQuery.
+ *
+ *                M_BB_A12_BLK_TRACE moves the recorded events into the
+ *                buffer, as many as fit, and returns the filled size.
+ *                Events of a ring which were overwritten before they were
+ *                drained are counted by M_BB_A12_TRACE_LOST. Only one
+ *                caller may drain at a time.
+ *
+ *                M_BB_A12_BLK_REC moves the recorded accesses into the
+ *                buffer as one chunk of the recording stream (see
+ *                A12_REC_HDR), as many as fit, and returns the filled
+ *                size. Only one caller may drain at a time.
+ *
+ *                M_BB_A12_BLK_WARM saves the board state for a warm
+ *                restart with A12_WarmInit, e.g. just before A12_Exit.
+ *
+ *                M_BB_A12_BLK_IRQSTAT returns the statistics of mSlot, or
+ *                of all A12_NBR_OF_DEVS devices if the buffer is large
+ *                enough (M-module slots 0..2, QSPI).
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                mSlot     module slot number
+ *                code      getstat code
+ *  Output.....:  valueP    getstat value or ptr to blockgetstat data
+ *                return    0 | error code
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_GetStat(
+    BBIS_HANDLE     *h,
+    u_int32         mSlot,
+    int32           code,
+	INT32_OR_64     *valueP )
+{
+    int32       status=0;
+
+    DBGWRT_1((DBH, "BB - %s_GetStat: mSlot=%d code=0x%04x\n",BBNAME,mSlot,code));
+
+    switch (code) {
+        /* get debug level */
+        case M_BB_DEBUG_LEVEL:
+            *valueP = h->debugLevel;
+            break;
+
+        /* get IRQ vector */
+        case M_BB_IRQ_VECT:
+		{
+			A12_SLOT_RES *res;
+
+			if( (status = SlotRes( h, mSlot, &res )) )
+				break;
+			*valueP = (int32)res->irqVector;
+			break;
+		}
+        /* get IRQ level */
+        case M_BB_IRQ_LEVEL:
+		{
+			A12_SLOT_RES *res;
+
+			if( (status = SlotRes( h, mSlot, &res )) )
+				break;
+			*valueP = (int32)res->irqLevel;
+			break;
+		}
+
+        /* get IRQ priority */
+        case M_BB_IRQ_PRIORITY:
+            *valueP = 0;
+            break;
+
+        /* ident table */
+        case M_MK_BLK_REV_ID:
+           *valueP = (INT32_OR_64)&h->idFuncTbl;
+           break;
+
+        /* IRQ moderation */
+        case M_BB_A12_IRQMOD_EVENTS:
+        case M_BB_A12_IRQMOD_TIME:
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (status = SlotAttach( h, mSlot )) )
+				return status;
+
+			*valueP = (code == M_BB_A12_IRQMOD_EVENTS) ?
+				h->mmod[mSlot].modBudget : h->mmod[mSlot].modTime;
+			break;
+
+        /* deferred servicing */
+        case M_BB_A12_IRQ_DEFER:
+#ifdef A12_OS_WORKERS
+			*valueP = h->irqDefer;
+#else
+			*valueP = FALSE;
+#endif
+			break;
+
+        /* hybrid IRQ/poll mode */
+#ifdef A12_OS_WORKERS
+        case M_BB_A12_POLL:
+        case M_BB_A12_POLL_ON:
+        case M_BB_A12_POLL_OFF:
+        case M_BB_A12_POLL_WINDOW:
+        case M_BB_A12_POLL_PERIOD:
+#endif
+        case M_BB_A12_POLL_ACTIVE:
+		{
+			MMOD *mm;
+
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (status = SlotAttach( h, mSlot )) )
+				return status;
+
+			mm = &h->mmod[mSlot];
+			switch( code ){
+#ifdef A12_OS_WORKERS
+			case M_BB_A12_POLL:			*valueP = mm->poll;			break;
+			case M_BB_A12_POLL_ON:		*valueP = mm->pollOn;		break;
+			case M_BB_A12_POLL_OFF:		*valueP = mm->pollOff;		break;
+			case M_BB_A12_POLL_WINDOW:	*valueP = mm->pollWinMs;	break;
+			case M_BB_A12_POLL_PERIOD:	*valueP = mm->pollPeriod;	break;
+#endif
+			default:
+				*valueP = A12_POLLED( h, 1 << mSlot ) ? TRUE : FALSE;
+			}
+			break;
+		}
+
+        /* IRQ storm detection */
+        case M_BB_A12_STORM_IRQS:
+        case M_BB_A12_STORM_WINDOW:
+        case M_BB_A12_STORM_TIME:
+        case M_BB_A12_STORM_HOLDOFF:
+		{
+			MMOD *mm;
+
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (status = SlotAttach( h, mSlot )) )
+				return status;
+
+			mm = &h->mmod[mSlot];
+			switch( code ){
+			case M_BB_A12_STORM_IRQS:	*valueP = mm->stormIrqs;	break;
+			case M_BB_A12_STORM_WINDOW:	*valueP = mm->stormWinMs;	break;
+			case M_BB_A12_STORM_TIME:	*valueP = mm->stormTime;	break;
+			default:
+				*valueP = mm->stormHoldoff;
+			}
+			break;
+		}
+
+        /* IRQ statistics */
+        case M_BB_A12_BLK_IRQSTAT:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)valueP;
+			A12_IRQ_STAT *stat = (A12_IRQ_STAT*)blk->data;
+			int32 i;
+
+			if( (u_int32)blk->size >= sizeof(A12_IRQ_STAT)*BRD_NBR_OF_BRDDEV ){
+				for( i=0; i<BRD_NBR_OF_BRDDEV; i++ )
+					stat[i] = h->stat[i].s;
+				blk->size = sizeof(A12_IRQ_STAT)*BRD_NBR_OF_BRDDEV;
+			}
+			else if( (u_int32)blk->size >= sizeof(A12_IRQ_STAT) &&
+					 CFIDX(mSlot) < BRD_NBR_OF_BRDDEV ){
+				*stat = h->stat[CFIDX(mSlot)].s;
+				blk->size = sizeof(A12_IRQ_STAT);
+			}
+			else
+				status = ERR_BBIS_ILL_PARAM;
+			break;
+		}
+
+#ifdef A12_OS_WORKERS
+        /* SG queue statistics */
+        case M_BB_A12_BLK_SGSTAT:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)valueP;
+
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (u_int32)blk->size < sizeof(A12_SG_STAT) )
+				return ERR_BBIS_ILL_PARAM;
+
+			*(A12_SG_STAT*)blk->data = h->sg[mSlot].stat;
+			blk->size = sizeof(A12_SG_STAT);
+			break;
+		}
+#endif
+
+        /* device configuration */
+        case M_BB_A12_SLOT_ENABLE:
+        case M_BB_A12_SLOT_IRQ_MODE:
+        case M_BB_A12_SLOT_POLICY:
+		{
+			int32 idx = CFIDX(mSlot);
+
+			if( idx < 0 || idx >= BRD_NBR_OF_BRDDEV ||
+				(code == M_BB_A12_SLOT_POLICY && idx >= A12_NBR_OF_MMODS) )
+				return ERR_BBIS_ILL_SLOT;
+
+			switch( code ){
+			case M_BB_A12_SLOT_ENABLE:
+				*valueP = h->slotCfg[idx].enable;		break;
+			case M_BB_A12_SLOT_IRQ_MODE:
+				*valueP = h->slotCfg[idx].irqMode;		break;
+			default:
+				*valueP = h->slotCfg[idx].policy;
+			}
+			break;
+		}
+
+        case M_BB_A12_SLOT_TIMING:
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (status = SlotAttach( h, mSlot )) )
+				return status;
+
+			*valueP = h->slotCfg[mSlot].timing;
+			break;
+
+        /* CPU hints */
+        case M_BB_A12_IRQ_CPUMASK:
+			*valueP = h->irqCpus;
+			break;
+
+        case M_BB_A12_SLOT_CPUMASK:
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+			if( (status = SlotAttach( h, mSlot )) )
+				return status;
+
+			*valueP = h->mmod[mSlot].cpus;
+			break;
+
+        /* event trace */
+        case M_BB_A12_TRACE:
+			*valueP = h->irq.trace;
+			break;
+
+        /* register access recording */
+        case M_BB_A12_REC:
+			*valueP = h->irq.rec;
+			break;
+
+        case M_BB_A12_REC_LOST:
+			*valueP = h->recRing ? h->recRing->lost : 0;
+			break;
+
+        /* suspend/resume */
+        case M_BB_A12_SUSPEND:
+			*valueP = h->suspended;
+			break;
+
+        /* slot reset */
+        case M_BB_A12_SLOT_RESET:
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+
+			*valueP = (h->quiesced & (1 << mSlot)) ? A12_RESET_QUIESCE : 0;
+			break;
+
+        /* order of the slot checks */
+        case M_BB_A12_SCAN:
+			*valueP = h->irq.scan;
+			break;
+
+        case M_BB_A12_SCAN_PRIO:
+			if( mSlot >= A12_NBR_OF_MMODS )
+				return ERR_BBIS_ILL_SLOT;
+
+			*valueP = h->slotCfg[mSlot].scanPrio;
+			break;
+
+        case M_BB_A12_SCAN_ORDER:
+		{
+			u_int32 order;
+
+			A12_IrqOrder( h, &order );
+			*valueP = order;
+			break;
+		}
+
+        case M_BB_A12_TRACE_LOST:
+		{
+			u_int32 cpu, lost = 0;
+
+			for( cpu=0; h->trRing && cpu<A12_TRACE_CPUS; cpu++ )
+				lost += h->trRing[cpu].lost;
+			*valueP = lost;
+			break;
+		}
+
+        /* QSPI interrupt events */
+        case M_BB_A12_BLK_QSPISTAT:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)valueP;
+			A12_QSPI_STAT *qs = (A12_QSPI_STAT*)blk->data;
+			int32 i;
+
+			if( (u_int32)blk->size < sizeof(A12_QSPI_STAT) )
+				return ERR_BBIS_ILL_PARAM;
+
+			for( i=0; i<8; i++ )
+				qs->ev[i] = h->qspi.ev[i];
+			qs->spurious = h->stat[A12_NBR_OF_MMODS].s.irqNo;
+			qs->last	 = h->qspi.last;
+			blk->size	 = sizeof(A12_QSPI_STAT);
+			break;
+		}
+
+        /* device resources */
+        case M_BB_A12_BLK_SLOTRES:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)valueP;
+			u_int32 n = (u_int32)blk->size / sizeof(A12_SLOT_RES);
+
+			status = A12_ResQuery( h, n >= BRD_NBR_OF_BRDDEV ?
+								   A12_RES_ALL : mSlot,
+								   (A12_SLOT_RES*)blk->data, &n );
+			if( !status )
+				blk->size = n * sizeof(A12_SLOT_RES);
+			break;
+		}
+
+        case M_BB_A12_BLK_TRACE:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)valueP;
+
+			blk->size = TraceDrain( h, (A12_TRACE_EV*)blk->data,
+									(u_int32)blk->size /
+									sizeof(A12_TRACE_EV) ) *
+				sizeof(A12_TRACE_EV);
+			break;
+		}
+
+        case M_BB_A12_BLK_REC:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)valueP;
+
+			if( (u_int32)blk->size < sizeof(A12_REC_HDR) )
+				return ERR_BBIS_ILL_PARAM;
+
+			blk->size = RecDrain( h, blk->data, (u_int32)blk->size );
+			break;
+		}
+
+        /* board state for a warm restart */
+        case M_BB_A12_BLK_WARM:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)valueP;
+
+			if( (u_int32)blk->size < sizeof(A12_WARM) )
+				return ERR_BBIS_ILL_PARAM;
+
+			WarmSave( h, (A12_WARM*)blk->data );
+			blk->size = sizeof(A12_WARM);
+			break;
+		}
+
+        /* unknown */
+        default:
+            status = ERR_BBIS_UNK_CODE;
+    }
+
+    return status;
+}
+
+#ifndef A12_OS_WORKERS
+/****************************** A12_Unused ***********************************
+ *
+ *  Description:  Dummy function for unused jump table entries.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  ---
+ *  Output.....:  return  ERR_BBIS_ILL_FUNC
+ *  Globals....:  ---
+ ****************************************************************************/
+static int32 A12_Unused( void )		/* nodoc */
+{
+    return ERR_BBIS_ILL_FUNC;
+}
+#endif
+
+/*********************************** Ident **********************************
+ *
+ *  Description:  Return ident string
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  -
+ *  Output.....:  return  pointer to ident string
+ *  Globals....:  -
+ ****************************************************************************/
+static char* Ident( void )		/* nodoc */
+{
+	return( (char*) IdentString );
+}
+
+/********************************* SrvClaim **********************************
+ *
+ *  Description:  Claim or reject the interrupt of a device
+ *
+ *                Bookkeeping of A12_IrqSrvInit and A12_IrqPendMask after
+ *                the pending state is known: adaptive scan order, poll
+ *                rate, deferred servicing and IRQ statistics.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number
+ *                ctrl		control/status register read
+ *                ret		BBIS_IRQ_YES if the device is pending
+ *  Output.....:  return	BBIS_IRQ_NO | BBIS_IRQ_YES | A12_SRV_DEFERRED
+ *                          (slot masked and queued, no ISR call)
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 SrvClaim(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 ctrl,
+	int32 ret )
+{
+	A12_DEV_STAT *st = &h->stat[CFIDX(mSlot)];
+	u_int32 bit = (mSlot < A12_NBR_OF_MMODS) ? 1 << mSlot : 0;
+
+	/* claims for the adaptive scan order, polled slots take no IRQ */
+	if( ret == BBIS_IRQ_YES && bit && h->irq.scan == A12_SCAN_ADAPTIVE &&
+		!A12_POLLED( h, bit ) )
+		ScanHit( h, mSlot );
+
+#ifdef A12_OS_WORKERS
+	/* rate for hybrid IRQ/poll mode */
+	if( ret == BBIS_IRQ_YES && bit && h->mmod[mSlot].poll )
+		A12_ATOMIC_FETCH_ADD( &h->mmod[mSlot].pollEvents, 1 );
+#endif
+
+#ifdef A12_OS_WORKERS
+	/* deferred servicing: mask slot and queue it for a worker */
+	if( ret == BBIS_IRQ_YES && bit && h->irqDefer ){
+		MMOD *mm = &h->mmod[mSlot];
+		u_int32 q = A12_CPU_ID();
+
+		/* already queued (line still asserted, shared interrupt) */
+		if( A12_ATOMIC_FETCH_OR( &mm->maskReasons, A12_MASK_DEFER ) &
+			A12_MASK_DEFER ){
+			A12_TRACE( h, mSlot, A12_TEV_SRVINIT, ctrl, BBIS_IRQ_NO );
+			return BBIS_IRQ_NO;
+		}
+
+		A12_TRACE( h, mSlot, A12_TEV_DEFER, ctrl, BBIS_IRQ_NO );
+		IenApply( h, mSlot );
+		st->t0 = A12_CYCLES(h);
+		st->inSrv = TRUE;
+		A12_ATOMIC_FETCH_ADD( &st->s.irqDeferred, 1 );
+
+		/* to the queue of a hinted CPU */
+		if( mm->cpus && (q >= 32 || !(mm->cpus & ((u_int32)1 << q))) )
+			for( q=0; !(mm->cpus & ((u_int32)1 << q)); q++ )
+				;
+		A12_ATOMIC_FETCH_OR( &h->dq[q % A12_DEFER_QUEUES].mask, bit );
+		return A12_SRV_DEFERRED;
+	}
+#endif
+
+	if( ret == BBIS_IRQ_YES ){
+		A12_ATOMIC_FETCH_ADD( &st->s.irqYes, 1 );
+		st->t0 = A12_CYCLES(h);
+		st->inSrv = TRUE;
+	}
+	else
+		A12_ATOMIC_FETCH_ADD( &st->s.irqNo, 1 );
+
+	A12_TRACE( h, mSlot, A12_TEV_SRVINIT, ctrl, ret );
+	return ret;
+}
+
+/******************************** CtrlUpdate *********************************
+ *
+ *  Description:  Change bits of a control register through its shadow
+ *
+ *                The shadow is updated lock-free, the register is written
+ *                without reading it back. A CPU that lost the race against
+ *                a concurrent update writes again until the register holds
+ *                the latest shadow value. While the slot is set up again
+ *                (A12_RESET_REMAP), only the shadow is updated, SlotAttach
+ *                writes it afterwards.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *                set		bits to set
+ *                clr		bits to clear (before setting)
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void CtrlUpdate(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 set,
+	u_int32 clr )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 old, val;
+
+	do {
+		old = mm->ctrl;
+		val = ((old & ~clr) | set) & ~A12_CTRL_IRQ;
+	} while( !A12_ATOMIC_CAS( &mm->ctrl, old, val ) );
+
+	if( !CtrlGet( h, mSlot ) )
+		return;
+
+	for(;;){
+		MWRITE_D8( mm->vCtrlBase, 0, val );
+		A12_RECORD( h, mSlot, A12_ROP_WR8, 0, val );
+		A12_MEMBAR();
+		if( (old = mm->ctrl) == val )
+			break;
+		val = old;
+	}
+	CtrlPut( h, mSlot );
+}
+
+/********************************** CtrlGet **********************************
+ *
+ *  Description:  Start an access to the control register
+ *
+ *                Fails while A12_RESET_REMAP has the register unmapped
+ *                or is about to unmap it, see SlotReset. Otherwise the
+ *                register stays mapped until CtrlPut.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *  Output.....:  return	TRUE: access, call CtrlPut | FALSE: no access
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 CtrlGet(
+	BBIS_HANDLE *h,
+	u_int32 mSlot )
+{
+	MMOD *mm = &h->mmod[mSlot];
+
+	A12_ATOMIC_FETCH_ADD( &mm->ctrlUsers, 1 );
+	A12_MEMBAR();
+	if( !mm->unmapped )
+		return TRUE;
+
+	CtrlPut( h, mSlot );
+	return FALSE;
+}
+
+/********************************** CtrlPut **********************************
+ *
+ *  Description:  End an access to the control register
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void CtrlPut(
+	BBIS_HANDLE *h,
+	u_int32 mSlot )
+{
+	A12_ATOMIC_FETCH_ADD( &h->mmod[mSlot].ctrlUsers, (u_int32)-1 );
+}
+
+/********************************* IenApply **********************************
+ *
+ *  Description:  Bring IEN of a slot in line with driver request and
+ *                BBIS mask reasons
+ *
+ *                Repeats until the state it wrote is still the wanted one,
+ *                so concurrent callers converge on the latest state.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void IenApply(
+	BBIS_HANDLE *h,
+	u_int32 mSlot )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 bit = 1 << mSlot, on;
+
+	do {
+		on = (h->irq.ienMask & bit) && !mm->maskReasons;
+		if( on )
+			CtrlUpdate( h, mSlot, A12_CTRL_IEN, 0 );
+		else
+			CtrlUpdate( h, mSlot, 0, A12_CTRL_IEN );
+		A12_MEMBAR();
+	} while( on != ((h->irq.ienMask & bit) && !mm->maskReasons) );
+}
+
+/********************************** ModSet ***********************************
+ *
+ *  Description:  Configure IRQ moderation of a slot
+ *
+ *                Switching moderation off releases a running holdoff.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *                budget	serviced IRQs before holdoff, 0=off
+ *                time		holdoff time [ms]
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 ModSet(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 budget,
+	u_int32 time )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	int32 error;
+
+	if( budget && !mm->modAlarm ){
+		error = OSS_AlarmCreate( h->osHdl, ModAlarm, (void*)mm,
+								 &mm->modAlarm );
+		if( error )
+			return error;
+	}
+
+	mm->modTime	  = time ? time : 1;
+	mm->modEvents = 0;
+	mm->modBudget = budget;
+
+	if( !budget && (mm->maskReasons & A12_MASK_MODERATE) ){
+		OSS_AlarmClear( h->osHdl, mm->modAlarm );
+		A12_ATOMIC_FETCH_AND( &mm->maskReasons, ~A12_MASK_MODERATE );
+		IenApply( h, mSlot );
+	}
+
+	DBGWRT_2((DBH," mSlot %d: IRQ moderation events=%d time=%dms\n",
+			  mSlot, mm->modBudget, mm->modTime));
+	return 0;
+}
+
+/********************************* ModAlarm **********************************
+ *
+ *  Description:  End of IRQ moderation holdoff, restore IEN
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  arg		MMOD of the slot
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void ModAlarm(
+	void *arg )
+{
+	MMOD *mm = (MMOD*)arg;
+	BBIS_HANDLE *h = (BBIS_HANDLE*)mm->brdHdl;
+
+	A12_ATOMIC_FETCH_AND( &mm->maskReasons, ~A12_MASK_MODERATE );
+	IenApply( h, mm->slot );
+}
+
+#ifdef A12_OS_WORKERS
+/********************************* DeferTake *********************************
+ *
+ *  Description:  Remove the lowest queued slot from a deferred work queue
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  dq		work queue
+ *                allow		slots that may be taken
+ *  Output.....:  return	bit of the removed slot, 0 if none
+ *  Globals....:  -
+ ****************************************************************************/
+static u_int32 DeferTake(
+	A12_DEFER_QUEUE *dq,
+	u_int32 allow )
+{
+	u_int32 old, bit;
+
+	do {
+		if( !((old = dq->mask) & allow) )
+			return 0;
+		bit = old & allow & (~(old & allow) + 1);
+	} while( !A12_ATOMIC_CAS( &dq->mask, old, old & ~bit ) );
+
+	return bit;
+}
+#endif /* A12_OS_WORKERS */
+
+/******************************** HandleAlloc ********************************
+ *
+ *  Description:  Allocate and set up a board handle
+ *
+ *                - cache line aligned handle, id function table, debugging
+ *                - descriptor handle and DEBUG_LEVEL_xxx keys
+ *                - slot back pointers, SG copy backends
+ *
+ *                Common part of A12_Init and A12_WarmInit. The handle is
+ *                released on error.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  osHdl     pointer to os specific structure
+ *                descSpec  pointer to os specific descriptor specifier
+ *  Output.....:  *hP		board handle
+ *                return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 HandleAlloc(
+	OSS_HANDLE *osHdl,
+	DESC_SPEC *descSpec,
+	BBIS_HANDLE **hP )
+{
+    BBIS_HANDLE	*h;
+	void		*mem;
+	u_int32     gotsize;
+    u_int32		value;
+	int32 error, i;
+
+    /* get memory for the board structure, cache line aligned */
+    mem = OSS_MemGet( osHdl, sizeof(BBIS_HANDLE) + A12_CACHE_LINE, &gotsize );
+    if ( mem == NULL )
+        return ERR_OSS_MEM_ALLOC;
+
+    h = (BBIS_HANDLE*)(((U_INT32_OR_64)mem + A12_CACHE_LINE - 1) &
+					   ~(U_INT32_OR_64)(A12_CACHE_LINE - 1));
+	OSS_MemFill( osHdl, sizeof(BBIS_HANDLE), (char*)h, 0 );
+
+    /* store data into the board structure */
+    h->ownMem = mem;
+    h->ownMemSize = gotsize;
+    h->osHdl = osHdl;
+
+#ifdef A12_OSS_ATOMIC
+	/* lock of the atomic operations, before anything uses them */
+	if( (error = AtomicInit( osHdl )) )
+		return( Cleanup(h,error) );
+	h->atomRef = TRUE;
+#endif
+
+    /*------------------------------+
+    |  init id function table       |
+    +------------------------------*/
+	/* drivers ident function */
+	h->idFuncTbl.idCall[0].identCall = Ident;
+	/* libraries ident functions */
+	h->idFuncTbl.idCall[1].identCall = DESC_Ident;
+	h->idFuncTbl.idCall[2].identCall = OSS_Ident;
+	/* terminator */
+	h->idFuncTbl.idCall[3].identCall = NULL;
+
+    /*------------------------------+
+    |  prepare debugging            |
+    +------------------------------*/
+	DBG_MYLEVEL = OSS_DBG_DEFAULT;	/* set OS specific debug level */
+	DBGINIT((NULL,&DBH));
+
+    /*------------------------------+
+    |  scan descriptor              |
+    +------------------------------*/
+    /* init descHdl */
+    error = DESC_Init( descSpec, osHdl, &h->descHdl );
+	if (error)
+		return( Cleanup(h,error) );
+
+    /* get DEBUG_LEVEL_DESC */
+    error = DESC_GetUInt32(h->descHdl, OSS_DBG_DEFAULT, &value,
+				"DEBUG_LEVEL_DESC");
+	if ( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return( Cleanup(h,error) );
+
+	/* set debug level for DESC module */
+	DESC_DbgLevelSet(h->descHdl, value);
+
+    /* get DEBUG_LEVEL */
+    error = DESC_GetUInt32( h->descHdl, OSS_DBG_DEFAULT,
+							 &(h->debugLevel),
+                "DEBUG_LEVEL");
+	if ( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return( Cleanup(h,error) );
+
+	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
+		h->mmod[i].brdHdl = (void*)h;
+		h->mmod[i].slot   = i;
+	}
+
+	*hP = h;
+	return 0;
+}
+
+/******************************** BridgeFind *********************************
+ *
+ *  Description:  Locate the n-th A12 bridge
+ *
+ *                Scans function 0 of all devices from bus h->pciBusNbr
+ *                up to A12_PCI_MAX_BUS.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                instance	bridge instance, 0 = first
+ *  Output.....:  h->pciBusNbr, h->pciDevNbr	bridge location
+ *                return	0 | ERR_BBIS_ILL_ID
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 BridgeFind(
+	BBIS_HANDLE *h,
+	u_int32 instance )
+{
+	int32 bus, dev, venId, devId;
+
+	for( bus=h->pciBusNbr; bus<=A12_PCI_MAX_BUS; bus++ ){
+		for( dev=0; dev<A12_PCI_MAX_DEV; dev++ ){
+			if( OSS_PciGetConfig( h->osHdl, bus, dev, 0, OSS_PCI_VENDOR_ID,
+								  &venId ) ||
+				venId != A12_MMOD_BRIDGE_VEN_ID )
+				continue;
+			if( OSS_PciGetConfig( h->osHdl, bus, dev, 0, OSS_PCI_DEVICE_ID,
+								  &devId ) ||
+				devId != A12_MMOD_BRIDGE_DEV_ID )
+				continue;
+
+			if( instance-- == 0 ){
+				h->pciBusNbr = bus;
+				h->pciDevNbr = dev;
+				return 0;
+			}
+		}
+	}
+
+	DBGWRT_ERR((DBH, "*** %s_Init: A12 bridge instance not found\n",
+				BBNAME ));
+	return ERR_BBIS_ILL_ID;
+}
+
+/******************************** BridgeCheck ********************************
+ *
+ *  Description:  Check the IDs of the bridge at h->pciBusNbr/pciDevNbr
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 BridgeCheck(
+	BBIS_HANDLE *h )
+{
+	int32 venId, devId, error;
+
+	error = OSS_PciGetConfig( h->osHdl, h->pciBusNbr, h->pciDevNbr, 0,
+							  OSS_PCI_VENDOR_ID, &venId );
+	error = OSS_PciGetConfig( h->osHdl, h->pciBusNbr, h->pciDevNbr, 0,
+							  OSS_PCI_DEVICE_ID, &devId );
+	if( error ){
+		DBGWRT_ERR((DBH, "*** %s_BrdInit: Can't read PCI ven/dev Id\n",
+					BBNAME ));
+		return error;
+	}
+
+	if( venId == 0xffff && devId == 0xffff ){
+		DBGWRT_ERR((DBH, "*** %s_BrdInit: PCI->M-mod bridge not present!\n",
+					BBNAME));
+		return ERR_BBIS_ILL_ID;
+	}
+
+	if( (venId != A12_MMOD_BRIDGE_VEN_ID) ||
+		(devId != A12_MMOD_BRIDGE_DEV_ID )){
+		DBGWRT_ERR((DBH, "*** %s_BrdInit: bad vendor/device ID of "
+					"PCI->M-mod bridge %04lx %04lx\n", BBNAME, venId, devId));
+		return ERR_BBIS_ILL_ID;
+	}
+
+	return 0;
+}
+
+/********************************* IrqAttach *********************************
+ *
+ *  Description:  Get PCI interrupt line and vector of the bridge, once
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 IrqAttach(
+	BBIS_HANDLE *h )
+{
+	int32 error;
+
+	if( h->irqValid )
+		return 0;
+
+    /* get interrupt line */
+	error = OSS_PciGetConfig( h->osHdl, h->pciBusNbr, h->pciDevNbr, 0,
+							   OSS_PCI_INTERRUPT_LINE, &h->irqLevel );
+
+	/* no interrupt connected */
+	if( error || (h->irqLevel == 0xff) )
+		return ERR_BBIS_NO_IRQ;
+
+	/* convert level to vector */
+	if( (error = OSS_IrqLevelToVector( h->osHdl, OSS_BUSTYPE_PCI,
+										h->irqLevel, &h->irqVector )) )
+		return error;
+
+	DBGWRT_2((DBH," IRQ level=0x%x, vector=0x%x\n",
+			  h->irqLevel, h->irqVector));
+
+	h->irqValid = TRUE;
+	return 0;
+}
+
+/******************************** SlotAttach *********************************
+ *
+ *  Description:  Set up an M-module slot on first use
+ *
+ *                - assigns and maps the control register
+ *                - reads the SLOT_n_xxx descriptor keys
+ *                - sets the control register to a safe state when the
+ *                  board is already initialized
+ *
+ *                Each step is done once, a failed attach is retried on
+ *                the next use. Called from init (unless LAZY_INIT) or
+ *                when a device on the slot is opened. Fails for a disabled
+ *                slot. A slot quiesced for a reset is enabled.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 SlotAttach(
+	BBIS_HANDLE *h,
+	u_int32 mSlot )
+{
+#ifdef A12_OS_WORKERS
+	static const char *key[] = { "SLOT_%d_POLL", "SLOT_%d_POLL_ON",
+								 "SLOT_%d_POLL_OFF", "SLOT_%d_POLL_WINDOW",
+								 "SLOT_%d_POLL_PERIOD" };
+	static const u_int32 def[] = { 0, 50, 5, 1, 10 };
+#endif
+	static const char *stormKey[] = { "SLOT_%d_STORM_IRQS",
+									  "SLOT_%d_STORM_WINDOW",
+									  "SLOT_%d_STORM_TIME" };
+	static const u_int32 stormDef[] = { 0, 10, 10 };
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 bit = 1 << mSlot, val[5], modEvents, modTime, n;
+	int32 error;
+
+	if( !((h->irq.enMask | h->quiesced) & bit) )
+		return ERR_BBIS_ILL_SLOT;
+	if( h->attached & bit )
+		return 0;
+
+	/*------------------------------------+
+	|  Assign and map control register    |
+	+------------------------------------*/
+	if( (error = SlotMap( h, mSlot )) )
+		return error;
+
+	/*------------------------------------+
+	|  Descriptor settings of the slot    |
+	+------------------------------------*/
+	/* IRQ moderation */
+	error = DESC_GetUInt32( h->descHdl, 0, &modEvents,
+							"SLOT_%d_IRQ_MOD_EVENTS", mSlot );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return error;
+
+	error = DESC_GetUInt32( h->descHdl, 1, &modTime,
+							"SLOT_%d_IRQ_MOD_TIME", mSlot );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return error;
+
+	if( (error = ModSet( h, mSlot, modEvents, modTime )) )
+		return error;
+
+	/* hybrid IRQ/poll mode */
+#ifdef A12_OS_WORKERS
+	for( n=0; n<5; n++ ){
+		error = DESC_GetUInt32( h->descHdl, def[n], &val[n],
+								(char*)key[n], mSlot );
+		if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+			return error;
+	}
+
+	if( (error = PollSet( h, mSlot, val[0], val[1], val[2], val[3],
+						  val[4] )) )
+		return error;
+#else
+	error = DESC_GetUInt32( h->descHdl, 0, &val[0], "SLOT_%d_POLL", mSlot );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return error;
+	if( val[0] ){
+		DBGWRT_ERR((DBH, "*** %s_Init: SLOT_%d_POLL needs A12_OS_WORKERS\n",
+					BBNAME, mSlot));
+		return ERR_BBIS_DESC_PARAM;
+	}
+#endif
+
+	/* IRQ storm detection */
+	for( n=0; n<3; n++ ){
+		error = DESC_GetUInt32( h->descHdl, stormDef[n], &val[n],
+								(char*)stormKey[n], mSlot );
+		if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+			return error;
+	}
+
+	if( (error = StormSet( h, mSlot, val[0], val[1], val[2] )) )
+		return error;
+
+	/* interrupt policy */
+	error = DESC_GetUInt32( h->descHdl, A12_POLICY_IRQ, &val[0],
+							"SLOT_%d_IRQ_POLICY", mSlot );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return error;
+	if( (error = PolicySet( h, mSlot, val[0] )) )
+		return error;
+
+	/* allowed attributes of A24 views */
+	error = DESC_GetUInt32( h->descHdl, 0, &h->a24Attr[mSlot],
+							"SLOT_%d_A24_ATTR", mSlot );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return error;
+	h->a24Attr[mSlot] &= A12_MATTR_WC | A12_MATTR_PREFETCH;
+
+	/* bus timing */
+	error = DESC_GetUInt32( h->descHdl, A12_TIMING_FAST, &val[0],
+							"SLOT_%d_TIMING", mSlot );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return error;
+	if( val[0] > A12_TIMING_FAST ){
+		DBGWRT_ERR((DBH, "*** %s: SLOT_%d_TIMING %d invalid\n",
+					BBNAME, mSlot, val[0]));
+		return ERR_BBIS_DESC_PARAM;
+	}
+	h->slotCfg[mSlot].timing = val[0];
+
+	/* CPU hint of deferred work */
+	error = DESC_GetUInt32( h->descHdl, 0, &mm->cpus,
+							"SLOT_%d_CPU_MASK", mSlot );
+	if( error && (error!=ERR_DESC_KEY_NOTFOUND) )
+		return error;
+
+	/* safe state, as A12_BrdInit */
+	if( h->brdUp )
+		CtrlUpdate( h, mSlot, A12_CTRL_TIMING(val[0]), 0xff );
+
+	h->attached |= bit;
+	return 0;
+}
+
+/********************************** SlotMap **********************************
+ *
+ *  Description:  Assign and map the control register of a slot, once
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 SlotMap(
+	BBIS_HANDLE *h,
+	u_int32 mSlot )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 bit = 1 << mSlot;
+	void *phys;
+	int32 error;
+
+	phys = (void*)((U_INT32_OR_64)h->physBase +
+				   (A12_MMOD_SLOT_OFFSET*mSlot) + A12_MMOD_CTRL_BASE);
+
+	if( !(h->resAssigned & bit) ){
+		h->res[mSlot].type = OSS_RES_MEM;
+		h->res[mSlot].u.mem.physAddr = phys;
+		h->res[mSlot].u.mem.size = A12_CTRL_SIZE;
+
+		if( (error = OSS_AssignResources( h->osHdl, OSS_BUSTYPE_PCI,
+										  h->pciBusNbr, 1, &h->res[mSlot] )) )
+			return error;
+		h->resAssigned |= bit;
+	}
+
+	if( !mm->vCtrlBase ){
+		error = OSS_MapPhysToVirtAddr( h->osHdl, phys, A12_CTRL_SIZE,
+									   OSS_ADDRSPACE_MEM, OSS_BUSTYPE_PCI,
+									   h->pciBusNbr,
+									   (void *)&mm->vCtrlBase );
+		if( error )
+			return error;
+		DBGWRT_2((DBH," vCtrlBase for M-mod %d: 0x%08lx\n", mSlot,
+				  mm->vCtrlBase));
+
+		/* set up again (A12_RESET_REMAP): back in use, restore shadow */
+		if( mm->unmapped ){
+			mm->unmapped = FALSE;
+			A12_MEMBAR();
+			CtrlUpdate( h, mSlot, 0, 0 );
+		}
+	}
+
+	return 0;
+}
+
+/******************************** QspiAttach *********************************
+ *
+ *  Description:  Set up the interrupt check of the QSPI on first use
+ *
+ *                Maps the QSPI status register and arms the check in
+ *                A12_IrqSrvInit. Until then, IRQ9 is claimed without
+ *                check. Nothing to do with QSPI_IRQ_MASK=0.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 QspiAttach(
+	BBIS_HANDLE *h )
+{
+	int32 error;
+
+	if( h->qspi.vStat || !h->qspiIrqMask )
+		return 0;
+
+	error = OSS_MapPhysToVirtAddr( h->osHdl,
+								   (void*)((U_INT32_OR_64)h->physBase +
+										   h->qspiOffs + h->qspiIrqOffs),
+								   1, OSS_ADDRSPACE_MEM, OSS_BUSTYPE_PCI,
+								   h->pciBusNbr, (void *)&h->qspi.vStat );
+	if( error )
+		return error;
+
+	A12_MEMBAR();
+	h->irq.qspiMask = h->qspiIrqMask;
+	DBGWRT_2((DBH," QSPI status at 0x%08lx mask 0x%02x\n", h->qspi.vStat,
+			  h->qspiIrqMask));
+	return 0;
+}
+
+/*********************************** MAddr ***********************************
+ *
+ *  Description:  Physical address and size of an address space
+ *
+ *                Full width address arithmetic, so BARs above 4GB work.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number
+ *                addrMode	MDIS_MA08 | MDIS_MA24
+ *                dataMode	MDIS_MD16 | MDIS_MD32
+ *  Output.....:  baseP		physical address
+ *                sizeP		size of address space
+ *                return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 MAddr(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 addrMode,
+	u_int32 dataMode,
+	U_INT32_OR_64 *baseP,
+	u_int32 *sizeP )
+{
+	int32 cfgIdx = CFIDX(mSlot);
+	U_INT32_OR_64 base;
+	u_int32 offs, size;
+	int32 error;
+
+	/* check device number */
+	if( (cfgIdx<0) || (cfgIdx >= BRD_NBR_OF_BRDDEV )){
+		DBGWRT_ERR((DBH,"*** %s_GetMaddr: mSlot=0x%x not supported\n",
+					BBNAME,mSlot));
+		return ERR_BBIS_ILL_SLOT;
+	}
+	if( !((h->irq.enMask | h->quiesced) & (1 << cfgIdx)) ){
+		DBGWRT_ERR((DBH,"*** %s_GetMaddr: mSlot=0x%x disabled\n",
+					BBNAME,mSlot));
+		return ERR_BBIS_ILL_SLOT;
+	}
+
+	base = (U_INT32_OR_64)h->physBase +
+		(U_INT32_OR_64)cfgIdx * A12_MMOD_SLOT_OFFSET;
+
+	if( cfgIdx >= A12_NBR_OF_MMODS ){
+		/* QSPI */
+		if( (error = QspiAttach( h )) )
+			return error;
+
+		*baseP = (U_INT32_OR_64)h->physBase + h->qspiOffs;
+		*sizeP = h->qspiSize;
+		return 0;
+	}
+
+	/* M-module slots */
+	if( (error = SlotAttach( h, cfgIdx )) )
+		return error;
+
+	if( addrMode == MDIS_MA08 &&
+		(dataMode == MDIS_MD16 || dataMode == MDIS_MD08) ){
+		offs = A12_MMOD_A08_D16_BASE;
+		size = A12_MMOD_A08_SIZE;
+	}
+	else if( addrMode == MDIS_MA08 && dataMode == MDIS_MD32 ){
+		offs = A12_MMOD_A08_D32_BASE;
+		size = A12_MMOD_A08_SIZE;
+	}
+	else if( addrMode == MDIS_MA24 &&
+			 (dataMode == MDIS_MD16 || dataMode == MDIS_MD08) ){
+		offs = A12_MMOD_A24_D16_BASE;
+		size = A12_MMOD_A24_D16_SIZE;
+	}
+	else if( addrMode == MDIS_MA24 && dataMode == MDIS_MD32 ){
+		offs = A12_MMOD_A24_D32_BASE;
+		size = A12_MMOD_A24_D32_SIZE;
+	}
+	else {
+		DBGWRT_ERR((DBH,"*** %s_GetMAddr: addrMode=0x%x/dataMode=0x%x "
+					"not supported\n",
+					BBNAME,addrMode, dataMode));
+        return ERR_BBIS_ILL_ADDRMODE;
+	}
+
+	*baseP = base + offs;
+	*sizeP = size;
+	return 0;
+}
+
+/*********************************** MAttr ***********************************
+ *
+ *  Description:  View attributes allowed for an address space
+ *
+ *                Only the A24 windows may be write-combined, prefetchable
+ *                only if BAR0 is. Both must be allowed by SLOT_n_A24_ATTR.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number
+ *                addrMode	MDIS_MA08 | MDIS_MA24
+ *  Output.....:  return	A12_MATTR_xxx
+ *  Globals....:  -
+ ****************************************************************************/
+static u_int32 MAttr(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 addrMode )
+{
+	u_int32 attr;
+
+	if( mSlot >= A12_NBR_OF_MMODS || addrMode != MDIS_MA24 )
+		return 0;
+
+	attr = h->a24Attr[mSlot];
+	if( !h->barPrefetch )
+		attr &= ~A12_MATTR_PREFETCH;
+
+	return attr;
+}
+
+/********************************** BlkRead **********************************
+ *
+ *  Description:  Read a block from an address space of an M-module
+ *
+ *                See A12_BlkRead. SIMD bursts are only used in the A24
+ *                D32 window, A08 registers get 32-bit accesses.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number
+ *                addrMode	MDIS_MA08 | MDIS_MA24
+ *                dataMode	MDIS_MD16 | MDIS_MD32
+ *                offs		offset in address space
+ *                size		size [bytes]
+ *  Output.....:  buf		data read
+ *                return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 BlkRead(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 addrMode,
+	u_int32 dataMode,
+	u_int32 offs,
+	void *buf,
+	u_int32 size )
+{
+	u_int32 end = offs + size;
+	MACCESS ma;
+	int32 error;
+
+	if( (error = BlkWin( h, mSlot, addrMode, dataMode, offs, size, buf,
+						 &ma )) )
+		return error;
+	A12_RECORD( h, mSlot, A12_ROP_RDBLK, dataMode, size );
+
+	if( dataMode == MDIS_MD16 ){
+		u_int16 *b = (u_int16*)buf;
+
+		for( ; offs < end; offs += 2 )
+			*b++ = MREAD_D16( ma, offs );
+		return 0;
+	}
+	else {
+		u_int32 *b = (u_int32*)buf;
+
+#ifdef A12_BLK_SIMD
+		for( ; addrMode == MDIS_MA24 && (offs & 0xf) && offs < end; offs += 4 )
+			*b++ = MREAD_D32( ma, offs );
+
+		for( ; addrMode == MDIS_MA24 && end - offs >= 64;
+			 offs += 64, b += 16 ){
+			__m128i r0 = A12_RD128( ma, offs );
+			__m128i r1 = A12_RD128( ma, offs + 16 );
+			__m128i r2 = A12_RD128( ma, offs + 32 );
+			__m128i r3 = A12_RD128( ma, offs + 48 );
+
+			_mm_storeu_si128( (__m128i*)b,		r0 );
+			_mm_storeu_si128( (__m128i*)b + 1,	r1 );
+			_mm_storeu_si128( (__m128i*)b + 2,	r2 );
+			_mm_storeu_si128( (__m128i*)b + 3,	r3 );
+		}
+
+		for( ; addrMode == MDIS_MA24 && end - offs >= 16; offs += 16, b += 4 )
+			_mm_storeu_si128( (__m128i*)b, A12_RD128( ma, offs ) );
+#endif
+		for( ; offs < end; offs += 4 )
+			*b++ = MREAD_D32( ma, offs );
+	}
+
+	return 0;
+}
+
+/********************************* BlkWrite **********************************
+ *
+ *  Description:  Write a block to an address space of an M-module
+ *
+ *                See BlkRead.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number
+ *                addrMode	MDIS_MA08 | MDIS_MA24
+ *                dataMode	MDIS_MD16 | MDIS_MD32
+ *                offs		offset in address space
+ *                buf		data to write
+ *                size		size [bytes]
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 BlkWrite(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 addrMode,
+	u_int32 dataMode,
+	u_int32 offs,
+	const void *buf,
+	u_int32 size )
+{
+	u_int32 end = offs + size;
+	MACCESS ma;
+	int32 error;
+
+	if( (error = BlkWin( h, mSlot, addrMode, dataMode, offs, size, buf,
+						 &ma )) )
+		return error;
+	A12_RECORD( h, mSlot, A12_ROP_WRBLK, dataMode, size );
+
+	if( dataMode == MDIS_MD16 ){
+		const u_int16 *b = (const u_int16*)buf;
+
+		for( ; offs < end; offs += 2 )
+			MWRITE_D16( ma, offs, *b++ );
+		return 0;
+	}
+	else {
+		const u_int32 *b = (const u_int32*)buf;
+
+#ifdef A12_BLK_SIMD
+		for( ; addrMode == MDIS_MA24 && (offs & 0xf) && offs < end; offs += 4 )
+			MWRITE_D32( ma, offs, *b++ );
+
+		for( ; addrMode == MDIS_MA24 && end - offs >= 64;
+			 offs += 64, b += 16 ){
+			__m128i r0 = _mm_loadu_si128( (const __m128i*)b );
+			__m128i r1 = _mm_loadu_si128( (const __m128i*)b + 1 );
+			__m128i r2 = _mm_loadu_si128( (const __m128i*)b + 2 );
+			__m128i r3 = _mm_loadu_si128( (const __m128i*)b + 3 );
+
+			A12_WR128( ma, offs,	  r0 );
+			A12_WR128( ma, offs + 16, r1 );
+			A12_WR128( ma, offs + 32, r2 );
+			A12_WR128( ma, offs + 48, r3 );
+		}
+
+		for( ; addrMode == MDIS_MA24 && end - offs >= 16; offs += 16, b += 4 )
+			A12_WR128( ma, offs, _mm_loadu_si128( (const __m128i*)b ) );
+#endif
+		for( ; offs < end; offs += 4 )
+			MWRITE_D32( ma, offs, *b++ );
+	}
+
+	return 0;
+}
+
+/*********************************** BlkWin **********************************
+ *
+ *  Description:  Check block transfer parameters and get the window
+ *
+ *                The window is mapped on first use. Concurrent first
+ *                callers may both map it, the loser unmaps its mapping.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number
+ *                addrMode	MDIS_MA08 | MDIS_MA24
+ *                dataMode	MDIS_MD16 | MDIS_MD32
+ *                offs		offset in window
+ *                size		size [bytes]
+ *                buf		user buffer (NULL: none)
+ *  Output.....:  maP		virtual base of window
+ *                return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 BlkWin(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 addrMode,
+	u_int32 dataMode,
+	u_int32 offs,
+	u_int32 size,
+	const void *buf,
+	MACCESS *maP )
+{
+	U_INT32_OR_64 base;
+	u_int32 idx, wsize, align;
+	MACCESS ma = NULL;
+	int32 error;
+
+	if( mSlot >= A12_NBR_OF_MMODS )
+		return ERR_BBIS_ILL_SLOT;
+
+	switch( dataMode ){
+	case MDIS_MD32:	idx = A12_WIN_D32; align = 3;	break;
+	case MDIS_MD16:	idx = A12_WIN_D16; align = 1;	break;
+	default:		return ERR_BBIS_ILL_DATAMODE;
+	}
+	if( addrMode == MDIS_MA08 )
+		idx += A12_WIN_A08;
+
+	if( (error = MAddr( h, mSlot, addrMode, dataMode, &base, &wsize )) )
+		return error;
+
+	if( ((offs | size | (u_int32)(U_INT32_OR_64)buf) & align) ||
+		offs > wsize || size > wsize - offs )
+		return ERR_BBIS_ILL_PARAM;
+
+	if( h->mmod[mSlot].vWin[idx] == NULL ){
+		error = OSS_MapPhysToVirtAddr( h->osHdl, (void*)base, wsize,
+									   OSS_ADDRSPACE_MEM, OSS_BUSTYPE_PCI,
+									   h->pciBusNbr,
+									   (void*)&ma );
+		if( error )
+			return error;
+
+		if( !A12_ATOMIC_CASPTR( &h->mmod[mSlot].vWin[idx], NULL, ma ) )
+			OSS_UnMapVirtAddr( h->osHdl, (void**)&ma, wsize,
+							   OSS_ADDRSPACE_MEM );
+	}
+
+	*maP = h->mmod[mSlot].vWin[idx];
+	return 0;
+}
+
+#ifdef A12_OS_WORKERS
+/********************************* SgFlush ***********************************
+ *
+ *  Description:  Move completions which did not fit into the ring into it
+ *
+ *                Caller must own the queue (busy).
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  q			SG queue of the slot
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void SgFlush(
+	A12_SG_QUEUE *q )
+{
+	A12_SG_REQ *req;
+
+	while( q->ovfl && q->head - q->tail < A12_SG_RING ){
+		req = q->ovfl;
+		q->ovfl = req->next;
+		q->ring[q->head % A12_SG_RING] = req;
+		A12_MEMBAR();
+		q->head++;
+	}
+}
+
+/********************************* SgQueue ***********************************
+ *
+ *  Description:  Execute the queued requests of a slot
+ *
+ *                Requests are taken in submission order. Consecutive
+ *                elements with the same direction and modes, adjacent in
+ *                the address space and in memory, are passed to the
+ *                backend as one run, even across requests. A failing run
+ *                sets the status of all requests it contains. A request
+ *                is completed when its last run is done.
+ *
+ *                Called by the SG worker, which owns the queue (busy).
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *                be		copy backend
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void SgQueue(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	const A12_SG_BACKEND *be )
+{
+	A12_SG_QUEUE *q = &h->sg[mSlot];
+	A12_SG_REQ *list, *req, *next, *first = NULL, *last = NULL;
+	A12_SG_ELEM *e;
+	u_int32 n = 0, dir = 0, addrMode = 0, dataMode = 0, offs = 0, size = 0;
+	u_int8 *buf = NULL;
+	int32 error;
+
+	/* completions which did not fit into the ring last time */
+	SgFlush( q );
+
+	/* take all submitted requests, oldest first */
+	do {
+		list = q->submit;
+	} while( list && !A12_ATOMIC_CASPTR( &q->submit, list, NULL ) );
+
+	if( list == NULL )
+		return;
+
+	for( req = NULL; list; list = next ){
+		next = list->next;
+		list->next = req;
+		req = list;
+	}
+	list = req;
+	q->stat.runs++;
+
+	for(;;){
+		/* next element, NULL at the end */
+		while( req && n >= req->nElem ){
+			req = req->next;
+			n = 0;
+		}
+		e = req ? &req->elem[n] : NULL;
+
+		if( e && size && req->dir == dir && req->addrMode == addrMode &&
+			req->dataMode == dataMode && e->offs == offs + size &&
+			(u_int8*)e->buf == buf + size ){
+			size += e->size;
+			last = req;
+			n++;
+			continue;
+		}
+
+		/* execute the current run */
+		if( size ){
+			error = be->xfer( be->arg, mSlot, dir, addrMode, dataMode,
+							  offs, buf, size );
+			q->stat.xfers++;
+
+			for( ; error; first = first->next ){
+				if( !first->status )
+					first->status = error;
+				if( first == last )
+					break;
+			}
+		}
+
+		/* all requests before the current one are done */
+		while( list != req ){
+			next = list->next;
+			SgDone( q, list );
+			list = next;
+		}
+
+		if( e == NULL )
+			break;
+
+		/* start a new run */
+		first	 = last = req;
+		dir		 = req->dir;
+		addrMode = req->addrMode;
+		dataMode = req->dataMode;
+		offs	 = e->offs;
+		buf		 = (u_int8*)e->buf;
+		size	 = e->size;
+		n++;
+	}
+}
+
+/********************************** SgDone ***********************************
+ *
+ *  Description:  Complete a request
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  q			SG queue of the slot
+ *                req		request
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void SgDone(
+	A12_SG_QUEUE *q,
+	A12_SG_REQ *req )
+{
+	if( req->status )
+		q->stat.errors++;
+
+	if( req->callback ){
+		req->callback( req, req->cbArg );
+		return;
+	}
+
+	if( q->ovfl == NULL && q->head - q->tail < A12_SG_RING ){
+		q->ring[q->head % A12_SG_RING] = req;
+		A12_MEMBAR();
+		q->head++;
+		return;
+	}
+
+	/* ring full, keep order */
+	req->next = NULL;
+	if( q->ovfl )
+		q->ovflTail->next = req;
+	else
+		q->ovfl = req;
+	q->ovflTail = req;
+}
+
+/********************************** SgCopy ***********************************
+ *
+ *  Description:  Default SG backend, CPU accesses
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  arg		board handle
+ *                mSlot		M-module slot
+ *                dir		A12_SG_READ | A12_SG_WRITE
+ *                addrMode	MDIS_MA08 | MDIS_MA24
+ *                dataMode	MDIS_MD16 | MDIS_MD32
+ *                offs		offset in address space
+ *                buf		memory buffer
+ *                size		size [bytes]
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 SgCopy(
+	void *arg,
+	u_int32 mSlot,
+	u_int32 dir,
+	u_int32 addrMode,
+	u_int32 dataMode,
+	u_int32 offs,
+	void *buf,
+	u_int32 size )
+{
+	BBIS_HANDLE *h = (BBIS_HANDLE*)arg;
+
+	if( dir == A12_SG_WRITE )
+		return BlkWrite( h, mSlot, addrMode, dataMode, offs, buf, size );
+
+	return BlkRead( h, mSlot, addrMode, dataMode, offs, buf, size );
+}
+
+/********************************** PollSet **********************************
+ *
+ *  Description:  Configure hybrid IRQ/poll mode of a slot
+ *
+ *                Switching the mode off returns a polled slot to
+ *                interrupts, unless it is always polled (A12_POLICY_POLL).
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *                poll		hybrid mode on/off
+ *                on		IRQs per window to start polling
+ *                off		events per window to return to interrupts
+ *                winMs		rate window [ms]
+ *                period	poll period [us]
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 PollSet(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 poll,
+	u_int32 on,
+	u_int32 off,
+	u_int32 winMs,
+	u_int32 period )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 win;
+
+	if( poll && (on == 0 || off >= on || winMs == 0) )
+		return ERR_BBIS_ILL_PARAM;
+
+	win = winMs * OSS_TickRateGet( h->osHdl ) / 1000;
+
+	mm->pollOn		 = on;
+	mm->pollOff		 = off;
+	mm->pollWinMs	 = winMs;
+	mm->pollWin		 = win ? win : 1;
+	mm->pollPeriod	 = period;
+	mm->pollEvents	 = 0;
+	mm->pollWinStart = (u_int32)OSS_TickGet( h->osHdl );
+	mm->poll		 = poll ? TRUE : FALSE;
+
+	if( !poll && !(h->irq.pollFix & (1 << mSlot)) &&
+		(h->irq.pollMask & (1 << mSlot)) )
+		PollSwitch( h, mSlot, FALSE );
+
+	DBGWRT_2((DBH," mSlot %d: poll=%d on=%d off=%d window=%dms period=%dus\n",
+			  mSlot, mm->poll, on, off, winMs, period));
+	return 0;
+}
+
+/********************************* PollCheck *********************************
+ *
+ *  Description:  Switch between interrupts and polling at end of a rate
+ *                window
+ *
+ *                The event count is scaled to the window length, so a
+ *                window stretched by a quiet slot (no interrupt, no poll)
+ *                does not look busier than it was. Only one caller
+ *                evaluates a window.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void PollCheck(
+	BBIS_HANDLE *h,
+	u_int32 mSlot )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 now, start, elapsed, events;
+
+	/* always polled (A12_POLICY_POLL) */
+	if( h->irq.pollFix & (1 << mSlot) )
+		return;
+
+	now = (u_int32)OSS_TickGet( h->osHdl );
+	start = mm->pollWinStart;
+	elapsed = now - start;
+
+	if( elapsed < mm->pollWin || !A12_ATOMIC_CAS( &mm->pollWinStart, start,
+												   now ) )
+		return;
+
+	events = (u_int32)((u_int64)A12_ATOMIC_FETCH_AND( &mm->pollEvents, 0 ) *
+					   mm->pollWin / elapsed);
+
+	if( !(h->irq.pollMask & (1 << mSlot)) ){
+		if( events >= mm->pollOn )
+			PollSwitch( h, mSlot, TRUE );
+	}
+	else if( events <= mm->pollOff )
+		PollSwitch( h, mSlot, FALSE );
+}
+/******************************** PollSwitch *********************************
+ *
+ *  Description:  Switch a slot between interrupts and polling
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *                poll		TRUE: start polling, FALSE: back to interrupts
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void PollSwitch(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 poll )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	A12_DEV_STAT *st = &h->stat[mSlot];
+	u_int32 bit = 1 << mSlot;
+
+	if( poll ){
+		if( A12_ATOMIC_FETCH_OR( &h->irq.pollMask, bit ) & bit )
+			return;
+		A12_ATOMIC_FETCH_OR( &mm->maskReasons, A12_MASK_POLL );
+		A12_ATOMIC_FETCH_ADD( &st->s.toPoll, 1 );
+	}
+	else {
+		if( !(A12_ATOMIC_FETCH_AND( &h->irq.pollMask, ~bit ) & bit) )
+			return;
+		A12_ATOMIC_FETCH_AND( &mm->maskReasons, ~A12_MASK_POLL );
+		A12_ATOMIC_FETCH_ADD( &st->s.toIrq, 1 );
+	}
+	IenApply( h, mSlot );
+
+	A12_TRACE( h, mSlot, poll ? A12_TEV_TOPOLL : A12_TEV_TOIRQ, mm->ctrl,
+			   0 );
+}
+#endif /* A12_OS_WORKERS */
+
+/********************************* StormSet **********************************
+ *
+ *  Description:  Configure IRQ storm detection of a slot
+ *
+ *                Switching detection off ends a running quarantine. A new
+ *                configuration starts again with the first quarantine
+ *                time.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *                irqs		IRQs per window seen as storm, 0=off
+ *                winMs		storm window [ms]
+ *                time		first quarantine [ms]
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 StormSet(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 irqs,
+	u_int32 winMs,
+	u_int32 time )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 win;
+	int32 error;
+
+	if( winMs == 0 || time == 0 || time > A12_STORM_TIME_MAX )
+		return ERR_BBIS_ILL_PARAM;
+
+	if( irqs && !mm->stormAlarm ){
+		error = OSS_AlarmCreate( h->osHdl, StormAlarm, (void*)mm,
+								 &mm->stormAlarm );
+		if( error )
+			return error;
+	}
+
+	win = winMs * OSS_TickRateGet( h->osHdl ) / 1000;
+
+	mm->stormWinMs	  = winMs;
+	mm->stormWin	  = win ? win : 1;
+	mm->stormTime	  = time;
+	mm->stormShift	  = 0;
+	mm->stormEvents	  = 0;
+	mm->stormWinStart = (u_int32)OSS_TickGet( h->osHdl );
+	mm->stormIrqs	  = irqs;
+
+	if( !irqs && (mm->maskReasons & A12_MASK_STORM) ){
+		OSS_AlarmClear( h->osHdl, mm->stormAlarm );
+		mm->stormHoldoff = 0;
+		A12_ATOMIC_FETCH_AND( &mm->maskReasons, ~A12_MASK_STORM );
+		IenApply( h, mSlot );
+	}
+
+	DBGWRT_2((DBH," mSlot %d: IRQ storm irqs=%d window=%dms time=%dms\n",
+			  mSlot, irqs, winMs, time));
+	return 0;
+}
+
+/******************************** StormCheck *********************************
+ *
+ *  Description:  Count a serviced interrupt, quarantine the slot on a storm
+ *
+ *                SLOT_n_STORM_IRQS interrupts within one window clear IEN
+ *                for stormTime << stormShift milliseconds, the shift grows
+ *                with each storm. A window ending below the threshold
+ *                resets the shift. Only one caller starts a quarantine or
+ *                a new window.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void StormCheck(
+	BBIS_HANDLE *h,
+	u_int32 mSlot )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 now, start, events, ms, realMsec;
+
+	events = A12_ATOMIC_FETCH_ADD( &mm->stormEvents, 1 ) + 1;
+	now = (u_int32)OSS_TickGet( h->osHdl );
+	start = mm->stormWinStart;
+
+	/* end of window (at least stormWin ticks), a quiet one ends the backoff */
+	if( now - start > mm->stormWin ){
+		if( A12_ATOMIC_CAS( &mm->stormWinStart, start, now ) ){
+			mm->stormEvents = 0;
+			if( events < mm->stormIrqs )
+				mm->stormShift = 0;
+		}
+		return;
+	}
+
+	if( events < mm->stormIrqs ||
+		(A12_ATOMIC_FETCH_OR( &mm->maskReasons, A12_MASK_STORM ) &
+		 A12_MASK_STORM) )
+		return;
+
+	mm->stormEvents = 0;
+	ms = mm->stormTime << mm->stormShift;
+	if( mm->stormShift < A12_STORM_MAX_SHIFT )
+		mm->stormShift++;
+	mm->stormHoldoff = ms;
+
+	IenApply( h, mSlot );
+	OSS_AlarmSet( h->osHdl, mm->stormAlarm, ms, FALSE, &realMsec );
+	A12_ATOMIC_FETCH_ADD( &h->stat[mSlot].s.storms, 1 );
+	A12_TRACE( h, mSlot, A12_TEV_STORM, mm->ctrl, ms );
+}
+
+/******************************** StormAlarm *********************************
+ *
+ *  Description:  End of IRQ storm quarantine, restore IEN
+ *
+ *                Reports the storm and starts a new window, so the next
+ *                storm doubles the quarantine.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  arg		MMOD of the slot
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void StormAlarm(
+	void *arg )
+{
+	MMOD *mm = (MMOD*)arg;
+	BBIS_HANDLE *h = (BBIS_HANDLE*)mm->brdHdl;
+
+	DBGWRT_ERR((DBH,"*** %s: mSlot %d IRQ storm, IEN was off for %dms, "
+				"retry\n", BBNAME, mm->slot, mm->stormHoldoff));
+
+	mm->stormEvents	  = 0;
+	mm->stormWinStart = (u_int32)OSS_TickGet( h->osHdl );
+	mm->stormHoldoff  = 0;
+	A12_ATOMIC_FETCH_AND( &mm->maskReasons, ~A12_MASK_STORM );
+	IenApply( h, mm->slot );
+}
+
+/********************************* ScanOrder *********************************
+ *
+ *  Description:  Sort the M-module slots for the interrupt scan
+ *
+ *                Higher SLOT_n_SCAN_PRIO first, the lower slot number on a
+ *                tie. With adaptive set, the claim score decides first.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                adaptive	sort by claim score
+ *  Output.....:  return	order, A12_SCAN_SLOT places
+ *  Globals....:  -
+ ****************************************************************************/
+static u_int32 ScanOrder(
+	BBIS_HANDLE *h,
+	u_int32 adaptive )
+{
+	u_int32 key[A12_NBR_OF_MMODS], now = 0, age, score, order = 0, n, i, best;
+	u_int32 left = (1 << A12_NBR_OF_MMODS) - 1;
+
+	if( adaptive )
+		now = (u_int32)OSS_TickGet( h->osHdl );
+
+	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
+		key[i] = h->slotCfg[i].scanPrio;
+		if( adaptive ){
+			age	  = now - h->mmod[i].scanTick;
+			score = age < 32 ? h->mmod[i].scanScore >> age : 0;
+			if( score > A12_SCAN_SCORE_MAX )
+				score = A12_SCAN_SCORE_MAX;
+			key[i] |= score << 8;
+		}
+	}
+
+	for( n=0; n<A12_NBR_OF_MMODS; n++ ){
+		for( best=0; !(left & (1 << best)); best++ )
+			;
+		for( i=best+1; i<A12_NBR_OF_MMODS; i++ )
+			if( (left & (1 << i)) && key[i] > key[best] )
+				best = i;
+		left &= ~(1 << best);
+		order |= best << (4*n);
+	}
+
+	return order | (A12_SCAN_END << (4*n));
+}
+
+/********************************** ScanHit **********************************
+ *
+ *  Description:  Count a claimed interrupt for the adaptive scan order
+ *
+ *                The score halves each tick, so it follows the recent
+ *                claim rate. Concurrent claims of one slot may lose a hit,
+ *                the order is a hint only.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void ScanHit(
+	BBIS_HANDLE *h,
+	u_int32 mSlot )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 now = (u_int32)OSS_TickGet( h->osHdl ), age = now - mm->scanTick;
+
+	mm->scanScore = (age < 32 ? mm->scanScore >> age : 0) + A12_SCAN_HIT;
+	mm->scanTick  = now;
+}
+
+/********************************* PolicySet *********************************
+ *
+ *  Description:  Set the interrupt policy of a slot
+ *
+ *                A12_POLICY_POLL puts the slot in polling mode for good,
+ *                A12_POLICY_IRQ returns it to interrupts, or leaves the
+ *                decision to the hybrid IRQ/poll mode if that is on.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *                policy	A12_POLICY_xxx
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 PolicySet(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 policy )
+{
+#ifdef A12_OS_WORKERS
+	u_int32 bit = 1 << mSlot;
+#endif
+
+	if( policy > A12_POLICY_POLL )
+		return ERR_BBIS_ILL_PARAM;
+#ifndef A12_OS_WORKERS
+	/* no poller */
+	if( policy == A12_POLICY_POLL )
+		return ERR_BBIS_ILL_PARAM;
+#endif
+
+	h->slotCfg[mSlot].policy = policy;
+
+#ifdef A12_OS_WORKERS
+	if( policy == A12_POLICY_POLL ){
+		A12_ATOMIC_FETCH_OR( &h->irq.pollFix, bit );
+		PollSwitch( h, mSlot, TRUE );
+	}
+	else if( (A12_ATOMIC_FETCH_AND( &h->irq.pollFix, ~bit ) & bit) &&
+			 !h->mmod[mSlot].poll )
+		PollSwitch( h, mSlot, FALSE );
+#endif
+
+	DBGWRT_2((DBH," mSlot %d: policy=%d\n", mSlot, policy));
+	return 0;
+}
+
+/******************************** SlotEnable *********************************
+ *
+ *  Description:  Enable or disable a device
+ *
+ *                A disabled M-module slot keeps its resources and mappings,
+ *                its control register is set to the safe state. Fails
+ *                while the bridge is suspended or the slot is quiesced.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number
+ *                enable	TRUE: enable
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 SlotEnable(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 enable )
+{
+	int32 idx = CFIDX(mSlot);
+	u_int32 bit;
+
+	if( idx < 0 || idx >= BRD_NBR_OF_BRDDEV )
+		return ERR_BBIS_ILL_SLOT;
+	bit = 1 << idx;
+	if( h->suspended || (h->quiesced & bit) )
+		return ERR_BBIS_ILL_PARAM;
+
+	h->resValid &= ~bit;
+
+	if( enable ){
+		h->slotCfg[idx].enable = TRUE;
+		A12_ATOMIC_FETCH_OR( &h->irq.enMask, bit );
+		return 0;
+	}
+
+	/* in use */
+	if( idx < A12_NBR_OF_MMODS && (h->irq.ienMask & bit) )
+		return ERR_BBIS_ILL_PARAM;
+
+	h->slotCfg[idx].enable = FALSE;
+	A12_ATOMIC_FETCH_AND( &h->irq.enMask, ~bit );
+
+	/* safe state, as A12_BrdExit */
+	if( idx < A12_NBR_OF_MMODS && (h->attached & bit) && h->brdUp )
+		CtrlUpdate( h, idx, A12_CTRL_TIMING(h->slotCfg[idx].timing), 0xff );
+
+	return 0;
+}
+
+/********************************** Suspend **********************************
+ *
+ *  Description:  Suspend or resume the bridge
+ *
+ *                Suspend clears IEN of all set up slots (mask reason
+ *                A12_MASK_SUSPEND) and hides the enabled devices from
+ *                the interrupt and poll paths, which then neither claim
+ *                nor touch the bridge. Queued deferred work is dropped,
+ *                a module still asserting interrupts again after resume.
+ *                The control register shadows hold the state to restore.
+ *
+ *                Resume checks the bridge IDs (the bridge must be back at
+ *                its place with BAR0 unchanged) and writes the shadows,
+ *                IEN as the drivers left it, one write per slot.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                suspend	TRUE: suspend, FALSE: resume
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 Suspend(
+	BBIS_HANDLE *h,
+	u_int32 suspend )
+{
+	u_int32 mSlot, slots;
+	int32 error;
+
+	suspend = suspend ? TRUE : FALSE;
+	if( suspend == h->suspended )
+		return 0;
+
+	if( suspend ){
+		h->enSave = h->irq.enMask;
+		h->suspended = TRUE;
+		h->irq.enMask = 0;
+		A12_MEMBAR();
+
+#ifdef A12_OS_WORKERS
+		for( mSlot=0; mSlot<A12_DEFER_QUEUES; mSlot++ )
+			A12_ATOMIC_FETCH_AND( &h->dq[mSlot].mask, 0 );
+#endif
+
+		slots = h->attached & h->enSave;
+		for( mSlot=0; mSlot<A12_NBR_OF_MMODS; mSlot++ ){
+			if( !(slots & (1 << mSlot)) )
+				continue;
+			A12_ATOMIC_FETCH_AND( &h->mmod[mSlot].maskReasons,
+								  ~A12_MASK_DEFER );
+			A12_ATOMIC_FETCH_OR( &h->mmod[mSlot].maskReasons,
+								 A12_MASK_SUSPEND );
+			IenApply( h, mSlot );
+		}
+		DBGWRT_2((DBH," suspended, enabled 0x%x\n", h->enSave));
+		return 0;
+	}
+
+	if( (error = BridgeCheck( h )) )
+		return error;
+
+	h->irq.enMask = h->enSave;
+	h->suspended = FALSE;
+	A12_MEMBAR();
+
+	slots = h->attached & h->enSave;
+	for( mSlot=0; mSlot<A12_NBR_OF_MMODS; mSlot++ ){
+		if( !(slots & (1 << mSlot)) )
+			continue;
+		A12_ATOMIC_FETCH_AND( &h->mmod[mSlot].maskReasons,
+							  ~A12_MASK_SUSPEND );
+		IenApply( h, mSlot );
+	}
+	DBGWRT_2((DBH," resumed, IEN 0x%x\n", h->irq.ienMask & slots));
+	return 0;
+}
+
+/********************************* SlotReset *********************************
+ *
+ *  Description:  Reset an M-module slot while the other slots stay in
+ *                service
+ *
+ *                The steps are done in the order of the A12_RESET_xxx bits:
+ *
+ *                A12_RESET_QUIESCE clears IEN (mask reason A12_MASK_RESET)
+ *                and takes the slot out of the IRQ and poll paths, like a
+ *                disabled slot. Deferred work, a moderation holdoff and
+ *                the pending snapshot of the slot are dropped. The driver
+ *                may still access its module, e.g. to reset it.
+ *
+ *                A12_RESET_CTRL writes the safe state of A12_BrdInit to
+ *                the control register.
+ *
+ *                A12_RESET_REMAP unmaps the control register, releases
+ *                its resources and sets the slot up again, SLOT_n_xxx
+ *                descriptor keys included (see SlotAttach). It waits
+ *                for control register accesses of the IRQ and poll paths
+ *                on other CPUs to finish (CtrlGet), until the register
+ *                is mapped again they skip the slot. The windows of the
+ *                module are kept.
+ *
+ *                A12_RESET_ENABLE puts the slot back in service, IEN as
+ *                requested by its driver.
+ *
+ *                A12_RESET_CTRL and A12_RESET_REMAP need a quiesced slot.
+ *                After a failed step, the slot stays quiesced.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		M-module slot 0..A12_NBR_OF_MMODS-1
+ *                steps		A12_RESET_xxx
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 SlotReset(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 steps )
+{
+	MMOD *mm = &h->mmod[mSlot];
+	u_int32 bit = 1 << mSlot;
+#ifdef A12_OS_WORKERS
+	u_int32 i;
+#endif
+	int32 error;
+
+	if( mSlot >= A12_NBR_OF_MMODS )
+		return ERR_BBIS_ILL_SLOT;
+	if( h->suspended || (steps & ~A12_RESET_ALL) )
+		return ERR_BBIS_ILL_PARAM;
+	if( (error = SlotAttach( h, mSlot )) )
+		return error;
+
+	/*------------------------------------+
+	|  Quiesce                            |
+	+------------------------------------*/
+	if( (steps & A12_RESET_QUIESCE) && !(h->quiesced & bit) ){
+		A12_ATOMIC_FETCH_OR( &h->quiesced, bit );
+		A12_ATOMIC_FETCH_AND( &h->irq.enMask, ~bit );
+		A12_ATOMIC_FETCH_OR( &mm->maskReasons, A12_MASK_RESET );
+		A12_MEMBAR();
+
+		if( mm->modAlarm )
+			OSS_AlarmClear( h->osHdl, mm->modAlarm );
+		if( mm->stormAlarm )
+			OSS_AlarmClear( h->osHdl, mm->stormAlarm );
+#ifdef A12_OS_WORKERS
+		for( i=0; i<A12_DEFER_QUEUES; i++ )
+			A12_ATOMIC_FETCH_AND( &h->dq[i].mask, ~bit );
+#endif
+		A12_ATOMIC_FETCH_AND( &mm->maskReasons,
+							  ~(A12_MASK_MODERATE | A12_MASK_DEFER |
+								A12_MASK_STORM) );
+#ifdef A12_OS_WORKERS
+		A12_ATOMIC_FETCH_AND( &h->irq.irqPendValid, ~bit );
+		A12_ATOMIC_FETCH_AND( &h->irq.irqPend, ~bit );
+#endif
+		mm->modEvents	 = 0;
+		mm->stormEvents	 = 0;
+		mm->stormShift	 = 0;
+		mm->stormHoldoff = 0;
+
+		IenApply( h, mSlot );
+		DBGWRT_2((DBH," mSlot %d: quiesced\n", mSlot));
+	}
+
+	if( (steps & (A12_RESET_CTRL | A12_RESET_REMAP)) &&
+		!(h->quiesced & bit) )
+		return ERR_BBIS_ILL_PARAM;
+
+	/*------------------------------------+
+	|  Control register                   |
+	+------------------------------------*/
+	if( steps & A12_RESET_CTRL )
+		CtrlUpdate( h, mSlot, A12_CTRL_TIMING(h->slotCfg[mSlot].timing),
+					0xff );
+
+	/*------------------------------------+
+	|  Set up again                       |
+	+------------------------------------*/
+	if( steps & A12_RESET_REMAP ){
+		mm->unmapped = TRUE;
+		A12_MEMBAR();
+		while( mm->ctrlUsers )
+			OSS_MikroDelay( h->osHdl, 1 );
+
+		h->attached &= ~bit;
+		h->resValid &= ~bit;
+		OSS_UnMapVirtAddr( h->osHdl, (void **)&mm->vCtrlBase,
+						   A12_CTRL_SIZE, OSS_ADDRSPACE_MEM );
+#ifdef OSS_HAS_UNASSIGN_RESOURCES
+		if( h->resAssigned & bit )
+			OSS_UnAssignResources( h->osHdl, OSS_BUSTYPE_PCI,
+								   h->pciBusNbr, 1, &h->res[mSlot] );
+#endif
+		h->resAssigned &= ~bit;
+
+		if( (error = SlotAttach( h, mSlot )) )
+			return error;
+		DBGWRT_2((DBH," mSlot %d: set up again\n", mSlot));
+	}
+
+	/*------------------------------------+
+	|  Back in service                    |
+	+------------------------------------*/
+	if( (steps & A12_RESET_ENABLE) && (h->quiesced & bit) ){
+		A12_ATOMIC_FETCH_AND( &mm->maskReasons, ~A12_MASK_RESET );
+		A12_ATOMIC_FETCH_OR( &h->irq.enMask, bit );
+		A12_ATOMIC_FETCH_AND( &h->quiesced, ~bit );
+		A12_MEMBAR();
+
+		IenApply( h, mSlot );
+		DBGWRT_2((DBH," mSlot %d: back in service\n", mSlot));
+	}
+
+	return 0;
+}
+
+/********************************* WarmSave **********************************
+ *
+ *  Description:  Save the board state for A12_WarmInit
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *  Output.....:  w			saved board state
+ *  Globals....:  -
+ ****************************************************************************/
+static void WarmSave(
+	BBIS_HANDLE *h,
+	A12_WARM *w )
+{
+	int32 i;
+
+	OSS_MemFill( h->osHdl, sizeof(A12_WARM), (char*)w, 0 );
+
+	w->magic	   = A12_WARM_MAGIC;
+	w->version	   = A12_WARM_VERSION;
+	w->size		   = sizeof(A12_WARM);
+	w->pciBusNbr   = h->pciBusNbr;
+	w->pciDevNbr   = h->pciDevNbr;
+	w->physBase	   = (u_int64)(U_INT32_OR_64)h->physBase;
+	w->barPrefetch = h->barPrefetch;
+	w->irqValid	   = h->irqValid;
+	w->irqLevel	   = h->irqLevel;
+	w->irqVector   = h->irqVector;
+#ifdef A12_OS_WORKERS
+	w->irqDefer	   = h->irqDefer;
+#endif
+	w->irqCpus	   = h->irqCpus;
+	w->lazyInit	   = h->lazyInit;
+	w->scan		   = h->irq.scan;
+	w->qspiOffs	   = h->qspiOffs;
+	w->qspiSize	   = h->qspiSize;
+	w->qspiIrqOffs = h->qspiIrqOffs;
+	w->qspiIrqMask = h->qspiIrqMask;
+	w->attached	   = h->attached |
+		(h->qspi.vStat ? 1 << A12_NBR_OF_MMODS : 0);
+	w->ienMask	   = h->irq.ienMask;
+
+	for( i=0; i<BRD_NBR_OF_BRDDEV; i++ ){
+		if( h->slotCfg[i].enable )
+			w->enable |= 1 << i;
+		w->irqMode[i] = (u_int32)h->slotCfg[i].irqMode;
+	}
+
+	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
+		A12_WARM_SLOT *ws = &w->slot[i];
+		MMOD *mm = &h->mmod[i];
+
+		w->policy[i]   = h->slotCfg[i].policy;
+		w->timing[i]   = h->slotCfg[i].timing;
+		w->scanPrio[i] = h->slotCfg[i].scanPrio;
+		ws->ctrl	   = mm->ctrl & ~A12_CTRL_IEN;
+		ws->modBudget  = mm->modBudget;
+		ws->modTime	   = mm->modTime;
+#ifdef A12_OS_WORKERS
+		ws->poll	   = mm->poll;
+		ws->pollOn	   = mm->pollOn;
+		ws->pollOff	   = mm->pollOff;
+		ws->pollWinMs  = mm->pollWinMs;
+		ws->pollPeriod = mm->pollPeriod;
+#endif
+		ws->a24Attr	   = h->a24Attr[i];
+		ws->cpus	   = mm->cpus;
+		ws->stormIrqs  = mm->stormIrqs;
+		ws->stormWinMs = mm->stormWinMs;
+		ws->stormTime  = mm->stormTime;
+	}
+}
+
+/********************************** SlotRes **********************************
+ *
+ *  Description:  Resources of an enabled device
+ *
+ *                Computed on the first call after the device was enabled
+ *                or its IRQ mode changed, later calls return the copy in
+ *                the handle: no level to vector conversion, no address
+ *                arithmetic. Attaches the device like A12_GetMAddr.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number
+ *  Output.....:  resP		device resources
+ *                return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 SlotRes(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	A12_SLOT_RES **resP )
+{
+	int32 idx = CFIDX(mSlot);
+	A12_SLOT_CFG *cfg;
+	A12_SLOT_RES *res;
+	U_INT32_OR_64 base;
+	u_int32 i, addrMode, dataMode;
+	int32 error;
+
+	if( idx < 0 || idx >= BRD_NBR_OF_BRDDEV )
+		return ERR_BBIS_ILL_SLOT;
+	cfg = &h->slotCfg[idx];
+	if( !cfg->enable )
+		return ERR_BBIS_ILL_SLOT;
+
+	res = *resP = &h->slotRes[idx];
+	if( h->resValid & (1 << idx) )
+		return 0;
+
+	OSS_MemFill( h->osHdl, sizeof(A12_SLOT_RES), (char*)res, 0 );
+	res->mSlot		= mSlot;
+	res->enable		= TRUE;
+	res->devBusType	= cfg->devBusType;
+	res->interrupts	= cfg->interrupts;
+	res->addrSpace	= cfg->addrSpace;
+	res->busNbr		= cfg->pciBusNbr >= 0 ? cfg->pciBusNbr : h->pciBusNbr;
+	res->pciDevNbr	= cfg->pciDevNbr >= 0 ? cfg->pciDevNbr : h->pciDevNbr;
+	res->irqMode	= cfg->irqMode;
+
+	/* interrupt */
+	if( cfg->irqLevel == -1 ){
+		if( (error = IrqAttach( h )) )
+			return error;
+		res->irqLevel  = h->irqLevel;
+		res->irqVector = h->irqVector;
+	}
+	else {
+		res->irqLevel = cfg->irqLevel;
+		error = OSS_IrqLevelToVector( h->osHdl, cfg->devBusType,
+									  cfg->irqLevel,
+									  (int32*)&res->irqVector );
+		if( error )
+			return error;
+	}
+
+	/* address spaces, QSPI: one window */
+	for( i=0; i<(idx < A12_NBR_OF_MMODS ? A12_RES_WINS : 1); i++ ){
+		addrMode = i < A12_RES_A24_D16 ? MDIS_MA08 : MDIS_MA24;
+		dataMode = i & 1 ? MDIS_MD32 : MDIS_MD16;
+
+		if( (error = MAddr( h, mSlot, addrMode, dataMode, &base,
+							&res->win[i].size )) )
+			return error;
+		res->win[i].phys = (u_int64)base;
+		res->win[i].attr = MAttr( h, mSlot, addrMode );
+	}
+
+	DBGWRT_2((DBH, " dev:%d : resources IRQ level=0x%x vector=0x%x\n",
+			  idx, res->irqLevel, res->irqVector));
+	h->resValid |= 1 << idx;
+	return 0;
+}
+
+/********************************* TraceRec **********************************
+ *
+ *  Description:  Record an event in the trace ring of the current CPU
+ *
+ *                Called through A12_TRACE only while the trace is on.
+ *                The entry is reserved with an atomic increment, so an
+ *                interrupt nesting into a recording on the same CPU gets
+ *                its own entry. ev is written last, an entry with ev=0 is
+ *                still being written and not drained yet.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number
+ *                ev		A12_TEV_xxx
+ *                ctrl		control register value
+ *                ret		return code/mask
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void TraceRec(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 ev,
+	u_int32 ctrl,
+	int32 ret )
+{
+	u_int32 cpu = A12_CPU_ID();
+	A12_TRACE_RING *r = &h->trRing[cpu % A12_TRACE_CPUS];
+	A12_TRACE_EV *e;
+
+	e = &r->ev[A12_ATOMIC_FETCH_ADD( &r->head, 1 ) % A12_TRACE_ENTRIES];
+	e->ev	= 0;
+	e->time	= A12_CYCLES(h);
+	e->ret	= ret;
+	e->dev	= (u_int8)CFIDX(mSlot);
+	e->ctrl	= (u_int8)ctrl;
+	e->cpu	= (u_int8)cpu;
+	A12_MEMBAR();
+	e->ev	= (u_int8)ev;
+}
+
+/********************************** TraceOn **********************************
+ *
+ *  Description:  Switch the event trace on or off
+ *
+ *                The rings are allocated when the trace is switched on
+ *                the first time and emptied on each switch on.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                on		TRUE: trace on
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 TraceOn(
+	BBIS_HANDLE *h,
+	u_int32 on )
+{
+	u_int32 size = sizeof(A12_TRACE_RING) * A12_TRACE_CPUS;
+
+#ifdef A12_NO_TRACE
+	if( on )
+		return ERR_BBIS_ILL_FUNC;			/* compiled out */
+#endif
+	if( !on || h->irq.trace ){
+		h->irq.trace = on;
+		return 0;
+	}
+
+	if( !h->trMem ){
+		h->trMem = OSS_MemGet( h->osHdl, size + A12_CACHE_LINE,
+							   &h->trMemSize );
+		if( !h->trMem )
+			return ERR_OSS_MEM_ALLOC;
+		h->trRing = (A12_TRACE_RING*)(((U_INT32_OR_64)h->trMem +
+									   A12_CACHE_LINE - 1) &
+									  ~(U_INT32_OR_64)(A12_CACHE_LINE - 1));
+	}
+	OSS_MemFill( h->osHdl, size, (char*)h->trRing, 0 );
+
+	A12_MEMBAR();
+	h->irq.trace = TRUE;
+	return 0;
+}
+
+/******************************** TraceDrain *********************************
+ *
+ *  Description:  Move recorded events out of the trace rings
+ *
+ *                Takes the events of each CPU in order. Events which were
+ *                overwritten since the last drain are counted as lost.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                buf		event buffer
+ *                max		size of buf [events]
+ *  Output.....:  return	number of events in buf
+ *  Globals....:  -
+ ****************************************************************************/
+static u_int32 TraceDrain(
+	BBIS_HANDLE *h,
+	A12_TRACE_EV *buf,
+	u_int32 max )
+{
+	A12_TRACE_RING *r;
+	A12_TRACE_EV *e;
+	u_int32 cpu, head, n = 0;
+
+	for( cpu=0; h->trRing && cpu<A12_TRACE_CPUS && n<max; cpu++ ){
+		r = &h->trRing[cpu];
+		head = r->head;
+		A12_MEMBAR();
+
+		if( head - r->tail > A12_TRACE_ENTRIES ){
+			r->lost += head - r->tail - A12_TRACE_ENTRIES;
+			r->tail = head - A12_TRACE_ENTRIES;
+		}
+
+		for( ; r->tail != head && n<max; r->tail++ ){
+			e = &r->ev[r->tail % A12_TRACE_ENTRIES];
+			if( !e->ev )
+				break;				/* being written */
+			buf[n++] = *e;
+		}
+	}
+	return n;
+}
+
+/********************************** RecAdd ***********************************
+ *
+ *  Description:  Record an access or entry point in the recording ring
+ *
+ *                Called through A12_RECORD only while recording is on.
+ *                All CPUs share the ring, so the records keep the order
+ *                of the accesses to the bridge. As in TraceRec, the entry
+ *                is reserved with an atomic increment and op is written
+ *                last.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                mSlot		module slot number | A12_REC_BRD
+ *                op		A12_ROP_xxx
+ *                arg		operation argument
+ *                val		operation value
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void RecAdd(
+	BBIS_HANDLE *h,
+	u_int32 mSlot,
+	u_int32 op,
+	u_int32 arg,
+	u_int32 val )
+{
+	A12_REC_RING *r = h->recRing;
+	A12_REC_ENT *e;
+
+	e = &r->ent[A12_ATOMIC_FETCH_ADD( &r->head, 1 ) % A12_REC_ENTRIES];
+	e->r.op		= 0;
+	e->time		= A12_CYCLES(h);
+	e->r.val	= val;
+	e->r.dev	= (u_int8)(mSlot < A12_NBR_OF_MMODS || mSlot == 0x1000 ?
+						   CFIDX(mSlot) : A12_REC_BRD);
+	e->r.arg	= (u_int8)arg;
+	e->r.cpu	= (u_int8)A12_CPU_ID();
+	A12_MEMBAR();
+	e->r.op		= (u_int8)op;
+}
+
+/*********************************** RecOn ***********************************
+ *
+ *  Description:  Switch the access recording on or off
+ *
+ *                The ring is allocated when recording is switched on the
+ *                first time and emptied on each switch on.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                on		TRUE: recording on
+ *  Output.....:  return	0 | error code
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 RecOn(
+	BBIS_HANDLE *h,
+	u_int32 on )
+{
+	u_int32 size = sizeof(A12_REC_RING);
+
+#ifdef A12_NO_REC
+	if( on )
+		return ERR_BBIS_ILL_FUNC;			/* compiled out */
+#endif
+	if( !on || h->irq.rec ){
+		h->irq.rec = on;
+		return 0;
+	}
+
+	if( !h->recMem ){
+		h->recMem = OSS_MemGet( h->osHdl, size + A12_CACHE_LINE,
+								&h->recMemSize );
+		if( !h->recMem )
+			return ERR_OSS_MEM_ALLOC;
+		h->recRing = (A12_REC_RING*)(((U_INT32_OR_64)h->recMem +
+									  A12_CACHE_LINE - 1) &
+									 ~(U_INT32_OR_64)(A12_CACHE_LINE - 1));
+	}
+	OSS_MemFill( h->osHdl, size, (char*)h->recRing, 0 );
+	h->recRing->cycOn	= A12_CYCLES(h);
+	h->recRing->tickOn	= (u_int32)OSS_TickGet( h->osHdl );
+
+	A12_MEMBAR();
+	h->irq.rec = TRUE;
+	return 0;
+}
+
+/********************************* RecDrain **********************************
+ *
+ *  Description:  Move recorded accesses out of the recording ring
+ *
+ *                Builds one chunk, see A12_REC_HDR. The absolute times of
+ *                the ring are converted to deltas; records of other CPUs
+ *                reserved earlier but stamped later get dt=0, so the
+ *                times of a chunk never run backwards. Records which were
+ *                overwritten since the last drain are counted as lost and
+ *                reported in the header of the next chunk.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    		pointer to board handle structure
+ *                buf		chunk buffer
+ *                size		size of buf [bytes], >= sizeof(A12_REC_HDR)
+ *  Output.....:  return	size of the chunk [bytes]
+ *  Globals....:  -
+ ****************************************************************************/
+static u_int32 RecDrain(
+	BBIS_HANDLE *h,
+	void *buf,
+	u_int32 size )
+{
+	A12_REC_RING *r = h->recRing;
+	A12_REC_HDR *hdr = (A12_REC_HDR*)buf;
+	A12_REC *rec = (A12_REC*)(hdr + 1);
+	A12_REC_ENT *e;
+	u_int32 head, max, n = 0;
+	u_int64 t = 0, dt;
+
+	OSS_MemFill( h->osHdl, sizeof(*hdr), (char*)hdr, 0 );
+	hdr->magic		= A12_REC_MAGIC;
+	hdr->version	= A12_REC_VERSION;
+	hdr->recSize	= sizeof(A12_REC);
+	hdr->cycNow		= A12_CYCLES(h);
+	hdr->tickNow	= (u_int32)OSS_TickGet( h->osHdl );
+	hdr->tickRate	= (u_int32)OSS_TickRateGet( h->osHdl );
+	if( !r )
+		return sizeof(*hdr);
+
+	hdr->cycOn	= r->cycOn;
+	hdr->tickOn	= r->tickOn;
+	max = (size - sizeof(*hdr)) / sizeof(A12_REC);
+
+	head = r->head;
+	A12_MEMBAR();
+
+	if( head - r->tail > A12_REC_ENTRIES ){
+		r->lost += head - r->tail - A12_REC_ENTRIES;
+		r->tail = head - A12_REC_ENTRIES;
+	}
+
+	for( ; r->tail != head && n<max; r->tail++, n++ ){
+		e = &r->ent[r->tail % A12_REC_ENTRIES];
+		if( !e->r.op )
+			break;					/* being written */
+
+		if( !n )
+			t = hdr->cycles = e->time;
+		dt = e->time > t ? e->time - t : 0;
+		if( dt > 0xffffffff )
+			dt = 0xffffffff;		/* saturated */
+		t += dt;
+
+		rec[n]		= e->r;
+		rec[n].dt	= (u_int32)dt;
+		e->r.op		= 0;
+	}
+
+	hdr->count	= n;
+	hdr->lost	= r->lost - r->lostRep;
+	r->lostRep	= r->lost;
+
+	return sizeof(*hdr) + n * sizeof(A12_REC);
+}
+
+/********************************* StatHist **********************************
+ *
+ *  Description:  Count service time in log2 histogram bucket
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  st		device statistics
+ *                cycles	service time in CPU cycles
+ *  Output.....:  -
+ *  Globals....:  -
+ ****************************************************************************/
+static void StatHist(
+	A12_DEV_STAT *st,
+	u_int64 cycles )
+{
+	u_int32 n = 0;
+
+	while( (cycles >>= 1) && n < A12_HIST_BUCKETS-1 )
+		n++;
+
+	A12_ATOMIC_FETCH_ADD( &st->s.hist[n], 1 );
+}
+
+#ifdef A12_OSS_ATOMIC
+/******************************** AtomicInit *********************************
+ *
+ *  Description:  Create the spin lock of the atomic operations
+ *
+ *                The first board creates it, the others share it. Called
+ *                from A12_Init/A12_WarmInit, which the OS layer does not
+ *                run concurrently.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  osHdl		os specific handle
+ *  Output.....:  return	0 | error code
+ *  Globals....:  G_atomOsHdl, G_atomLock, G_atomUsers
+ ****************************************************************************/
+static int32 AtomicInit(
+	OSS_HANDLE *osHdl )
+{
+	int32 error;
+
+	if( G_atomUsers == 0 ){
+		if( (error = OSS_SpinLockCreate( osHdl, &G_atomLock )) )
+			return error;
+		G_atomOsHdl = osHdl;
+	}
+	G_atomUsers++;
+	return 0;
+}
+
+/******************************** AtomicExit *********************************
+ *
+ *  Description:  Release the spin lock of the atomic operations
+ *
+ *                The last board removes it.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  -
+ *  Output.....:  -
+ *  Globals....:  G_atomOsHdl, G_atomLock, G_atomUsers
+ ****************************************************************************/
+static void AtomicExit( void )
+{
+	if( --G_atomUsers == 0 )
+		OSS_SpinLockRemove( G_atomOsHdl, &G_atomLock );
+}
+
+/********************************* AtomicOp **********************************
+ *
+ *  Description:  Atomic operation under the OSS spin lock
+ *
+ *                Stands in for the compiler atomics of A12_ATOMIC_xxx and
+ *                A12_MEMBAR, see a12_int.h. The spin lock also keeps the
+ *                accesses from being reordered across it.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  p			variable (NULL for A12_AOP_BAR)
+ *                v			operand, new value for A12_AOP_CAS
+ *                o			expected value for A12_AOP_CAS
+ *                op		A12_AOP_xxx
+ *  Output.....:  return	previous value of *p
+ *  Globals....:  G_atomOsHdl, G_atomLock
+ ****************************************************************************/
+static u_int32 AtomicOp(
+	volatile u_int32 *p,
+	u_int32 v,
+	u_int32 o,
+	u_int32 op )
+{
+	u_int32 old = 0;
+
+	OSS_SpinLockAcquire( G_atomOsHdl, G_atomLock );
+	if( p )
+		old = *p;
+
+	switch( op ){
+	case A12_AOP_OR:	*p = old | v;	break;
+	case A12_AOP_AND:	*p = old & v;	break;
+	case A12_AOP_ADD:	*p = old + v;	break;
+	case A12_AOP_CAS:
+		if( old == o )
+			*p = v;
+		break;
+	}
+	OSS_SpinLockRelease( G_atomOsHdl, G_atomLock );
+
+	return old;
+}
+
+/******************************* AtomicCasPtr ********************************
+ *
+ *  Description:  Pointer compare and swap under the OSS spin lock
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  p			pointer variable
+ *                o			expected value
+ *                n			new value
+ *  Output.....:  return	TRUE if *p was o and is now n
+ *  Globals....:  G_atomOsHdl, G_atomLock
+ ****************************************************************************/
+static int32 AtomicCasPtr(
+	void * volatile *p,
+	void *o,
+	void *n )
+{
+	int32 done = FALSE;
+
+	OSS_SpinLockAcquire( G_atomOsHdl, G_atomLock );
+	if( *p == o ){
+		*p = n;
+		done = TRUE;
+	}
+	OSS_SpinLockRelease( G_atomOsHdl, G_atomLock );
+
+	return done;
+}
+#endif /* A12_OSS_ATOMIC */
+
+/********************************* Cleanup **********************************
+ *
+ *  Description:  Close all handles, free memory and return error code
+ *
+ *		          NOTE: The h handle is invalid after calling this
+ *                      function.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......:  h    pointer to board handle structure
+ *                retCode	return value
+ *  Output.....:  return	retCode
+ *  Globals....:  -
+ ****************************************************************************/
+static int32 Cleanup(
+   BBIS_HANDLE  *h,
+   int32        retCode		/* nodoc */
+)
+{
 	int32 i;
 
     /*------------------------------+
@@ -1166,6 +5649,33 @@ static int32 Cleanup(
 	if (h->descHdl)
 		DESC_Exit(&h->descHdl);
 
+	/* remove moderation and storm alarms */
+	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
+		if( h->mmod[i].modAlarm )
+			OSS_AlarmRemove( h->osHdl, &h->mmod[i].modAlarm );
+		if( h->mmod[i].stormAlarm )
+			OSS_AlarmRemove( h->osHdl, &h->mmod[i].stormAlarm );
+	}
+
+	/* unmap windows of block transfers */
+	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
+		static const u_int32 size[A12_NBR_OF_WINS] = {
+			A12_MMOD_A24_D32_SIZE, A12_MMOD_A24_D16_SIZE,
+			A12_MMOD_A08_SIZE, A12_MMOD_A08_SIZE };
+		int32 n;
+
+		for( n=0; n<A12_NBR_OF_WINS; n++ ){
+			if( h->mmod[i].vWin[n] )
+				OSS_UnMapVirtAddr( h->osHdl, (void **)&h->mmod[i].vWin[n],
+								   size[n], OSS_ADDRSPACE_MEM );
+		}
+	}
+
+	/* unmap QSPI status register */
+	if( h->qspi.vStat )
+		OSS_UnMapVirtAddr( h->osHdl, (void **)&h->qspi.vStat, 1,
+						   OSS_ADDRSPACE_MEM );
+
 	/* unmap control registers */
 	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
 		if( h->mmod[i].vCtrlBase )
@@ -1174,18 +5684,31 @@ static int32 Cleanup(
 	}
 
 #ifdef OSS_HAS_UNASSIGN_RESOURCES
-	if( h->resourcesAssigned )
-		OSS_UnAssignResources( h->osHdl, OSS_BUSTYPE_PCI, 0,
-							   A12_NBR_OF_MMODS, h->res );
+	for( i=0; i<A12_NBR_OF_MMODS; i++ ){
+		if( h->resAssigned & (1 << i) )
+			OSS_UnAssignResources( h->osHdl, OSS_BUSTYPE_PCI,
+								   h->pciBusNbr, 1, &h->res[i] );
+	}
 #endif
 	/* cleanup debug */
 	DBGEXIT((&DBH));
 
+	/* release trace rings */
+	if( h->trMem )
+		OSS_MemFree( h->osHdl, (int8*)h->trMem, h->trMemSize );
+	if( h->recMem )
+		OSS_MemFree( h->osHdl, (int8*)h->recMem, h->recMemSize );
+
+#ifdef A12_OSS_ATOMIC
+	if( h->atomRef )
+		AtomicExit();
+#endif
+
     /*------------------------------+
     |  free memory                  |
     +------------------------------*/
     /* release memory for the board handle */
-    OSS_MemFree( h->osHdl, (int8*)h, h->ownMemSize);
+    OSS_MemFree( h->osHdl, (int8*)h->ownMem, h->ownMemSize);
     h = NULL;
 
     /*------------------------------+
@@ -35,6 +35,7 @@ MAK_SWITCH=$(SW_PREFIX)MAC_MEM_MAPPED	 	  \
 		$(SW_PREFIX)$(DEF_REVISION)
 
 MAK_INCL=$(MEN_INC_DIR)/bb_a12.h	\
+		 $(MEN_INC_DIR)/bb_a12_ext.h	\
 		 $(MEN_INC_DIR)/bb_defs.h	\
 		 $(MEN_INC_DIR)/bb_entry.h	\
 		 $(MEN_MOD_DIR)/a12_int.h	\
@@ -0,0 +1,58 @@
+#***************************  M a k e f i l e  *******************************
+#  
+#         Author: kp
+#  
+#    Description: Makefile definitions for the A12 BBIS host simulation
+#
+#                 Links the real A12 handler against the simulated bridge
+#                 and the OSS/DESC stand-ins of a12_sim.c.
+#                      
+#-----------------------------------------------------------------------------
+#   Copyright 2001-2019, MEN Mikro Elektronik GmbH
+#*****************************************************************************
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+MAK_NAME=a12_sim
+# the next line is updated during the MDIS installation
+STAMPED_REVISION="mdis_drivers_bbis_a12_com_01_44-0-gba51d18-dirty_2019-02-21"
+
+DEF_REVISION=MAK_REVISION=$(STAMPED_REVISION)
+
+MAK_LIBS=
+
+MAK_SWITCH=$(SW_PREFIX)MAC_MEM_MAPPED	 	  \
+		$(SW_PREFIX)A12_SIM			  \
+		$(SW_PREFIX)A12_OS_WORKERS	  \
+		$(SW_PREFIX)$(DEF_REVISION)
+
+MAK_INCL=$(MEN_INC_DIR)/bb_a12.h	\
+		 $(MEN_INC_DIR)/bb_a12_ext.h	\
+		 $(MEN_INC_DIR)/bb_defs.h	\
+		 $(MEN_INC_DIR)/bb_entry.h	\
+		 $(MEN_MOD_DIR)/a12_int.h	\
+		 $(MEN_INC_DIR)/a12_sim.h	\
+		 $(MEN_INC_DIR)/dbg.h		\
+		 $(MEN_INC_DIR)/desc.h		\
+		 $(MEN_INC_DIR)/mdis_api.h	\
+		 $(MEN_INC_DIR)/mdis_com.h	\
+		 $(MEN_INC_DIR)/mdis_err.h	\
+         $(MEN_INC_DIR)/men_typs.h	\
+         $(MEN_INC_DIR)/oss.h
+
+MAK_INP1=bb_a12$(INP_SUFFIX)
+MAK_INP2=a12_sim$(INP_SUFFIX)
+
+MAK_INP=$(MAK_INP1) \
+		$(MAK_INP2)
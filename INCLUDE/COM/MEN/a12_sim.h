@@ -0,0 +1,165 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: a12_sim.h
+ *
+ *       Author: kp
+ *
+ *  Description: Host-side simulator for the A12 PCI->M-module bridge
+ *
+ *               When the A12 BBIS is compiled with A12_SIM, the register
+ *               accessors of the handler are routed into the simulator and
+ *               the OSS/DESC functions it calls are provided by a12_sim.c
+ *               instead of the real libraries.
+ *
+ *     Switches: A12_SIM
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ******************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _A12_SIM_H
+#define _A12_SIM_H
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--------------------------------------------------------------------------+
+|    DEFINES                                                                |
++--------------------------------------------------------------------------*/
+#define A12SIM_NBR_OF_SLOTS		4			/* 3 M-module slots + QSPI */
+#define A12SIM_MAX_BRIDGES		4			/* bridges in the system */
+#define A12SIM_BAR0_DEFAULT		0xd0000000	/* BAR0 phys address of bridge 0 */
+#define A12SIM_IRQ_LINE_DEFAULT	11			/* PCI interrupt line of bridge 0 */
+
+/* BAR0 attributes (A12SIM_SetBar0) */
+#define A12SIM_BAR_64			0x04		/* 64-bit BAR */
+#define A12SIM_BAR_PREFETCH		0x08		/* prefetchable */
+#define A12SIM_BAR_OSS32		0x100		/* OSS drops the high dword */
+
+/* control register bits */
+#define A12SIM_CTRL_IRQ			0x01		/* IRQ pending (read only) */
+#define A12SIM_CTRL_IEN			0x02		/* IRQ enable */
+#define A12SIM_CTRL_FAST		0x0c		/* fast bits (bus timing) */
+
+/*---------------------------------------------------------------------------+
+|    TYPEDEFS                                                                |
++---------------------------------------------------------------------------*/
+/* simulated descriptor entry (DESC_SPEC of the simulation build) */
+typedef struct {
+	const char	*key;		/* descriptor key, NULL terminates the table */
+	u_int32		value;		/* key value */
+} A12SIM_DESC;
+
+/* per-access latency model */
+typedef struct {
+	u_int32		cfgNs;		/* PCI config space access */
+	u_int32		readNs;		/* non-posted memory read */
+	u_int32		writeNs;	/* posted memory write */
+	u_int32		beatNs;		/* each further DWORD of a burst */
+	u_int32		waitNs;		/* M-module access, each timing step below
+							   fast (fast bits of the control register) */
+	u_int32		spin;		/* TRUE: really burn the latency on the CPU */
+} A12SIM_LATENCY;
+
+/* access statistics */
+typedef struct {
+	u_int32		cfgReads;	/* PCI config space reads */
+	u_int32		reads;		/* memory reads */
+	u_int32		writes;		/* memory writes */
+	u_int32		maps;		/* OSS_MapPhysToVirtAddr calls */
+	u_int32		wcMaps;		/* write-combined mappings */
+	u_int32		unmaps;		/* OSS_UnMapVirtAddr calls */
+	u_int32		descKeys;	/* DESC_GetUInt32 lookups */
+	u_int32		irqVecs;	/* OSS_IrqLevelToVector calls */
+	u_int32		timingErrs;	/* M-module accesses with too fast timing */
+	u_int64		simNs;		/* accumulated simulated bus time */
+} A12SIM_STATS;
+
+/*---------------------------------------------------------------------------+
+|    PROTOTYPES                                                              |
++---------------------------------------------------------------------------*/
+/* simulator control */
+extern void  A12SIM_Reset( void );
+extern void  A12SIM_SetLatency( const A12SIM_LATENCY *lat );
+extern void  A12SIM_GetStats( A12SIM_STATS *stats );
+extern void  A12SIM_ClrStats( void );
+extern u_int64 A12SIM_Clock( void );
+extern void  A12SIM_Advance( u_int32 ns );
+extern void  A12SIM_SetCpu( u_int32 cpu );
+extern u_int32 A12SIM_CpuId( void );
+
+/* bridge model, bridge 0 is at bus 0 device 0x18 */
+extern int32 A12SIM_AddBridge( u_int32 bus, u_int32 dev );
+extern void  A12SIM_SelBridge( u_int32 idx );
+extern void  A12SIM_SetBar0( u_int64 addr, u_int32 attr );
+extern void  A12SIM_SetIrq( u_int32 slot, u_int32 level );
+extern u_int32 A12SIM_IrqAsserted( void );
+extern u_int8  A12SIM_CtrlPeek( u_int32 slot );
+extern void  A12SIM_PowerLoss( void );
+extern void  A12SIM_Poke8( u_int32 slot, u_int32 offs, u_int8 val );
+extern void  A12SIM_SetModTiming( u_int32 slot, u_int32 timing );
+
+/* register accessors used by the handler in the simulation build */
+extern u_int8  A12SIM_Read8( void *ma, u_int32 offs );
+extern u_int16 A12SIM_Read16( void *ma, u_int32 offs );
+extern u_int32 A12SIM_Read32( void *ma, u_int32 offs );
+extern void    A12SIM_Write8( void *ma, u_int32 offs, u_int8 val );
+extern void    A12SIM_Write16( void *ma, u_int32 offs, u_int16 val );
+extern void    A12SIM_Write32( void *ma, u_int32 offs, u_int32 val );
+#if defined(__SSE2__)
+extern __m128i A12SIM_Read128( void *ma, u_int32 offs );
+extern void    A12SIM_Write128( void *ma, u_int32 offs, __m128i val );
+#endif
+extern int32   A12SIM_MapWc( u_int64 phys, u_int32 size, void **virtP );
+extern void    A12SIM_UnMapWc( void *virt, u_int32 size );
+
+/*--------------------------------------------------------------------------+
+|    ACCESSOR OVERRIDES                                                     |
++--------------------------------------------------------------------------*/
+#ifdef A12_SIM
+# undef MREAD_D8
+# undef MREAD_D16
+# undef MREAD_D32
+# undef MWRITE_D8
+# undef MWRITE_D16
+# undef MWRITE_D32
+# undef MSETMASK_D8
+# undef MCLRMASK_D8
+
+# define MREAD_D8(ma,offs)			A12SIM_Read8((void*)(ma),(offs))
+# define MREAD_D16(ma,offs)			A12SIM_Read16((void*)(ma),(offs))
+# define MREAD_D32(ma,offs)			A12SIM_Read32((void*)(ma),(offs))
+# define MWRITE_D8(ma,offs,val)		A12SIM_Write8((void*)(ma),(offs),\
+												  (u_int8)(val))
+# define MWRITE_D16(ma,offs,val)	A12SIM_Write16((void*)(ma),(offs),\
+												   (u_int16)(val))
+# define MWRITE_D32(ma,offs,val)	A12SIM_Write32((void*)(ma),(offs),\
+												   (u_int32)(val))
+# define MSETMASK_D8(ma,offs,mask)	MWRITE_D8(ma,offs,MREAD_D8(ma,offs)|(mask))
+# define MCLRMASK_D8(ma,offs,mask)	MWRITE_D8(ma,offs,MREAD_D8(ma,offs)&~(mask))
+#endif /* A12_SIM */
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _A12_SIM_H */
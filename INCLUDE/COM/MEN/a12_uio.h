@@ -0,0 +1,84 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: a12_uio.h
+ *
+ *       Author: kp
+ *
+ *  Description: Userspace backend for the A12 PCI->M-module bridge
+ *
+ *               When the A12 BBIS is compiled with A12_UIO, it runs in a
+ *               Linux process: a12_uio.c provides the OSS/DESC functions
+ *               it calls. The bridge is found through sysfs, BAR0 is
+ *               mapped through its resource0 file, so control registers
+ *               and slot windows are accessed without system calls.
+ *               Write-combined views (SLOT_n_A24_ATTR) are mapped
+ *               through resource0_wc, which Linux only provides for a
+ *               prefetchable BAR0.
+ *
+ *               There is no interrupt. Set SLOT_n_IRQ_POLICY to
+ *               A12_POLICY_POLL for the slots used (IEN is then never set
+ *               and the bridge never asserts its PCI interrupt) and find
+ *               pending slots with A12_Poll, e.g. through A12UIO_IrqWait.
+ *
+ *               A12UIO_SetRoot points the backend at another sysfs tree,
+ *               e.g. a fake bridge whose resource0 is a plain file.
+ *
+ *     Switches: A12_UIO
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ******************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _A12_UIO_H
+#define _A12_UIO_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--------------------------------------------------------------------------+
+|    DEFINES                                                                |
++--------------------------------------------------------------------------*/
+#define A12UIO_ROOT_DEFAULT		"/sys"		/* sysfs mount point */
+#define A12UIO_PCI_DOMAIN		0			/* PCI domain searched */
+
+/*---------------------------------------------------------------------------+
+|    TYPEDEFS                                                                |
++---------------------------------------------------------------------------*/
+/* descriptor entry (DESC_SPEC of the userspace build) */
+typedef struct {
+	const char	*key;		/* descriptor key, NULL terminates the table */
+	u_int32		value;		/* key value */
+} A12UIO_DESC;
+
+/*---------------------------------------------------------------------------+
+|    PROTOTYPES                                                              |
++---------------------------------------------------------------------------*/
+extern void  A12UIO_SetRoot( const char *root );
+extern u_int32 A12UIO_CpuId( void );
+extern int32 A12UIO_MapWc( u_int64 phys, u_int32 size, void **virtP );
+extern void  A12UIO_UnMapWc( void *virt, u_int32 size );
+#ifdef _BB_ENTRY_H
+extern int32 A12UIO_IrqWait( BBIS_ENTRY *bb, BBIS_HANDLE *h,
+							 u_int32 timeoutUs, u_int32 *maskP );
+#endif
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _A12_UIO_H */
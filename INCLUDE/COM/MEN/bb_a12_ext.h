@@ -0,0 +1,569 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: bb_a12_ext.h
+ *
+ *       Author: kp
+ *
+ *  Description: Extended interface of the A12 BBIS
+ *
+ *               Entry points in otherwise unused jump table slots and
+ *               board specific status codes. Include after bb_entry.h.
+ *
+ *               The entry point types are hidden from the BBIS itself
+ *               (_NO_BBIS_HANDLE), which includes this file before its
+ *               handle is defined.
+ *
+ *     Switches: ---
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ******************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BB_A12_EXT_H
+#define _BB_A12_EXT_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--------------------------------------------------------------------------+
+|    DEFINES                                                                |
++--------------------------------------------------------------------------*/
+#define A12_NBR_OF_DEVS			4	/* M-module slots 0..2 + QSPI */
+#define A12_HIST_BUCKETS		32	/* log2 buckets of latency histograms */
+
+/* view attributes (A12_GetMAddrEx/A12_MapView), 0 = uncached */
+#define A12_MATTR_WC			0x01	/* write-combined */
+#define A12_MATTR_PREFETCH		0x02	/* prefetchable */
+
+/* A12_IrqPendMask: slots queued for deferred servicing */
+#define A12_PEND_DEFERRED		0x100
+
+/* scatter-gather requests (A12_SgSubmit) */
+#define A12_SG_READ				0		/* M-module -> memory */
+#define A12_SG_WRITE			1		/* memory -> M-module */
+#define A12_SG_RING				64		/* completion ring entries/slot */
+#define A12_SG_MORE				0x01	/* flags: queue only, more follow */
+
+/* windows of A12_SLOT_RES.win[] */
+#define A12_RES_A08_D16			0
+#define A12_RES_A08_D32			1
+#define A12_RES_A24_D16			2
+#define A12_RES_A24_D32			3
+#define A12_RES_WINS			4
+#define A12_RES_ALL				0xffffffff	/* A12_ResQuery: all devices */
+
+/* event trace (M_BB_A12_TRACE) */
+#define A12_TRACE_CPUS			8		/* rings, CPU n uses n % 8 */
+#define A12_TRACE_ENTRIES		256		/* events per ring */
+
+/* traced events, A12_TRACE_EV.ev */
+#define A12_TEV_SRVINIT			1		/* irqSrvInit, ret BBIS_IRQ_xxx */
+#define A12_TEV_SRVEXIT			2		/* irqSrvExit */
+#define A12_TEV_EXPSRV			3		/* expSrv, ret BBIS_IRQ_xxx */
+#define A12_TEV_PENDMASK		4		/* A12_IrqPendMask, ret mask */
+#define A12_TEV_POLL			5		/* A12_Poll, ret mask */
+#define A12_TEV_DEFER			6		/* slot queued for deferred worker */
+#define A12_TEV_CLAIM			7		/* A12_DeferClaim, ret mask */
+#define A12_TEV_HOLDOFF			8		/* IRQ moderation holdoff start */
+#define A12_TEV_TOPOLL			9		/* switched to polling */
+#define A12_TEV_TOIRQ			10		/* switched to interrupts */
+#define A12_TEV_STORM			11		/* IRQ storm, ret holdoff [ms] */
+
+/* saved board state (M_BB_A12_BLK_WARM) */
+#define A12_WARM_MAGIC			0x41313257	/* A12_WARM.magic "A12W" */
+#define A12_WARM_VERSION		3			/* A12_WARM.version */
+
+/* register access recording (REC_ENABLE / M_BB_A12_REC) */
+#define A12_REC_ENTRIES			4096	/* records in the ring */
+#define A12_REC_MAGIC			0x41313252	/* A12_REC_HDR.magic "A12R" */
+#define A12_REC_VERSION			1		/* A12_REC_HDR.version */
+#define A12_REC_BRD				0xff	/* A12_REC.dev: board, no device */
+
+/* recorded operations, A12_REC.op */
+#define A12_ROP_RD8				1		/* control/QSPI status read, val */
+#define A12_ROP_WR8				2		/* control register write, val */
+#define A12_ROP_RDBLK			3		/* block read, val bytes,
+										   arg dataMode */
+#define A12_ROP_WRBLK			4		/* block write/fill, as RDBLK */
+#define A12_ROP_ENTRY			5		/* entry point called, arg
+										   A12_REP_xxx, val 1st argument */
+#define A12_ROP_ARG				6		/* further arguments of ENTRY,
+										   val size, arg dataMode */
+#define A12_ROP_EXIT			7		/* entry point returns, arg
+										   A12_REP_xxx, val return/mask */
+
+/* recorded entry points, A12_REC.arg of A12_ROP_ENTRY/EXIT */
+#define A12_REP_IRQENABLE		1		/* val enable */
+#define A12_REP_SRVINIT			2		/* exit val BBIS_IRQ_xxx */
+#define A12_REP_SRVEXIT			3
+#define A12_REP_PENDMASK		4		/* exit val mask */
+#define A12_REP_DEFERCLAIM		5		/* val cpu, exit val mask */
+#define A12_REP_POLL			6		/* exit val mask */
+#define A12_REP_BLKREAD			7		/* val offs, ARG */
+#define A12_REP_BLKWRITE		8		/* val offs, ARG */
+#define A12_REP_BLKFILL			9		/* val offs, ARG, 2nd ARG pattern */
+#define A12_REP_NUM				10		/* entry point ids 0..9, 0=none */
+
+/* interrupt policy of an M-module slot (M_BB_A12_SLOT_POLICY) */
+#define A12_POLICY_IRQ			0		/* interrupts, hybrid mode optional */
+#define A12_POLICY_POLL			1		/* always polled */
+
+/* M-module bus timing, fast bits of the control register (SLOT_n_TIMING) */
+#define A12_TIMING_SLOW			0		/* slowest cycles */
+#define A12_TIMING_FAST			3		/* fastest cycles, reset value */
+
+/* steps of a slot reset (M_BB_A12_SLOT_RESET), done in this order */
+#define A12_RESET_QUIESCE		0x01	/* IEN off, slot out of IRQ paths */
+#define A12_RESET_CTRL			0x02	/* control register to safe state */
+#define A12_RESET_REMAP			0x04	/* unmap, set up again (SLOT_n_xxx) */
+#define A12_RESET_ENABLE		0x08	/* back in service, IEN restored */
+#define A12_RESET_ALL			0x0f
+
+/* order of the slot checks in an interrupt (IRQ_SCAN, M_BB_A12_SCAN) */
+#define A12_SCAN_STATIC			0		/* by SLOT_n_SCAN_PRIO */
+#define A12_SCAN_ADAPTIVE		1		/* busiest/latest slots first */
+#define A12_SCAN_PRIO_MAX		0xff	/* SLOT_n_SCAN_PRIO, higher first */
+
+/* scan order (A12_IrqOrder, M_BB_A12_SCAN_ORDER): 4 bits per place */
+#define A12_SCAN_END			0xf		/* no further slot */
+#define A12_SCAN_SLOT(order,n)	(((order) >> (4*(n))) & 0xf) /* n-th slot */
+
+/* IRQ storm quarantine (SLOT_n_STORM_TIME), doubled up to 2^6 times */
+#define A12_STORM_TIME_MAX		0x10000	/* first holdoff max. [ms] */
+
+/*
+ * A12 specific cfgInfo code: CPU hints of a device (IRQ_CPU_MASK,
+ * SLOT_n_CPU_MASK), bit n = CPU n, 0 = no preference
+ *   A12_CfgInfo( h, A12_CFGINFO_CPUMASK, mSlot, &irqCpus, &workCpus )
+ */
+#define A12_CFGINFO_CPUMASK		0x100
+
+/* A12 specific setstat codes */
+#define M_BB_A12_IRQSTAT_CLR	(M_BRD_OF+0x40)		/* clear IRQ statistics */
+#define M_BB_A12_IRQMOD_EVENTS	(M_BRD_OF+0x41)		/* IRQs before holdoff */
+#define M_BB_A12_IRQMOD_TIME	(M_BRD_OF+0x42)		/* holdoff time [ms] */
+#define M_BB_A12_IRQ_DEFER		(M_BRD_OF+0x43)		/* deferred servicing */
+#define M_BB_A12_POLL			(M_BRD_OF+0x44)		/* hybrid IRQ/poll mode */
+#define M_BB_A12_POLL_ON		(M_BRD_OF+0x45)		/* IRQs/window to poll */
+#define M_BB_A12_POLL_OFF		(M_BRD_OF+0x46)		/* events/window to IRQ */
+#define M_BB_A12_POLL_WINDOW	(M_BRD_OF+0x47)		/* rate window [ms] */
+#define M_BB_A12_POLL_PERIOD	(M_BRD_OF+0x48)		/* poll period [us] */
+#define M_BB_A12_POLL_ACTIVE	(M_BRD_OF+0x49)		/* slot polled (get) */
+#define M_BB_A12_SLOT_ENABLE	(M_BRD_OF+0x4a)		/* slot enabled */
+#define M_BB_A12_SLOT_IRQ_MODE	(M_BRD_OF+0x4b)		/* BBIS_IRQ_SHARED/EXCL. */
+#define M_BB_A12_SLOT_POLICY	(M_BRD_OF+0x4c)		/* A12_POLICY_xxx */
+#define M_BB_A12_TRACE			(M_BRD_OF+0x4d)		/* event trace on/off */
+#define M_BB_A12_TRACE_LOST		(M_BRD_OF+0x4e)		/* events lost (get) */
+#define M_BB_A12_SLOT_TIMING	(M_BRD_OF+0x4f)		/* A12_TIMING_xxx */
+#define M_BB_A12_IRQ_CPUMASK	(M_BRD_OF+0x50)		/* CPUs for bridge IRQ */
+#define M_BB_A12_SLOT_CPUMASK	(M_BRD_OF+0x51)		/* CPUs for deferred work */
+#define M_BB_A12_REC			(M_BRD_OF+0x52)		/* access recording on/off */
+#define M_BB_A12_REC_LOST		(M_BRD_OF+0x53)		/* records lost (get) */
+#define M_BB_A12_SUSPEND		(M_BRD_OF+0x54)		/* suspend 1, resume 0 */
+#define M_BB_A12_SLOT_RESET		(M_BRD_OF+0x55)		/* A12_RESET_xxx steps */
+#define M_BB_A12_STORM_IRQS		(M_BRD_OF+0x56)		/* IRQs/window = storm */
+#define M_BB_A12_STORM_WINDOW	(M_BRD_OF+0x57)		/* storm window [ms] */
+#define M_BB_A12_STORM_TIME		(M_BRD_OF+0x58)		/* 1st quarantine [ms] */
+#define M_BB_A12_STORM_HOLDOFF	(M_BRD_OF+0x59)		/* quarantine [ms] (get) */
+#define M_BB_A12_SCAN			(M_BRD_OF+0x5a)		/* A12_SCAN_xxx */
+#define M_BB_A12_SCAN_PRIO		(M_BRD_OF+0x5b)		/* slot scan priority */
+#define M_BB_A12_SCAN_ORDER		(M_BRD_OF+0x5c)		/* scan order (get) */
+
+/* A12 specific blockgetstat codes */
+#define M_BB_A12_BLK_IRQSTAT	(M_BRD_BLK_OF+0x40)	/* IRQ statistics */
+#define M_BB_A12_BLK_SGSTAT		(M_BRD_BLK_OF+0x41)	/* SG queue statistics */
+#define M_BB_A12_BLK_TRACE		(M_BRD_BLK_OF+0x43)	/* drain event trace */
+#define M_BB_A12_BLK_QSPISTAT	(M_BRD_BLK_OF+0x44)	/* QSPI IRQ events */
+#define M_BB_A12_BLK_SLOTRES	(M_BRD_BLK_OF+0x45)	/* device resources */
+#define M_BB_A12_BLK_REC		(M_BRD_BLK_OF+0x46)	/* drain access recording */
+#define M_BB_A12_BLK_WARM		(M_BRD_BLK_OF+0x47)	/* board state, A12_WARM */
+
+/*---------------------------------------------------------------------------+
+|    TYPEDEFS                                                                |
++---------------------------------------------------------------------------*/
+/*
+ * IRQ statistics of one device (M_BB_A12_BLK_IRQSTAT). hist[n] counts the
+ * interrupts which took [2^n, 2^(n+1)) CPU cycles from irqSrvInit to
+ * irqSrvExit, hist[0] also counts zero-length ones. For deferred slots this
+ * includes the time in the work queue.
+ */
+typedef struct {
+	u_int32		irqYes;						/* irqSrvInit answered YES */
+	u_int32		irqNo;						/* irqSrvInit answered NO */
+	u_int32		modHoldoffs;				/* IRQ moderation holdoffs */
+	u_int32		irqDeferred;				/* queued for deferred worker */
+	u_int32		toPoll;						/* switches to polling */
+	u_int32		toIrq;						/* switches to interrupts */
+	u_int32		storms;						/* IRQ storm quarantines */
+	u_int32		hist[A12_HIST_BUCKETS];		/* service time histogram */
+} A12_IRQ_STAT;
+
+/* address space description (A12_GetMAddrEx) */
+typedef struct {
+	u_int64		phys;						/* physical address */
+	u_int32		size;						/* size [bytes] */
+	u_int32		attr;						/* allowed A12_MATTR_xxx */
+} A12_MADDR;
+
+/* mapped address space (A12_MapView) */
+typedef struct {
+	void		*virt;						/* virtual address */
+	u_int32		size;						/* size [bytes] */
+	u_int32		attr;						/* granted A12_MATTR_xxx */
+} A12_VIEW;
+
+/*
+ * Resources of one device (A12_ResQuery, M_BB_A12_BLK_SLOTRES): what
+ * BrdInfo, CfgInfo and A12_GetMAddrEx report for it. The QSPI has one
+ * window (win[0]). For a disabled device only the first fields are set.
+ */
+typedef struct {
+	u_int32		mSlot;						/* 0..2, 0x1000=QSPI */
+	u_int32		enable;						/* device enabled */
+	u_int32		devBusType;					/* BBIS_BRDINFO_DEVBUSTYPE */
+	u_int32		interrupts;					/* BBIS_BRDINFO_INTERRUPTS */
+	u_int32		addrSpace;					/* BBIS_BRDINFO_ADDRSPACE */
+	u_int32		busNbr;						/* BBIS_CFGINFO_BUSNBR */
+	u_int32		pciDevNbr;					/* BBIS_CFGINFO_PCI_DEVNBR */
+	u_int32		irqVector;					/* BBIS_CFGINFO_IRQ */
+	u_int32		irqLevel;
+	u_int32		irqMode;
+	A12_MADDR	win[A12_RES_WINS];			/* A12_RES_xxx */
+} A12_SLOT_RES;
+
+/* one contiguous piece of a scatter-gather request */
+typedef struct {
+	void		*buf;						/* memory buffer */
+	u_int32		offs;						/* offset in address space */
+	u_int32		size;						/* size [bytes] */
+} A12_SG_ELEM;
+
+/*
+ * Scatter-gather request. Owned by the BBIS from A12_SgSubmit until it is
+ * completed: then callback is called in the context of the SG worker
+ * executing the queue (A12_SgRun), or the request is put into the
+ * completion ring of the slot if callback is NULL.
+ */
+typedef struct A12_SG_REQ {
+	u_int32		dir;						/* A12_SG_READ/WRITE */
+	u_int32		addrMode;					/* MDIS_MA08 | MDIS_MA24 */
+	u_int32		dataMode;					/* MDIS_MD16 | MDIS_MD32 */
+	A12_SG_ELEM	*elem;						/* elements */
+	u_int32		nElem;						/* number of elements */
+	u_int32		flags;						/* A12_SG_MORE */
+	void		(*callback)( struct A12_SG_REQ *req, void *arg );
+	void		*cbArg;						/* callback argument */
+	int32		status;						/* out: 0 | error code */
+	struct A12_SG_REQ *next;				/* internal */
+} A12_SG_REQ;
+
+/*
+ * Copy backend of the SG queue, passed to A12_SgRun by the OS layer (e.g.
+ * a DMA engine). xfer moves one contiguous block, the default backend uses
+ * CPU accesses like A12_BlkRead/A12_BlkWrite. xfer=NULL selects the
+ * default backend.
+ */
+typedef struct {
+	int32		(*xfer)( void *arg, u_int32 mSlot, u_int32 dir,
+						 u_int32 addrMode, u_int32 dataMode, u_int32 offs,
+						 void *buf, u_int32 size );
+	void		*arg;						/* first argument of xfer */
+} A12_SG_BACKEND;
+
+/* SG queue statistics of one slot (M_BB_A12_BLK_SGSTAT) */
+typedef struct {
+	u_int32		reqs;						/* submitted requests */
+	u_int32		elems;						/* submitted elements */
+	u_int32		xfers;						/* backend calls */
+	u_int32		errors;						/* requests with error */
+	u_int32		runs;						/* queue runs */
+} A12_SG_STAT;
+
+/* QSPI interrupt events (M_BB_A12_BLK_QSPISTAT) */
+typedef struct {
+	u_int32		ev[8];						/* claimed IRQs w. status bit n */
+	u_int32		spurious;					/* IRQ9 without status bit */
+	u_int32		last;						/* status of last claimed IRQ */
+} A12_QSPI_STAT;
+
+/*
+ * One traced event (M_BB_A12_BLK_TRACE). Events of one CPU are drained in
+ * order, time orders the events of different CPUs.
+ */
+typedef struct {
+	u_int64		time;						/* CPU cycles */
+	int32		ret;						/* return code/mask */
+	u_int8		dev;						/* device 0..2, 3=QSPI */
+	u_int8		ev;							/* A12_TEV_xxx */
+	u_int8		ctrl;						/* control register value */
+	u_int8		cpu;						/* CPU */
+} A12_TRACE_EV;
+
+/*
+ * Register access recording (M_BB_A12_BLK_REC). Each drain returns one
+ * chunk: an A12_REC_HDR followed by count records. A recording file is
+ * the plain concatenation of the chunks, so a capture tool just appends
+ * what it drains and a reader can process the file while it grows.
+ *
+ * The time of a record is cycles of its chunk plus the dt of all records
+ * of the chunk up to and including it (dt of the first record is 0).
+ * cycOn/tickOn and cycNow/tickNow convert CPU cycles to time.
+ */
+typedef struct {
+	u_int32		magic;						/* A12_REC_MAGIC */
+	u_int16		version;					/* A12_REC_VERSION */
+	u_int16		recSize;					/* sizeof(A12_REC) */
+	u_int32		count;						/* records in this chunk */
+	u_int32		lost;						/* records lost before them */
+	u_int64		cycles;						/* CPU cycles of 1st record */
+	u_int64		cycOn;						/* CPU cycles at recording on */
+	u_int64		cycNow;						/* CPU cycles at drain */
+	u_int32		tickOn;						/* OSS ticks at recording on */
+	u_int32		tickNow;					/* OSS ticks at drain */
+	u_int32		tickRate;					/* OSS ticks per second */
+	u_int32		reserved;
+} A12_REC_HDR;
+
+/* one recorded operation */
+typedef struct {
+	u_int32		dt;							/* CPU cycles since previous
+											   record, saturated */
+	u_int32		val;						/* value, see A12_ROP_xxx */
+	u_int8		op;							/* A12_ROP_xxx */
+	u_int8		dev;						/* device 0..2, 3=QSPI,
+											   A12_REC_BRD */
+	u_int8		arg;						/* see A12_ROP_xxx */
+	u_int8		cpu;						/* CPU */
+} A12_REC;
+
+/*
+ * Board state for a warm restart (M_BB_A12_BLK_WARM, A12_WarmInit): the
+ * probed bridge, the parsed descriptor settings and the control register
+ * shadows of the M-module slots. Only valid for the same bridge in the
+ * same system boot.
+ */
+typedef struct {
+	u_int32		ctrl;						/* control register w/o IEN */
+	u_int32		modBudget;					/* SLOT_n_IRQ_MOD_EVENTS */
+	u_int32		modTime;					/* SLOT_n_IRQ_MOD_TIME */
+	u_int32		poll;						/* SLOT_n_POLL */
+	u_int32		pollOn;						/* SLOT_n_POLL_ON */
+	u_int32		pollOff;					/* SLOT_n_POLL_OFF */
+	u_int32		pollWinMs;					/* SLOT_n_POLL_WINDOW */
+	u_int32		pollPeriod;					/* SLOT_n_POLL_PERIOD */
+	u_int32		a24Attr;					/* SLOT_n_A24_ATTR */
+	u_int32		cpus;						/* SLOT_n_CPU_MASK */
+	u_int32		stormIrqs;					/* SLOT_n_STORM_xxx */
+	u_int32		stormWinMs;
+	u_int32		stormTime;
+} A12_WARM_SLOT;
+
+typedef struct {
+	u_int32		magic;						/* A12_WARM_MAGIC */
+	u_int16		version;					/* A12_WARM_VERSION */
+	u_int16		size;						/* sizeof(A12_WARM) */
+	int32		pciBusNbr;					/* bridge location */
+	int32		pciDevNbr;
+	u_int64		physBase;					/* BAR0 */
+	u_int32		barPrefetch;				/* BAR0 prefetchable */
+	u_int32		irqValid;					/* irqLevel/Vector valid */
+	int32		irqLevel;
+	int32		irqVector;
+	u_int32		irqDefer;					/* IRQ_DEFER */
+	u_int32		irqCpus;					/* IRQ_CPU_MASK */
+	u_int32		lazyInit;					/* LAZY_INIT */
+	u_int32		scan;						/* IRQ_SCAN */
+	u_int32		scanPrio[3];				/* SLOT_n_SCAN_PRIO */
+	u_int32		qspiOffs;					/* QSPI_xxx */
+	u_int32		qspiSize;
+	u_int32		qspiIrqOffs;
+	u_int32		qspiIrqMask;
+	u_int32		enable;						/* enabled devices, bit n */
+	u_int32		attached;					/* slots set up, bit n */
+	u_int32		ienMask;					/* slots with IRQ enabled */
+	u_int32		irqMode[4];					/* SLOT_n_IRQ_MODE */
+	u_int32		policy[3];					/* SLOT_n_IRQ_POLICY */
+	u_int32		timing[3];					/* SLOT_n_TIMING */
+	A12_WARM_SLOT slot[3];
+} A12_WARM;
+
+/*
+ * The extended entry points are stored in the int32 (*)(void) slots of
+ * BBIS_ENTRY and fetched by the A12_ENTRY_xxx macros below, both through
+ * the generic A12_FUNC, which compilers accept for any function pointer
+ * cast (no -Wcast-function-type).
+ */
+typedef void (*A12_FUNC)( void );
+#define A12_ENTRY_SET(fkt)		((int32 (*)(void))(A12_FUNC)(fkt))
+#define A12_ENTRY_GET(type,fkt)	((type)(A12_FUNC)(fkt))
+
+#ifndef _NO_BBIS_HANDLE
+/*
+ * Read the IRQ pending bit of all slots with enabled interrupt in one pass
+ * and claim the interrupt for the asserting ones. *maskP gets bit n set
+ * for each claimed M-module slot n: the dispatcher calls the driver ISR
+ * and irqSrvExit for it, but not irqSrvInit. A12_PEND_DEFERRED is set if
+ * slots were queued for deferred servicing instead.
+ */
+typedef int32 (*A12_IRQPENDMASK_FUNC)( BBIS_HANDLE *h, u_int32 *maskP );
+
+/*
+ * Deferred servicing (IRQ_DEFER / M_BB_A12_IRQ_DEFER): irqSrvInit masks an
+ * asserting slot, queues it on the calling CPU and answers BBIS_IRQ_NO.
+ * The deferred worker of each CPU claims queued slots (stealing from other
+ * CPUs when its own queue is empty), calls the driver ISR of the slot and
+ * then irqSrvExit, which unmasks it. *maskP gets one claimed slot or 0.
+ * The OS layer must treat the interrupt as handled if A12_IrqPendMask
+ * reported A12_PEND_DEFERRED. Only built with A12_OS_WORKERS, fkt17 is
+ * unused otherwise.
+ */
+typedef int32 (*A12_DEFERCLAIM_FUNC)( BBIS_HANDLE *h, u_int32 cpu,
+									  u_int32 *maskP );
+
+/*
+ * Hybrid IRQ/poll mode (SLOT_n_POLL / M_BB_A12_POLL): while any slot has
+ * M_BB_A12_POLL_ACTIVE set, the poller of the OS layer calls this every
+ * M_BB_A12_POLL_PERIOD microseconds. *maskP gets bit n set for each
+ * pending polled slot n, which is then serviced like an interrupt
+ * (irqSrvInit, driver ISR, irqSrvExit). Only built with A12_OS_WORKERS,
+ * fkt18 is unused otherwise.
+ */
+typedef int32 (*A12_POLL_FUNC)( BBIS_HANDLE *h, u_int32 *maskP );
+
+/*
+ * Address views: A12_GetMAddrEx reports the address space of getMAddr with
+ * a 64-bit address and the attributes allowed for it (write-combined or
+ * prefetchable A24 windows, see SLOT_n_A24_ATTR). A12_MapView maps it with
+ * the requested attributes, as far as allowed and supported by the OS.
+ */
+typedef int32 (*A12_GETMADDREX_FUNC)( BBIS_HANDLE *h, u_int32 mSlot,
+									  u_int32 addrMode, u_int32 dataMode,
+									  A12_MADDR *ma );
+typedef int32 (*A12_MAPVIEW_FUNC)( BBIS_HANDLE *h, u_int32 mSlot,
+								   u_int32 addrMode, u_int32 dataMode,
+								   u_int32 attr, A12_VIEW *view );
+typedef int32 (*A12_UNMAPVIEW_FUNC)( BBIS_HANDLE *h, A12_VIEW *view );
+
+/*
+ * Block transfers in the A24 window of an M-module slot (dataMode
+ * MDIS_MD32 or MDIS_MD16). Offset, size and buffer must be aligned to the
+ * data width. A24 D32 uses the widest access the build allows (16 byte
+ * bursts on x86-64 user mode builds), A24 D16 uses 16-bit accesses.
+ */
+typedef int32 (*A12_BLKREAD_FUNC)( BBIS_HANDLE *h, u_int32 mSlot,
+								   u_int32 dataMode, u_int32 offs,
+								   void *buf, u_int32 size );
+typedef int32 (*A12_BLKWRITE_FUNC)( BBIS_HANDLE *h, u_int32 mSlot,
+									u_int32 dataMode, u_int32 offs,
+									const void *buf, u_int32 size );
+typedef int32 (*A12_BLKFILL_FUNC)( BBIS_HANDLE *h, u_int32 mSlot,
+								   u_int32 dataMode, u_int32 offs,
+								   u_int32 val, u_int32 size );
+
+/*
+ * Asynchronous scatter-gather transfers of an M-module slot. A12_SgSubmit
+ * only queues a request and returns, it never accesses the module. The SG
+ * worker of the OS layer executes the queue with A12_SgRun: the OS layer
+ * wakes it after each submit without A12_SG_MORE. A12_SgRun executes the
+ * queued requests in order, merging elements which are contiguous in the
+ * address space and in memory (also across requests) into one backend
+ * call. It may block and is a kernel-side entry only: the backend be
+ * (NULL: CPU copies) is called with the given arguments.
+ * A12_SgComplete removes the oldest request from the completion ring, or
+ * sets *reqP to NULL if it is empty (one consumer per slot).
+ * Only built with A12_OS_WORKERS, fkt22/fkt23/fkt31 are unused otherwise.
+ */
+typedef int32 (*A12_SGSUBMIT_FUNC)( BBIS_HANDLE *h, u_int32 mSlot,
+									A12_SG_REQ *req );
+typedef int32 (*A12_SGCOMPLETE_FUNC)( BBIS_HANDLE *h, u_int32 mSlot,
+									  A12_SG_REQ **reqP );
+typedef int32 (*A12_SGRUN_FUNC)( BBIS_HANDLE *h, u_int32 mSlot,
+								 const A12_SG_BACKEND *be );
+
+/*
+ * Resources of device mSlot, or of all devices (mSlot A12_RES_ALL), in one
+ * call. *nP is the number of entries in res on entry and the number of
+ * filled entries on return. The resources are computed once per device
+ * and kept until its configuration changes.
+ */
+typedef int32 (*A12_RESQUERY_FUNC)( BBIS_HANDLE *h, u_int32 mSlot,
+									A12_SLOT_RES *res, u_int32 *nP );
+
+/*
+ * Warm restart: like A12_Init, but the bridge location, BAR0, interrupt
+ * and descriptor settings are taken from a state saved with
+ * M_BB_A12_BLK_WARM (e.g. just before the A12_Exit of the previous
+ * instance). The bridge is not searched, only its IDs are checked, and
+ * only the DEBUG_LEVEL keys are read from descSpec (slots not set up at
+ * the save still read their keys on first use). A12_BrdInit of such a
+ * handle restores the saved control registers, IEN included, in one pass.
+ */
+typedef int32 (*A12_WARMINIT_FUNC)( OSS_HANDLE *osHdl, DESC_SPEC *descSpec,
+									const A12_WARM *warm, BBIS_HANDLE **hP );
+
+/*
+ * Slot scan order: the M-module slots in the order the OS layer should
+ * call irqSrvInit for them, 4 bits per place (A12_SCAN_SLOT), ended by
+ * A12_SCAN_END. With A12_SCAN_STATIC it follows SLOT_n_SCAN_PRIO, with
+ * A12_SCAN_ADAPTIVE the slots which claimed the interrupt most often and
+ * most recently come first. Disabled slots are listed too (irqSrvInit
+ * answers BBIS_IRQ_NO for them without a register read). An OS layer
+ * which stops at the first claiming slot saves the control register
+ * reads of the slots behind it: the bridge interrupt is level triggered
+ * and stays asserted for the others.
+ */
+typedef int32 (*A12_IRQORDER_FUNC)( BBIS_HANDLE *h, u_int32 *orderP );
+
+/* jump table slots of the extended entry points */
+#define A12_ENTRY_WARMINIT(bbisP)	\
+	A12_ENTRY_GET( A12_WARMINIT_FUNC, (bbisP)->fkt04 )
+#define A12_ENTRY_GETMADDREX(bbisP)	\
+	A12_ENTRY_GET( A12_GETMADDREX_FUNC, (bbisP)->fkt07 )
+#define A12_ENTRY_MAPVIEW(bbisP)	\
+	A12_ENTRY_GET( A12_MAPVIEW_FUNC, (bbisP)->fkt08 )
+#define A12_ENTRY_UNMAPVIEW(bbisP)	\
+	A12_ENTRY_GET( A12_UNMAPVIEW_FUNC, (bbisP)->fkt09 )
+#define A12_ENTRY_IRQPENDMASK(bbisP)	\
+	A12_ENTRY_GET( A12_IRQPENDMASK_FUNC, (bbisP)->fkt14 )
+#define A12_ENTRY_DEFERCLAIM(bbisP)	\
+	A12_ENTRY_GET( A12_DEFERCLAIM_FUNC, (bbisP)->fkt17 )
+#define A12_ENTRY_POLL(bbisP)	\
+	A12_ENTRY_GET( A12_POLL_FUNC, (bbisP)->fkt18 )
+#define A12_ENTRY_BLKREAD(bbisP)	\
+	A12_ENTRY_GET( A12_BLKREAD_FUNC, (bbisP)->fkt19 )
+#define A12_ENTRY_BLKWRITE(bbisP)	\
+	A12_ENTRY_GET( A12_BLKWRITE_FUNC, (bbisP)->fkt20 )
+#define A12_ENTRY_BLKFILL(bbisP)	\
+	A12_ENTRY_GET( A12_BLKFILL_FUNC, (bbisP)->fkt21 )
+#define A12_ENTRY_SGSUBMIT(bbisP)	\
+	A12_ENTRY_GET( A12_SGSUBMIT_FUNC, (bbisP)->fkt22 )
+#define A12_ENTRY_SGCOMPLETE(bbisP)	\
+	A12_ENTRY_GET( A12_SGCOMPLETE_FUNC, (bbisP)->fkt23 )
+#define A12_ENTRY_RESQUERY(bbisP)	\
+	A12_ENTRY_GET( A12_RESQUERY_FUNC, (bbisP)->fkt24 )
+#define A12_ENTRY_IRQORDER(bbisP)	\
+	A12_ENTRY_GET( A12_IRQORDER_FUNC, (bbisP)->fkt30 )
+#define A12_ENTRY_SGRUN(bbisP)	\
+	A12_ENTRY_GET( A12_SGRUN_FUNC, (bbisP)->fkt31 )
+#endif /* _NO_BBIS_HANDLE */
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _BB_A12_EXT_H */
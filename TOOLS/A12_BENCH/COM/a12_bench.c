@@ -0,0 +1,668 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                   A 1 2 _ B E N C H                ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *       Author: kp
+ *
+ *  Description: Microbenchmarks of the A12 BBIS entry points
+ *
+ *               Calls each entry point of the A12_GetEntry jump table
+ *               many times against the bridge simulator and measures the
+ *               CPU cycles per call (median, 99th percentile, maximum)
+ *               and the PCI accesses per call. The simulator latencies
+ *               are 0 by default, so the cycles are those of the BBIS
+ *               code and the register model.
+ *
+ *               The results are printed one line per benchmark:
+ *
+ *                 <name> <calls> <cfg> <rd> <wr> <p50> <p99> <max>
+ *
+ *               cfg/rd/wr are PCI config/memory reads/writes per call,
+ *               p50/p99/max CPU cycles per call (ns without cycle
+ *               counter). Other lines start with '#'. With -o the lines
+ *               are also written to a file, which can serve as baseline
+ *               for a later run (-B). A run fails if an entry point needs
+ *               more PCI accesses than in the baseline, or more cycles
+ *               than allowed by the tolerance (-T). Cycles of 0 in the
+ *               baseline are not compared, so a baseline written with -A
+ *               is independent of the machine. a12_bench.base is such a
+ *               baseline of the current BBIS.
+ *
+ *     Required: libraries: a12_sim, usr_utl
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/usr_utl.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/bb_defs.h>
+#include <MEN/bb_entry.h>
+#include <MEN/bb_a12.h>
+#include <MEN/bb_a12_ext.h>
+#include <MEN/a12_sim.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define BENCH_CALLS			10000		/* default calls per benchmark */
+#define BENCH_LIFE_DIV		10			/* fewer init/exit calls */
+#define BENCH_TOL			50			/* default tolerance [%] */
+#define BENCH_SLACK			100			/* plus tolerance [cycles] for the
+										   jitter of very short calls */
+#define BENCH_MAX			32			/* benchmarks in a baseline */
+#define BENCH_NAME_LEN		24
+
+/* CPU cycle counter, ns if there is none */
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+# define BENCH_UNIT			"cycles"
+static __inline__ u_int64 Cycles( void )
+{
+	u_int32 lo, hi;
+	__asm__ __volatile__( "rdtsc" : "=a"(lo), "=d"(hi) );
+	return ((u_int64)hi << 32) | lo;
+}
+#else
+# define BENCH_UNIT			"ns"
+static u_int64 Cycles( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (u_int64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* benchmarked call, pre/post untimed */
+typedef int32 (*BENCH_FUNC)( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+
+/* benchmark */
+typedef struct {
+	const char	*name;
+	BENCH_FUNC	pre;			/* before each call, may be NULL */
+	BENCH_FUNC	call;			/* timed */
+	BENCH_FUNC	post;			/* after each call, may be NULL */
+	u_int32		arg;
+	u_int32		life;			/* TRUE: own handle, fewer calls */
+} BENCH;
+
+/* result of a benchmark, line of a baseline */
+typedef struct {
+	char		name[BENCH_NAME_LEN];
+	u_int32		calls;
+	double		cfg;			/* PCI accesses per call */
+	double		rd;
+	double		wr;
+	u_int32		p50;			/* cycles per call */
+	u_int32		p99;
+	u_int32		max;
+} BENCH_RES;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void usage(void);
+static int32 Run( BBIS_ENTRY *bb, BBIS_HANDLE *h, const BENCH *b,
+				  u_int32 calls, u_int64 *smp, u_int32 ovh, BENCH_RES *res );
+static int SmpCmp( const void *a, const void *b );
+static int32 LoadBase( const char *file, BENCH_RES *base, u_int32 *nP );
+static u_int32 Compare( const BENCH_RES *res, const BENCH_RES *base,
+						u_int32 nBase, u_int32 tol );
+
+static int32 Nop( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 Init( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 BrdInit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 BrdExit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 Exit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 InitBrd( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 ExitBrd( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 IrqOff( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 IrqEnable( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 IrqSet( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 SrvInit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 SrvExit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 GetMAddr( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 CfgInfo( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+static int32 GetStat( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg );
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static const A12SIM_DESC G_desc[] = {
+	{ "DEBUG_LEVEL",	0 },
+	{ NULL,				0 }
+};
+
+/* GetMAddr arg: slot << 16 | addrMode << 8 | dataMode */
+#define MADDR_ARG(s,a,d)	(((s) << 16) | ((a) << 8) | (d))
+
+static const BENCH G_bench[] = {
+	{ "timer",				NULL,		Nop,		NULL,		0, FALSE },
+	{ "Init",				NULL,		Init,		Exit,		0, TRUE },
+	{ "BrdInit",			Init,		BrdInit,	ExitBrd,	0, TRUE },
+	{ "BrdExit",			InitBrd,	BrdExit,	Exit,		0, TRUE },
+	{ "Exit",				Init,		Exit,		NULL,		0, TRUE },
+	{ "IrqEnable",			IrqOff,		IrqEnable,	NULL,		0, FALSE },
+	{ "IrqSrvInit_pend",	IrqSet,		SrvInit,	SrvExit,	1, FALSE },
+	{ "IrqSrvInit_idle",	IrqSet,		SrvInit,	NULL,		0, FALSE },
+	{ "GetMAddr_a08_d08",	NULL,		GetMAddr,	NULL,
+	  MADDR_ARG(0, MDIS_MA08, MDIS_MD08), FALSE },
+	{ "GetMAddr_a08_d16",	NULL,		GetMAddr,	NULL,
+	  MADDR_ARG(0, MDIS_MA08, MDIS_MD16), FALSE },
+	{ "GetMAddr_a08_d32",	NULL,		GetMAddr,	NULL,
+	  MADDR_ARG(0, MDIS_MA08, MDIS_MD32), FALSE },
+	{ "GetMAddr_a24_d08",	NULL,		GetMAddr,	NULL,
+	  MADDR_ARG(0, MDIS_MA24, MDIS_MD08), FALSE },
+	{ "GetMAddr_a24_d16",	NULL,		GetMAddr,	NULL,
+	  MADDR_ARG(0, MDIS_MA24, MDIS_MD16), FALSE },
+	{ "GetMAddr_a24_d32",	NULL,		GetMAddr,	NULL,
+	  MADDR_ARG(0, MDIS_MA24, MDIS_MD32), FALSE },
+	{ "GetMAddr_qspi",		NULL,		GetMAddr,	NULL,
+	  MADDR_ARG(0x1000, MDIS_MA24, MDIS_MD32), FALSE },
+	{ "CfgInfo_busnbr",		NULL,		CfgInfo,	NULL,
+	  BBIS_CFGINFO_BUSNBR, FALSE },
+	{ "CfgInfo_devnbr",		NULL,		CfgInfo,	NULL,
+	  BBIS_CFGINFO_PCI_DEVNBR, FALSE },
+	{ "CfgInfo_irq",		NULL,		CfgInfo,	NULL,
+	  BBIS_CFGINFO_IRQ, FALSE },
+	{ "GetStat_irq_vect",	NULL,		GetStat,	NULL,
+	  M_BB_IRQ_VECT, FALSE },
+	{ "GetStat_policy",		NULL,		GetStat,	NULL,
+	  M_BB_A12_SLOT_POLICY, FALSE },
+	{ "GetStat_irqstat",	NULL,		GetStat,	NULL,
+	  M_BB_A12_BLK_IRQSTAT, FALSE },
+	{ NULL }
+};
+
+/********************************* usage ************************************
+ *
+ *  Description: Print program usage
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void usage(void)
+{
+	printf("Usage: a12_bench [<opts>]\n");
+	printf("Function: Microbenchmarks of the A12 BBIS entry points\n");
+	printf("Options:\n");
+	printf("    -n=<n>    calls per benchmark .............. [%d]\n",
+		   BENCH_CALLS);
+	printf("              (Init/BrdInit/BrdExit/Exit: n/%d)\n",
+		   BENCH_LIFE_DIV);
+	printf("    -o=<file> write results (baseline)\n");
+	printf("    -A        write access counts only, no cycles\n");
+	printf("    -B=<file> compare with baseline, fail on regression\n");
+	printf("    -T=<%%>    tolerance for cycles ............. [%d]\n",
+		   BENCH_TOL);
+	printf("              (p50 +T%%, p99 +2T%%, each plus %d/%d cycles,\n",
+		   BENCH_SLACK, 2 * BENCH_SLACK);
+	printf("              max not compared)\n");
+	printf("    -c=<ns>   latency of PCI config access ..... [0]\n");
+	printf("    -r=<ns>   latency of non-posted read ....... [0]\n");
+	printf("    -w=<ns>   latency of posted write .......... [0]\n");
+	printf("\n");
+}
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return		success (0), error/regression (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main( int argc, char *argv[] )
+{
+	static BENCH_RES base[BENCH_MAX];
+	BBIS_ENTRY		bb;
+	BBIS_HANDLE		*h = NULL;
+	A12SIM_LATENCY	lat;
+	BENCH_RES		res;
+	const BENCH		*b;
+	char			*str, errstr[40], *baseFile;
+	u_int64			*smp = NULL;
+	u_int32			calls, tol, nBase = 0, ovh = 0, fail = 0, accOnly;
+	FILE			*fp = NULL;
+	int32			ret = 1;
+
+	/*--------------------+
+	|  check arguments    |
+	+--------------------*/
+	if( (str = UTL_ILLIOPT("n=o=AB=T=c=r=w=?", errstr)) ){
+		printf("*** %s\n", errstr);
+		return(1);
+	}
+	if( UTL_TSTOPT("?") ){
+		usage();
+		return(1);
+	}
+
+	calls		= ((str = UTL_TSTOPT("n=")) ? atoi(str) : BENCH_CALLS);
+	tol			= ((str = UTL_TSTOPT("T=")) ? atoi(str) : BENCH_TOL);
+	accOnly		= (UTL_TSTOPT("A") ? TRUE : FALSE);
+	baseFile	= UTL_TSTOPT("B=");
+	lat.cfgNs	= ((str = UTL_TSTOPT("c=")) ? atoi(str) : 0);
+	lat.readNs	= ((str = UTL_TSTOPT("r=")) ? atoi(str) : 0);
+	lat.writeNs	= ((str = UTL_TSTOPT("w=")) ? atoi(str) : 0);
+	lat.beatNs	= 0;
+	lat.waitNs	= 0;
+	lat.spin	= (lat.cfgNs || lat.readNs || lat.writeNs);
+
+	if( calls < BENCH_LIFE_DIV ){
+		printf("*** at least %d calls\n", BENCH_LIFE_DIV);
+		return(1);
+	}
+	if( baseFile && LoadBase( baseFile, base, &nBase ) )
+		return(1);
+	if( (str = UTL_TSTOPT("o=")) && (fp = fopen( str, "w" )) == NULL ){
+		printf("*** can't create %s\n", str);
+		return(1);
+	}
+	if( (smp = malloc( calls * sizeof(*smp) )) == NULL ){
+		printf("*** out of memory\n");
+		goto cleanup;
+	}
+
+	/*--------------------+
+	|  run benchmarks     |
+	+--------------------*/
+	A12SIM_Reset();
+	A12SIM_SetLatency( &lat );
+	A12_GetEntry( &bb );
+
+	if( bb.init( NULL, (DESC_SPEC*)G_desc, &h ) || bb.brdInit( h ) ||
+		bb.irqEnable( h, 0, TRUE ) ){
+		printf("*** init failed\n");
+		goto cleanup;
+	}
+
+	printf("# a12_bench unit=%s calls=%u\n", BENCH_UNIT, calls);
+	printf("# %-20s %7s %6s %6s %6s %8s %8s %8s\n", "name", "calls",
+		   "cfg", "rd", "wr", "p50", "p99", "max");
+	if( fp )
+		fprintf(fp, "# a12_bench unit=%s%s\n", BENCH_UNIT,
+				accOnly ? ", accesses only" : "");
+
+	for( b=G_bench; b->name; b++ ){
+		if( Run( &bb, h, b, b->life ? calls / BENCH_LIFE_DIV : calls, smp,
+				 ovh, &res ) ){
+			printf("*** %s failed\n", b->name);
+			goto cleanup;
+		}
+		/* timer overhead, subtracted from all further samples */
+		if( b == G_bench )
+			ovh = res.p50;
+
+		printf("%-22s %7u %6.2f %6.2f %6.2f %8u %8u %8u\n", res.name,
+			   res.calls, res.cfg, res.rd, res.wr, res.p50, res.p99,
+			   res.max);
+		if( accOnly )
+			res.p50 = res.p99 = res.max = 0;
+		if( fp )
+			fprintf(fp, "%s %u %.2f %.2f %.2f %u %u %u\n", res.name,
+					res.calls, res.cfg, res.rd, res.wr, res.p50, res.p99,
+					res.max);
+		if( nBase && b != G_bench )
+			fail += Compare( &res, base, nBase, tol );
+	}
+
+	if( nBase )
+		printf("# %s: %u regression(s) against %s\n", fail ? "FAIL" : "PASS",
+			   fail, baseFile);
+	ret = fail ? 1 : 0;
+
+cleanup:
+	if( h ){
+		bb.irqEnable( h, 0, FALSE );
+		bb.brdExit( h );
+		bb.exit( &h );
+	}
+	if( fp && fclose( fp ) )
+		ret = 1;
+	free( smp );
+	return ret;
+}
+
+/*********************************** Run ************************************
+ *
+ *  Description: Run one benchmark
+ *
+ *               Only the call itself is timed and its PCI accesses
+ *               counted, pre and post run untimed around each call.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle (not for life cycle benchmarks)
+ *               b		benchmark
+ *               calls	number of calls
+ *               smp	sample buffer [calls]
+ *               ovh	timer overhead [cycles]
+ *  Output.....: res	result
+ *               return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 Run(
+	BBIS_ENTRY *bb,
+	BBIS_HANDLE *h,
+	const BENCH *b,
+	u_int32 calls,
+	u_int64 *smp,
+	u_int32 ovh,
+	BENCH_RES *res )
+{
+	BBIS_HANDLE *lh = NULL, **hP = b->life ? &lh : &h;
+	A12SIM_STATS st;
+	u_int64 t0, t1, cfg = 0, rd = 0, wr = 0;
+	u_int32 i;
+	int32 error;
+
+	for( i=0; i<calls; i++ ){
+		if( b->pre && b->pre( bb, hP, b->arg ) )
+			goto abort;
+
+		A12SIM_ClrStats();
+		t0 = Cycles();
+		error = b->call( bb, hP, b->arg );
+		t1 = Cycles();
+		A12SIM_GetStats( &st );
+		if( error )
+			goto abort;
+
+		smp[i] = t1 - t0 > ovh ? t1 - t0 - ovh : 0;
+		cfg	+= st.cfgReads;
+		rd	+= st.reads;
+		wr	+= st.writes;
+
+		if( b->post && b->post( bb, hP, b->arg ) )
+			goto abort;
+	}
+
+	qsort( smp, calls, sizeof(*smp), SmpCmp );
+
+	memset( res, 0, sizeof(*res) );
+	strncpy( res->name, b->name, BENCH_NAME_LEN - 1 );
+	res->calls	= calls;
+	res->cfg	= (double)cfg / calls;
+	res->rd		= (double)rd / calls;
+	res->wr		= (double)wr / calls;
+	res->p50	= (u_int32)smp[calls / 2];
+	res->p99	= (u_int32)smp[(u_int64)calls * 99 / 100];
+	res->max	= (u_int32)smp[calls - 1];
+	return 0;
+
+abort:
+	if( lh )
+		bb->exit( &lh );
+	return 1;
+}
+
+/********************************* SmpCmp ***********************************
+ *
+ *  Description: qsort compare function of the samples
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: a,b	samples
+ *  Output.....: return	<0, 0, >0
+ *  Globals....: -
+ ****************************************************************************/
+static int SmpCmp( const void *a, const void *b )
+{
+	u_int64 x = *(const u_int64*)a, y = *(const u_int64*)b;
+
+	return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/******************************** LoadBase **********************************
+ *
+ *  Description: Read a baseline written with -o
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: file	baseline file
+ *  Output.....: base	baseline results
+ *               nP		number of results
+ *               return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 LoadBase(
+	const char *file,
+	BENCH_RES *base,
+	u_int32 *nP )
+{
+	char line[200];
+	FILE *fp;
+	u_int32 n = 0, lineNo = 0;
+	BENCH_RES *r;
+
+	if( (fp = fopen( file, "r" )) == NULL ){
+		printf("*** can't open %s\n", file);
+		return 1;
+	}
+
+	while( fgets( line, sizeof(line), fp ) ){
+		lineNo++;
+		if( line[0] == '#' || line[0] == '\n' )
+			continue;
+		if( n == BENCH_MAX ){
+			printf("*** %s: more than %d results\n", file, BENCH_MAX);
+			break;
+		}
+		r = &base[n];
+		if( sscanf( line, "%23s %u %lf %lf %lf %u %u %u", r->name,
+					&r->calls, &r->cfg, &r->rd, &r->wr, &r->p50, &r->p99,
+					&r->max ) != 8 ){
+			printf("*** %s line %u: bad format\n", file, lineNo);
+			fclose( fp );
+			return 1;
+		}
+		n++;
+	}
+	fclose( fp );
+
+	*nP = n;
+	return 0;
+}
+
+/********************************* Compare **********************************
+ *
+ *  Description: Compare a result with the baseline
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: res	result
+ *               base	baseline results
+ *               nBase	number of baseline results
+ *               tol	tolerance for cycles [%]
+ *  Output.....: return	number of regressions
+ *  Globals....: -
+ ****************************************************************************/
+static u_int32 Compare(
+	const BENCH_RES *res,
+	const BENCH_RES *base,
+	u_int32 nBase,
+	u_int32 tol )
+{
+	const BENCH_RES *r;
+	u_int32 n, fail = 0;
+
+	for( n=0, r=base; n<nBase; n++, r++ )
+		if( !strcmp( r->name, res->name ) )
+			break;
+	if( n == nBase ){
+		printf("# %s: not in baseline\n", res->name);
+		return 0;
+	}
+
+	/* PCI accesses are exact, 0.005 for the rounding of the file */
+	if( res->cfg > r->cfg + 0.005 || res->rd > r->rd + 0.005 ||
+		res->wr > r->wr + 0.005 ){
+		printf("# REGRESSION %s: accesses cfg/rd/wr %.2f/%.2f/%.2f, "
+			   "baseline %.2f/%.2f/%.2f\n", res->name, res->cfg, res->rd,
+			   res->wr, r->cfg, r->rd, r->wr);
+		fail++;
+	}
+	if( r->p50 && (u_int64)res->p50 * 100 >
+		(u_int64)r->p50 * (100 + tol) + BENCH_SLACK * 100 ){
+		printf("# REGRESSION %s: p50 %u, baseline %u\n", res->name,
+			   res->p50, r->p50);
+		fail++;
+	}
+	if( r->p99 && (u_int64)res->p99 * 100 >
+		(u_int64)r->p99 * (100 + 2 * tol) + 2 * BENCH_SLACK * 100 ){
+		printf("# REGRESSION %s: p99 %u, baseline %u\n", res->name,
+			   res->p99, r->p99);
+		fail++;
+	}
+	return fail;
+}
+
+/*--------------------------------------------------------------------------+
+|    BENCHMARKED CALLS                                                      |
++--------------------------------------------------------------------------*/
+/* empty, timer overhead */
+static int32 Nop( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	return 0;
+}
+
+static int32 Init( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	return bb->init( NULL, (DESC_SPEC*)G_desc, hP );
+}
+
+static int32 BrdInit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	return bb->brdInit( *hP );
+}
+
+static int32 BrdExit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	return bb->brdExit( *hP );
+}
+
+static int32 Exit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	return bb->exit( hP );
+}
+
+static int32 InitBrd( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	int32 error;
+
+	if( (error = bb->init( NULL, (DESC_SPEC*)G_desc, hP )) )
+		return error;
+	return bb->brdInit( *hP );
+}
+
+static int32 ExitBrd( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	int32 error;
+
+	if( (error = bb->brdExit( *hP )) )
+		return error;
+	return bb->exit( hP );
+}
+
+/* slot 0 off and on */
+static int32 IrqOff( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	return bb->irqEnable( *hP, 0, FALSE );
+}
+
+static int32 IrqEnable( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	return bb->irqEnable( *hP, 0, TRUE );
+}
+
+/* IRQ line of slot 0 to arg */
+static int32 IrqSet( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	A12SIM_SetIrq( 0, arg );
+	return 0;
+}
+
+/* slot 0, arg: IRQ expected */
+static int32 SrvInit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	int32 ret = bb->irqSrvInit( *hP, 0 );
+
+	return ret == (arg ? BBIS_IRQ_YES : BBIS_IRQ_NO) ? 0 : 1;
+}
+
+static int32 SrvExit( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	A12SIM_SetIrq( 0, 0 );
+	bb->irqSrvExit( *hP, 0 );
+	return 0;
+}
+
+/* arg: MADDR_ARG */
+static int32 GetMAddr( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	void *addr;
+	u_int32 size;
+
+	return bb->getMAddr( *hP, arg >> 16, (arg >> 8) & 0xff, arg & 0xff,
+						 &addr, &size );
+}
+
+/* arg: BBIS_CFGINFO_xxx of slot 0 */
+static int32 CfgInfo( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	u_int32 val[3];
+
+	switch( arg ){
+	case BBIS_CFGINFO_BUSNBR:
+		return bb->cfgInfo( *hP, arg, &val[0], 0 );
+	case BBIS_CFGINFO_PCI_DEVNBR:
+		return bb->cfgInfo( *hP, arg, 0, &val[0] );
+	default:
+		return bb->cfgInfo( *hP, arg, 0, &val[0], &val[1], &val[2] );
+	}
+}
+
+/* arg: code for slot 0, IRQ statistics block */
+static int32 GetStat( BBIS_ENTRY *bb, BBIS_HANDLE **hP, u_int32 arg )
+{
+	A12_IRQ_STAT stat[A12_NBR_OF_DEVS];
+	M_SG_BLOCK blk;
+	INT32_OR_64 val;
+
+	if( arg == M_BB_A12_BLK_IRQSTAT ){
+		blk.size = sizeof(stat);
+		blk.data = (void*)stat;
+		return bb->getStat( *hP, 0, arg, (INT32_OR_64*)&blk );
+	}
+	return bb->getStat( *hP, 0, arg, &val );
+}
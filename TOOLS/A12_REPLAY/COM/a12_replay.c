@@ -0,0 +1,627 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                  A 1 2 _ R E P L A Y               ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *       Author: kp
+ *
+ *  Description: Analyse and replay an A12 access recording
+ *
+ *               Reads a file of A12_REC_HDR chunks (M_BB_A12_BLK_REC, e.g.
+ *               written by a12_simrun -t=15) and reports the recorded
+ *               register accesses and time per entry point. Then the
+ *               recorded calls are replayed in order against the current
+ *               BBIS on the bridge simulator, with the recorded interrupt
+ *               state presented to each call, and the PCI transactions
+ *               and simulated bus time of the replay are reported next to
+ *               the recording. Results differing from the recording are
+ *               counted as mismatches.
+ *
+ *               Changing the configuration of the replay (-D, -P) shows
+ *               the cost of a workload under another interrupt policy.
+ *
+ *     Required: libraries: a12_sim, usr_utl
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/usr_utl.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/bb_defs.h>
+#include <MEN/bb_entry.h>
+#include <MEN/bb_a12.h>
+#include <MEN/bb_a12_ext.h>
+#include <MEN/a12_sim.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define REP_DEVS			4			/* M-module slots 0..2, QSPI */
+#define REP_NEST			4			/* nested calls per CPU */
+#define REP_CPUS			256			/* A12_REC.cpu */
+#define REP_QSPI_STAT		0x1f		/* QSPI status in the QSPI window */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* recorded entry point call */
+typedef struct {
+	u_int32		rep;			/* A12_REP_xxx */
+	u_int32		dev;			/* A12_REC.dev */
+	u_int32		cpu;
+	u_int32		val;			/* 1st argument */
+	u_int32		nArg;			/* ARG records */
+	u_int32		size;			/* 1st ARG: size */
+	u_int32		dataMode;		/* 1st ARG: dataMode */
+	u_int32		pattern;		/* 2nd ARG */
+	u_int32		ret;			/* EXIT val */
+	u_int32		ctrlValid;		/* devices read, mask */
+	u_int8		ctrl[REP_DEVS];	/* value read per device */
+	u_int64		time;			/* ENTRY time [cycles] */
+	u_int64		cycles;			/* ENTRY..EXIT [cycles] */
+	u_int32		reads;			/* recorded register accesses */
+	u_int32		writes;
+	u_int32		blkBytes;
+} REP_CALL;
+
+/* statistics of one entry point */
+typedef struct {
+	u_int32		calls;
+	u_int32		reads;
+	u_int32		writes;
+	u_int32		blkBytes;
+	u_int64		cycles;
+	u_int32		simCalls;		/* replay */
+	u_int32		simReads;
+	u_int32		simWrites;
+	u_int64		simNs;
+	u_int32		mismatch;
+} REP_STAT;
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static const char *G_repName[A12_REP_NUM] = {
+	"other", "IrqEnable", "IrqSrvInit", "IrqSrvExit", "IrqPendMask",
+	"DeferClaim", "Poll", "BlkRead", "BlkWrite", "BlkFill"
+};
+
+static const char *G_policyKey[3] = {
+	"SLOT_0_IRQ_POLICY", "SLOT_1_IRQ_POLICY", "SLOT_2_IRQ_POLICY"
+};
+
+static REP_CALL	*G_call;				/* calls in order of EXIT */
+static u_int32	G_calls;
+static REP_STAT	G_stat[A12_REP_NUM];	/* [0]: outside entry points */
+static u_int32	G_preEnable;			/* slots to enable before replay */
+static u_int32	G_maxSize;				/* largest block */
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void usage(void);
+static int32 Analyse( u_int8 *buf, u_int32 len, u_int32 verbose,
+					  double *nsPerCycP );
+static int32 Replay( u_int32 defer, u_int32 pollMask );
+static void ReplayCall( BBIS_ENTRY *bb, BBIS_HANDLE *h, REP_CALL *c,
+						void *data, u_int32 *retP );
+static void Report( double nsPerCyc );
+
+/********************************* usage ************************************
+ *
+ *  Description: Print program usage
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void usage(void)
+{
+	printf("Usage: a12_replay [<opts>] <file>\n");
+	printf("Function: Analyse and replay an A12 access recording\n");
+	printf("Options:\n");
+	printf("    file      recording (M_BB_A12_BLK_REC chunks)\n");
+	printf("    -v        list the records\n");
+	printf("    -n        analyse only, no replay\n");
+	printf("    -D        replay with deferred IRQ servicing\n");
+	printf("    -P=<mask> replay with polled slots (mask) .. [0]\n");
+	printf("    -c=<ns>   latency of PCI config access ..... [200]\n");
+	printf("    -r=<ns>   latency of non-posted read ....... [1000]\n");
+	printf("    -w=<ns>   latency of posted write .......... [100]\n");
+	printf("    -b=<ns>   each further DWORD of a burst .... [30]\n");
+	printf("\n");
+}
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return		success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main( int argc, char *argv[] )
+{
+	A12SIM_LATENCY	lat;
+	char			*str, errstr[40], *file = NULL;
+	u_int8			*buf = NULL;
+	u_int32			len = 0, n, defer, pollMask, mismatch;
+	double			nsPerCyc;
+	FILE			*fp;
+	int32			i, ret = 1;
+
+	/*--------------------+
+	|  check arguments    |
+	+--------------------*/
+	if( (str = UTL_ILLIOPT("vnDP=c=r=w=b=?", errstr)) ){
+		printf("*** %s\n", errstr);
+		return(1);
+	}
+	for( i=1; i<argc; i++ ){
+		if( *argv[i] != '-' ){
+			file = argv[i];
+			break;
+		}
+	}
+	if( UTL_TSTOPT("?") || !file ){
+		usage();
+		return(1);
+	}
+
+	defer		= (UTL_TSTOPT("D") ? TRUE : FALSE);
+	pollMask	= ((str = UTL_TSTOPT("P=")) ? strtoul(str, NULL, 0) : 0);
+	lat.cfgNs	= ((str = UTL_TSTOPT("c=")) ? atoi(str) : 200);
+	lat.readNs	= ((str = UTL_TSTOPT("r=")) ? atoi(str) : 1000);
+	lat.writeNs	= ((str = UTL_TSTOPT("w=")) ? atoi(str) : 100);
+	lat.beatNs	= ((str = UTL_TSTOPT("b=")) ? atoi(str) : 30);
+	lat.waitNs	= 0;
+	lat.spin	= FALSE;
+
+	/*--------------------+
+	|  read recording     |
+	+--------------------*/
+	if( (fp = fopen( file, "rb" )) == NULL ){
+		printf("*** can't open %s\n", file);
+		return(1);
+	}
+	for(;;){
+		if( (buf = realloc( buf, len + 0x10000 )) == NULL ){
+			printf("*** out of memory\n");
+			fclose( fp );
+			return(1);
+		}
+		if( (n = (u_int32)fread( buf + len, 1, 0x10000, fp )) == 0 )
+			break;
+		len += n;
+	}
+	fclose( fp );
+
+	if( Analyse( buf, len, UTL_TSTOPT("v") ? TRUE : FALSE, &nsPerCyc ) )
+		goto cleanup;
+
+	/*--------------------+
+	|  replay             |
+	+--------------------*/
+	if( !UTL_TSTOPT("n") ){
+		A12SIM_Reset();
+		A12SIM_SetLatency( &lat );
+		if( Replay( defer, pollMask ) )
+			goto cleanup;
+	}
+
+	Report( nsPerCyc );
+
+	for( mismatch=0, n=0; n<A12_REP_NUM; n++ )
+		mismatch += G_stat[n].mismatch;
+
+	/* the recorded configuration must reproduce the recording */
+	ret = (mismatch && !defer && !pollMask) ? 1 : 0;
+
+cleanup:
+	free( G_call );
+	free( buf );
+	return ret;
+}
+
+/******************************** Analyse ***********************************
+ *
+ *  Description: Parse the chunks and collect the recorded calls
+ *
+ *               Records are attributed to the innermost open entry point
+ *               of their CPU. An interrupt taken while a call of the same
+ *               CPU is open nests into it.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: buf		file contents
+ *               len		file size [bytes]
+ *               verbose	TRUE: list the records
+ *  Output.....: nsPerCycP	ns per CPU cycle, 0 if unknown
+ *               return		success (0) or error (1)
+ *  Globals....: G_call, G_calls, G_stat, G_preEnable, G_maxSize
+ ****************************************************************************/
+static int32 Analyse(
+	u_int8 *buf,
+	u_int32 len,
+	u_int32 verbose,
+	double *nsPerCycP )
+{
+	static REP_CALL stack[REP_CPUS][REP_NEST];
+	static u_int32 depth[REP_CPUS];
+	A12_REC_HDR hdr, first;
+	A12_REC *r;
+	REP_CALL *c;
+	REP_STAT *st;
+	u_int32 pos = 0, i, chunks = 0, recs = 0, lost = 0, bad = 0, max = 0;
+	u_int32 enabled = 0;
+	u_int64 t = 0;
+
+	*nsPerCycP = 0.0;
+	memset( &first, 0, sizeof(first) );
+
+	while( pos + sizeof(hdr) <= len ){
+		memcpy( &hdr, buf + pos, sizeof(hdr) );
+		if( hdr.magic != A12_REC_MAGIC || hdr.version != A12_REC_VERSION ||
+			hdr.recSize != sizeof(A12_REC) ||
+			pos + sizeof(hdr) + hdr.count * sizeof(A12_REC) > len ){
+			printf("*** bad chunk at offset 0x%x\n", pos);
+			return 1;
+		}
+		if( !chunks++ )
+			first = hdr;
+		lost += hdr.lost;
+		r = (A12_REC*)(buf + pos + sizeof(hdr));
+		t = hdr.cycles;
+
+		for( i=0; i<hdr.count; i++, r++ ){
+			t += r->dt;
+			recs++;
+			if( verbose )
+				printf("%14llu cpu %3u dev %3u op %u arg %3u val 0x%08x\n",
+					   (unsigned long long)t, r->cpu, r->dev, r->op,
+					   r->arg, r->val);
+
+			c = depth[r->cpu] ? &stack[r->cpu][depth[r->cpu]-1] : NULL;
+			st = &G_stat[c ? c->rep : 0];
+
+			switch( r->op ){
+			case A12_ROP_RD8:
+				st->reads++;
+				if( c ){
+					c->reads++;
+					if( r->dev < REP_DEVS && !(c->ctrlValid & (1<<r->dev)) ){
+						c->ctrl[r->dev] = (u_int8)r->val;
+						c->ctrlValid |= 1 << r->dev;
+					}
+				}
+				break;
+			case A12_ROP_WR8:
+				st->writes++;
+				if( c )
+					c->writes++;
+				break;
+			case A12_ROP_RDBLK:
+			case A12_ROP_WRBLK:
+				/* bytes only, the access width depends on the build */
+				st->blkBytes += r->val;
+				if( c )
+					c->blkBytes += r->val;
+				break;
+			case A12_ROP_ENTRY:
+				if( r->arg == 0 || r->arg >= A12_REP_NUM ||
+					depth[r->cpu] == REP_NEST ){
+					bad++;
+					break;
+				}
+				c = &stack[r->cpu][depth[r->cpu]++];
+				memset( c, 0, sizeof(*c) );
+				c->rep	= r->arg;
+				c->dev	= r->dev;
+				c->cpu	= r->cpu;
+				c->val	= r->val;
+				c->time	= t;
+
+				/* slot used before the recording enabled it */
+				if( r->dev < 3 && r->arg != A12_REP_IRQENABLE &&
+					!(enabled & (1 << r->dev)) )
+					G_preEnable |= 1 << r->dev;
+				if( r->dev < 3 && r->arg == A12_REP_IRQENABLE )
+					enabled |= 1 << r->dev;
+				break;
+			case A12_ROP_ARG:
+				if( !c ){
+					bad++;
+					break;
+				}
+				if( !c->nArg++ ){
+					c->size		= r->val;
+					c->dataMode	= r->arg;
+					if( c->size > G_maxSize )
+						G_maxSize = c->size;
+				}
+				else
+					c->pattern	= r->val;
+				break;
+			case A12_ROP_EXIT:
+				if( !c || c->rep != r->arg ){
+					bad++;
+					break;
+				}
+				depth[r->cpu]--;
+				c->ret		= r->val;
+				c->cycles	= t - c->time;
+				st->calls++;
+				st->cycles += c->cycles;
+
+				if( G_calls == max ){
+					max = max ? 2 * max : 1024;
+					if( (G_call = realloc( G_call, max * sizeof(*c) )) ==
+						NULL ){
+						printf("*** out of memory\n");
+						return 1;
+					}
+				}
+				G_call[G_calls++] = *c;
+				break;
+			default:
+				bad++;
+			}
+		}
+
+		/* time base from the last chunk */
+		if( hdr.tickRate && hdr.tickNow != first.tickOn &&
+			hdr.cycNow > first.cycOn )
+			*nsPerCycP = (double)(u_int32)(hdr.tickNow - first.tickOn) *
+				1e9 / hdr.tickRate / (double)(hdr.cycNow - first.cycOn);
+
+		pos += sizeof(hdr) + hdr.count * sizeof(A12_REC);
+	}
+
+	if( pos != len )
+		printf("*** %u trailing bytes ignored\n", len - pos);
+
+	for( i=0; i<REP_CPUS; i++ )
+		bad += depth[i];				/* still open */
+
+	printf("%u chunks, %u records, %u calls, %u lost, %u unmatched\n",
+		   chunks, recs, G_calls, lost, bad);
+	if( *nsPerCycP )
+		printf("time base: %.3f ns per cycle\n", *nsPerCycP);
+	else
+		printf("time base: unknown, times in cycles\n");
+
+	return 0;
+}
+
+/********************************* Replay ***********************************
+ *
+ *  Description: Replay the recorded calls on the simulator
+ *
+ *               The BBIS is initialized with the default descriptor,
+ *               optionally with deferred servicing or polled slots.
+ *               Slots used before the recording enabled them are enabled
+ *               first.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: defer		TRUE: IRQ_DEFER
+ *               pollMask	slots with A12_POLICY_POLL
+ *  Output.....: return		success (0) or error (1)
+ *  Globals....: G_call, G_calls, G_stat
+ ****************************************************************************/
+static int32 Replay(
+	u_int32 defer,
+	u_int32 pollMask )
+{
+	A12SIM_DESC desc[6];
+	BBIS_ENTRY bb;
+	BBIS_HANDLE *h = NULL;
+	A12SIM_STATS sim;
+	REP_STAT *st;
+	REP_CALL *c;
+	void *data = NULL;
+	u_int32 i, n = 0, ret;
+	int32 error;
+
+	desc[n].key = "DEBUG_LEVEL";	desc[n++].value = 0;
+	if( defer ){
+		desc[n].key = "IRQ_DEFER";	desc[n++].value = 1;
+	}
+	for( i=0; i<3; i++ ){
+		if( pollMask & (1 << i) ){
+			desc[n].key = G_policyKey[i];
+			desc[n++].value = A12_POLICY_POLL;
+		}
+	}
+	desc[n].key = NULL;				desc[n].value = 0;
+
+	A12_GetEntry( &bb );
+	if( (error = bb.init( NULL, (DESC_SPEC*)desc, &h )) ||
+		(error = bb.brdInit( h )) ){
+		printf("*** init failed: 0x%x\n", (int)error);
+		goto abort;
+	}
+	for( i=0; i<3; i++ ){
+		if( (G_preEnable & (1 << i)) &&
+			(error = bb.irqEnable( h, i, TRUE )) ){
+			printf("*** irqEnable slot %u failed: 0x%x\n", i, (int)error);
+			goto abort;
+		}
+	}
+
+	if( (data = calloc( 1, G_maxSize + 4 )) == NULL ){
+		printf("*** out of memory\n");
+		goto abort;
+	}
+
+	for( i=0; i<G_calls; i++ ){
+		c = &G_call[i];
+		st = &G_stat[c->rep];
+
+		A12SIM_ClrStats();
+		ReplayCall( &bb, h, c, data, &ret );
+		A12SIM_GetStats( &sim );
+
+		st->simCalls++;
+		st->simReads	+= sim.reads;
+		st->simWrites	+= sim.writes;
+		st->simNs		+= sim.simNs;
+		if( ret != c->ret )
+			st->mismatch++;
+	}
+	A12SIM_SetCpu( 0 );
+
+	bb.brdExit( h );
+	bb.exit( &h );
+	free( data );
+	return 0;
+
+abort:
+	if( h )
+		bb.exit( &h );
+	free( data );
+	return 1;
+}
+
+/******************************* ReplayCall *********************************
+ *
+ *  Description: Present the recorded state and call one entry point
+ *
+ *               The IRQ lines of the slots (and the QSPI status) are set
+ *               to the first value the recorded call read from them.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               c		recorded call
+ *               data	block buffer
+ *  Output.....: retP	result, compares to the EXIT record
+ *  Globals....: -
+ ****************************************************************************/
+static void ReplayCall(
+	BBIS_ENTRY *bb,
+	BBIS_HANDLE *h,
+	REP_CALL *c,
+	void *data,
+	u_int32 *retP )
+{
+	u_int32 dev, mask = 0;
+
+	*retP = 0;
+
+	A12SIM_SetCpu( c->cpu );
+
+	for( dev=0; dev<REP_DEVS; dev++ ){
+		if( !(c->ctrlValid & (1 << dev)) )
+			continue;
+		if( dev < 3 )
+			A12SIM_SetIrq( dev, (c->ctrl[dev] & A12SIM_CTRL_IRQ) ? 1 : 0 );
+		else
+			A12SIM_Poke8( 3, REP_QSPI_STAT, c->ctrl[dev] );
+	}
+
+	/* A12_REC.dev back to the BBIS slot number */
+	dev = c->dev == 3 ? 0x1000 : c->dev;
+
+	switch( c->rep ){
+	case A12_REP_IRQENABLE:
+		*retP = (u_int32)bb->irqEnable( h, dev, c->val );
+		break;
+	case A12_REP_SRVINIT:
+		*retP = (u_int32)bb->irqSrvInit( h, dev );
+		break;
+	case A12_REP_SRVEXIT:
+		bb->irqSrvExit( h, dev );
+		break;
+	case A12_REP_PENDMASK:
+		A12_ENTRY_IRQPENDMASK( bb )( h, &mask );
+		*retP = mask;
+		break;
+	case A12_REP_DEFERCLAIM:
+		A12_ENTRY_DEFERCLAIM( bb )( h, c->val, &mask );
+		*retP = mask;
+		break;
+	case A12_REP_POLL:
+		A12_ENTRY_POLL( bb )( h, &mask );
+		*retP = mask;
+		break;
+	case A12_REP_BLKREAD:
+		*retP = (u_int32)A12_ENTRY_BLKREAD( bb )( h, dev, c->dataMode,
+												  c->val, data, c->size );
+		break;
+	case A12_REP_BLKWRITE:
+		*retP = (u_int32)A12_ENTRY_BLKWRITE( bb )( h, dev, c->dataMode,
+												   c->val, data, c->size );
+		break;
+	case A12_REP_BLKFILL:
+		*retP = (u_int32)A12_ENTRY_BLKFILL( bb )( h, dev, c->dataMode,
+												  c->val, c->pattern,
+												  c->size );
+		break;
+	}
+}
+
+/********************************* Report ***********************************
+ *
+ *  Description: Print recorded and replayed cost per entry point
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: nsPerCyc	ns per CPU cycle, 0 if unknown
+ *  Output.....: -
+ *  Globals....: G_stat
+ ****************************************************************************/
+static void Report( double nsPerCyc )
+{
+	REP_STAT *st;
+	u_int32 n;
+	double t;
+
+	printf("\n%-11s |%8s %8s %8s %9s %10s |%8s %8s %10s %8s\n",
+		   "", "calls", "reads", "writes", "blk bytes",
+		   nsPerCyc ? "ns/call" : "cyc/call",
+		   "reads", "writes", "bus ns/call", "mismatch");
+	printf("%-11s |%46s |%39s\n", "entry", "recorded", "replayed");
+
+	for( n=1; n<=A12_REP_NUM; n++ ){
+		st = &G_stat[n % A12_REP_NUM];		/* "other" last */
+		if( !st->calls && !st->reads && !st->writes )
+			continue;
+
+		t = st->calls ? (double)st->cycles / st->calls : 0.0;
+		if( nsPerCyc )
+			t *= nsPerCyc;
+
+		printf("%-11s |%8u %8u %8u %9u %10.0f |", G_repName[n % A12_REP_NUM],
+			   st->calls, st->reads, st->writes, st->blkBytes, t);
+		if( st->simCalls )
+			printf("%8u %8u %10.0f %8u\n", st->simReads, st->simWrites,
+				   (double)st->simNs / st->simCalls, st->mismatch);
+		else
+			printf("%8s %8s %10s %8s\n", "-", "-", "-", "-");
+	}
+}
@@ -0,0 +1,348 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                  A 1 2 _ S I M R U N               ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *       Author: kp
+ *
+ *  Description: Exercise the A12 BBIS against the host-side simulator
+ *
+ *               Calls the entry points of the real A12_GetEntry jump
+ *               table and reports the PCI transactions and the simulated
+ *               bus time spent in each of them. The tests are grouped
+ *               by feature in a12_simrun_xxx.c, see a12_simrun_int.h.
+ *
+ *     Required: libraries: a12_sim, usr_utl
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "a12_simrun_int.h"
+#include <MEN/usr_utl.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* access recording test: default file */
+#define REC_FILE			"a12.rec"
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+/* plain board, used by most tests */
+const A12SIM_DESC G_desc[] = {
+	{ "DEBUG_LEVEL",	0 },
+	{ NULL,				0 }
+};
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void usage(void);
+
+/********************************* usage ************************************
+ *
+ *  Description: Print program usage
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void usage(void)
+{
+	printf("Usage: a12_simrun [<opts>]\n");
+	printf("Function: Exercise the A12 BBIS against the bridge simulator\n");
+	printf("Options:\n");
+	printf("    -t=<n>    test ............................. [0]\n");
+	printf("              0 = PCI cost of all entry points\n");
+	printf("              1 = IRQ moderation, CPU time for a 100 kHz\n");
+	printf("                  sample stream on slot 0\n");
+	printf("              2 = deferred servicing, 3 busy slots on\n");
+	printf("                  %d CPUs\n", DEF_CPUS);
+	printf("              3 = hybrid IRQ/poll mode, 200 kHz burst\n");
+	printf("                  between 1 kHz phases on slot 0\n");
+	printf("              4 = address views, BAR0 above 4GB\n");
+	printf("              5 = block transfers vs. per-word loops\n");
+	printf("              6 = scatter-gather queue\n");
+	printf("              7 = %d bridges, independence and scaling\n",
+		   A12SIM_MAX_BRIDGES);
+	printf("              8 = lazy slot set up, init and first open\n");
+	printf("              9 = per-slot configuration table\n");
+	printf("             10 = event trace of the interrupt path\n");
+	printf("             11 = QSPI interrupt check and window\n");
+	printf("             12 = batched resource query\n");
+	printf("             13 = bus timing, throughput per slot and window\n");
+	printf("             14 = IRQ CPU hints\n");
+	printf("             15 = access recording, file for a12_replay\n");
+	printf("             16 = suspend/resume and warm restart\n");
+	printf("             17 = slot reset, downtime and other slots\n");
+	printf("             18 = IRQ storm quarantine, stuck IRQ on slot 0\n");
+	printf("             19 = slot scan order, reads and latency\n");
+	printf("    -e=<n>    moderation: IRQs before holdoff .. [1]\n");
+	printf("    -m=<ms>   moderation: holdoff time ......... [1]\n");
+	printf("    -c=<ns>   latency of PCI config access ..... [200]\n");
+	printf("    -r=<ns>   latency of non-posted read ....... [1000]\n");
+	printf("    -w=<ns>   latency of posted write .......... [100]\n");
+	printf("    -b=<ns>   each further DWORD of a burst .... [30]\n");
+	printf("    -W=<ns>   each timing step below fast ...... [120]\n");
+	printf("    -s        burn latency on the CPU (spin)\n");
+	printf("    -f=<file> recording: file .................. [%s]\n",
+		   REC_FILE);
+	printf("\n");
+}
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return		success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main( int argc, char *argv[] )
+{
+	BBIS_ENTRY		bb;
+	A12SIM_LATENCY	lat;
+	char			*str, errstr[40];
+	int32			test;
+	u_int32			events, msec;
+
+	/*--------------------+
+	|  check arguments    |
+	+--------------------*/
+	if( (str = UTL_ILLIOPT("t=c=r=w=b=W=se=m=f=?", errstr)) ){
+		printf("*** %s\n", errstr);
+		return(1);
+	}
+	if( UTL_TSTOPT("?") ){
+		usage();
+		return(1);
+	}
+
+	A12SIM_Reset();
+
+	test		= ((str = UTL_TSTOPT("t=")) ? atoi(str) : 0);
+	lat.cfgNs	= ((str = UTL_TSTOPT("c=")) ? atoi(str) : 200);
+	lat.readNs	= ((str = UTL_TSTOPT("r=")) ? atoi(str) : 1000);
+	lat.writeNs	= ((str = UTL_TSTOPT("w=")) ? atoi(str) : 100);
+	lat.beatNs	= ((str = UTL_TSTOPT("b=")) ? atoi(str) : 30);
+	lat.waitNs	= 0;
+	lat.spin	= (UTL_TSTOPT("s") ? TRUE : FALSE);
+	A12SIM_SetLatency( &lat );
+
+	A12_GetEntry( &bb );
+
+	switch( test ){
+	case 0:
+		return EntryTest( &bb );
+	case 1:
+		events	= ((str = UTL_TSTOPT("e=")) ? atoi(str) : 1);
+		msec	= ((str = UTL_TSTOPT("m=")) ? atoi(str) : 1);
+		return ModTest( &bb, events, msec );
+	case 2:
+		return DeferTest( &bb );
+	case 3:
+		return PollTest( &bb );
+	case 4:
+		return ViewTest( &bb );
+	case 5:
+		return BlkTest( &bb );
+	case 6:
+		return SgTest( &bb );
+	case 7:
+		return BrgTest( &bb );
+	case 8:
+		return LazyTest( &bb );
+	case 9:
+		return CfgTest( &bb );
+	case 10:
+		return TrcTest( &bb );
+	case 11:
+		return QspiTest( &bb );
+	case 12:
+		return ResTest( &bb );
+	case 13:
+		lat.waitNs = ((str = UTL_TSTOPT("W=")) ? atoi(str) : 120);
+		return TimTest( &bb, &lat );
+	case 14:
+		return CpuTest( &bb );
+	case 15:
+		return RecTest( &bb, (str = UTL_TSTOPT("f=")) ? str : REC_FILE );
+	case 16:
+		return WarmTest( &bb );
+	case 17:
+		return RstTest( &bb );
+	case 18:
+		return StormTest( &bb );
+	case 19:
+		return ScanTest( &bb );
+	default:
+		usage();
+		return 1;
+	}
+}
+
+/******************************** Report ************************************
+ *
+ *  Description: Print PCI transactions since last A12SIM_ClrStats
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: what	name of the measured operation
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+void Report( const char *what )
+{
+	A12SIM_STATS st;
+
+	A12SIM_GetStats( &st );
+	printf("%-28s %5u %5u %5u %10llu\n", what, st.cfgReads, st.reads,
+		   st.writes, (unsigned long long)st.simNs );
+}
+
+/***************************** PendDispatch *********************************
+ *
+ *  Description: Dispatch an interrupt with A12_IrqPendMask
+ *
+ *               Calls the (simulated) M-module ISR and irqSrvExit for each
+ *               claimed slot, irqSrvInit is not needed.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *  Output.....: maskP	claimed slots
+ *               return	0 or error code
+ *  Globals....: -
+ ****************************************************************************/
+int32 PendDispatch( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 *maskP )
+{
+	u_int32 slot;
+	int32 error;
+
+	if( (error = A12_ENTRY_IRQPENDMASK( bb )( h, maskP )) )
+		return error;
+
+	for( slot=0; slot<3; slot++ ){
+		if( *maskP & (1 << slot) ){
+			A12SIM_Advance( 2000 );		/* M-module ISR */
+			bb->irqSrvExit( h, slot );
+		}
+	}
+	return 0;
+}
+
+/****************************** ShowIrqStat *********************************
+ *
+ *  Description: Print IRQ statistics of all devices
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *  Output.....: return	0 or error code
+ *  Globals....: -
+ ****************************************************************************/
+int32 ShowIrqStat( BBIS_ENTRY *bb, BBIS_HANDLE *h )
+{
+	A12_IRQ_STAT stat[A12_NBR_OF_DEVS];
+	M_SG_BLOCK blk;
+	int32 dev, n, err;
+
+	blk.size = sizeof(stat);
+	blk.data = (void*)stat;
+	if( (err = bb->getStat( h, 0, M_BB_A12_BLK_IRQSTAT, (INT32_OR_64*)&blk )) )
+		return err;
+
+	for( dev=0; dev<A12_NBR_OF_DEVS; dev++ ){
+		printf("dev %d: irqYes=%u irqNo=%u deferred=%u hist:", dev,
+			   stat[dev].irqYes, stat[dev].irqNo, stat[dev].irqDeferred );
+		for( n=0; n<A12_HIST_BUCKETS; n++ )
+			if( stat[dev].hist[n] )
+				printf(" 2^%d:%u", n, stat[dev].hist[n] );
+		printf("\n");
+	}
+	return 0;
+}
+
+/********************************* SimOpen **********************************
+ *
+ *  Description: Open and initialize the board, enable slot interrupts
+ *
+ *               Common set up of the tests. The simulator is not reset,
+ *               bridges and latency model are kept.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               desc	board descriptor
+ *               ien	slots to enable the interrupt of (bit n = slot n)
+ *  Output.....: *hP	board handle, NULL on error
+ *               return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 SimOpen(
+	BBIS_ENTRY *bb,
+	const A12SIM_DESC *desc,
+	u_int32 ien,
+	BBIS_HANDLE **hP )
+{
+	u_int32 slot;
+
+	*hP = NULL;
+	CHK( bb->init( NULL, (DESC_SPEC*)desc, hP ) == 0 );
+	CHK( bb->brdInit( *hP ) == 0 );
+	for( slot=0; slot<3; slot++ ){
+		if( ien & (1 << slot) )
+			CHK( bb->irqEnable( *hP, slot, TRUE ) == 0 );
+	}
+	return 0;
+
+abort:
+	SimClose( bb, hP );
+	return 1;
+}
+
+/********************************* SimClose *********************************
+ *
+ *  Description: Deinitialize and close the board of SimOpen
+ *
+ *               Also used on the error path of the tests, nothing to do
+ *               without handle.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               hP		board handle or NULL
+ *  Output.....: *hP	NULL
+ *               return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 SimClose( BBIS_ENTRY *bb, BBIS_HANDLE **hP )
+{
+	int32 error = 0;
+
+	if( *hP == NULL )
+		return 0;
+
+	if( bb->brdExit( *hP ) )
+		error = 1;
+	if( bb->exit( hP ) )
+		error = 1;
+	return error;
+}
@@ -0,0 +1,676 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: a12_simrun_cfg.c
+ *      Project: A12 simulator run tool
+ *
+ *       Author: kp
+ *
+ *  Description: Set up tests: multiple bridges, lazy slot set up, per-slot
+ *               configuration table, QSPI and resource query
+ *               (tests 7, 8, 9, 11, 12)
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "a12_simrun_int.h"
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* QSPI test: IRQ9 hits, every 4th spurious */
+#define QSPI_IRQS			1000
+#define QSPI_SPIF			0x80		/* SPSR: QSPI finished */
+
+/* resource query test */
+#define RES_ROUNDS			1000		/* queries of all devices */
+#define RES_DEVS			4			/* M-module slots 0..2, QSPI */
+
+/* multi-bridge test: 1..A12SIM_MAX_BRIDGES bridges, 3 busy slots each */
+#define BRG_ROUNDS			1000		/* IRQs per slot */
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+/* bridges of the multi-bridge test: explicit location or bus scan */
+static const A12SIM_DESC G_descBrg[A12SIM_MAX_BRIDGES][4] = {
+	{ { "DEBUG_LEVEL", 0 }, { NULL, 0 } },
+	{ { "DEBUG_LEVEL", 0 }, { "PCI_BUS_NUMBER", 1 },
+	  { "PCI_DEVICE_NUMBER", 0x18 }, { NULL, 0 } },
+	{ { "DEBUG_LEVEL", 0 }, { "PCI_BUS_NUMBER", 2 },
+	  { "PCI_DEVICE_NUMBER", 0x0c }, { NULL, 0 } },
+	{ { "DEBUG_LEVEL", 0 }, { "BRIDGE_INSTANCE", 3 }, { NULL, 0 } }
+};
+
+/* lazy slot set up */
+static const A12SIM_DESC G_descLazy[] = {
+	{ "DEBUG_LEVEL",	0 },
+	{ "LAZY_INIT",		1 },
+	{ NULL,				0 }
+};
+
+/* configuration table: slot 1 disabled, slot 0 exclusive, slot 2 polled */
+static const A12SIM_DESC G_descCfg[] = {
+	{ "DEBUG_LEVEL",		0 },
+	{ "SLOT_0_IRQ_MODE",	BBIS_IRQ_EXCLUSIVE },
+	{ "SLOT_1_ENABLE",		0 },
+	{ "SLOT_2_IRQ_POLICY",	A12_POLICY_POLL },
+	{ NULL,					0 }
+};
+
+/* QSPI: without status check, moved window and status register */
+static const A12SIM_DESC G_descQspiOff[] = {
+	{ "DEBUG_LEVEL",		0 },
+	{ "QSPI_IRQ_MASK",		0 },
+	{ NULL,					0 }
+};
+static const A12SIM_DESC G_descQspiWin[] = {
+	{ "DEBUG_LEVEL",		0 },
+	{ "QSPI_WIN_OFFSET",	0x06001000 },
+	{ "QSPI_WIN_SIZE",		0x1000 },
+	{ "QSPI_IRQ_OFFSET",	0x10 },
+	{ "QSPI_IRQ_MASK",		0x01 },
+	{ NULL,					0 }
+};
+static const A12SIM_DESC G_descQspiBad[] = {
+	{ "DEBUG_LEVEL",		0 },
+	{ "QSPI_WIN_OFFSET",	0x07fff000 },
+	{ "QSPI_WIN_SIZE",		0x2000 },
+	{ NULL,					0 }
+};
+
+/* PCI location of the bridges above */
+static const u_int32 G_brgLoc[A12SIM_MAX_BRIDGES][2] = {
+	{ 0, 0x18 }, { 1, 0x18 }, { 2, 0x0c }, { 4, 0x10 }
+};
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static int32 BrgRun( BBIS_ENTRY *bb, BBIS_HANDLE **h, u_int32 nBrg );
+static int32 LazyRun( BBIS_ENTRY *bb, const A12SIM_DESC *desc );
+static int32 QspiRun( BBIS_ENTRY *bb, const A12SIM_DESC *desc,
+					  u_int32 winOffs, u_int32 winSize, u_int32 statOffs,
+					  u_int32 statBit );
+static int32 ResSingle( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 mSlot,
+						A12_SLOT_RES *res, u_int32 *callsP );
+
+/********************************* BrgTest **********************************
+ *
+ *  Description: Several bridges driven by independent board instances
+ *
+ *               Bridge 3 is located by a bus scan (BRIDGE_INSTANCE), the
+ *               others by PCI_BUS_NUMBER/PCI_DEVICE_NUMBER. Checks the
+ *               location and IRQ of each instance and that an interrupt
+ *               is seen only by its own instance, then measures the IRQ
+ *               cost with 1..A12SIM_MAX_BRIDGES busy bridges.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 BrgTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE		*h[A12SIM_MAX_BRIDGES];
+	A12_IRQ_STAT	stat;
+	A12SIM_STATS	st;
+	M_SG_BLOCK		blk;
+	u_int32			b, n, bus, dev, vector, level, mode;
+
+	memset( h, 0, sizeof(h) );
+	for( b=1; b<A12SIM_MAX_BRIDGES; b++ )
+		CHK( A12SIM_AddBridge( G_brgLoc[b][0], G_brgLoc[b][1] ) == (int32)b );
+
+	printf("%-6s %4s %4s %4s %8s\n", "bridge", "bus", "dev", "irq",
+		   "init cfg");
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ ){
+		A12SIM_ClrStats();
+		CHK( bb->init( NULL, (DESC_SPEC*)G_descBrg[b], &h[b] ) == 0 );
+		A12SIM_GetStats( &st );
+		CHK( bb->brdInit( h[b] ) == 0 );
+
+		CHK( bb->cfgInfo( h[b], BBIS_CFGINFO_BUSNBR, &bus, 0 ) == 0 );
+		CHK( bb->cfgInfo( h[b], BBIS_CFGINFO_PCI_DEVNBR, 0, &dev ) == 0 );
+		CHK( bb->cfgInfo( h[b], BBIS_CFGINFO_IRQ, 0, &vector, &level,
+						  &mode ) == 0 );
+		printf("%-6u %4u %4x %4u %8u\n", b, bus, dev, level, st.cfgReads );
+		CHK( bus == G_brgLoc[b][0] && dev == G_brgLoc[b][1] );
+		CHK( level == A12SIM_IRQ_LINE_DEFAULT + b );
+	}
+
+	/* slot 0 IRQ of bridge 2 is seen only by its instance */
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ )
+		CHK( bb->irqEnable( h[b], 0, TRUE ) == 0 );
+	A12SIM_SelBridge( 2 );
+	A12SIM_SetIrq( 0, 1 );
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ ){
+		CHK( bb->irqSrvInit( h[b], 0 ) ==
+			 (b == 2 ? BBIS_IRQ_YES : BBIS_IRQ_NO) );
+		bb->irqSrvExit( h[b], 0 );
+
+		blk.size = sizeof(stat);
+		blk.data = (void*)&stat;
+		CHK( bb->getStat( h[b], 0, M_BB_A12_BLK_IRQSTAT,
+						  (INT32_OR_64*)&blk ) == 0 );
+		CHK( stat.irqYes == (b == 2 ? 1 : 0) );
+	}
+	A12SIM_SetIrq( 0, 0 );
+
+	/* scaling */
+	printf("\n%-7s %8s %8s %10s %8s\n", "bridges", "irqs", "pci",
+		   "bus [us]", "ns/irq");
+	for( n=1; n<=A12SIM_MAX_BRIDGES; n++ )
+		CHK( BrgRun( bb, h, n ) == 0 );
+
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ )
+		CHK( SimClose( bb, &h[b] ) == 0 );
+	return 0;
+
+abort:
+	for( b=0; b<A12SIM_MAX_BRIDGES; b++ )
+		SimClose( bb, &h[b] );
+	return 1;
+}
+
+/********************************** BrgRun **********************************
+ *
+ *  Description: Service BRG_ROUNDS interrupts on each slot of nBrg
+ *               bridges and print the PCI cost
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handles of the bridges
+ *               nBrg	number of busy bridges
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 BrgRun( BBIS_ENTRY *bb, BBIS_HANDLE **h, u_int32 nBrg )
+{
+	A12SIM_STATS st;
+	u_int32 b, slot, i, irqs = 0;
+
+	for( b=0; b<nBrg; b++ )
+		for( slot=0; slot<3; slot++ )
+			CHK( bb->irqEnable( h[b], slot, TRUE ) == 0 );
+
+	A12SIM_ClrStats();
+	for( i=0; i<BRG_ROUNDS; i++ ){
+		for( b=0; b<nBrg; b++ ){
+			A12SIM_SelBridge( b );
+			for( slot=0; slot<3; slot++ ){
+				A12SIM_SetIrq( slot, 1 );
+				CHK( bb->irqSrvInit( h[b], slot ) == BBIS_IRQ_YES );
+				A12SIM_SetIrq( slot, 0 );
+				bb->irqSrvExit( h[b], slot );
+				irqs++;
+			}
+		}
+	}
+	A12SIM_GetStats( &st );
+
+	printf("%-7u %8u %8u %10llu %8llu\n", nBrg, irqs, st.reads + st.writes,
+		   (unsigned long long)st.simNs / 1000,
+		   (unsigned long long)st.simNs / irqs );
+	return 0;
+
+abort:
+	return 1;
+}
+
+/******************************** LazyTest **********************************
+ *
+ *  Description: Cost of init, first open of slot 0 and exit without and
+ *               with LAZY_INIT
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 LazyTest( BBIS_ENTRY *bb )
+{
+	printf("%-6s %-10s %5s %5s %5s %5s %5s %10s\n", "mode", "step", "cfg",
+		   "pci", "maps", "unmap", "desc", "bus [ns]");
+
+	CHK( LazyRun( bb, G_desc ) == 0 );
+	CHK( LazyRun( bb, G_descLazy ) == 0 );
+	return 0;
+
+abort:
+	return 1;
+}
+
+/********************************* LazyRun **********************************
+ *
+ *  Description: Init, open slot 0 like MDIS does, exit
+ *
+ *               With LAZY_INIT, init must not map anything and only the
+ *               control register of slot 0 is set up and unmapped again.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               desc	descriptor
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 LazyRun( BBIS_ENTRY *bb, const A12SIM_DESC *desc )
+{
+	const char *mode = (desc == G_descLazy) ? "lazy" : "eager";
+	BBIS_HANDLE *h = NULL;
+	A12SIM_STATS st;
+	u_int32 vector, level, irqMode, size, maps;
+	void *addr;
+
+	A12SIM_Reset();
+
+	A12SIM_ClrStats();
+	CHK( SimOpen( bb, desc, 0, &h ) == 0 );
+	LazyReport( mode, "init" );
+	A12SIM_GetStats( &st );
+	maps = st.maps;
+	if( desc == G_descLazy )
+		CHK( st.maps == 0 && A12SIM_CtrlPeek( 1 ) == 0 );
+
+	A12SIM_ClrStats();
+	CHK( bb->cfgInfo( h, BBIS_CFGINFO_IRQ, 0, &vector, &level,
+					  &irqMode ) == 0 );
+	CHK( bb->getMAddr( h, 0, MDIS_MA08, MDIS_MD16, &addr, &size ) == 0 );
+	CHK( bb->irqEnable( h, 0, TRUE ) == 0 );
+	LazyReport( mode, "open" );
+	A12SIM_GetStats( &st );
+	maps += st.maps;
+	CHK( (A12SIM_CtrlPeek( 0 ) & 0x0c) == 0x0c );
+
+	A12SIM_ClrStats();
+	CHK( bb->irqEnable( h, 0, FALSE ) == 0 );
+	CHK( SimClose( bb, &h ) == 0 );
+	LazyReport( mode, "exit" );
+	A12SIM_GetStats( &st );
+	CHK( st.unmaps == maps );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/******************************** LazyReport ********************************
+ *
+ *  Description: Print costs since last A12SIM_ClrStats
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: mode	eager/lazy
+ *               what	step
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+void LazyReport( const char *mode, const char *what )
+{
+	A12SIM_STATS st;
+
+	A12SIM_GetStats( &st );
+	printf("%-6s %-10s %5u %5u %5u %5u %5u %10llu\n", mode, what,
+		   st.cfgReads, st.reads + st.writes, st.maps, st.unmaps,
+		   st.descKeys, (unsigned long long)st.simNs );
+}
+
+/********************************* CfgTest **********************************
+ *
+ *  Description: Per-slot configuration table from descriptor and setstat
+ *
+ *               Slot 1 is disabled: init and the IRQ demux must not touch
+ *               it and it can not be opened. Slot 0 is opened with
+ *               exclusive IRQ mode, slot 2 is always polled.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 CfgTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE *h = NULL;
+	A12SIM_STATS st;
+	u_int32 vector, level, irqMode, size, mask, slot;
+	INT32_OR_64 val;
+	void *addr;
+
+	A12SIM_Reset();
+
+	/* init, disabled slot untouched */
+	A12SIM_ClrStats();
+	CHK( SimOpen( bb, G_descCfg, 0, &h ) == 0 );
+	A12SIM_GetStats( &st );
+	printf("init:        %u maps, slot 1 ctrl 0x%02x\n", st.maps,
+		   A12SIM_CtrlPeek( 1 ));
+	CHK( st.maps == 3 );			/* slots 0, 2 and QSPI status */
+	CHK( A12SIM_CtrlPeek( 1 ) == 0 );
+	CHK( (A12SIM_CtrlPeek( 0 ) & 0x0c) == 0x0c );
+
+	/* configuration as read from the descriptor */
+	CHK( bb->getStat( h, 1, M_BB_A12_SLOT_ENABLE, &val ) == 0 && val == 0 );
+	CHK( bb->getStat( h, 2, M_BB_A12_SLOT_POLICY, &val ) == 0 &&
+		 val == A12_POLICY_POLL );
+	CHK( bb->getStat( h, 0x1000, M_BB_A12_SLOT_IRQ_MODE, &val ) == 0 &&
+		 val == BBIS_IRQ_EXCLUSIVE );
+	CHK( bb->cfgInfo( h, BBIS_CFGINFO_IRQ, 0, &vector, &level,
+					  &irqMode ) == 0 && irqMode == BBIS_IRQ_EXCLUSIVE );
+	CHK( bb->cfgInfo( h, BBIS_CFGINFO_IRQ, 1, &vector, &level,
+					  &irqMode ) == ERR_BBIS_ILL_SLOT );
+	CHK( bb->getMAddr( h, 1, MDIS_MA08, MDIS_MD16, &addr, &size ) ==
+		 ERR_BBIS_ILL_SLOT );
+	CHK( bb->irqEnable( h, 1, TRUE ) == ERR_BBIS_ILL_SLOT );
+
+	/* open slots 0 and 2, slot 2 polled from the start */
+	CHK( bb->irqEnable( h, 0, TRUE ) == 0 );
+	CHK( bb->irqEnable( h, 2, TRUE ) == 0 );
+	CHK( bb->getStat( h, 2, M_BB_A12_POLL_ACTIVE, &val ) == 0 && val == 1 );
+	CHK( (A12SIM_CtrlPeek( 0 ) & A12SIM_CTRL_IEN) );
+	CHK( !(A12SIM_CtrlPeek( 2 ) & A12SIM_CTRL_IEN) );
+
+	/* IRQ demux: the disabled slot is never read nor claimed */
+	A12SIM_SetIrq( 0, 1 );
+	A12SIM_SetIrq( 1, 1 );
+	A12SIM_SetIrq( 2, 1 );
+	A12SIM_ClrStats();
+	CHK( A12_ENTRY_IRQPENDMASK( bb )( h, &mask ) == 0 );
+	A12SIM_GetStats( &st );
+	printf("demux:       mask 0x%x, %u reads\n", mask, st.reads );
+	CHK( (mask & 3) == 1 && st.reads == 2 );
+	for( slot=0; slot<3; slot++ )
+		if( mask & (1 << slot) )
+			bb->irqSrvExit( h, slot );
+
+	/* poller serves slot 2, the disabled slot is not polled */
+	CHK( A12_ENTRY_POLL( bb )( h, &mask ) == 0 );
+	printf("poll:        mask 0x%x\n", mask );
+	CHK( mask == 4 );
+	CHK( bb->irqSrvInit( h, 2 ) == BBIS_IRQ_YES );
+	bb->irqSrvExit( h, 2 );
+	CHK( bb->getStat( h, 2, M_BB_A12_POLL_ACTIVE, &val ) == 0 && val == 1 );
+	A12SIM_SetIrq( 0, 0 );
+	A12SIM_SetIrq( 1, 0 );
+	A12SIM_SetIrq( 2, 0 );
+
+	/* slot 2 back to interrupts */
+	CHK( bb->setStat( h, 2, M_BB_A12_SLOT_POLICY, A12_POLICY_IRQ ) == 0 );
+	CHK( bb->getStat( h, 2, M_BB_A12_POLL_ACTIVE, &val ) == 0 && val == 0 );
+	CHK( (A12SIM_CtrlPeek( 2 ) & A12SIM_CTRL_IEN) );
+	CHK( bb->setStat( h, 2, M_BB_A12_SLOT_POLICY, 2 ) == ERR_BBIS_ILL_PARAM );
+
+	/* slot 0 can not be disabled while its interrupt is enabled */
+	CHK( bb->setStat( h, 0, M_BB_A12_SLOT_ENABLE, 0 ) == ERR_BBIS_ILL_PARAM );
+	CHK( bb->irqEnable( h, 0, FALSE ) == 0 );
+	CHK( bb->setStat( h, 0, M_BB_A12_SLOT_ENABLE, 0 ) == 0 );
+	CHK( bb->getMAddr( h, 0, MDIS_MA08, MDIS_MD16, &addr, &size ) ==
+		 ERR_BBIS_ILL_SLOT );
+	CHK( bb->setStat( h, 0, M_BB_A12_SLOT_ENABLE, 1 ) == 0 );
+	CHK( bb->getMAddr( h, 0, MDIS_MA08, MDIS_MD16, &addr, &size ) == 0 );
+
+	/* enable slot 1 at runtime, set up on first use */
+	CHK( bb->setStat( h, 1, M_BB_A12_SLOT_IRQ_MODE, 0x55 ) ==
+		 ERR_BBIS_ILL_PARAM );
+	CHK( bb->setStat( h, 1, M_BB_A12_SLOT_ENABLE, 1 ) == 0 );
+	A12SIM_ClrStats();
+	CHK( bb->getMAddr( h, 1, MDIS_MA08, MDIS_MD16, &addr, &size ) == 0 );
+	CHK( bb->cfgInfo( h, BBIS_CFGINFO_IRQ, 1, &vector, &level,
+					  &irqMode ) == 0 && irqMode == BBIS_IRQ_SHARED );
+	A12SIM_GetStats( &st );
+	printf("enable:      slot 1 %u maps, ctrl 0x%02x\n", st.maps,
+		   A12SIM_CtrlPeek( 1 ));
+	CHK( st.maps == 1 && (A12SIM_CtrlPeek( 1 ) & 0x0c) == 0x0c );
+
+	CHK( bb->irqEnable( h, 2, FALSE ) == 0 );
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************* QspiTest *********************************
+ *
+ *  Description: QSPI interrupt ownership check and descriptor window
+ *
+ *               QSPI_IRQS IRQ9 hits, every 4th without a QSPI event. Without
+ *               check (QSPI_IRQ_MASK=0) each hit calls the driver ISR.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 QspiTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE *h = NULL;
+
+	printf("%-8s %6s %6s %6s %6s %10s\n", "mode", "irq9", "isr", "spur",
+		   "pci", "bus [ns]");
+
+	CHK( QspiRun( bb, G_descQspiOff, 0x06000000, 0x800, 0x1f, 0 ) == 0 );
+	CHK( QspiRun( bb, G_desc, 0x06000000, 0x800, 0x1f, QSPI_SPIF ) == 0 );
+	CHK( QspiRun( bb, G_descQspiWin, 0x06001000, 0x1000, 0x10, 0x01 ) == 0 );
+
+	/* window beyond BAR0 */
+	A12SIM_Reset();
+	CHK( bb->init( NULL, (DESC_SPEC*)G_descQspiBad, &h ) ==
+		 ERR_BBIS_DESC_PARAM );
+	return 0;
+
+abort:
+	return 1;
+}
+
+/********************************* QspiRun **********************************
+ *
+ *  Description: Open the QSPI and service IRQ9 hits
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb			BBIS jump table
+ *               desc		descriptor
+ *               winOffs	expected window offset in BAR0
+ *               winSize	expected window size
+ *               statOffs	status register offset in the window
+ *               statBit	event bit in the status register, 0=no check
+ *  Output.....: return		success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 QspiRun( BBIS_ENTRY *bb, const A12SIM_DESC *desc,
+					  u_int32 winOffs, u_int32 winSize, u_int32 statOffs,
+					  u_int32 statBit )
+{
+	BBIS_HANDLE *h = NULL;
+	A12SIM_STATS st;
+	A12_QSPI_STAT qs;
+	M_SG_BLOCK blk;
+	u_int32 i, isr = 0, size, bit, want;
+	void *addr;
+
+	A12SIM_Reset();
+	CHK( SimOpen( bb, desc, 0, &h ) == 0 );
+	CHK( bb->getMAddr( h, 0x1000, MDIS_MA08, MDIS_MD16, &addr, &size ) == 0 );
+	CHK( (U_INT32_OR_64)addr == A12SIM_BAR0_DEFAULT + winOffs );
+	CHK( size == winSize );
+
+	A12SIM_ClrStats();
+	for( i=0; i<QSPI_IRQS; i++ ){
+		bit = (i % 4 == 3) ? 0 : statBit;
+		A12SIM_Poke8( 3, winOffs - 0x06000000 + statOffs, (u_int8)bit );
+		if( bb->irqSrvInit( h, 0x1000 ) == BBIS_IRQ_YES ){
+			isr++;
+			A12SIM_Poke8( 3, winOffs - 0x06000000 + statOffs, 0 );
+		}
+		bb->irqSrvExit( h, 0x1000 );
+	}
+	A12SIM_GetStats( &st );
+
+	blk.size = sizeof(qs);
+	blk.data = (void*)&qs;
+	CHK( bb->getStat( h, 0x1000, M_BB_A12_BLK_QSPISTAT,
+					  (INT32_OR_64*)&blk ) == 0 );
+
+	printf("%-8s %6u %6u %6u %6u %10llu\n",
+		   statBit ? (desc == G_desc ? "check" : "moved") : "no check",
+		   QSPI_IRQS, isr, qs.spurious, st.reads,
+		   (unsigned long long)st.simNs );
+
+	want = statBit ? QSPI_IRQS - QSPI_IRQS / 4 : QSPI_IRQS;
+	CHK( isr == want && qs.spurious == QSPI_IRQS - want );
+	CHK( st.reads == (statBit ? QSPI_IRQS : 0) );
+	if( statBit )
+		CHK( qs.last == statBit && qs.ev[statBit == 1 ? 0 : 7] == want );
+
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************* ResTest **********************************
+ *
+ *  Description: Batched resource query vs. one call per item
+ *
+ *               RES_ROUNDS times the resources of all devices, as a driver
+ *               stack collects them on each open: per item with CfgInfo,
+ *               GetStat and A12_GetMAddrEx, and with one A12_ResQuery.
+ *               Both must agree, also after an IRQ mode change.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 ResTest( BBIS_ENTRY *bb )
+{
+	static const u_int32 dev[RES_DEVS] = { 0, 1, 2, 0x1000 };
+	BBIS_HANDLE *h = NULL;
+	A12_SLOT_RES res[RES_DEVS], one;
+	A12SIM_STATS st;
+	M_SG_BLOCK blk;
+	u_int32 i, d, n, calls = 0;
+
+	A12SIM_Reset();
+	CHK( SimOpen( bb, G_desc, 0, &h ) == 0 );
+
+	printf("%-8s %7s %7s %7s\n", "query", "calls", "irq2vec", "pci");
+
+	/* per item */
+	A12SIM_ClrStats();
+	for( i=0; i<RES_ROUNDS; i++ )
+		for( d=0; d<RES_DEVS; d++ )
+			CHK( ResSingle( bb, h, dev[d], &one, &calls ) == 0 );
+	A12SIM_GetStats( &st );
+	printf("%-8s %7u %7u %7u\n", "per item", calls, st.irqVecs,
+		   st.reads + st.writes + st.cfgReads );
+
+	/* batched */
+	A12SIM_ClrStats();
+	for( i=0; i<RES_ROUNDS; i++ ){
+		n = RES_DEVS;
+		CHK( A12_ENTRY_RESQUERY( bb )( h, A12_RES_ALL, res, &n ) == 0 );
+	}
+	A12SIM_GetStats( &st );
+	printf("%-8s %7u %7u %7u\n", "batched", RES_ROUNDS, st.irqVecs,
+		   st.reads + st.writes + st.cfgReads );
+	CHK( n == RES_DEVS && st.irqVecs == 0 );
+	CHK( st.reads + st.writes + st.cfgReads == 0 );
+
+	for( d=0; d<RES_DEVS; d++ ){
+		CHK( ResSingle( bb, h, dev[d], &one, &calls ) == 0 );
+		CHK( memcmp( &one, &res[d], sizeof(one) ) == 0 );
+	}
+	CHK( res[3].irqLevel == 9 && res[3].win[0].size == 0x800 );
+	CHK( res[1].win[A12_RES_A24_D32].phys == A12SIM_BAR0_DEFAULT + 0x2000000 );
+
+	/* configuration change, single device via blockgetstat */
+	CHK( bb->setStat( h, 0, M_BB_A12_SLOT_IRQ_MODE, BBIS_IRQ_EXCLUSIVE ) == 0 );
+	blk.size = sizeof(one);
+	blk.data = (void*)&one;
+	CHK( bb->getStat( h, 0, M_BB_A12_BLK_SLOTRES, (INT32_OR_64*)&blk ) == 0 );
+	CHK( blk.size == sizeof(one) && one.irqMode == BBIS_IRQ_EXCLUSIVE );
+
+	CHK( bb->setStat( h, 1, M_BB_A12_SLOT_ENABLE, FALSE ) == 0 );
+	blk.size = sizeof(res);
+	blk.data = (void*)res;
+	CHK( bb->getStat( h, 0, M_BB_A12_BLK_SLOTRES, (INT32_OR_64*)&blk ) == 0 );
+	CHK( blk.size == sizeof(res) && !res[1].enable && res[1].win[0].size == 0 );
+	CHK( res[0].irqMode == BBIS_IRQ_EXCLUSIVE );
+	printf("change:  mode %u, slot 1 enable %u\n", res[0].irqMode,
+		   res[1].enable);
+
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/******************************** ResSingle *********************************
+ *
+ *  Description: Resources of one device with one call per item
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               mSlot	module slot number
+ *               callsP	call counter
+ *  Output.....: res	device resources
+ *               callsP	incremented by the calls made
+ *               return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 ResSingle( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 mSlot,
+						A12_SLOT_RES *res, u_int32 *callsP )
+{
+	INT32_OR_64 val;
+	u_int32 i, nWin = mSlot < 0x1000 ? A12_RES_WINS : 1;
+
+	memset( res, 0, sizeof(*res) );
+	res->mSlot	= mSlot;
+	res->enable	= TRUE;
+	CHK( bb->brdInfo( BBIS_BRDINFO_DEVBUSTYPE, mSlot,
+					  &res->devBusType ) == 0 );
+	CHK( bb->brdInfo( BBIS_BRDINFO_INTERRUPTS, mSlot,
+					  &res->interrupts ) == 0 );
+	CHK( bb->brdInfo( BBIS_BRDINFO_ADDRSPACE, mSlot, &res->addrSpace ) == 0 );
+	CHK( bb->cfgInfo( h, BBIS_CFGINFO_BUSNBR, &res->busNbr, mSlot ) == 0 );
+	CHK( bb->cfgInfo( h, BBIS_CFGINFO_PCI_DEVNBR, mSlot,
+					  &res->pciDevNbr ) == 0 );
+	CHK( bb->cfgInfo( h, BBIS_CFGINFO_IRQ, mSlot, &res->irqVector,
+					  &res->irqLevel, &res->irqMode ) == 0 );
+	CHK( bb->getStat( h, mSlot, M_BB_IRQ_VECT, &val ) == 0 );
+	CHK( (u_int32)val == res->irqVector );
+	CHK( bb->getStat( h, mSlot, M_BB_IRQ_LEVEL, &val ) == 0 );
+	CHK( (u_int32)val == res->irqLevel );
+	*callsP += 8;
+
+	for( i=0; i<nWin; i++ ){
+		CHK( A12_ENTRY_GETMADDREX( bb )( h, mSlot,
+			 i < A12_RES_A24_D16 ? MDIS_MA08 : MDIS_MA24,
+			 i & 1 ? MDIS_MD32 : MDIS_MD16, &res->win[i] ) == 0 );
+		(*callsP)++;
+	}
+	return 0;
+
+abort:
+	return 1;
+}
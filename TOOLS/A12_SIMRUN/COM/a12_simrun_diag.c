@@ -0,0 +1,311 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: a12_simrun_diag.c
+ *      Project: A12 simulator run tool
+ *
+ *       Author: kp
+ *
+ *  Description: Diagnostic tests: event trace and access recording
+ *               (tests 10, 15)
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "a12_simrun_int.h"
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* event trace test */
+#define TRC_IRQS			100			/* IRQs per CPU */
+
+/* access recording test */
+#define REC_ROUNDS			1000		/* IRQs, see RecRun */
+#define REC_DRAIN			50			/* rounds between drains */
+#define REC_CHUNK			256			/* records per chunk */
+#define REC_BLK_SIZE		0x100		/* bytes per block transfer */
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+/* access recording from the start */
+static const A12SIM_DESC G_descRec[] = {
+	{ "DEBUG_LEVEL",		0 },
+	{ "REC_ENABLE",			1 },
+	{ NULL,					0 }
+};
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static int32 TrcRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 irqs );
+static int32 RecRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 rounds );
+
+/********************************* TrcTest **********************************
+ *
+ *  Description: Event trace of the interrupt path
+ *
+ *               Interrupts of slot 0 on two CPUs with the trace off and
+ *               on. The trace must not add PCI accesses, the drained
+ *               events must come in pairs per CPU, and a ring overrun must
+ *               be counted as lost.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 TrcTest( BBIS_ENTRY *bb )
+{
+	static A12_TRACE_EV ev[A12_TRACE_CPUS * A12_TRACE_ENTRIES];
+	BBIS_HANDLE *h = NULL;
+	A12SIM_STATS st;
+	M_SG_BLOCK blk;
+	u_int32 n, i, pci[2];
+	INT32_OR_64 val;
+
+	A12SIM_Reset();
+	CHK( SimOpen( bb, G_desc, 0, &h ) == 0 );
+	CHK( bb->irqEnable( h, 0, TRUE ) == 0 );
+
+	blk.data = (void*)ev;
+
+	for( i=0; i<2; i++ ){
+		CHK( bb->setStat( h, 0, M_BB_A12_TRACE, i ) == 0 );
+		A12SIM_ClrStats();
+		CHK( TrcRun( bb, h, TRC_IRQS ) == 0 );
+		A12SIM_GetStats( &st );
+		pci[i] = st.reads + st.writes;
+	}
+	CHK( bb->getStat( h, 0, M_BB_A12_TRACE, &val ) == 0 && val == 1 );
+	printf("PCI accesses for %d IRQs: trace off %u, on %u\n",
+		   2 * TRC_IRQS, pci[0], pci[1]);
+	CHK( pci[0] == pci[1] );
+
+	/* drain, srvInit/srvExit pairs of each CPU in order */
+	blk.size = sizeof(ev);
+	CHK( bb->getStat( h, 0, M_BB_A12_BLK_TRACE, (INT32_OR_64*)&blk ) == 0 );
+	n = blk.size / sizeof(A12_TRACE_EV);
+	printf("drained %u events, first:\n", n);
+	for( i=0; i<n && i<4; i++ )
+		printf("  %12llu cpu %u dev %u ev %2u ctrl 0x%02x ret %d\n",
+			   (unsigned long long)ev[i].time, ev[i].cpu, ev[i].dev,
+			   ev[i].ev, ev[i].ctrl, (int)ev[i].ret);
+	CHK( n == 4 * TRC_IRQS );
+	for( i=0; i<n; i+=2 ){
+		CHK( ev[i].ev == A12_TEV_SRVINIT && ev[i].ret == BBIS_IRQ_YES &&
+			 (ev[i].ctrl & A12SIM_CTRL_IRQ) );
+		CHK( ev[i+1].ev == A12_TEV_SRVEXIT && ev[i+1].cpu == ev[i].cpu &&
+			 ev[i+1].time >= ev[i].time );
+	}
+	blk.size = sizeof(ev);
+	CHK( bb->getStat( h, 0, M_BB_A12_BLK_TRACE, (INT32_OR_64*)&blk ) == 0 &&
+		 blk.size == 0 );
+
+	/* overrun: 2*n events per CPU into A12_TRACE_ENTRIES */
+	CHK( TrcRun( bb, h, A12_TRACE_ENTRIES ) == 0 );
+	blk.size = sizeof(ev);
+	CHK( bb->getStat( h, 0, M_BB_A12_BLK_TRACE, (INT32_OR_64*)&blk ) == 0 );
+	CHK( bb->getStat( h, 0, M_BB_A12_TRACE_LOST, &val ) == 0 );
+	printf("overrun: drained %u events, lost %u\n",
+		   (u_int32)(blk.size / sizeof(A12_TRACE_EV)), (u_int32)val);
+	CHK( blk.size / sizeof(A12_TRACE_EV) == 2 * A12_TRACE_ENTRIES );
+	CHK( val == 2 * A12_TRACE_ENTRIES );
+
+	CHK( bb->setStat( h, 0, M_BB_A12_TRACE, 0 ) == 0 );
+	CHK( bb->irqEnable( h, 0, FALSE ) == 0 );
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************** TrcRun **********************************
+ *
+ *  Description: Service interrupts of slot 0, alternating CPU 0 and 1
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               irqs	IRQs per CPU
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 TrcRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 irqs )
+{
+	u_int32 i;
+
+	for( i=0; i<2*irqs; i++ ){
+		A12SIM_SetCpu( i & 1 );
+		A12SIM_SetIrq( 0, 1 );
+		A12SIM_Advance( MOD_IRQ_ENTRY_NS );
+		CHK( bb->irqSrvInit( h, 0 ) == BBIS_IRQ_YES );
+		A12SIM_Advance( MOD_ISR_NS );
+		A12SIM_SetIrq( 0, 0 );
+		bb->irqSrvExit( h, 0 );
+	}
+	A12SIM_SetCpu( 0 );
+	return 0;
+
+abort:
+	A12SIM_SetCpu( 0 );
+	return 1;
+}
+
+/********************************* RecTest **********************************
+ *
+ *  Description: Access recording of the interrupt path and block transfers
+ *
+ *               Recording is switched on by the descriptor. The workload
+ *               must cause the same PCI accesses with recording on and
+ *               off. The chunks are drained periodically into a file for
+ *               a12_replay; the ring must not overrun then. Finally the
+ *               ring is overrun on purpose and the loss must be reported.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               file	recording file
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 RecTest( BBIS_ENTRY *bb, const char *file )
+{
+	static u_int8 buf[sizeof(A12_REC_HDR) + REC_CHUNK * sizeof(A12_REC)];
+	A12_REC_HDR *hdr = (A12_REC_HDR*)buf;
+	BBIS_HANDLE *h = NULL;
+	A12SIM_STATS st;
+	M_SG_BLOCK blk;
+	FILE *fp = NULL;
+	u_int32 i, slot, pci[2], recs = 0, chunks = 0;
+	INT32_OR_64 val;
+
+	A12SIM_Reset();
+	CHK( bb->init( NULL, (DESC_SPEC*)G_descRec, &h ) == 0 );
+	CHK( bb->getStat( h, 0, M_BB_A12_REC, &val ) == 0 && val == 1 );
+	CHK( bb->brdInit( h ) == 0 );
+	for( slot=0; slot<3; slot++ )
+		CHK( bb->irqEnable( h, slot, TRUE ) == 0 );
+
+	/* same PCI accesses with and without recording */
+	for( i=0; i<2; i++ ){
+		CHK( bb->setStat( h, 0, M_BB_A12_REC, !i ) == 0 );
+		A12SIM_ClrStats();
+		CHK( RecRun( bb, h, REC_ROUNDS ) == 0 );
+		A12SIM_GetStats( &st );
+		pci[i] = st.reads + st.writes;
+	}
+	printf("PCI accesses for %d rounds: recording on %u, off %u\n",
+		   REC_ROUNDS, pci[0], pci[1]);
+	CHK( pci[0] == pci[1] );
+
+	/* record into the file, drain every REC_DRAIN rounds */
+	CHK( (fp = fopen( file, "wb" )) != NULL );
+	CHK( bb->setStat( h, 0, M_BB_A12_REC, 1 ) == 0 );
+	blk.data = (void*)buf;
+	for( i=0; i<=REC_ROUNDS; i+=REC_DRAIN ){
+		if( i < REC_ROUNDS )
+			CHK( RecRun( bb, h, REC_DRAIN ) == 0 );
+		do {
+			blk.size = sizeof(buf);
+			CHK( bb->getStat( h, 0, M_BB_A12_BLK_REC,
+							  (INT32_OR_64*)&blk ) == 0 );
+			CHK( hdr->magic == A12_REC_MAGIC && hdr->lost == 0 &&
+				 blk.size == sizeof(*hdr) + hdr->count * sizeof(A12_REC) );
+			if( hdr->count ){
+				CHK( fwrite( buf, blk.size, 1, fp ) == 1 );
+				recs += hdr->count;
+				chunks++;
+			}
+		} while( hdr->count == REC_CHUNK );
+	}
+	CHK( fclose( fp ) == 0 );
+	fp = NULL;
+	CHK( bb->getStat( h, 0, M_BB_A12_REC_LOST, &val ) == 0 && val == 0 );
+	printf("recorded %u records in %u chunks to %s\n", recs, chunks, file);
+	CHK( recs > 0 );
+
+	/* overrun without draining */
+	CHK( RecRun( bb, h, REC_ROUNDS ) == 0 );
+	blk.size = sizeof(buf);
+	CHK( bb->getStat( h, 0, M_BB_A12_BLK_REC, (INT32_OR_64*)&blk ) == 0 );
+	CHK( bb->getStat( h, 0, M_BB_A12_REC_LOST, &val ) == 0 );
+	printf("overrun: lost %u, reported in chunk %u\n", (u_int32)val,
+		   hdr->lost);
+	CHK( val > 0 && hdr->lost == (u_int32)val );
+
+	CHK( bb->setStat( h, 0, M_BB_A12_REC, 0 ) == 0 );
+	for( slot=0; slot<3; slot++ )
+		CHK( bb->irqEnable( h, slot, FALSE ) == 0 );
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	if( fp )
+		fclose( fp );
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************** RecRun **********************************
+ *
+ *  Description: Interrupts of all slots and block transfers on slot 0
+ *
+ *               Each round services one IRQ found by A12_IrqPendMask,
+ *               every 8th round moves a block.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               rounds	rounds
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 RecRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 rounds )
+{
+	static u_int32 data[REC_BLK_SIZE / 4];
+	u_int32 i, slot, mask;
+
+	for( i=0; i<rounds; i++ ){
+		slot = i % 3;
+		A12SIM_SetCpu( i & 1 );
+		A12SIM_SetIrq( slot, 1 );
+		A12SIM_Advance( MOD_IRQ_ENTRY_NS );
+		CHK( A12_ENTRY_IRQPENDMASK( bb )( h, &mask ) == 0 &&
+			 mask == (1U << slot) );
+		A12SIM_Advance( MOD_ISR_NS );
+		A12SIM_SetIrq( slot, 0 );
+		bb->irqSrvExit( h, slot );
+
+		if( (i & 7) == 7 ){
+			CHK( A12_ENTRY_BLKWRITE( bb )( h, 0, MDIS_MD32, 0, data,
+										   sizeof(data) ) == 0 );
+			CHK( A12_ENTRY_BLKREAD( bb )( h, 0, MDIS_MD16, 0, data,
+										  sizeof(data) ) == 0 );
+			CHK( A12_ENTRY_BLKFILL( bb )( h, 0, MDIS_MD32, 0, i,
+										  sizeof(data) ) == 0 );
+		}
+	}
+	A12SIM_SetCpu( 0 );
+	return 0;
+
+abort:
+	A12SIM_SetCpu( 0 );
+	return 1;
+}
@@ -0,0 +1,137 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: a12_simrun_entry.c
+ *      Project: A12 simulator run tool
+ *
+ *       Author: kp
+ *
+ *  Description: PCI cost of all entry points (test 0)
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "a12_simrun_int.h"
+
+/******************************* EntryTest **********************************
+ *
+ *  Description: Call all entry points and report their PCI cost
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 EntryTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE	*h = NULL;
+	void		*addr;
+	u_int32		size, slot, mask, irqs = 0;
+
+	printf("%-28s %5s %5s %5s %10s\n", "entry point", "cfg", "rd", "wr",
+		   "bus [ns]");
+
+	/*--------------------+
+	|  init               |
+	+--------------------*/
+	A12SIM_ClrStats();
+	CHK( bb->init( NULL, (DESC_SPEC*)G_desc, &h ) == 0 );
+	Report( "Init" );
+
+	A12SIM_ClrStats();
+	CHK( bb->brdInit( h ) == 0 );
+	Report( "BrdInit" );
+
+	/*--------------------+
+	|  interrupts         |
+	+--------------------*/
+	A12SIM_ClrStats();
+	for( slot=0; slot<3; slot++ )
+		CHK( bb->irqEnable( h, slot, TRUE ) == 0 );
+	Report( "IrqEnable (3 slots)" );
+
+	/* slot 1 asserts, MDIS asks every shared slot */
+	A12SIM_SetIrq( 1, 1 );
+	CHK( A12SIM_IrqAsserted() == 0x2 );
+
+	A12SIM_ClrStats();
+	for( slot=0; slot<3; slot++ ){
+		if( bb->irqSrvInit( h, slot ) == BBIS_IRQ_YES ){
+			irqs |= 1 << slot;
+			bb->irqSrvExit( h, slot );
+		}
+	}
+	Report( "IrqSrvInit/Exit (3 slots)" );
+	CHK( irqs == 0x2 );
+
+	/* same with single-pass claim, no irqSrvInit */
+	A12SIM_ClrStats();
+	CHK( PendDispatch( bb, h, &mask ) == 0 );
+	Report( "IrqPendMask+SrvExit" );
+	CHK( mask == 0x2 );
+
+	/* slot 2 without IRQ enabled: skipped by the pending mask only */
+	CHK( bb->irqEnable( h, 2, FALSE ) == 0 );
+	A12SIM_ClrStats();
+	for( irqs=0, slot=0; slot<3; slot++ ){
+		if( bb->irqSrvInit( h, slot ) == BBIS_IRQ_YES ){
+			irqs |= 1 << slot;
+			bb->irqSrvExit( h, slot );
+		}
+	}
+	Report( "IrqSrvInit/Exit (IEN 0,1)" );
+	CHK( irqs == 0x2 );
+
+	A12SIM_ClrStats();
+	CHK( PendDispatch( bb, h, &mask ) == 0 );
+	Report( "IrqPendMask+Exit (IEN 0,1)" );
+	CHK( mask == 0x2 );
+	CHK( bb->irqEnable( h, 2, TRUE ) == 0 );
+	A12SIM_SetIrq( 1, 0 );
+
+	CHK( ShowIrqStat( bb, h ) == 0 );
+
+	/*--------------------+
+	|  address info       |
+	+--------------------*/
+	A12SIM_ClrStats();
+	CHK( bb->getMAddr( h, 0, MDIS_MA24, MDIS_MD32, &addr, &size ) == 0 );
+	Report( "GetMAddr" );
+	CHK( size == 0x1000000 );
+
+	/*--------------------+
+	|  cleanup            |
+	+--------------------*/
+	A12SIM_ClrStats();
+	for( slot=0; slot<3; slot++ )
+		CHK( bb->irqEnable( h, slot, FALSE ) == 0 );
+	Report( "IrqEnable off (3 slots)" );
+
+	A12SIM_ClrStats();
+	CHK( bb->brdExit( h ) == 0 );
+	Report( "BrdExit" );
+
+	A12SIM_ClrStats();
+	CHK( bb->exit( &h ) == 0 );
+	Report( "Exit" );
+
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
@@ -0,0 +1,108 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: a12_simrun_int.h
+ *
+ *       Author: kp
+ *
+ *  Description: Internal header file for the A12 simulator run tool
+ *
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ******************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _A12_SIMRUN_INT_H
+#define _A12_SIMRUN_INT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/bb_defs.h>
+#include <MEN/bb_entry.h>
+#include <MEN/bb_a12.h>
+#include <MEN/bb_a12_ext.h>
+#include <MEN/a12_sim.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* CPU cost model of an interrupt, all IRQ driven tests */
+#define MOD_IRQ_ENTRY_NS	3000		/* IRQ entry/exit, MDIS dispatch */
+#define MOD_ISR_NS			1000		/* M-module ISR base cost */
+
+/* deferred servicing test: 3 busy slots, 4 CPUs, bridge IRQ on CPU 0 */
+#define DEF_CPUS			4
+
+#define CHK(expression) \
+ if( !(expression)) {\
+	 printf("\n*** Error during: %s\nfile %s\nline %d\n", \
+      #expression,__FILE__,__LINE__);\
+      goto abort;\
+ }
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+extern const A12SIM_DESC G_desc[];
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+/* a12_simrun.c */
+void Report( const char *what );
+int32 PendDispatch( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 *maskP );
+int32 ShowIrqStat( BBIS_ENTRY *bb, BBIS_HANDLE *h );
+int32 SimOpen( BBIS_ENTRY *bb, const A12SIM_DESC *desc, u_int32 ien,
+				BBIS_HANDLE **hP );
+int32 SimClose( BBIS_ENTRY *bb, BBIS_HANDLE **hP );
+/* a12_simrun_entry.c */
+int32 EntryTest( BBIS_ENTRY *bb );
+/* a12_simrun_irq.c */
+int32 ModTest( BBIS_ENTRY *bb, u_int32 events, u_int32 msec );
+int32 DeferTest( BBIS_ENTRY *bb );
+int32 PollTest( BBIS_ENTRY *bb );
+int32 CpuTest( BBIS_ENTRY *bb );
+int32 StormTest( BBIS_ENTRY *bb );
+int32 ScanTest( BBIS_ENTRY *bb );
+/* a12_simrun_mem.c */
+int32 ViewTest( BBIS_ENTRY *bb );
+int32 BlkTest( BBIS_ENTRY *bb );
+int32 SgTest( BBIS_ENTRY *bb );
+int32 TimTest( BBIS_ENTRY *bb, const A12SIM_LATENCY *lat );
+/* a12_simrun_cfg.c */
+int32 BrgTest( BBIS_ENTRY *bb );
+int32 LazyTest( BBIS_ENTRY *bb );
+void LazyReport( const char *mode, const char *what );
+int32 CfgTest( BBIS_ENTRY *bb );
+int32 QspiTest( BBIS_ENTRY *bb );
+int32 ResTest( BBIS_ENTRY *bb );
+/* a12_simrun_diag.c */
+int32 TrcTest( BBIS_ENTRY *bb );
+int32 RecTest( BBIS_ENTRY *bb, const char *file );
+/* a12_simrun_life.c */
+int32 WarmTest( BBIS_ENTRY *bb );
+int32 RstTest( BBIS_ENTRY *bb );
+int32 RstIrqs( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 expect );
+
+#endif /* _A12_SIMRUN_INT_H */
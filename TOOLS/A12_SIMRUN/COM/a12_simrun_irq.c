@@ -0,0 +1,900 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: a12_simrun_irq.c
+ *      Project: A12 simulator run tool
+ *
+ *       Author: kp
+ *
+ *  Description: Interrupt path tests: IRQ moderation, deferred servicing,
+ *               hybrid IRQ/poll mode, CPU hints, IRQ storm quarantine
+ *               and slot scan order (tests 1, 2, 3, 14, 18, 19)
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "a12_simrun_int.h"
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* IRQ moderation test: sample stream and CPU cost model */
+#define MOD_SAMPLE_NS		10000		/* sample period (100 kHz) */
+#define MOD_DURATION_NS		100000000	/* 100 ms */
+#define MOD_PER_SAMPLE_NS	200			/* M-module ISR cost per sample */
+
+/* deferred servicing test: 3 busy slots, 4 CPUs, bridge IRQ on CPU 0 */
+#define DEF_SAMPLE_NS		20000		/* sample period per slot (50 kHz) */
+#define DEF_DURATION_NS		50000000	/* 50 ms */
+#define DEF_ISR_NS			12000		/* M-module ISR base cost */
+#define DEF_PER_SAMPLE_NS	500			/* M-module ISR cost per sample */
+#define DEF_STEP_NS			1000		/* simulation step */
+
+/* hybrid IRQ/poll test: slot 0 low rate, burst, low rate */
+#define POLL_LOW_NS			1000000		/* low rate sample period (1 kHz) */
+#define POLL_HIGH_NS		5000		/* burst sample period (200 kHz) */
+#define POLL_PHASE_NS		10000000	/* 10 ms low, 20 ms burst, 10 ms low */
+#define POLL_CHECK_NS		300			/* poller overhead per poll */
+#define POLL_STEP_NS		500			/* simulation step */
+#define POLL_PERIOD_US		1			/* poll period */
+
+/* IRQ storm test: stuck IRQ on slot 0, sample stream on slot 1 */
+#define STORM_SAMPLE_NS		50000		/* slot 1 sample period (20 kHz) */
+#define STORM_DURATION_NS	100000000	/* 100 ms */
+#define STORM_STUCK1_NS		10000000	/* slot 0 stuck 10..50 ms */
+#define STORM_FREE1_NS		50000000
+#define STORM_EVENT_NS		75000000	/* slot 0 regular IRQ at 75 ms */
+#define STORM_STUCK2_NS		80000000	/* slot 0 stuck again from 80 ms */
+#define STORM_STUCK_ISR_NS	10000		/* ISR finding nothing to do */
+#define STORM_IRQS			20			/* IRQs/window seen as storm */
+#define STORM_WINDOW_MS		1
+#define STORM_TIME_MS		1			/* first quarantine */
+#define STORM_HOLDS			16			/* quarantines reported */
+
+/* scan order test: 3 slots on one interrupt, slot 2 busiest */
+#define SCAN_PERIOD0_NS		500000		/* mean IRQ period of slot 0 */
+#define SCAN_PERIOD1_NS		100000		/* critical slot 1 */
+#define SCAN_PERIOD2_NS		20000		/* busy slot 2 */
+#define SCAN_DURATION_NS	50000000	/* 50 ms */
+#define SCAN_ISR_NS			2000		/* M-module ISR */
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+/* CPU hints: bridge IRQ on CPU 1, deferred work of slot 1 on CPU 2/3 */
+static const A12SIM_DESC G_descCpu[] = {
+	{ "DEBUG_LEVEL",		0 },
+	{ "IRQ_DEFER",			1 },
+	{ "IRQ_CPU_MASK",		0x2 },
+	{ "SLOT_1_CPU_MASK",	0xc },
+	{ NULL,					0 }
+};
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static int32 ModRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 events );
+static int32 DeferRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 defer );
+static int32 PollRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 poll );
+static int32 StormRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 irqs );
+static int32 ScanRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, const char *name,
+					  u_int32 *readsP, u_int32 *lat );
+
+/******************************** ModTest ***********************************
+ *
+ *  Description: Compare CPU time of a sample stream without and with IRQ
+ *               moderation
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               events	IRQs before holdoff
+ *               msec	holdoff time
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 ModTest( BBIS_ENTRY *bb, u_int32 events, u_int32 msec )
+{
+	BBIS_HANDLE	*h = NULL;
+
+	CHK( SimOpen( bb, G_desc, 0, &h ) == 0 );
+	CHK( bb->setStat( h, 0, M_BB_A12_IRQMOD_TIME, msec ) == 0 );
+	CHK( bb->irqEnable( h, 0, TRUE ) == 0 );
+
+	printf("%-16s %8s %8s %10s %6s %8s\n", "moderation", "irqs", "samples",
+		   "cpu [us]", "cpu%", "backlog");
+
+	CHK( ModRun( bb, h, 0 ) == 0 );
+	CHK( ModRun( bb, h, events ) == 0 );
+
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************* ModRun ***********************************
+ *
+ *  Description: Run sample stream on slot 0 and print CPU cost
+ *
+ *               The M-module keeps its IRQ asserted while samples are
+ *               unread, its ISR reads all of them.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               events	IRQs before holdoff, 0=moderation off
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 ModRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 events )
+{
+	u_int64 start, t0, cpu = 0, produced, consumed = 0, backlog = 0;
+	u_int32 irqs = 0, slot;
+	char name[32];
+
+	CHK( bb->setStat( h, 0, M_BB_A12_IRQMOD_EVENTS, events ) == 0 );
+
+	start = A12SIM_Clock();
+	while( A12SIM_Clock() - start < MOD_DURATION_NS ){
+		produced = (A12SIM_Clock() - start) / MOD_SAMPLE_NS;
+		A12SIM_SetIrq( 0, produced > consumed );
+		if( produced - consumed > backlog )
+			backlog = produced - consumed;
+
+		if( !A12SIM_IrqAsserted() ){
+			/* idle until next sample (or alarm) */
+			A12SIM_Advance( MOD_SAMPLE_NS -
+							(u_int32)((A12SIM_Clock() - start) % MOD_SAMPLE_NS) );
+			continue;
+		}
+
+		/* bridge interrupt */
+		t0 = A12SIM_Clock();
+		irqs++;
+		A12SIM_Advance( MOD_IRQ_ENTRY_NS );
+		for( slot=0; slot<3; slot++ ){
+			if( bb->irqSrvInit( h, slot ) != BBIS_IRQ_YES )
+				continue;
+			A12SIM_Advance( MOD_ISR_NS + (u_int32)(produced - consumed) *
+							MOD_PER_SAMPLE_NS );
+			consumed = produced;
+			A12SIM_SetIrq( slot, 0 );
+			bb->irqSrvExit( h, slot );
+		}
+		cpu += A12SIM_Clock() - t0;
+	}
+
+	/* wait for holdoff end */
+	A12SIM_Advance( 100000000 );
+
+	if( events )
+		sprintf( name, "%u IRQ/holdoff", events );
+	else
+		sprintf( name, "off" );
+
+	printf("%-16s %8u %8llu %10llu %5llu%% %8llu\n", name, irqs,
+		   (unsigned long long)consumed, (unsigned long long)cpu / 1000,
+		   (unsigned long long)cpu * 100 / MOD_DURATION_NS,
+		   (unsigned long long)backlog );
+	return 0;
+
+abort:
+	return 1;
+}
+
+/******************************* DeferTest **********************************
+ *
+ *  Description: Compare servicing of 3 busy slots in interrupt context
+ *               and by deferred per-CPU workers
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 DeferTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE	*h = NULL;
+	u_int32		cpu;
+
+	CHK( SimOpen( bb, G_desc, 0x7, &h ) == 0 );
+
+	printf("%-10s %6s %8s %8s", "mode", "irqs", "samples", "backlog");
+	for( cpu=0; cpu<DEF_CPUS; cpu++ )
+		printf("  cpu%u%% claims", cpu);
+	printf("\n");
+
+	CHK( DeferRun( bb, h, FALSE ) == 0 );
+	CHK( DeferRun( bb, h, TRUE ) == 0 );
+
+	CHK( ShowIrqStat( bb, h ) == 0 );
+
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/******************************** DeferRun **********************************
+ *
+ *  Description: Run sample streams on slots 0..2 and print CPU load
+ *
+ *               The bridge interrupt is always taken by CPU 0. Without
+ *               deferred servicing, all driver ISRs run there. With it,
+ *               the worker of each CPU claims queued slots while the CPU
+ *               is idle. A slot is unmasked (irqSrvExit) when its ISR
+ *               is finished.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               defer	deferred servicing on/off
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 DeferRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 defer )
+{
+	u_int64 start, now, cost, produced[3], consumed[3] = { 0, 0, 0 };
+	u_int64 backlog = 0, samples = 0;
+	u_int64 cpuFree[DEF_CPUS], busy[DEF_CPUS];
+	u_int32 inIsr[DEF_CPUS], claims[DEF_CPUS];
+	u_int32 irqs = 0, slot, cpu, mask;
+
+	CHK( bb->setStat( h, 0, M_BB_A12_IRQ_DEFER, defer ) == 0 );
+	for( cpu=0; cpu<DEF_CPUS; cpu++ ){
+		cpuFree[cpu] = busy[cpu] = 0;
+		inIsr[cpu] = claims[cpu] = 0;
+	}
+
+	start = A12SIM_Clock();
+	while( (now = A12SIM_Clock()) - start < DEF_DURATION_NS ){
+		/* M-module IRQ lines: unread samples */
+		for( slot=0; slot<3; slot++ ){
+			produced[slot] = (now - start) / DEF_SAMPLE_NS + 1;
+			A12SIM_SetIrq( slot, produced[slot] > consumed[slot] );
+			if( produced[slot] - consumed[slot] > backlog )
+				backlog = produced[slot] - consumed[slot];
+		}
+
+		/* finished ISRs */
+		for( cpu=0; cpu<DEF_CPUS; cpu++ ){
+			if( inIsr[cpu] && cpuFree[cpu] <= now ){
+				A12SIM_SetCpu( cpu );
+				for( slot=0; slot<3; slot++ )
+					if( inIsr[cpu] & (1 << slot) )
+						bb->irqSrvExit( h, slot );
+				inIsr[cpu] = 0;
+			}
+		}
+
+		/* bridge interrupt on CPU 0 */
+		if( A12SIM_IrqAsserted() && cpuFree[0] <= now ){
+			A12SIM_SetCpu( 0 );
+			irqs++;
+			cost = MOD_IRQ_ENTRY_NS;
+			for( slot=0; slot<3; slot++ ){
+				if( bb->irqSrvInit( h, slot ) != BBIS_IRQ_YES )
+					continue;
+				cost += DEF_ISR_NS + (produced[slot] - consumed[slot]) *
+					DEF_PER_SAMPLE_NS;
+				samples += produced[slot] - consumed[slot];
+				consumed[slot] = produced[slot];
+				A12SIM_SetIrq( slot, 0 );
+				inIsr[0] |= 1 << slot;
+			}
+			cpuFree[0] = now + cost;
+			busy[0] += cost;
+		}
+
+		/* deferred workers of idle CPUs */
+		for( cpu=0; defer && cpu<DEF_CPUS; cpu++ ){
+			if( cpuFree[cpu] > now )
+				continue;
+			A12SIM_SetCpu( cpu );
+			CHK( A12_ENTRY_DEFERCLAIM( bb )( h, cpu, &mask ) == 0 );
+			if( !mask )
+				continue;
+			for( slot=0; !(mask & (1 << slot)); slot++ )
+				;
+			cost = DEF_ISR_NS + (produced[slot] - consumed[slot]) *
+				DEF_PER_SAMPLE_NS;
+			samples += produced[slot] - consumed[slot];
+			consumed[slot] = produced[slot];
+			A12SIM_SetIrq( slot, 0 );
+			inIsr[cpu] |= mask;
+			claims[cpu]++;
+			cpuFree[cpu] = now + cost;
+			busy[cpu] += cost;
+		}
+
+		A12SIM_Advance( DEF_STEP_NS );
+	}
+
+	/* let running ISRs finish, drain work queues */
+	A12SIM_Advance( 1000000 );
+	for( cpu=0; cpu<DEF_CPUS; cpu++ ){
+		A12SIM_SetCpu( cpu );
+		for( slot=0; slot<3; slot++ )
+			if( inIsr[cpu] & (1 << slot) )
+				bb->irqSrvExit( h, slot );
+		while( A12_ENTRY_DEFERCLAIM( bb )( h, cpu, &mask ) == 0 && mask )
+			for( slot=0; slot<3; slot++ )
+				if( mask & (1 << slot) )
+					bb->irqSrvExit( h, slot );
+	}
+	for( slot=0; slot<3; slot++ )
+		A12SIM_SetIrq( slot, 0 );
+	A12SIM_SetCpu( 0 );
+
+	printf("%-10s %6u %8llu %8llu", defer ? "deferred" : "irq", irqs,
+		   (unsigned long long)samples, (unsigned long long)backlog );
+	for( cpu=0; cpu<DEF_CPUS; cpu++ )
+		printf("  %4llu%% %6u",
+			   (unsigned long long)busy[cpu] * 100 / DEF_DURATION_NS,
+			   claims[cpu] );
+	printf("\n");
+	return 0;
+
+abort:
+	return 1;
+}
+
+/******************************** PollTest **********************************
+ *
+ *  Description: Compare slot 0 with interrupts only and in hybrid
+ *               IRQ/poll mode
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 PollTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE	*h = NULL;
+
+	CHK( SimOpen( bb, G_desc, 0, &h ) == 0 );
+	CHK( bb->irqEnable( h, 0, TRUE ) == 0 );
+
+	printf("%-8s %6s %6s %8s %6s %6s %10s %6s %8s\n", "mode", "irqs", "polls",
+		   "samples", "toPoll", "toIrq", "cpu [us]", "cpu%", "lat [ns]");
+
+	CHK( PollRun( bb, h, FALSE ) == 0 );
+	CHK( PollRun( bb, h, TRUE ) == 0 );
+
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/******************************** PollRun ***********************************
+ *
+ *  Description: Run low/burst/low sample stream on slot 0 and print CPU
+ *               cost and mean latency from sample to ISR
+ *
+ *               While the slot is polled, the poller burns its CPU
+ *               completely.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               poll	hybrid mode on/off
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 PollRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 poll )
+{
+	u_int64 start, now, t, t0, nextSample, nextPoll = 0, cpu = 0, lat = 0;
+	u_int64 oldest = 0, produced = 0, consumed = 0;
+	u_int32 irqs = 0, polls = 0, mask, period;
+	INT32_OR_64 active, usec;
+	A12_IRQ_STAT stat;
+	M_SG_BLOCK blk;
+
+	CHK( bb->setStat( h, 0, M_BB_A12_IRQSTAT_CLR, 0 ) == 0 );
+	CHK( bb->setStat( h, 0, M_BB_A12_POLL_PERIOD, POLL_PERIOD_US ) == 0 );
+	CHK( bb->setStat( h, 0, M_BB_A12_POLL, poll ) == 0 );
+	CHK( bb->getStat( h, 0, M_BB_A12_POLL_PERIOD, &usec ) == 0 );
+
+	start = nextSample = A12SIM_Clock();
+	while( (now = A12SIM_Clock()) - start < 4 * POLL_PHASE_NS ){
+		/* sample stream */
+		t = now - start;
+		period = (t >= POLL_PHASE_NS && t < 3 * POLL_PHASE_NS) ?
+			POLL_HIGH_NS : POLL_LOW_NS;
+		while( nextSample <= now ){
+			if( produced++ == consumed )
+				oldest = nextSample;
+			nextSample += period;
+		}
+		A12SIM_SetIrq( 0, produced > consumed );
+
+		CHK( bb->getStat( h, 0, M_BB_A12_POLL_ACTIVE, &active ) == 0 );
+		if( active ){
+			/* poller, busy on its CPU */
+			if( now >= nextPoll ){
+				t0 = A12SIM_Clock();
+				polls++;
+				A12SIM_Advance( POLL_CHECK_NS );
+				CHK( A12_ENTRY_POLL( bb )( h, &mask ) == 0 );
+				if( (mask & 1) && bb->irqSrvInit( h, 0 ) == BBIS_IRQ_YES ){
+					lat += A12SIM_Clock() - oldest;
+					A12SIM_Advance( MOD_ISR_NS + (u_int32)(produced - consumed)
+									* MOD_PER_SAMPLE_NS );
+					consumed = produced;
+					A12SIM_SetIrq( 0, 0 );
+					bb->irqSrvExit( h, 0 );
+				}
+				nextPoll = t0 + usec * 1000;
+			}
+			if( A12SIM_Clock() < nextPoll )
+				A12SIM_Advance( (u_int32)(nextPoll - A12SIM_Clock()) <
+								POLL_STEP_NS ?
+								(u_int32)(nextPoll - A12SIM_Clock()) :
+								POLL_STEP_NS );
+			cpu += A12SIM_Clock() - now;
+		}
+		else if( A12SIM_IrqAsserted() ){
+			/* bridge interrupt */
+			t0 = A12SIM_Clock();
+			irqs++;
+			A12SIM_Advance( MOD_IRQ_ENTRY_NS );
+			if( bb->irqSrvInit( h, 0 ) == BBIS_IRQ_YES ){
+				lat += A12SIM_Clock() - oldest;
+				A12SIM_Advance( MOD_ISR_NS + (u_int32)(produced - consumed) *
+								MOD_PER_SAMPLE_NS );
+				consumed = produced;
+				A12SIM_SetIrq( 0, 0 );
+				bb->irqSrvExit( h, 0 );
+			}
+			cpu += A12SIM_Clock() - t0;
+		}
+		else
+			A12SIM_Advance( POLL_STEP_NS );
+	}
+	A12SIM_SetIrq( 0, 0 );
+
+	blk.size = sizeof(stat);
+	blk.data = (void*)&stat;
+	CHK( bb->getStat( h, 0, M_BB_A12_BLK_IRQSTAT, (INT32_OR_64*)&blk ) == 0 );
+
+	printf("%-8s %6u %6u %8llu %6u %6u %10llu %5llu%% %8llu\n",
+		   poll ? "hybrid" : "irq", irqs, polls, (unsigned long long)consumed,
+		   stat.toPoll, stat.toIrq, (unsigned long long)cpu / 1000,
+		   (unsigned long long)cpu * 100 / (4 * POLL_PHASE_NS),
+		   (unsigned long long)(stat.irqYes ? lat / stat.irqYes : 0) );
+
+	CHK( bb->setStat( h, 0, M_BB_A12_POLL, FALSE ) == 0 );
+	return 0;
+
+abort:
+	return 1;
+}
+
+/********************************* CpuTest **********************************
+ *
+ *  Description: CPU hints of the bridge IRQ and the deferred work
+ *
+ *               The descriptor hints must be reported by CfgInfo and
+ *               GetStat and follow SetStat. A deferred IRQ of slot 1 taken
+ *               on CPU 0 may only be claimed by the workers of CPU 2/3,
+ *               slot 0 without hint by any worker.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 CpuTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE *h = NULL;
+	INT32_OR_64 val;
+	u_int32 irqCpus, workCpus, mask, slot;
+
+	A12SIM_Reset();
+	CHK( SimOpen( bb, G_descCpu, 0, &h ) == 0 );
+
+	/* descriptor hints */
+	for( slot=0; slot<3; slot++ ){
+		CHK( bb->cfgInfo( h, A12_CFGINFO_CPUMASK, slot, &irqCpus,
+						  &workCpus ) == 0 );
+		printf("slot %u: irq cpus 0x%x, work cpus 0x%x\n", slot, irqCpus,
+			   workCpus);
+		CHK( irqCpus == 0x2 && workCpus == (slot == 1 ? 0xc : 0) );
+	}
+	CHK( bb->cfgInfo( h, A12_CFGINFO_CPUMASK, 0x1000, &irqCpus,
+					  &workCpus ) == 0 );
+	CHK( irqCpus == 0 && workCpus == 0 );
+	CHK( bb->cfgInfo( h, A12_CFGINFO_CPUMASK, 5, &irqCpus, &workCpus ) ==
+		 ERR_BBIS_ILL_SLOT );
+
+	/* setstat */
+	CHK( bb->setStat( h, 0, M_BB_A12_IRQ_CPUMASK, 0x1 ) == 0 );
+	CHK( bb->setStat( h, 2, M_BB_A12_SLOT_CPUMASK, 0x8 ) == 0 );
+	CHK( bb->getStat( h, 2, M_BB_A12_IRQ_CPUMASK, &val ) == 0 && val == 1 );
+	CHK( bb->getStat( h, 2, M_BB_A12_SLOT_CPUMASK, &val ) == 0 &&
+		 val == 8 );
+	CHK( bb->cfgInfo( h, A12_CFGINFO_CPUMASK, 2, &irqCpus,
+					  &workCpus ) == 0 );
+	CHK( irqCpus == 0x1 && workCpus == 0x8 );
+	printf("setstat: irq cpus 0x%x, slot 2 work cpus 0x%x\n", irqCpus,
+		   workCpus);
+
+	/* deferred work of slots 0 and 1, IRQ on CPU 0 */
+	A12SIM_SetCpu( 0 );
+	for( slot=0; slot<2; slot++ ){
+		CHK( bb->irqEnable( h, slot, TRUE ) == 0 );
+		A12SIM_SetIrq( slot, 1 );
+		CHK( bb->irqSrvInit( h, slot ) == BBIS_IRQ_NO );
+	}
+
+	CHK( A12_ENTRY_DEFERCLAIM( bb )( h, 0, &mask ) == 0 && mask == 0x1 );
+	CHK( A12_ENTRY_DEFERCLAIM( bb )( h, 0, &mask ) == 0 && mask == 0 );
+	CHK( A12_ENTRY_DEFERCLAIM( bb )( h, 1, &mask ) == 0 && mask == 0 );
+	CHK( A12_ENTRY_DEFERCLAIM( bb )( h, 3, &mask ) == 0 && mask == 0x2 );
+	printf("deferred: slot 0 claimed by CPU 0, slot 1 by CPU 3\n");
+
+	for( slot=0; slot<2; slot++ ){
+		A12SIM_SetIrq( slot, 0 );
+		bb->irqSrvExit( h, slot );
+		CHK( bb->irqEnable( h, slot, FALSE ) == 0 );
+	}
+
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/******************************** StormTest *********************************
+ *
+ *  Description: Slot 0 with a stuck IRQ next to a sample stream on slot 1,
+ *               without and with IRQ storm quarantine
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 StormTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE	*h = NULL;
+
+	A12SIM_Reset();
+	CHK( SimOpen( bb, G_desc, 0x7, &h ) == 0 );
+
+	CHK( bb->setStat( h, 0, M_BB_A12_STORM_TIME, 0 ) == ERR_BBIS_ILL_PARAM );
+	CHK( bb->setStat( h, 0, M_BB_A12_STORM_TIME, A12_STORM_TIME_MAX + 1 ) ==
+		 ERR_BBIS_ILL_PARAM );
+	CHK( bb->setStat( h, 0, M_BB_A12_STORM_WINDOW, STORM_WINDOW_MS ) == 0 );
+	CHK( bb->setStat( h, 0, M_BB_A12_STORM_TIME, STORM_TIME_MS ) == 0 );
+
+	printf("slot 0 stuck %u..%u and %u..%u ms, slot 1 sample every %u us\n",
+		   STORM_STUCK1_NS / 1000000, STORM_FREE1_NS / 1000000,
+		   STORM_STUCK2_NS / 1000000, STORM_DURATION_NS / 1000000,
+		   STORM_SAMPLE_NS / 1000);
+	printf("%-12s %6s %7s %5s %8s %8s %6s  %s\n", "storm", "irqs",
+		   "samples", "cpu%", "lat [us]", "max [us]", "storms",
+		   "quarantine [ms]@start [ms]");
+
+	CHK( StormRun( bb, h, 0 ) == 0 );
+	CHK( StormRun( bb, h, STORM_IRQS ) == 0 );
+
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************* StormRun *********************************
+ *
+ *  Description: Run stuck slot 0 and sample stream on slot 1, print CPU
+ *               cost, worst slot 1 latency and the quarantines of slot 0
+ *
+ *               The stuck ISR of slot 0 finds nothing to do and leaves
+ *               the IRQ asserted. Between the stuck phases slot 0 raises
+ *               one regular IRQ, which must end the backoff.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               irqs	IRQs per window seen as storm, 0=off
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 StormRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 irqs )
+{
+	u_int64 start, now, t0, cpu = 0, produced, consumed = 0, lat, maxLat = 0;
+	u_int64 sumLat = 0, nLat = 0;
+	u_int32 nIrqs = 0, slot, stuck, event0 = FALSE, n, nHold = 0, hold = 0;
+	u_int32 holdAt[STORM_HOLDS], holdMs[STORM_HOLDS];
+	A12_IRQ_STAT stat;
+	M_SG_BLOCK blk;
+	INT32_OR_64 val;
+	char name[32];
+
+	CHK( bb->setStat( h, 0, M_BB_A12_STORM_IRQS, irqs ) == 0 );
+	CHK( bb->setStat( h, 0, M_BB_A12_IRQSTAT_CLR, 0 ) == 0 );
+
+	start = A12SIM_Clock();
+	while( (now = A12SIM_Clock() - start) < STORM_DURATION_NS ){
+		stuck = (now >= STORM_STUCK1_NS && now < STORM_FREE1_NS) ||
+				now >= STORM_STUCK2_NS;
+		if( now >= STORM_EVENT_NS && now < STORM_EVENT_NS + STORM_SAMPLE_NS )
+			event0 = TRUE;
+		A12SIM_SetIrq( 0, stuck || event0 );
+
+		produced = now / STORM_SAMPLE_NS;
+		A12SIM_SetIrq( 1, produced > consumed );
+
+		/* quarantines started */
+		CHK( bb->getStat( h, 0, M_BB_A12_STORM_HOLDOFF, &val ) == 0 );
+		if( val && val != hold && nHold < STORM_HOLDS ){
+			holdAt[nHold] = (u_int32)(now / 1000000);
+			holdMs[nHold++] = (u_int32)val;
+		}
+		hold = (u_int32)val;
+
+		if( !A12SIM_IrqAsserted() ){
+			/* idle until next sample (or alarm) */
+			A12SIM_Advance( STORM_SAMPLE_NS -
+							(u_int32)(now % STORM_SAMPLE_NS) );
+			continue;
+		}
+
+		/* bridge interrupt */
+		t0 = A12SIM_Clock();
+		nIrqs++;
+		A12SIM_Advance( MOD_IRQ_ENTRY_NS );
+		for( slot=0; slot<2; slot++ ){
+			if( bb->irqSrvInit( h, slot ) != BBIS_IRQ_YES )
+				continue;
+			if( slot == 0 ){
+				A12SIM_Advance( event0 ? MOD_ISR_NS : STORM_STUCK_ISR_NS );
+				event0 = FALSE;
+				A12SIM_SetIrq( 0, stuck );
+			}
+			else {
+				lat = A12SIM_Clock() - start - (consumed + 1) * STORM_SAMPLE_NS;
+				if( lat > maxLat )
+					maxLat = lat;
+				sumLat += lat;
+				nLat++;
+				A12SIM_Advance( MOD_ISR_NS + (u_int32)(produced - consumed) *
+								MOD_PER_SAMPLE_NS );
+				consumed = produced;
+				A12SIM_SetIrq( 1, 0 );
+			}
+			bb->irqSrvExit( h, slot );
+		}
+		cpu += A12SIM_Clock() - t0;
+	}
+	A12SIM_SetIrq( 0, 0 );
+	A12SIM_SetIrq( 1, 0 );
+
+	/* wait for quarantine end */
+	A12SIM_Advance( (STORM_TIME_MS << 7) * 1000000 );
+
+	blk.size = sizeof(stat);
+	blk.data = (void*)&stat;
+	CHK( bb->getStat( h, 0, M_BB_A12_BLK_IRQSTAT, (INT32_OR_64*)&blk ) == 0 );
+
+	if( irqs )
+		sprintf( name, "%u IRQ/%ums", irqs, STORM_WINDOW_MS );
+	else
+		sprintf( name, "off" );
+
+	printf("%-12s %6u %7llu %4llu%% %8llu %8llu %6u ", name, nIrqs,
+		   (unsigned long long)consumed,
+		   (unsigned long long)cpu * 100 / STORM_DURATION_NS,
+		   (unsigned long long)(nLat ? sumLat / nLat / 1000 : 0),
+		   (unsigned long long)maxLat / 1000, stat.storms);
+	for( n=0; n<nHold; n++ )
+		printf(" %u@%u", holdMs[n], holdAt[n]);
+	printf("\n");
+
+	CHK( bb->getStat( h, 0, M_BB_A12_STORM_HOLDOFF, &val ) == 0 && val == 0 );
+	if( !irqs ){
+		CHK( stat.storms == 0 );
+		return 0;
+	}
+
+	/* backoff doubles, the regular IRQ between the phases resets it */
+	CHK( nHold >= 4 && stat.storms == nHold && holdMs[0] == STORM_TIME_MS );
+	for( n=1; n<nHold; n++ ){
+		hold = holdAt[n] >= STORM_STUCK2_NS / 1000000 &&
+			   holdAt[n-1] < STORM_STUCK2_NS / 1000000;
+		CHK( hold ? holdMs[n] == STORM_TIME_MS :
+			 (holdMs[n] == holdMs[n-1] * 2 ||
+			  holdMs[n] == STORM_TIME_MS << 6) );
+	}
+
+	/* slot 0 back in service */
+	CHK( RstIrqs( bb, h, 0x7 ) == 0 );
+	return 0;
+
+abort:
+	A12SIM_SetIrq( 0, 0 );
+	A12SIM_SetIrq( 1, 0 );
+	return 1;
+}
+
+/********************************* ScanTest *********************************
+ *
+ *  Description: Three busy slots on one interrupt, checked in the order of
+ *               A12_IrqOrder: slot number, static priority and adaptive
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 ScanTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE	*h = NULL;
+	u_int32 order, reads[3], lat[3][3];
+	INT32_OR_64 val;
+
+	A12SIM_Reset();
+	CHK( SimOpen( bb, G_desc, 0x7, &h ) == 0 );
+
+	CHK( bb->setStat( h, 0, M_BB_A12_SCAN, A12_SCAN_ADAPTIVE + 1 ) ==
+		 ERR_BBIS_ILL_PARAM );
+	CHK( bb->setStat( h, 1, M_BB_A12_SCAN_PRIO, A12_SCAN_PRIO_MAX + 1 ) ==
+		 ERR_BBIS_ILL_PARAM );
+	CHK( bb->getStat( h, 0, M_BB_A12_SCAN, &val ) == 0 &&
+		 val == A12_SCAN_STATIC );
+	CHK( A12_ENTRY_IRQORDER( bb )( h, &order ) == 0 && order == 0xf210 );
+
+	printf("slot 0/1/2 IRQ every %u/%u/%u us (+-50%%), ISR stops at the "
+		   "first claim\n", SCAN_PERIOD0_NS / 1000, SCAN_PERIOD1_NS / 1000,
+		   SCAN_PERIOD2_NS / 1000);
+	printf("%-16s %6s %6s %9s %9s %9s %9s\n", "scan", "irqs", "pci/irq",
+		   "lat0 [us]", "lat1 [us]", "lat2 [us]", "max1 [us]");
+
+	/* slot order */
+	CHK( ScanRun( bb, h, "static 0,1,2", &reads[0], lat[0] ) == 0 );
+
+	/* critical slot 1 first */
+	CHK( bb->setStat( h, 1, M_BB_A12_SCAN_PRIO, 1 ) == 0 );
+	CHK( bb->getStat( h, 0, M_BB_A12_SCAN_ORDER, &val ) == 0 &&
+		 val == 0xf201 );
+	CHK( ScanRun( bb, h, "static 1,0,2", &reads[1], lat[1] ) == 0 );
+
+	/* busiest slot 2 first */
+	CHK( bb->setStat( h, 0, M_BB_A12_SCAN, A12_SCAN_ADAPTIVE ) == 0 );
+	CHK( ScanRun( bb, h, "adaptive", &reads[2], lat[2] ) == 0 );
+	CHK( bb->getStat( h, 0, M_BB_A12_SCAN_ORDER, &val ) == 0 &&
+		 A12_SCAN_SLOT( val, 0 ) == 2 );
+
+	CHK( lat[1][1] < lat[0][1] );
+	CHK( reads[2] < reads[0] && reads[2] < reads[1] );
+
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************* ScanRun **********************************
+ *
+ *  Description: Run three slots with jittered IRQ periods, checked in the
+ *               order of A12_IrqOrder, and print reads and latencies
+ *
+ *               The dispatcher stops at the first claiming slot, the
+ *               bridge interrupt stays asserted for the others. The
+ *               latency of an IRQ is taken from its assertion to the
+ *               start of its ISR.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               name	configuration
+ *  Output.....: readsP	control register reads per IRQ * 100
+ *               lat	average latency per slot [ns]
+ *               return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 ScanRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, const char *name,
+					  u_int32 *readsP, u_int32 *lat )
+{
+	static const u_int32 period[3] = { SCAN_PERIOD0_NS, SCAN_PERIOD1_NS,
+									   SCAN_PERIOD2_NS };
+	u_int64 start, now, next[3], since[3], sum[3] = { 0, 0, 0 }, maxLat = 0;
+	u_int32 cnt[3] = { 0, 0, 0 }, pend = 0, irqs = 0, seed = 1, slot, n;
+	u_int32 order;
+	A12SIM_STATS st;
+
+	start = A12SIM_Clock();
+	for( slot=0; slot<3; slot++ )
+		next[slot] = period[slot];
+
+	A12SIM_ClrStats();
+	while( (now = A12SIM_Clock() - start) < SCAN_DURATION_NS ){
+		/* new IRQs, jittered +-50% */
+		for( slot=0; slot<3; slot++ ){
+			if( now < next[slot] )
+				continue;
+			if( !(pend & (1 << slot)) ){
+				pend |= 1 << slot;
+				since[slot] = next[slot];
+				A12SIM_SetIrq( slot, 1 );
+			}
+			seed = seed * 1103515245 + 12345;
+			next[slot] += period[slot] / 2 + (seed >> 8) % period[slot];
+		}
+
+		if( !A12SIM_IrqAsserted() ){
+			for( n=next[0], slot=1; slot<3; slot++ )
+				if( next[slot] < n )
+					n = (u_int32)next[slot];
+			A12SIM_Advance( n - (u_int32)now );
+			continue;
+		}
+
+		/* bridge interrupt, first claiming slot */
+		irqs++;
+		A12SIM_Advance( MOD_IRQ_ENTRY_NS );
+		CHK( A12_ENTRY_IRQORDER( bb )( h, &order ) == 0 );
+		for( n=0; (slot = A12_SCAN_SLOT( order, n )) != A12_SCAN_END; n++ ){
+			if( bb->irqSrvInit( h, slot ) != BBIS_IRQ_YES )
+				continue;
+
+			now = A12SIM_Clock() - start;
+			sum[slot] += now - since[slot];
+			cnt[slot]++;
+			if( slot == 1 && now - since[slot] > maxLat )
+				maxLat = now - since[slot];
+
+			A12SIM_Advance( SCAN_ISR_NS );
+			pend &= ~(1 << slot);
+			A12SIM_SetIrq( slot, 0 );
+			bb->irqSrvExit( h, slot );
+			break;
+		}
+	}
+	A12SIM_GetStats( &st );
+	for( slot=0; slot<3; slot++ )
+		A12SIM_SetIrq( slot, 0 );
+
+	*readsP = irqs ? st.reads * 100 / irqs : 0;
+	for( slot=0; slot<3; slot++ )
+		lat[slot] = cnt[slot] ? (u_int32)(sum[slot] / cnt[slot]) : 0;
+
+	printf("%-16s %6u %3u.%02u %9u %9u %9u %9llu\n", name, irqs,
+		   *readsP / 100, *readsP % 100, lat[0] / 1000, lat[1] / 1000,
+		   lat[2] / 1000, (unsigned long long)maxLat / 1000);
+	return 0;
+
+abort:
+	for( slot=0; slot<3; slot++ )
+		A12SIM_SetIrq( slot, 0 );
+	return 1;
+}
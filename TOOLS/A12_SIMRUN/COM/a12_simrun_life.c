@@ -0,0 +1,337 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: a12_simrun_life.c
+ *      Project: A12 simulator run tool
+ *
+ *       Author: kp
+ *
+ *  Description: Board life cycle tests: suspend/resume, warm restart and
+ *               slot reset (tests 16, 17)
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "a12_simrun_int.h"
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* warm restart test: bus time budget until back in service */
+#define WARM_BUDGET_NS		1000000		/* 1 ms */
+
+/* slot reset test: IRQs of the other slots while slot 0 is down */
+#define RST_IRQS			10
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+/* warm restart: settings that must survive, slot 2 polled */
+static const A12SIM_DESC G_descWarm[] = {
+	{ "DEBUG_LEVEL",			0 },
+	{ "SLOT_0_IRQ_MOD_EVENTS",	4 },
+	{ "SLOT_1_TIMING",			A12_TIMING_SLOW },
+	{ "SLOT_1_CPU_MASK",		0x2 },
+	{ "SLOT_2_IRQ_POLICY",		A12_POLICY_POLL },
+	{ NULL,						0 }
+};
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static int32 WarmCheck( const u_int8 *ctrl );
+
+/********************************* WarmTest *********************************
+ *
+ *  Description: Suspend/resume and warm restart from a saved board state
+ *
+ *               Cold start: init, BrdInit and all slots opened. Suspend,
+ *               the bridge loses its registers, the IRQ paths must leave
+ *               it alone, resume restores the control registers. Warm
+ *               restart: the state is saved, the BBIS exits and comes
+ *               back with A12_WarmInit, without bridge search, BAR0 and
+ *               descriptor reads, in service within WARM_BUDGET_NS of bus
+ *               time with IEN and bus timing as before.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 WarmTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE *h = NULL;
+	A12_WARM warm;
+	M_SG_BLOCK blk;
+	A12SIM_STATS st;
+	u_int8 ctrl[3];
+	u_int32 slot, mask;
+	INT32_OR_64 val;
+
+	A12SIM_Reset();
+	printf("%-6s %-10s %5s %5s %5s %5s %5s %10s\n", "mode", "step", "cfg",
+		   "pci", "maps", "unmap", "desc", "bus [ns]");
+
+	/* cold start, drivers open all slots */
+	A12SIM_ClrStats();
+	CHK( SimOpen( bb, G_descWarm, 0x7, &h ) == 0 );
+	LazyReport( "cold", "in service" );
+	for( slot=0; slot<3; slot++ )
+		ctrl[slot] = A12SIM_CtrlPeek( slot );
+	CHK( (ctrl[0] & A12SIM_CTRL_IEN) && (ctrl[1] & A12SIM_CTRL_IEN) &&
+		 !(ctrl[2] & A12SIM_CTRL_IEN) );
+
+	/* suspend, registers lost, IRQ paths off the bridge */
+	A12SIM_ClrStats();
+	CHK( bb->setStat( h, 0, M_BB_A12_SUSPEND, 1 ) == 0 );
+	LazyReport( "susp", "suspend" );
+	CHK( bb->getStat( h, 0, M_BB_A12_SUSPEND, &val ) == 0 && val == 1 );
+	CHK( A12SIM_IrqAsserted() == 0 );
+	A12SIM_PowerLoss();
+
+	A12SIM_SetIrq( 0, 1 );
+	A12SIM_ClrStats();
+	CHK( A12_ENTRY_IRQPENDMASK( bb )( h, &mask ) == 0 && mask == 0 );
+	CHK( bb->irqSrvInit( h, 0 ) == BBIS_IRQ_NO );
+	CHK( A12_ENTRY_POLL( bb )( h, &mask ) == 0 && mask == 0 );
+	CHK( bb->setStat( h, 1, M_BB_A12_SLOT_ENABLE, 0 ) == ERR_BBIS_ILL_PARAM );
+	A12SIM_GetStats( &st );
+	CHK( st.reads + st.writes == 0 );
+	A12SIM_SetIrq( 0, 0 );
+
+	A12SIM_ClrStats();
+	CHK( bb->setStat( h, 0, M_BB_A12_SUSPEND, 0 ) == 0 );
+	LazyReport( "susp", "resume" );
+	A12SIM_GetStats( &st );
+	CHK( st.writes == 3 && st.reads == 0 );
+	CHK( WarmCheck( ctrl ) == 0 );
+
+	/* save, exit, warm restart */
+	blk.size = sizeof(warm);
+	blk.data = (void*)&warm;
+	CHK( bb->getStat( h, 0, M_BB_A12_BLK_WARM, (INT32_OR_64*)&blk ) == 0 &&
+		 blk.size == sizeof(warm) );
+	CHK( bb->exit( &h ) == 0 );
+
+	A12SIM_ClrStats();
+	CHK( A12_ENTRY_WARMINIT( bb )( NULL, (DESC_SPEC*)G_descWarm, &warm,
+									&h ) == 0 );
+	CHK( bb->brdInit( h ) == 0 );
+	LazyReport( "warm", "in service" );
+	A12SIM_GetStats( &st );
+	CHK( st.cfgReads == 2 && st.descKeys == 2 && st.reads == 0 &&
+		 st.writes == 3 );
+	CHK( st.simNs < WARM_BUDGET_NS );
+	CHK( WarmCheck( ctrl ) == 0 );
+
+	/* settings as from the descriptor */
+	CHK( bb->getStat( h, 0, M_BB_A12_IRQMOD_EVENTS, &val ) == 0 && val == 4 );
+	CHK( bb->getStat( h, 1, M_BB_A12_SLOT_TIMING, &val ) == 0 &&
+		 val == A12_TIMING_SLOW );
+	CHK( bb->getStat( h, 1, M_BB_A12_SLOT_CPUMASK, &val ) == 0 && val == 2 );
+	CHK( bb->getStat( h, 2, M_BB_A12_SLOT_POLICY, &val ) == 0 &&
+		 val == A12_POLICY_POLL );
+	CHK( bb->getStat( h, 2, M_BB_A12_POLL_ACTIVE, &val ) == 0 && val == 1 );
+
+	/* back in service: IRQ of slot 1, poll of slot 2 */
+	A12SIM_SetIrq( 1, 1 );
+	A12SIM_SetIrq( 2, 1 );
+	CHK( A12SIM_IrqAsserted() == 0x2 );
+	CHK( bb->irqSrvInit( h, 1 ) == BBIS_IRQ_YES );
+	bb->irqSrvExit( h, 1 );
+	CHK( A12_ENTRY_POLL( bb )( h, &mask ) == 0 && mask == 0x4 );
+	A12SIM_SetIrq( 1, 0 );
+	A12SIM_SetIrq( 2, 0 );
+	CHK( SimClose( bb, &h ) == 0 );
+
+	/* bad state, bridge gone */
+	warm.version++;
+	CHK( A12_ENTRY_WARMINIT( bb )( NULL, (DESC_SPEC*)G_descWarm, &warm,
+									&h ) == ERR_BBIS_ILL_PARAM && !h );
+	warm.version--;
+	warm.pciDevNbr++;
+	CHK( A12_ENTRY_WARMINIT( bb )( NULL, (DESC_SPEC*)G_descWarm, &warm,
+									&h ) == ERR_BBIS_ILL_ID );
+	printf("saved state: %u bytes\n", (u_int32)sizeof(warm));
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************* WarmCheck ********************************
+ *
+ *  Description: Compare the control registers with their saved values
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: ctrl	expected control registers of slots 0..2
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 WarmCheck( const u_int8 *ctrl )
+{
+	u_int32 slot;
+
+	for( slot=0; slot<3; slot++ ){
+		if( A12SIM_CtrlPeek( slot ) != ctrl[slot] ){
+			printf("*** slot %u ctrl 0x%02x, expected 0x%02x\n", slot,
+				   A12SIM_CtrlPeek( slot ), ctrl[slot]);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/********************************** RstTest *********************************
+ *
+ *  Description: Reset of slot 0 while slots 1 and 2 stay in service
+ *
+ *               Slot 0 gets stuck with its IRQ asserted. It is quiesced,
+ *               its driver resets the module, then control register
+ *               reset, set up again and back in service step by step and
+ *               at once. Each step is reported with its PCI cost; the
+ *               downtime of slot 0 is the simulated time from quiesce to
+ *               back in service, IRQs of the other slots included.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 RstTest( BBIS_ENTRY *bb )
+{
+	static const u_int32 step[] = { A12_RESET_QUIESCE, A12_RESET_CTRL,
+									A12_RESET_REMAP, A12_RESET_ENABLE };
+	static const char *name[] = { "quiesce", "ctrl", "remap", "enable" };
+	BBIS_HANDLE *h = NULL;
+	A12SIM_STATS st;
+	u_int8 ctrl[3];
+	u_int32 slot, i, size;
+	u_int64 t0;
+	INT32_OR_64 val;
+	void *addr;
+
+	A12SIM_Reset();
+	CHK( SimOpen( bb, G_desc, 0, &h ) == 0 );
+	for( slot=0; slot<3; slot++ ){
+		CHK( bb->irqEnable( h, slot, TRUE ) == 0 );
+		ctrl[slot] = A12SIM_CtrlPeek( slot );
+	}
+
+	/* steps need a quiesced slot */
+	CHK( bb->setStat( h, 0, M_BB_A12_SLOT_RESET, A12_RESET_CTRL ) ==
+		 ERR_BBIS_ILL_PARAM );
+	CHK( bb->setStat( h, 3, M_BB_A12_SLOT_RESET, A12_RESET_ALL ) ==
+		 ERR_BBIS_ILL_SLOT );
+	CHK( RstIrqs( bb, h, 0x7 ) == 0 );
+
+	printf("%-6s %-10s %5s %5s %5s %5s %5s %10s\n", "mode", "step", "cfg",
+		   "pci", "maps", "unmap", "desc", "bus [ns]");
+
+	/* step by step, the other slots are serviced in between */
+	A12SIM_SetIrq( 0, 1 );
+	t0 = A12SIM_Clock();
+	for( i=0; i<4; i++ ){
+		A12SIM_ClrStats();
+		CHK( bb->setStat( h, 0, M_BB_A12_SLOT_RESET, step[i] ) == 0 );
+		LazyReport( "steps", name[i] );
+
+		if( i == 0 ){
+			CHK( bb->getStat( h, 0, M_BB_A12_SLOT_RESET, &val ) == 0 &&
+				 val == A12_RESET_QUIESCE );
+			CHK( bb->setStat( h, 0, M_BB_A12_SLOT_ENABLE, 0 ) ==
+				 ERR_BBIS_ILL_PARAM );
+			/* driver resets its module */
+			CHK( bb->getMAddr( h, 0, MDIS_MA08, MDIS_MD16, &addr,
+							   &size ) == 0 );
+			A12SIM_SetIrq( 0, 0 );
+		}
+		if( i < 3 )
+			CHK( RstIrqs( bb, h, 0x6 ) == 0 );
+	}
+	printf("slot 0 down for %llu ns, %d IRQs of slots 1/2 serviced "
+		   "meanwhile\n", (unsigned long long)(A12SIM_Clock() - t0),
+		   3 * RST_IRQS * 2);
+	CHK( bb->getStat( h, 0, M_BB_A12_SLOT_RESET, &val ) == 0 && val == 0 );
+	CHK( WarmCheck( ctrl ) == 0 );
+	CHK( RstIrqs( bb, h, 0x7 ) == 0 );
+
+	/* all steps at once */
+	A12SIM_ClrStats();
+	t0 = A12SIM_Clock();
+	CHK( bb->setStat( h, 0, M_BB_A12_SLOT_RESET, A12_RESET_ALL ) == 0 );
+	LazyReport( "once", "all" );
+	A12SIM_GetStats( &st );
+	printf("slot 0 down for %llu ns\n",
+		   (unsigned long long)(A12SIM_Clock() - t0));
+	CHK( st.maps == 1 && st.unmaps == 1 && st.reads == 0 );
+	CHK( WarmCheck( ctrl ) == 0 );
+	CHK( RstIrqs( bb, h, 0x7 ) == 0 );
+
+	CHK( SimClose( bb, &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************** RstIrqs *********************************
+ *
+ *  Description: Raise IRQs on all slots, check which are serviced
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               expect	slots that must claim their IRQ, the others not
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 RstIrqs( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 expect )
+{
+	u_int32 n, slot, mask;
+
+	for( n=0; n<RST_IRQS; n++ ){
+		for( slot=0; slot<3; slot++ )
+			A12SIM_SetIrq( slot, 1 );
+
+		CHK( A12SIM_IrqAsserted() == expect );
+
+		/* alternately single-pass claim and irqSrvInit per slot */
+		if( n & 1 ){
+			CHK( A12_ENTRY_IRQPENDMASK( bb )( h, &mask ) == 0 &&
+				 mask == expect );
+		}
+		for( slot=0; slot<3; slot++ ){
+			if( !(n & 1) && bb->irqSrvInit( h, slot ) !=
+				((expect & (1 << slot)) ? BBIS_IRQ_YES : BBIS_IRQ_NO) ){
+				printf("*** slot %u: IRQ claimed wrong\n", slot);
+				goto abort;
+			}
+			if( expect & (1 << slot) )
+				bb->irqSrvExit( h, slot );
+			A12SIM_SetIrq( slot, 0 );
+		}
+	}
+	return 0;
+
+abort:
+	for( slot=0; slot<3; slot++ )
+		A12SIM_SetIrq( slot, 0 );
+	return 1;
+}
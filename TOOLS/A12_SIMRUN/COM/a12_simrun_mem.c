@@ -0,0 +1,692 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: a12_simrun_mem.c
+ *      Project: A12 simulator run tool
+ *
+ *       Author: kp
+ *
+ *  Description: Address space tests: views, block transfers, scatter-gather
+ *               queue and bus timing (tests 4, 5, 6, 13)
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "a12_simrun_int.h"
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* address view test: 64-bit BAR0 above 4GB */
+#define VIEW_BAR0			0x340000000ULL
+
+/* block transfer benchmark */
+#define BLK_SIZE			0x10000		/* 64 KB */
+#define BLK_OFFS			4			/* unaligned head and tail */
+
+/* scatter-gather queue test */
+#define SG_REQS				16			/* requests per batch */
+#define SG_ELEM_SIZE		0x400		/* 1 KB */
+
+/* bus timing benchmark */
+#define TIM_A24_SIZE		0x1000		/* bytes per A24 transfer */
+#define TIM_A08_SIZE		0x100		/* whole A08 space */
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+/* write-combined/prefetchable A24 views allowed on slot 0 */
+static const A12SIM_DESC G_descView[] = {
+	{ "DEBUG_LEVEL",		0 },
+	{ "SLOT_0_A24_ATTR",	A12_MATTR_WC | A12_MATTR_PREFETCH },
+	{ NULL,					0 }
+};
+
+/* bus timing: slot 2 slow from the start */
+static const A12SIM_DESC G_descTiming[] = {
+	{ "DEBUG_LEVEL",		0 },
+	{ "SLOT_2_TIMING",		A12_TIMING_SLOW },
+	{ NULL,					0 }
+};
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static int32 ViewRun( BBIS_ENTRY *bb, u_int32 barAttr );
+static void BlkReport( const char *op, u_int32 dataMode, const char *how );
+static void SgCallback( A12_SG_REQ *req, void *arg );
+static int32 SgCount( void *arg, u_int32 mSlot, u_int32 dir, u_int32 addrMode,
+					  u_int32 dataMode, u_int32 offs, void *buf, u_int32 size );
+static int32 SgStat( BBIS_ENTRY *bb, BBIS_HANDLE *h, A12_SG_STAT *st );
+static int32 TimRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 mSlot,
+					 u_int32 win, u_int32 *okP );
+
+/******************************** ViewTest **********************************
+ *
+ *  Description: Address spaces and views with BAR0 above 4GB, with
+ *               prefetchable and non-prefetchable BAR0, and with an OSS
+ *               which drops the high dword of BAR0
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 ViewTest( BBIS_ENTRY *bb )
+{
+	printf("%-14s %4s %4s %12s %9s %5s %7s\n", "BAR0", "slot", "mode",
+		   "phys", "size", "allow", "granted");
+
+	CHK( ViewRun( bb, A12SIM_BAR_64 | A12SIM_BAR_PREFETCH ) == 0 );
+	CHK( ViewRun( bb, A12SIM_BAR_64 ) == 0 );
+	CHK( ViewRun( bb, A12SIM_BAR_64 | A12SIM_BAR_OSS32 ) == 0 );
+	return 0;
+
+abort:
+	return 1;
+}
+
+/******************************** ViewRun ***********************************
+ *
+ *  Description: Query and map the A24/A08 D32 spaces of slots 0 and 1
+ *
+ *               Slot 0 allows write-combined and prefetchable A24 views
+ *               (G_descView), slot 1 does not.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb			BBIS jump table
+ *               barAttr	A12SIM_BAR_xxx of BAR0
+ *  Output.....: return		success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 ViewRun( BBIS_ENTRY *bb, u_int32 barAttr )
+{
+	static const u_int32 addrMode[] = { MDIS_MA24, MDIS_MA08 };
+	BBIS_HANDLE	*h = NULL;
+	A12_MADDR	ma;
+	A12_VIEW	view;
+	void		*addr;
+	u_int32		slot, n, size, want;
+
+	A12SIM_Reset();
+	A12SIM_SetBar0( VIEW_BAR0, barAttr );
+	CHK( bb->init( NULL, (DESC_SPEC*)G_descView, &h ) == 0 );
+
+	for( slot=0; slot<2; slot++ ){
+		for( n=0; n<2; n++ ){
+			CHK( bb->getMAddr( h, slot, addrMode[n], MDIS_MD32, &addr,
+							   &size ) == 0 );
+			CHK( A12_ENTRY_GETMADDREX( bb )( h, slot, addrMode[n], MDIS_MD32,
+											  &ma ) == 0 );
+			CHK( ma.phys == (u_int64)(U_INT32_OR_64)addr && ma.size == size );
+			CHK( ma.phys >= VIEW_BAR0 );
+
+			want = A12_MATTR_WC | A12_MATTR_PREFETCH;
+			CHK( A12_ENTRY_MAPVIEW( bb )( h, slot, addrMode[n], MDIS_MD32,
+										   want, &view ) == 0 );
+			CHK( view.virt != NULL && view.attr == ma.attr );
+
+			/* view reaches the module address space */
+			*(volatile u_int32*)view.virt = 0x12345678 + slot;
+			CHK( A12SIM_Read32( view.virt, 0 ) == 0x12345678 + slot );
+			CHK( A12_ENTRY_UNMAPVIEW( bb )( h, &view ) == 0 );
+
+			printf("%-14s %4u %4s %12llx %9x %5x %7x\n",
+				   (barAttr & A12SIM_BAR_PREFETCH) ? "64/prefetch" :
+				   (barAttr & A12SIM_BAR_OSS32) ? "64/oss32" : "64",
+				   slot, n ? "A08" : "A24", (unsigned long long)ma.phys,
+				   ma.size, ma.attr, view.attr );
+		}
+	}
+
+	CHK( bb->exit( &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************* BlkTest **********************************
+ *
+ *  Description: Compare BBIS block transfers with the per-word loops of
+ *               M-module drivers
+ *
+ *               64 KB at an offset that is not 16 byte aligned are read,
+ *               written and filled in the A24 D32 and D16 windows of
+ *               slot 0. The data is checked across both methods.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 BlkTest( BBIS_ENTRY *bb )
+{
+	static const u_int32 dataMode[] = { MDIS_MD32, MDIS_MD16 };
+	BBIS_HANDLE	*h = NULL;
+	A12_VIEW	view;
+	u_int32		*src = NULL, *dst = NULL, n, m, i;
+	u_int16		*s16, *d16;
+
+	view.virt = NULL;
+	CHK( (src = (u_int32*)malloc( BLK_SIZE )) != NULL );
+	CHK( (dst = (u_int32*)malloc( BLK_SIZE )) != NULL );
+	s16 = (u_int16*)src;
+	d16 = (u_int16*)dst;
+	for( i=0; i<BLK_SIZE/4; i++ )
+		src[i] = i * 0x01010101 + 0x12345678;
+
+	CHK( SimOpen( bb, G_desc, 0, &h ) == 0 );
+
+	printf("%-6s %4s %-8s %8s %10s %8s\n", "op", "mode", "method", "pci",
+		   "bus [us]", "MB/s");
+
+	for( m=0; m<2; m++ ){
+		CHK( A12_ENTRY_MAPVIEW( bb )( h, 0, MDIS_MA24, dataMode[m], 0,
+									   &view ) == 0 );
+		n = BLK_SIZE - 2 * BLK_OFFS;
+
+		/*--------------------+
+		|  write              |
+		+--------------------*/
+		A12SIM_ClrStats();
+		if( dataMode[m] == MDIS_MD32 )
+			for( i=0; i<n; i+=4 )
+				A12SIM_Write32( view.virt, BLK_OFFS + i, src[i/4] );
+		else
+			for( i=0; i<n; i+=2 )
+				A12SIM_Write16( view.virt, BLK_OFFS + i, s16[i/2] );
+		BlkReport( "write", dataMode[m], "loop" );
+
+		A12SIM_ClrStats();
+		CHK( A12_ENTRY_BLKWRITE( bb )( h, 0, dataMode[m], BLK_OFFS, src,
+										n ) == 0 );
+		BlkReport( "write", dataMode[m], "block" );
+
+		/*--------------------+
+		|  read               |
+		+--------------------*/
+		memset( dst, 0, BLK_SIZE );
+		A12SIM_ClrStats();
+		if( dataMode[m] == MDIS_MD32 )
+			for( i=0; i<n; i+=4 )
+				dst[i/4] = A12SIM_Read32( view.virt, BLK_OFFS + i );
+		else
+			for( i=0; i<n; i+=2 )
+				d16[i/2] = A12SIM_Read16( view.virt, BLK_OFFS + i );
+		BlkReport( "read", dataMode[m], "loop" );
+		CHK( memcmp( src, dst, n ) == 0 );
+
+		memset( dst, 0, BLK_SIZE );
+		A12SIM_ClrStats();
+		CHK( A12_ENTRY_BLKREAD( bb )( h, 0, dataMode[m], BLK_OFFS, dst,
+									   n ) == 0 );
+		BlkReport( "read", dataMode[m], "block" );
+		CHK( memcmp( src, dst, n ) == 0 );
+
+		/*--------------------+
+		|  fill               |
+		+--------------------*/
+		A12SIM_ClrStats();
+		if( dataMode[m] == MDIS_MD32 )
+			for( i=0; i<n; i+=4 )
+				A12SIM_Write32( view.virt, BLK_OFFS + i, 0 );
+		else
+			for( i=0; i<n; i+=2 )
+				A12SIM_Write16( view.virt, BLK_OFFS + i, 0 );
+		BlkReport( "fill", dataMode[m], "loop" );
+
+		A12SIM_ClrStats();
+		CHK( A12_ENTRY_BLKFILL( bb )( h, 0, dataMode[m], BLK_OFFS,
+									   0xa5a5a5a5, n ) == 0 );
+		BlkReport( "fill", dataMode[m], "block" );
+		for( i=0; i<n; i+=2 )
+			CHK( A12SIM_Read16( view.virt, BLK_OFFS + i ) == 0xa5a5 );
+
+		CHK( A12_ENTRY_UNMAPVIEW( bb )( h, &view ) == 0 );
+	}
+
+	/* parameter checks */
+	CHK( A12_ENTRY_BLKREAD( bb )( h, 0, MDIS_MD32, 2, dst, 4 ) ==
+		 ERR_BBIS_ILL_PARAM );
+	CHK( A12_ENTRY_BLKREAD( bb )( h, 0, MDIS_MD32, 0xfffffc, dst, 8 ) ==
+		 ERR_BBIS_ILL_PARAM );
+	CHK( A12_ENTRY_BLKREAD( bb )( h, 3, MDIS_MD32, 0, dst, 4 ) ==
+		 ERR_BBIS_ILL_SLOT );
+
+	CHK( SimClose( bb, &h ) == 0 );
+	free( src );
+	free( dst );
+	return 0;
+
+abort:
+	if( h && view.virt )
+		A12_ENTRY_UNMAPVIEW( bb )( h, &view );
+	SimClose( bb, &h );
+	if( src )
+		free( src );
+	if( dst )
+		free( dst );
+	return 1;
+}
+
+/******************************** BlkReport *********************************
+ *
+ *  Description: Print PCI transactions and throughput of a block
+ *               transfer since last A12SIM_ClrStats
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: op			operation
+ *               dataMode	MDIS_MD16 | MDIS_MD32
+ *               how		method
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void BlkReport( const char *op, u_int32 dataMode, const char *how )
+{
+	A12SIM_STATS st;
+
+	A12SIM_GetStats( &st );
+	printf("%-6s %4s %-8s %8u %10llu %8llu\n", op,
+		   dataMode == MDIS_MD32 ? "D32" : "D16", how, st.reads + st.writes,
+		   (unsigned long long)st.simNs / 1000,
+		   st.simNs ? (unsigned long long)(BLK_SIZE - 2 * BLK_OFFS) * 1000 /
+		   st.simNs : 0ULL );
+}
+
+/********************************* SgTest ***********************************
+ *
+ *  Description: Asynchronous scatter-gather queue of slot 0
+ *
+ *               A12_SgSubmit only queues, A12_SgRun is called here as
+ *               the SG worker of the OS layer.
+ *
+ *               - SG_REQS write requests of two adjacent elements each,
+ *                 contiguous across requests: one backend call
+ *               - scattered read with callback, read via completion ring
+ *                 executed with the next submit
+ *               - failing request, custom backend
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 SgTest( BBIS_ENTRY *bb )
+{
+	BBIS_HANDLE		*h = NULL;
+	A12_SG_REQ		req[SG_REQS], *done;
+	A12_SG_ELEM		elem[SG_REQS][2];
+	A12_SG_STAT		st;
+	A12_SG_BACKEND	be;
+	A12SIM_STATS	sim;
+	u_int8			*src = NULL, *dst = NULL;
+	u_int32			i, n, size = SG_REQS * 2 * SG_ELEM_SIZE, calls = 0;
+	u_int32			cnt = 0;
+
+	CHK( (src = (u_int8*)malloc( size )) != NULL );
+	CHK( (dst = (u_int8*)malloc( size )) != NULL );
+	for( i=0; i<size; i++ )
+		src[i] = (u_int8)(i * 7 + 3);
+
+	CHK( SimOpen( bb, G_desc, 0, &h ) == 0 );
+	memset( req, 0, sizeof(req) );
+
+	/*----------------------------+
+	|  adjacent writes, batched   |
+	+----------------------------*/
+	for( i=0; i<SG_REQS; i++ ){
+		for( n=0; n<2; n++ ){
+			elem[i][n].buf	= src + (i*2 + n) * SG_ELEM_SIZE;
+			elem[i][n].offs = (i*2 + n) * SG_ELEM_SIZE;
+			elem[i][n].size = SG_ELEM_SIZE;
+		}
+		req[i].dir		= A12_SG_WRITE;
+		req[i].addrMode = MDIS_MA24;
+		req[i].dataMode = MDIS_MD32;
+		req[i].elem		= elem[i];
+		req[i].nElem	= 2;
+		req[i].flags	= i < SG_REQS-1 ? A12_SG_MORE : 0;
+		req[i].callback = SgCallback;
+		req[i].cbArg	= &cnt;
+		if( i == SG_REQS-1 ){
+			CHK( cnt == 0 );
+			A12SIM_ClrStats();
+		}
+		CHK( A12_ENTRY_SGSUBMIT( bb )( h, 0, &req[i] ) == 0 );
+	}
+	A12SIM_GetStats( &sim );
+	CHK( cnt == 0 && sim.writes == 0 );		/* nothing done by submit */
+	CHK( A12_ENTRY_SGRUN( bb )( h, 0, NULL ) == 0 );
+	A12SIM_GetStats( &sim );
+	CHK( cnt == SG_REQS );
+	CHK( SgStat( bb, h, &st ) == 0 );
+	printf("write: %d requests, %d elements -> %d backend calls, "
+		   "%d queue runs, %d PCI writes\n", st.reqs, st.elems, st.xfers,
+		   st.runs, sim.writes );
+	CHK( st.xfers == 1 && st.runs == 1 && st.errors == 0 );
+	for( i=0; i<SG_REQS; i++ )
+		CHK( req[i].status == 0 );
+
+	/*----------------------------+
+	|  scattered read, callback   |
+	+----------------------------*/
+	memset( dst, 0, size );
+	for( n=0; n<2; n++ ){
+		/* swap the two halves in memory: not contiguous */
+		elem[0][n].buf	= dst + (1 - n) * size / 2;
+		elem[0][n].offs = n * size / 2;
+		elem[0][n].size = size / 2;
+	}
+	req[0].dir	 = A12_SG_READ;
+	req[0].nElem = 2;
+	req[0].flags = 0;
+	cnt = 0;
+	CHK( A12_ENTRY_SGSUBMIT( bb )( h, 0, &req[0] ) == 0 );
+	CHK( cnt == 0 );
+	CHK( A12_ENTRY_SGRUN( bb )( h, 0, NULL ) == 0 );
+	CHK( cnt == 1 && req[0].status == 0 );
+	CHK( memcmp( dst, src + size / 2, size / 2 ) == 0 );
+	CHK( memcmp( dst + size / 2, src, size / 2 ) == 0 );
+	CHK( SgStat( bb, h, &st ) == 0 );
+	CHK( st.xfers == 3 );
+
+	/*----------------------------+
+	|  read via completion ring   |
+	+----------------------------*/
+	memset( dst, 0, size );
+	elem[1][0].buf	= dst;
+	elem[1][0].offs = 0;
+	elem[1][0].size = size;
+	req[1].dir		= A12_SG_READ;
+	req[1].nElem	= 1;
+	req[1].callback = NULL;
+	req[1].flags	= A12_SG_MORE;
+	CHK( A12_ENTRY_SGSUBMIT( bb )( h, 0, &req[1] ) == 0 );
+	CHK( A12_ENTRY_SGCOMPLETE( bb )( h, 0, &done ) == 0 && done == NULL );
+	req[2].nElem	= 0;
+	req[2].flags	= 0;
+	req[2].callback = SgCallback;
+	CHK( A12_ENTRY_SGSUBMIT( bb )( h, 0, &req[2] ) == 0 );
+	CHK( A12_ENTRY_SGCOMPLETE( bb )( h, 0, &done ) == 0 && done == NULL );
+	CHK( A12_ENTRY_SGRUN( bb )( h, 0, NULL ) == 0 );
+	CHK( A12_ENTRY_SGCOMPLETE( bb )( h, 0, &done ) == 0 && done == &req[1] );
+	CHK( done->status == 0 && memcmp( dst, src, size ) == 0 );
+	CHK( A12_ENTRY_SGCOMPLETE( bb )( h, 0, &done ) == 0 && done == NULL );
+
+	/*----------------------------+
+	|  failing request            |
+	+----------------------------*/
+	elem[1][0].offs = 2;
+	elem[1][0].size = 4;
+	req[1].flags	= 0;
+	CHK( A12_ENTRY_SGSUBMIT( bb )( h, 0, &req[1] ) == 0 );
+	CHK( A12_ENTRY_SGRUN( bb )( h, 0, NULL ) == 0 );
+	CHK( A12_ENTRY_SGCOMPLETE( bb )( h, 0, &done ) == 0 && done == &req[1] );
+	CHK( done->status == ERR_BBIS_ILL_PARAM );
+	CHK( SgStat( bb, h, &st ) == 0 && st.errors == 1 );
+
+	/*----------------------------+
+	|  custom backend             |
+	+----------------------------*/
+	be.xfer = SgCount;
+	be.arg	= &calls;
+	elem[1][0].offs = 0;
+	CHK( A12_ENTRY_SGSUBMIT( bb )( h, 0, &req[1] ) == 0 );
+	CHK( A12_ENTRY_SGRUN( bb )( h, 0, &be ) == 0 );
+	CHK( A12_ENTRY_SGCOMPLETE( bb )( h, 0, &done ) == 0 && done == &req[1] );
+	CHK( done->status == 0 && calls == 1 );
+
+	/* parameter checks */
+	req[1].dir = 2;
+	CHK( A12_ENTRY_SGSUBMIT( bb )( h, 0, &req[1] ) == ERR_BBIS_ILL_PARAM );
+	CHK( A12_ENTRY_SGSUBMIT( bb )( h, 3, &req[1] ) == ERR_BBIS_ILL_SLOT );
+	CHK( A12_ENTRY_SGRUN( bb )( h, 3, NULL ) == ERR_BBIS_ILL_SLOT );
+	req[1].dir = A12_SG_READ;
+	CHK( bb->setStat( h, 1, M_BB_A12_SLOT_ENABLE, 0 ) == 0 );
+	CHK( A12_ENTRY_SGSUBMIT( bb )( h, 1, &req[1] ) == ERR_BBIS_ILL_SLOT );
+
+	CHK( SimClose( bb, &h ) == 0 );
+	free( src );
+	free( dst );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	if( src )
+		free( src );
+	if( dst )
+		free( dst );
+	return 1;
+}
+
+/******************************** SgCallback ********************************
+ *
+ *  Description: Completion callback, count completed requests
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: req	completed request
+ *               arg	counter
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void SgCallback( A12_SG_REQ *req, void *arg )
+{
+	(*(u_int32*)arg)++;
+}
+
+/********************************* SgCount **********************************
+ *
+ *  Description: Custom SG backend, count calls only
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg		counter
+ *               ...		see A12_SG_BACKEND
+ *  Output.....: return		0
+ *  Globals....: -
+ ****************************************************************************/
+static int32 SgCount( void *arg, u_int32 mSlot, u_int32 dir, u_int32 addrMode,
+					  u_int32 dataMode, u_int32 offs, void *buf, u_int32 size )
+{
+	(*(u_int32*)arg)++;
+	return 0;
+}
+
+/********************************* SgStat ***********************************
+ *
+ *  Description: Get SG queue statistics of slot 0
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *  Output.....: st		statistics
+ *               return	0 | error code
+ *  Globals....: -
+ ****************************************************************************/
+static int32 SgStat( BBIS_ENTRY *bb, BBIS_HANDLE *h, A12_SG_STAT *st )
+{
+	M_SG_BLOCK blk;
+
+	blk.size = sizeof(*st);
+	blk.data = (void*)st;
+	return bb->getStat( h, 0, M_BB_A12_BLK_SGSTAT, (INT32_OR_64*)&blk );
+}
+
+/********************************* TimTest **********************************
+ *
+ *  Description: Read/write throughput per slot, window and bus timing
+ *
+ *               The module in slot 0 works with any timing, slot 1 up to
+ *               timing 2, slot 2 only with A12_TIMING_SLOW. For each slot
+ *               the fastest timing with correct data in all windows is
+ *               reported. Slot 2 is set up slow by SLOT_2_TIMING.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               lat	latency model
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 TimTest( BBIS_ENTRY *bb, const A12SIM_LATENCY *lat )
+{
+	static const u_int32 modTiming[3] = { 3, 2, 0 };
+	BBIS_HANDLE *h = NULL;
+	INT32_OR_64 val;
+	u_int32 mSlot, win, ok, allOk, best[3];
+	int32 t;
+
+	A12SIM_Reset();
+	A12SIM_SetLatency( lat );
+	for( mSlot=0; mSlot<3; mSlot++ )
+		A12SIM_SetModTiming( mSlot, modTiming[mSlot] );
+
+	CHK( SimOpen( bb, G_descTiming, 0, &h ) == 0 );
+	CHK( (A12SIM_CtrlPeek( 0 ) & A12SIM_CTRL_FAST) == A12SIM_CTRL_FAST );
+	CHK( (A12SIM_CtrlPeek( 2 ) & A12SIM_CTRL_FAST) == 0 );
+	CHK( bb->getStat( h, 2, M_BB_A12_SLOT_TIMING, &val ) == 0 &&
+		 val == A12_TIMING_SLOW );
+
+	printf("%-4s %6s %-7s %9s %9s %4s\n", "slot", "timing", "window",
+		   "wr MB/s", "rd MB/s", "data");
+
+	for( mSlot=0; mSlot<3; mSlot++ ){
+		best[mSlot] = 0xff;
+		for( t=A12_TIMING_FAST; t>=A12_TIMING_SLOW; t-- ){
+			CHK( bb->setStat( h, mSlot, M_BB_A12_SLOT_TIMING, t ) == 0 );
+			CHK( ((A12SIM_CtrlPeek( mSlot ) & A12SIM_CTRL_FAST) >> 2) ==
+				 (u_int32)t );
+
+			allOk = TRUE;
+			for( win=0; win<A12_RES_WINS; win++ ){
+				CHK( TimRun( bb, h, mSlot, win, &ok ) == 0 );
+				allOk &= ok;
+			}
+			if( allOk && best[mSlot] == 0xff )
+				best[mSlot] = t;
+		}
+	}
+
+	for( mSlot=0; mSlot<3; mSlot++ )
+		printf("slot %u: fastest safe timing %u\n", mSlot, best[mSlot]);
+	for( mSlot=0; mSlot<3; mSlot++ )
+		CHK( best[mSlot] == modTiming[mSlot] );
+
+	/* parameter checks, IEN kept */
+	CHK( bb->irqEnable( h, 0, TRUE ) == 0 );
+	CHK( bb->setStat( h, 0, M_BB_A12_SLOT_TIMING, 1 ) == 0 );
+	CHK( A12SIM_CtrlPeek( 0 ) == (A12SIM_CTRL_IEN | 0x04) );
+	CHK( bb->setStat( h, 0, M_BB_A12_SLOT_TIMING, 4 ) == ERR_BBIS_ILL_PARAM );
+	CHK( bb->setStat( h, 0x1000, M_BB_A12_SLOT_TIMING, 0 ) ==
+		 ERR_BBIS_ILL_SLOT );
+	CHK( bb->irqEnable( h, 0, FALSE ) == 0 );
+
+	CHK( bb->brdExit( h ) == 0 );
+	CHK( (A12SIM_CtrlPeek( 0 ) & A12SIM_CTRL_FAST) == 0x04 );
+	CHK( bb->exit( &h ) == 0 );
+	return 0;
+
+abort:
+	SimClose( bb, &h );
+	return 1;
+}
+
+/********************************** TimRun **********************************
+ *
+ *  Description: Write and read back one window with the current timing
+ *
+ *               A24 windows use A12_BlkWrite/A12_BlkRead, A08 windows
+ *               (registers) word accesses through a view.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               h		board handle
+ *               mSlot	module slot number
+ *               win	A12_RES_xxx
+ *  Output.....: okP	data read back correctly
+ *               return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 TimRun( BBIS_ENTRY *bb, BBIS_HANDLE *h, u_int32 mSlot,
+					 u_int32 win, u_int32 *okP )
+{
+	static const char *winName[A12_RES_WINS] = {
+		"A08/D16", "A08/D32", "A24/D16", "A24/D32" };
+	u_int32 addrMode = win < A12_RES_A24_D16 ? MDIS_MA08 : MDIS_MA24;
+	u_int32 dataMode = win & 1 ? MDIS_MD32 : MDIS_MD16;
+	u_int32 size = addrMode == MDIS_MA08 ? TIM_A08_SIZE : TIM_A24_SIZE;
+	u_int32 src[TIM_A24_SIZE/4], dst[TIM_A24_SIZE/4], i, step;
+	u_int64 wrNs, rdNs;
+	A12SIM_STATS st;
+	A12_VIEW view;
+
+	step = dataMode == MDIS_MD32 ? 4 : 2;
+	for( i=0; i<size/4; i++ )
+		src[i] = (i + mSlot * 0x100) * 0x00010001 + win;
+	memset( dst, 0, size );
+
+	view.virt = NULL;
+	if( addrMode == MDIS_MA08 )
+		CHK( A12_ENTRY_MAPVIEW( bb )( h, mSlot, addrMode, dataMode, 0,
+									   &view ) == 0 );
+
+	/* write */
+	A12SIM_ClrStats();
+	if( view.virt ){
+		for( i=0; i<size; i+=step )
+			if( step == 4 )
+				A12SIM_Write32( view.virt, i, src[i/4] );
+			else
+				A12SIM_Write16( view.virt, i, ((u_int16*)src)[i/2] );
+	}
+	else
+		CHK( A12_ENTRY_BLKWRITE( bb )( h, mSlot, dataMode, 0, src,
+										size ) == 0 );
+	A12SIM_GetStats( &st );
+	wrNs = st.simNs;
+
+	/* read */
+	A12SIM_ClrStats();
+	if( view.virt ){
+		for( i=0; i<size; i+=step )
+			if( step == 4 )
+				dst[i/4] = A12SIM_Read32( view.virt, i );
+			else
+				((u_int16*)dst)[i/2] = A12SIM_Read16( view.virt, i );
+	}
+	else
+		CHK( A12_ENTRY_BLKREAD( bb )( h, mSlot, dataMode, 0, dst,
+									   size ) == 0 );
+	A12SIM_GetStats( &st );
+	rdNs = st.simNs;
+
+	if( view.virt )
+		CHK( A12_ENTRY_UNMAPVIEW( bb )( h, &view ) == 0 );
+
+	*okP = memcmp( src, dst, size ) == 0 && st.timingErrs == 0;
+	printf("%-4u %6u %-7s %9llu %9llu %4s\n", mSlot,
+		   (A12SIM_CtrlPeek( mSlot ) & A12SIM_CTRL_FAST) >> 2, winName[win],
+		   wrNs ? (unsigned long long)size * 1000 / wrNs : 0ULL,
+		   rdNs ? (unsigned long long)size * 1000 / rdNs : 0ULL,
+		   *okP ? "ok" : "BAD");
+	return 0;
+
+abort:
+	if( view.virt )
+		A12_ENTRY_UNMAPVIEW( bb )( h, &view );
+	return 1;
+}
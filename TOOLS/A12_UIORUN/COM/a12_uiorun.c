@@ -0,0 +1,511 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                  A 1 2 _ U I O R U N               ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *       Author: kp
+ *
+ *  Description: Exercise the A12 BBIS in userspace (kernel bypass)
+ *
+ *               Runs the real A12_GetEntry jump table in this process,
+ *               with BAR0 of the bridge mapped through sysfs (a12_uio).
+ *
+ *               Without -r, a fake bridge is created in a temporary
+ *               sysfs tree: config space, resource file and a 128 MB
+ *               resource0 file standing in for a prefetchable BAR0, with
+ *               resource0_wc linked to it. The tool checks block
+ *               transfers and uncached and write-combined views against
+ *               the file and
+ *               detects an interrupt raised by another thread writing
+ *               the control register of slot 0 by polling.
+ *
+ *               With -r=<root>, e.g. -r=/sys on a system with an A12,
+ *               only the non-destructive checks are run: init, mapping
+ *               and the polling cost.
+ *
+ *     Required: libraries: a12_uio, usr_utl, pthread
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2001-2019, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/usr_utl.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/bb_defs.h>
+#include <MEN/bb_entry.h>
+#include <MEN/bb_a12.h>
+#include <MEN/bb_a12_ext.h>
+#include <MEN/a12_uio.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+/* fake bridge, location and layout as the A12 */
+#define FAKE_DEV_DIR		"bus/pci/devices/0000:00:18.0"
+#define FAKE_VEN_ID			0x1172
+#define FAKE_DEV_ID			0x410c
+#define FAKE_BAR0			0xd0000000	/* memory, 32 bit, prefetchable */
+#define FAKE_BAR0_SIZE		0x08000000	/* 4 x 32 MB */
+#define FAKE_IRQ_LINE		11
+#define FAKE_CTRL_OFFS		0x01ffff04	/* control register in slot space */
+#define FAKE_CTRL_IRQ		0x01		/* IRQ pending */
+
+#define BLK_SIZE			0x1000		/* block transfer check */
+#define BLK_OFFS			0x100
+#define POLL_ROUNDS			100000		/* idle polls timed */
+#define IRQ_ROUNDS			100			/* interrupts raised */
+#define IRQ_DELAY_US		200			/* raise delay */
+#define IRQ_TIMEOUT_US		1000000
+
+#define CHK(expression) \
+ if( !(expression)) {\
+	 printf("\n*** Error during: %s\nfile %s\nline %d\n", \
+      #expression,__FILE__,__LINE__);\
+      goto abort;\
+ }
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* interrupt source thread */
+typedef struct {
+	int				fd;			/* resource0 of the fake bridge */
+	u_int32			rounds;		/* interrupts to raise */
+	volatile u_int32 ack;		/* interrupts serviced */
+	struct timespec	raised;		/* time of the last raise */
+} IRQ_SRC;
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+/* slot 0 polled, so IEN is never set */
+static const A12UIO_DESC G_desc[] = {
+	{ "DEBUG_LEVEL",		0 },
+	{ "SLOT_0_IRQ_POLICY",	A12_POLICY_POLL },
+	{ "SLOT_0_A24_ATTR",	A12_MATTR_WC | A12_MATTR_PREFETCH },
+	{ NULL,					0 }
+};
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void usage( void );
+static int32 FakeCreate( char *root );
+static void FakeRemove( const char *root );
+static int32 WriteFile( const char *root, const char *name,
+						const void *buf, u_int32 size );
+static u_int64 NowNs( void );
+static void *IrqSource( void *arg );
+static int32 UioRun( BBIS_ENTRY *bb, int fd );
+
+/********************************* usage ************************************
+ *
+ *  Description: Print program usage
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void usage( void )
+{
+	printf("Usage: a12_uiorun [<opts>]\n");
+	printf("Function: exercise the A12 BBIS in userspace (kernel bypass)\n");
+	printf("Options:\n");
+	printf("    -r=<root>  sysfs root of a real A12, e.g. /sys\n");
+	printf("               (default: temporary fake bridge)\n");
+	printf("\n");
+}
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return		success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main( int argc, char *argv[] )
+{
+	BBIS_ENTRY	bb;
+	char		*str, errstr[40], root[64], path[128];
+	int32		ret = 1;
+	int			fd = -1;
+
+	if( (str = UTL_ILLIOPT("r=?", errstr)) ){
+		printf("*** %s\n", errstr);
+		return(1);
+	}
+	if( UTL_TSTOPT("?") ){
+		usage();
+		return(1);
+	}
+
+	A12_GetEntry( &bb );
+
+	/* real bridge: non-destructive checks only */
+	if( (str = UTL_TSTOPT("r=")) ){
+		A12UIO_SetRoot( str );
+		return UioRun( &bb, -1 );
+	}
+
+	if( FakeCreate( root ) ){
+		printf("*** can't create fake bridge\n");
+		return 1;
+	}
+	printf("fake bridge: %s/%s\n", root, FAKE_DEV_DIR);
+
+	snprintf( path, sizeof(path), "%s/%s/resource0", root, FAKE_DEV_DIR );
+	if( (fd = open( path, O_RDWR )) >= 0 ){
+		A12UIO_SetRoot( root );
+		ret = UioRun( &bb, fd );
+		close( fd );
+	}
+
+	FakeRemove( root );
+	return ret;
+}
+
+/********************************* UioRun ***********************************
+ *
+ *  Description: Run the checks
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: bb		BBIS jump table
+ *               fd		resource0 of the fake bridge, -1: real bridge
+ *  Output.....: return	success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 UioRun( BBIS_ENTRY *bb, int fd )
+{
+	BBIS_HANDLE	*h = NULL, *hInit;
+	A12_MADDR	ma;
+	A12_VIEW	view;
+	IRQ_SRC		src;
+	pthread_t	thread;
+	u_int8		*buf = NULL, *chk = NULL;
+	u_int64		t0, lat, latMax = 0, latSum = 0;
+	u_int32		mask, i, n = 0;
+	int32		error, running = FALSE;
+
+	view.virt = NULL;
+	CHK( (buf = (u_int8*)malloc( BLK_SIZE )) != NULL );
+	CHK( (chk = (u_int8*)malloc( BLK_SIZE )) != NULL );
+
+	/*--------------------+
+	|  init, map BAR0     |
+	+--------------------*/
+	/* the handle is freed if init fails */
+	if( (error = bb->init( NULL, (DESC_SPEC*)G_desc, &hInit )) ){
+		printf("*** init: no A12 found (error 0x%04x)\n", (int)error);
+		goto abort;
+	}
+	h = hInit;
+	CHK( bb->brdInit( h ) == 0 );
+	CHK( A12_ENTRY_GETMADDREX( bb )( h, 0, MDIS_MA24, MDIS_MD32, &ma ) == 0 );
+	printf("init:        slot 0 A24 D32 at 0x%08llx\n",
+		   (unsigned long long)ma.phys);
+
+	/*--------------------+
+	|  polling cost       |
+	+--------------------*/
+	CHK( bb->irqEnable( h, 0, TRUE ) == 0 );
+
+	t0 = NowNs();
+	for( i=0; i<POLL_ROUNDS; i++ )
+		CHK( A12_ENTRY_POLL( bb )( h, &mask ) == 0 );
+	printf("poll:        %llu ns per poll (idle)\n",
+		   (unsigned long long)((NowNs() - t0) / POLL_ROUNDS));
+
+	if( fd < 0 ){
+		CHK( bb->irqEnable( h, 0, FALSE ) == 0 );
+		goto done;
+	}
+
+	/*--------------------+
+	|  block transfers    |
+	+--------------------*/
+	for( i=0; i<BLK_SIZE; i++ )
+		buf[i] = (u_int8)(i * 7 + 3);
+
+	CHK( A12_ENTRY_BLKWRITE( bb )( h, 0, MDIS_MD32, BLK_OFFS, buf,
+									BLK_SIZE ) == 0 );
+	CHK( pread( fd, chk, BLK_SIZE, (off_t)(ma.phys - FAKE_BAR0 + BLK_OFFS) )
+		 == BLK_SIZE );
+	CHK( memcmp( buf, chk, BLK_SIZE ) == 0 );
+
+	memset( chk, 0, BLK_SIZE );
+	CHK( A12_ENTRY_BLKREAD( bb )( h, 0, MDIS_MD32, BLK_OFFS, chk,
+								   BLK_SIZE ) == 0 );
+	CHK( memcmp( buf, chk, BLK_SIZE ) == 0 );
+	printf("block:       %d bytes written and read back\n", BLK_SIZE);
+
+	/*--------------------+
+	|  direct view        |
+	+--------------------*/
+	CHK( A12_ENTRY_MAPVIEW( bb )( h, 0, MDIS_MA24, MDIS_MD32, 0,
+								   &view ) == 0 );
+	CHK( memcmp( (u_int8*)view.virt + BLK_OFFS, buf, BLK_SIZE ) == 0 );
+	CHK( A12_ENTRY_UNMAPVIEW( bb )( h, &view ) == 0 );
+	printf("view:        A24 D32 window matches resource0\n");
+
+	/* write-combined through resource0_wc, same BAR */
+	CHK( A12_ENTRY_MAPVIEW( bb )( h, 0, MDIS_MA24, MDIS_MD32,
+								   A12_MATTR_WC | A12_MATTR_PREFETCH,
+								   &view ) == 0 );
+	CHK( view.attr == (A12_MATTR_WC | A12_MATTR_PREFETCH) );
+	for( i=0; i<BLK_SIZE; i++ )
+		((u_int8*)view.virt)[BLK_OFFS + i] = (u_int8)~buf[i];
+	CHK( A12_ENTRY_UNMAPVIEW( bb )( h, &view ) == 0 );
+	CHK( pread( fd, chk, BLK_SIZE, (off_t)(ma.phys - FAKE_BAR0 + BLK_OFFS) )
+		 == BLK_SIZE );
+	for( i=0; i<BLK_SIZE; i++ )
+		CHK( chk[i] == (u_int8)~buf[i] );
+	printf("view wc:     A24 D32 window written through resource0_wc\n");
+
+	/*--------------------+
+	|  interrupt by poll  |
+	+--------------------*/
+	src.fd	   = fd;
+	src.rounds = IRQ_ROUNDS;
+	src.ack	   = 0;
+	CHK( pthread_create( &thread, NULL, IrqSource, &src ) == 0 );
+	running = TRUE;
+
+	for( n=0; n<IRQ_ROUNDS; n++ ){
+		CHK( A12UIO_IrqWait( bb, h, IRQ_TIMEOUT_US, &mask ) == 0 );
+		lat = NowNs() - ((u_int64)src.raised.tv_sec * 1000000000 +
+						 src.raised.tv_nsec);
+		CHK( mask == 0x1 );
+		CHK( bb->irqSrvInit( h, 0 ) == BBIS_IRQ_YES );
+
+		/* driver ISR: clear the source */
+		CHK( pwrite( fd, "\0", 1, FAKE_CTRL_OFFS ) == 1 );
+		bb->irqSrvExit( h, 0 );
+
+		latSum += lat;
+		if( lat > latMax )
+			latMax = lat;
+		src.ack = n + 1;
+	}
+	pthread_join( thread, NULL );
+	running = FALSE;
+	printf("irq:         %u detected, latency avg %llu ns, max %llu ns\n", n,
+		   (unsigned long long)(latSum / n), (unsigned long long)latMax);
+
+	CHK( bb->irqEnable( h, 0, FALSE ) == 0 );
+
+done:
+	CHK( bb->brdExit( h ) == 0 );
+	CHK( bb->exit( &h ) == 0 );
+	free( buf );
+	free( chk );
+	printf("OK\n");
+	return 0;
+
+abort:
+	if( running ){
+		src.ack = IRQ_ROUNDS;
+		pthread_join( thread, NULL );
+	}
+	if( h )
+		bb->exit( &h );
+	free( buf );
+	free( chk );
+	return 1;
+}
+
+/******************************** IrqSource *********************************
+ *
+ *  Description: Raise slot 0 interrupts on the fake bridge
+ *
+ *               Sets the IRQ bit of the control register through the
+ *               file, i.e. not through the mapping of the BBIS, and waits
+ *               (sleeping, the poller owns the CPU) until it was serviced
+ *               before the next one.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg		IRQ_SRC
+ *  Output.....: return		NULL
+ *  Globals....: -
+ ****************************************************************************/
+static void *IrqSource( void *arg )
+{
+	IRQ_SRC *src = (IRQ_SRC*)arg;
+	u_int8 ctrl = FAKE_CTRL_IRQ;
+	u_int32 n;
+
+	for( n=0; n<src->rounds && src->ack < src->rounds; n++ ){
+		usleep( IRQ_DELAY_US );
+		clock_gettime( CLOCK_MONOTONIC, &src->raised );
+		__sync_synchronize();
+		if( pwrite( src->fd, &ctrl, 1, FAKE_CTRL_OFFS ) != 1 )
+			break;
+		while( src->ack <= n && src->ack < src->rounds )
+			usleep( 10 );
+	}
+	return NULL;
+}
+
+/******************************** FakeCreate ********************************
+ *
+ *  Description: Create a sysfs tree with a fake A12 at bus 0 device 0x18
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: root		buffer (64 bytes)
+ *  Output.....: *root		root of the tree
+ *               return		success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 FakeCreate( char *root )
+{
+	static const char *dirs[] = { "bus", "bus/pci", "bus/pci/devices",
+								  FAKE_DEV_DIR };
+	u_int8 cfg[64];
+	char path[128], res[256];
+	u_int32 i;
+	int fd;
+
+	snprintf( root, 64, "/tmp/a12uio.%d", (int)getpid() );
+	if( mkdir( root, 0700 ) )
+		return 1;
+	for( i=0; i<sizeof(dirs)/sizeof(dirs[0]); i++ ){
+		snprintf( path, sizeof(path), "%s/%s", root, dirs[i] );
+		if( mkdir( path, 0700 ) )
+			return 1;
+	}
+
+	/* config space, little endian */
+	memset( cfg, 0, sizeof(cfg) );
+	cfg[0x00] = FAKE_VEN_ID & 0xff;
+	cfg[0x01] = FAKE_VEN_ID >> 8;
+	cfg[0x02] = FAKE_DEV_ID & 0xff;
+	cfg[0x03] = FAKE_DEV_ID >> 8;
+	for( i=0; i<4; i++ )
+		cfg[0x10 + i] = (u_int8)(FAKE_BAR0 >> (8 * i));
+	cfg[0x10] |= 0x08;			/* prefetchable */
+	cfg[0x3c] = FAKE_IRQ_LINE;
+	if( WriteFile( root, "config", cfg, sizeof(cfg) ) )
+		return 1;
+
+	/* resource: BAR0, the other BARs unused */
+	i = snprintf( res, sizeof(res), "0x%016llx 0x%016llx 0x%016llx\n",
+				  (unsigned long long)FAKE_BAR0,
+				  (unsigned long long)FAKE_BAR0 + FAKE_BAR0_SIZE - 1,
+				  0x42208ULL );
+	while( i + 60 < sizeof(res) )
+		i += snprintf( res + i, sizeof(res) - i, "0x%016llx 0x%016llx "
+					   "0x%016llx\n", 0ULL, 0ULL, 0ULL );
+	if( WriteFile( root, "resource", res, i ) )
+		return 1;
+
+	/* BAR0: sparse file, resource0_wc maps the same BAR */
+	snprintf( path, sizeof(path), "%s/%s/resource0", root, FAKE_DEV_DIR );
+	if( (fd = open( path, O_RDWR | O_CREAT | O_TRUNC, 0600 )) < 0 )
+		return 1;
+	i = ftruncate( fd, FAKE_BAR0_SIZE ) ? 1 : 0;
+	close( fd );
+	snprintf( res, sizeof(res), "%s_wc", path );
+	if( !i && link( path, res ) )
+		i = 1;
+	return i;
+}
+
+/******************************** FakeRemove ********************************
+ *
+ *  Description: Remove the fake sysfs tree
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: root		root of the tree
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void FakeRemove( const char *root )
+{
+	static const char *names[] = {
+		FAKE_DEV_DIR "/config", FAKE_DEV_DIR "/resource",
+		FAKE_DEV_DIR "/resource0", FAKE_DEV_DIR "/resource0_wc",
+		FAKE_DEV_DIR,
+		"bus/pci/devices", "bus/pci", "bus", "" };
+	char path[128];
+	u_int32 i;
+
+	for( i=0; i<sizeof(names)/sizeof(names[0]); i++ ){
+		snprintf( path, sizeof(path), "%s/%s", root, names[i] );
+		remove( path );
+	}
+}
+
+/********************************* WriteFile ********************************
+ *
+ *  Description: Write a file of the fake bridge
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: root		root of the tree
+ *               name		file name in the device directory
+ *               buf		contents
+ *               size		size of contents
+ *  Output.....: return		success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 WriteFile( const char *root, const char *name,
+						const void *buf, u_int32 size )
+{
+	char path[128];
+	int32 ret;
+	int fd;
+
+	snprintf( path, sizeof(path), "%s/%s/%s", root, FAKE_DEV_DIR, name );
+	if( (fd = open( path, O_WRONLY | O_CREAT | O_TRUNC, 0600 )) < 0 )
+		return 1;
+	ret = (write( fd, buf, size ) == (ssize_t)size) ? 0 : 1;
+	close( fd );
+	return ret;
+}
+
+/********************************** NowNs ***********************************
+ *
+ *  Description: Monotonic time
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return		time [ns]
+ *  Globals....: -
+ ****************************************************************************/
+static u_int64 NowNs( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (u_int64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}